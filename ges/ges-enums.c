@@ -71,6 +71,30 @@ ges_pipeline_flags_get_type (void)
   return id;
 }
 
+static void
+register_ges_preview_quality (GType * id)
+{
+  static const GEnumValue values[] = {
+    {C_ENUM (GES_PREVIEW_QUALITY_FULL), "GES_PREVIEW_QUALITY_FULL", "full"},
+    {C_ENUM (GES_PREVIEW_QUALITY_HALF), "GES_PREVIEW_QUALITY_HALF", "half"},
+    {C_ENUM (GES_PREVIEW_QUALITY_QUARTER), "GES_PREVIEW_QUALITY_QUARTER",
+        "quarter"},
+    {0, NULL, NULL}
+  };
+
+  *id = g_enum_register_static ("GESPreviewQuality", values);
+}
+
+GType
+ges_preview_quality_get_type (void)
+{
+  static GType id;
+  static GOnce once = G_ONCE_INIT;
+
+  g_once (&once, (GThreadFunc) register_ges_preview_quality, &id);
+  return id;
+}
+
 static GEnumValue transition_types[] = {
   {
         0,
@@ -323,6 +323,30 @@ typedef enum {
 
 GType ges_pipeline_flags_get_type (void);
 
+/**
+ * GESPreviewQuality:
+ * @GES_PREVIEW_QUALITY_FULL: preview video at the full resolution (default)
+ * @GES_PREVIEW_QUALITY_HALF: preview video at half the width and height
+ * @GES_PREVIEW_QUALITY_QUARTER: preview video at a quarter of the width and
+ * height
+ *
+ * The resolution a #GESTimelinePipeline previews video at, relative to the
+ * resolution it renders at. The value of each level is the factor the width
+ * and height are divided by.
+ *
+ * Since: 0.10.2
+ */
+typedef enum {
+  GES_PREVIEW_QUALITY_FULL	= 1,
+  GES_PREVIEW_QUALITY_HALF	= 2,
+  GES_PREVIEW_QUALITY_QUARTER	= 4
+} GESPreviewQuality;
+
+#define GES_TYPE_PREVIEW_QUALITY\
+  ges_preview_quality_get_type()
+
+GType ges_preview_quality_get_type (void);
+
 G_END_DECLS
 
 #endif /* __GES_ENUMS_H__ */
@@ -22,8 +22,141 @@
 #define __GES_INTERNAL_H__
 
 #include <gst/gst.h>
+#include <gst/pbutils/encoding-profile.h>
+#include "ges-types.h"
 
 GST_DEBUG_CATEGORY_EXTERN (_ges_debug);
 #define GST_CAT_DEFAULT _ges_debug
 
+/* Colourspace conversion elimination (ges-utils.c) */
+gboolean ges_element_is_colorspace_converter (GstElement * element);
+guint    ges_bin_remove_redundant_converters (GstBin * bin,
+                                              const GstCaps * track_caps);
+guint    ges_bin_count_converters            (GstBin * bin);
+
+/* Decoded image cache (ges-track-image-source.c) */
+void     ges_track_image_source_cache_set_max_size (guint64 size);
+void     ges_track_image_source_cache_get_stats (guint64 * size,
+                                              guint * n_frames,
+                                              guint * decodes);
+
+/* Layer/track muting */
+gboolean ges_timeline_layer_is_audible       (GESTimelineLayer * layer);
+gboolean ges_timeline_has_solo_layer         (GESTimeline * timeline);
+gboolean ges_timeline_has_solo_track         (GESTimeline * timeline);
+void     ges_track_resync_muted_objects      (GESTrack * track);
+void     ges_track_resync_muted_object       (GESTrack * track,
+                                              GESTrackObject * object);
+
+/* Layer priority allocation (ges-timeline.c, ges-timeline-layer.c)
+ *
+ * Each layer of a timeline owns the band of gnl priorities
+ * [min_gnl_priority, max_gnl_priority]. The timeline gives the bands out
+ * with gaps between them, so that moving a layer or growing it only
+ * renumbers the objects of the few layers whose band has to move. */
+#define LAYER_HEIGHT 1000
+
+void     ges_timeline_place_layer            (GESTimeline * timeline,
+                                              GESTimelineLayer * layer);
+void     ges_timeline_grow_layer             (GESTimeline * timeline,
+                                              GESTimelineLayer * layer);
+guint32  ges_timeline_layer_get_height       (GESTimelineLayer * layer);
+void     ges_timeline_layer_reserve_height   (GESTimelineLayer * layer,
+                                              guint32 height);
+void     ges_timeline_layer_set_gnl_range    (GESTimelineLayer * layer,
+                                              guint32 min, guint32 max);
+
+/* Batched edits (ges-track.c, ges-timeline.c) */
+void     ges_track_set_batch                 (GESTrack * track, gboolean batch);
+void     ges_timeline_hold_notify            (GESTimeline * timeline,
+                                              GObject * object);
+
+/* Look-ahead pre-rolling (ges-track.c) */
+void     ges_track_lookahead_update          (GESTrack * track,
+                                              GstClockTime position);
+gboolean ges_track_is_prerolling             (GESTrack * track,
+                                              GESTrackObject * object);
+
+/* Track object changes (ges-track-object.c)
+ *
+ * Changes to the timing of a track object are dispatched to its timeline
+ * object and its track with direct calls, rather than through "notify::"
+ * handlers. The public notification follows. */
+typedef enum
+{
+  GES_CHANGE_START,
+  GES_CHANGE_INPOINT,
+  GES_CHANGE_DURATION,
+  GES_CHANGE_PRIORITY,
+  GES_CHANGE_ACTIVE             /* Only dispatched to the track */
+} GESChangeType;
+
+void     ges_timeline_object_track_object_changed (GESTimelineObject * object,
+                                                   GESTrackObject * child,
+                                                   GESChangeType type);
+void     ges_track_track_object_changed      (GESTrack * track,
+                                              GESTrackObject * object,
+                                              GESChangeType type);
+
+/* Timeline snapshots (ges-timeline-snapshot.c)
+ *
+ * The snapshots cache the record of each object and layer on it. Any change
+ * that shows in a snapshot must drop the records with these. */
+void     ges_timeline_snapshot_object_changed (GESTimelineObject * object);
+void     ges_timeline_snapshot_layer_changed (GESTimelineLayer * layer);
+
+/* Deep copies of timeline objects are created from their record, which is
+ * applied to each track once the copy created its track objects in it. */
+GESTimelineObject *ges_timeline_snapshot_copy_object (GESTimelineObject * object);
+void     ges_timeline_snapshot_apply_pending (GESTimelineObject * object,
+                                              GESTrack * track);
+
+/* Nested timelines are watched for changes and compared by snapshot */
+void     ges_timeline_snapshot_timeline_changed (GESTimeline * timeline);
+gulong   ges_timeline_snapshot_watch         (GESTimeline * timeline,
+                                              GHookFunc func, gpointer data,
+                                              GDestroyNotify destroy);
+void     ges_timeline_snapshot_unwatch       (GESTimeline * timeline,
+                                              gulong id);
+gboolean ges_timeline_snapshot_equal         (GESTimelineSnapshot * snapshot,
+                                              GESTimelineSnapshot * other);
+GESTrackType ges_timeline_snapshot_get_track_types (GESTimelineSnapshot * snapshot);
+GESTimeline *ges_timeline_snapshot_create_timeline_for_types (GESTimelineSnapshot * snapshot,
+                                              GESTrackType types);
+
+/* Background renders (ges-timeline-pipeline.c) */
+GESTimelinePipeline *ges_timeline_pipeline_render_background (GESTimeline * timeline,
+                                              const gchar * output_uri,
+                                              GstEncodingProfile * profile);
+
+/* Edit-latency tracing (ges-trace.c)
+ *
+ * Every GES_TRACE_BEGIN must be matched by a GES_TRACE_END on all the
+ * return paths of the traced function. GES_TRACE_COUNT adds to the number
+ * of objects touched by the innermost open span. */
+#ifndef GES_DISABLE_TRACING
+extern gboolean _ges_trace_enabled;
+
+void     _ges_trace_begin                    (const gchar * name);
+void     _ges_trace_count                    (guint objects);
+void     _ges_trace_end                      (void);
+
+#define GES_TRACE_BEGIN(name) G_STMT_START {    \
+    if (G_UNLIKELY (_ges_trace_enabled))        \
+      _ges_trace_begin (name);                  \
+  } G_STMT_END
+#define GES_TRACE_COUNT(n) G_STMT_START {       \
+    if (G_UNLIKELY (_ges_trace_enabled))        \
+      _ges_trace_count (n);                     \
+  } G_STMT_END
+#define GES_TRACE_END() G_STMT_START {          \
+    if (G_UNLIKELY (_ges_trace_enabled))        \
+      _ges_trace_end ();                        \
+  } G_STMT_END
+#else
+#define GES_TRACE_BEGIN(name) G_STMT_START { } G_STMT_END
+#define GES_TRACE_COUNT(n)    G_STMT_START { } G_STMT_END
+#define GES_TRACE_END()       G_STMT_START { } G_STMT_END
+#endif
+
 #endif /* __GES_INTERNAL_H__ */
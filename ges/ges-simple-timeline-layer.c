@@ -172,7 +172,8 @@ gstl_recalculate (GESSimpleTimelineLayer * self)
   gboolean valid = TRUE;
   GESSimpleTimelineLayerPrivate *priv = self->priv;
 
-  priority = GES_TIMELINE_LAYER (self)->min_gnl_priority + 2;
+  /* Object priorities are relative to the priority band of the layer */
+  priority = 2;
 
   GST_DEBUG ("recalculating values");
 
@@ -271,8 +272,6 @@ gstl_recalculate (GESSimpleTimelineLayer * self)
   GST_DEBUG ("Finished recalculating: final start pos is: %" GST_TIME_FORMAT,
       GST_TIME_ARGS (pos));
 
-  GES_TIMELINE_LAYER (self)->max_gnl_priority = priority;
-
   if (valid != self->priv->valid) {
     self->priv->valid = valid;
     g_object_notify (G_OBJECT (self), "valid");
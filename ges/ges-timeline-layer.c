@@ -35,8 +35,6 @@
 #include "ges.h"
 #include "ges-timeline-source.h"
 
-#define LAYER_HEIGHT 1000
-
 static void
 track_object_removed_cb (GESTimelineObject * object,
     GESTrackObject * track_object);
@@ -63,8 +61,13 @@ struct _GESTimelineLayerPrivate
   guint32 priority;             /* The priority of the layer within the 
                                  * containing timeline */
 
+  guint32 height;               /* The number of gnl priorities the objects
+                                 * need, see ges_timeline_layer_reserve_height() */
+
   gboolean auto_transition;
 
+  gboolean muted;
+  gboolean solo;
 
   GHashTable *signal_table;
 };
@@ -74,6 +77,8 @@ enum
   PROP_0,
   PROP_PRIORITY,
   PROP_AUTO_TRANSITION,
+  PROP_MUTED,
+  PROP_SOLO,
   PROP_LAST
 };
 
@@ -106,6 +111,12 @@ ges_timeline_layer_get_property (GObject * object, guint property_id,
     case PROP_AUTO_TRANSITION:
       g_value_set_boolean (value, layer->priv->auto_transition);
       break;
+    case PROP_MUTED:
+      g_value_set_boolean (value, layer->priv->muted);
+      break;
+    case PROP_SOLO:
+      g_value_set_boolean (value, layer->priv->solo);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -125,6 +136,12 @@ ges_timeline_layer_set_property (GObject * object, guint property_id,
       ges_timeline_layer_set_auto_transition (layer,
           g_value_get_boolean (value));
       break;
+    case PROP_MUTED:
+      ges_timeline_layer_set_muted (layer, g_value_get_boolean (value));
+      break;
+    case PROP_SOLO:
+      ges_timeline_layer_set_solo (layer, g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -177,6 +194,30 @@ ges_timeline_layer_class_init (GESTimelineLayerClass * klass)
       g_param_spec_boolean ("auto-transition", "Auto-Transition",
           "whether the transitions are added", FALSE, G_PARAM_READWRITE));
 
+  /**
+   * GESTimelineLayer:muted
+   *
+   * Whether the layer is muted. The objects of a muted layer are taken out of
+   * the compositions of the timeline tracks until the layer is unmuted.
+   *
+   * Since: 0.10.2
+   */
+  g_object_class_install_property (object_class, PROP_MUTED,
+      g_param_spec_boolean ("muted", "Muted",
+          "Whether the layer is muted", FALSE, G_PARAM_READWRITE));
+
+  /**
+   * GESTimelineLayer:solo
+   *
+   * Whether the layer is soloed. As soon as one layer of a #GESTimeline is
+   * soloed, only the soloed layers are played.
+   *
+   * Since: 0.10.2
+   */
+  g_object_class_install_property (object_class, PROP_SOLO,
+      g_param_spec_boolean ("solo", "Solo",
+          "Whether the layer is soloed", FALSE, G_PARAM_READWRITE));
+
   /**
    * GESTimelineLayer::object-added
    * @layer: the #GESTimelineLayer
@@ -213,7 +254,7 @@ ges_timeline_layer_init (GESTimelineLayer * self)
   self->priv->priority = 0;
   self->priv->auto_transition = FALSE;
   self->min_gnl_priority = 0;
-  self->max_gnl_priority = LAYER_HEIGHT;
+  self->max_gnl_priority = G_MAXUINT32;
   self->priv->signal_table =
       g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref,
       NULL);
@@ -239,6 +280,12 @@ ges_timeline_layer_set_timeline (GESTimelineLayer * layer,
   GST_DEBUG ("layer:%p, timeline:%p", layer, timeline);
 
   layer->timeline = timeline;
+
+  /* Out of a timeline, the layer has the priorities to itself */
+  if (!timeline) {
+    layer->min_gnl_priority = layer->priv->priority * LAYER_HEIGHT;
+    layer->max_gnl_priority = G_MAXUINT32;
+  }
 }
 
 static gint
@@ -297,7 +344,6 @@ ges_timeline_layer_add_object (GESTimelineLayer * layer,
     GESTimelineObject * object)
 {
   GESTimelineLayer *tl_obj_layer;
-  guint32 maxprio, minprio, prio;
 
   GST_DEBUG ("layer:%p, object:%p", layer, object);
 
@@ -309,6 +355,9 @@ ges_timeline_layer_add_object (GESTimelineLayer * layer,
     return FALSE;
   }
 
+  GES_TRACE_BEGIN ("timeline-layer-add-object");
+  GES_TRACE_COUNT (1);
+
   g_object_ref_sink (object);
 
   /* Take a reference to the object and store it stored by start/priority */
@@ -333,24 +382,18 @@ ges_timeline_layer_add_object (GESTimelineLayer * layer,
       GES_TIMELINE_OBJECT_PRIORITY (object),
       layer->min_gnl_priority, layer->max_gnl_priority);
 
-  /* Set the priority. */
-  maxprio = layer->max_gnl_priority;
-  minprio = layer->min_gnl_priority;
-  prio = GES_TIMELINE_OBJECT_PRIORITY (object);
-  if (minprio + prio > (maxprio)) {
-    GST_WARNING ("%p is out of the layer %p space, setting its priority to "
-        "setting its priority %d to failthe maximum priority of the layer %d",
-        object, layer, prio, maxprio - minprio);
-    ges_timeline_object_set_priority (object, LAYER_HEIGHT - 1);
-  }
-  /* If the object has an acceptable priority, we just let it with its current
-   * priority */
+  /* Put the object in the priority band of the layer, which grows if the
+   * object doesn't fit in it */
+  ges_timeline_object_set_priority (object, GES_TIMELINE_OBJECT_PRIORITY
+      (object));
 
-  ges_timeline_layer_resync_priorities (layer);
+  ges_timeline_snapshot_layer_changed (layer);
 
   /* emit 'object-added' */
   g_signal_emit (layer, ges_timeline_layer_signals[OBJECT_ADDED], 0, object);
 
+  GES_TRACE_END ();
+
   return TRUE;
 }
 
@@ -464,8 +507,11 @@ static void
 track_object_changed_cb (GESTrackObject * track_object,
     GParamSpec * arg G_GNUC_UNUSED)
 {
-  if (G_LIKELY (GES_IS_TRACK_SOURCE (track_object)))
+  if (G_LIKELY (GES_IS_TRACK_SOURCE (track_object))) {
+    GES_TRACE_BEGIN ("timeline-layer-calculate-transitions");
     calculate_transitions (track_object);
+    GES_TRACE_END ();
+  }
 }
 
 static void
@@ -791,6 +837,9 @@ ges_timeline_layer_remove_object (GESTimelineLayer * layer,
   }
   g_object_unref (tl_obj_layer);
 
+  GES_TRACE_BEGIN ("timeline-layer-remove-object");
+  GES_TRACE_COUNT (1);
+
   if (layer->priv->auto_transition) {
     trackobjects = ges_timeline_object_get_track_objects (object);
 
@@ -804,6 +853,8 @@ ges_timeline_layer_remove_object (GESTimelineLayer * layer,
   g_hash_table_foreach_remove (layer->priv->signal_table,
       (GHRFunc) disconnect_handlers, NULL);
 
+  ges_timeline_snapshot_layer_changed (layer);
+
   /* emit 'object-removed' */
   g_signal_emit (layer, ges_timeline_layer_signals[OBJECT_REMOVED], 0, object);
 
@@ -817,6 +868,8 @@ ges_timeline_layer_remove_object (GESTimelineLayer * layer,
   /* Remove our reference to the object */
   g_object_unref (object);
 
+  GES_TRACE_END ();
+
   return TRUE;
 }
 
@@ -863,10 +916,78 @@ ges_timeline_layer_set_priority (GESTimelineLayer * layer, guint priority)
   GST_DEBUG ("layer:%p, priority:%d", layer, priority);
 
   if (priority != layer->priv->priority) {
+    GES_TRACE_BEGIN ("timeline-layer-set-priority");
+
     layer->priv->priority = priority;
-    layer->min_gnl_priority = (priority * LAYER_HEIGHT);
-    layer->max_gnl_priority = ((priority + 1) * LAYER_HEIGHT) - 1;
+    ges_timeline_snapshot_layer_changed (layer);
 
+    if (layer->timeline)
+      ges_timeline_place_layer (layer->timeline, layer);
+    else
+      ges_timeline_layer_set_gnl_range (layer, priority * LAYER_HEIGHT,
+          G_MAXUINT32);
+
+    GES_TRACE_END ();
+  }
+}
+
+/* ges_timeline_layer_get_height:
+ * @layer: a #GESTimelineLayer
+ *
+ * Returns: the number of gnl priorities @layer needs for its objects, at
+ * least LAYER_HEIGHT.
+ */
+guint32
+ges_timeline_layer_get_height (GESTimelineLayer * layer)
+{
+  return MAX (layer->priv->height, LAYER_HEIGHT);
+}
+
+/* ges_timeline_layer_reserve_height:
+ * @layer: a #GESTimelineLayer
+ * @height: the number of gnl priorities, from the first one of @layer, an
+ * object is going to use
+ *
+ * Makes sure the priority band of @layer is large enough for @height,
+ * asking the timeline for more room if it isn't.
+ */
+void
+ges_timeline_layer_reserve_height (GESTimelineLayer * layer, guint32 height)
+{
+  if (height <= layer->priv->height)
+    return;
+
+  layer->priv->height = height;
+
+  if (layer->timeline && (guint64) layer->min_gnl_priority +
+      ges_timeline_layer_get_height (layer) >
+      (guint64) layer->max_gnl_priority + 1) {
+    GST_DEBUG ("layer %p needs %u priorities, it only has %u/%u", layer,
+        height, layer->min_gnl_priority, layer->max_gnl_priority);
+    ges_timeline_grow_layer (layer->timeline, layer);
+  }
+}
+
+/* ges_timeline_layer_set_gnl_range:
+ * @layer: a #GESTimelineLayer
+ * @min: the first gnl priority of @layer
+ * @max: the last gnl priority of @layer
+ *
+ * Sets the priority band of @layer. Its objects are only renumbered if the
+ * band starts somewhere else.
+ */
+void
+ges_timeline_layer_set_gnl_range (GESTimelineLayer * layer, guint32 min,
+    guint32 max)
+{
+  gboolean moved = (min != layer->min_gnl_priority);
+
+  layer->min_gnl_priority = min;
+  layer->max_gnl_priority = max;
+
+  if (moved) {
+    GST_DEBUG ("layer %p now starts at %u", layer, min);
+    GES_TRACE_COUNT (g_list_length (layer->priv->objects_start));
     ges_timeline_layer_resync_priorities (layer);
   }
 }
@@ -915,6 +1036,7 @@ ges_timeline_layer_set_auto_transition (GESTimelineLayer * layer,
     /* FIXME calculate all the transitions at that time */
   }
   layer->priv->auto_transition = auto_transition;
+  ges_timeline_snapshot_layer_changed (layer);
 }
 
 /**
@@ -967,3 +1089,165 @@ ges_timeline_layer_get_objects (GESTimelineLayer * layer)
   ret = g_list_reverse (ret);
   return ret;
 }
+
+/**
+ * ges_timeline_layer_set_muted:
+ * @layer: a #GESTimelineLayer
+ * @muted: whether @layer should be muted
+ *
+ * Mutes or unmutes @layer. The objects of a muted layer are removed from the
+ * compositions of the timeline tracks, in a single update per track.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_timeline_layer_set_muted (GESTimelineLayer * layer, gboolean muted)
+{
+  g_return_if_fail (GES_IS_TIMELINE_LAYER (layer));
+
+  if (layer->priv->muted == muted)
+    return;
+
+  GST_DEBUG ("layer:%p, muted:%d", layer, muted);
+
+  layer->priv->muted = muted;
+  ges_timeline_snapshot_layer_changed (layer);
+  g_object_notify (G_OBJECT (layer), "muted");
+}
+
+/**
+ * ges_timeline_layer_get_muted:
+ * @layer: a #GESTimelineLayer
+ *
+ * Returns: %TRUE if @layer is muted, else %FALSE.
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_timeline_layer_get_muted (GESTimelineLayer * layer)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE_LAYER (layer), FALSE);
+
+  return layer->priv->muted;
+}
+
+/**
+ * ges_timeline_layer_set_solo:
+ * @layer: a #GESTimelineLayer
+ * @solo: whether @layer should be soloed
+ *
+ * Solos or unsolos @layer. When at least one layer of the timeline is soloed,
+ * the objects of the other layers are removed from the compositions of the
+ * timeline tracks.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_timeline_layer_set_solo (GESTimelineLayer * layer, gboolean solo)
+{
+  g_return_if_fail (GES_IS_TIMELINE_LAYER (layer));
+
+  if (layer->priv->solo == solo)
+    return;
+
+  GST_DEBUG ("layer:%p, solo:%d", layer, solo);
+
+  layer->priv->solo = solo;
+  ges_timeline_snapshot_layer_changed (layer);
+  g_object_notify (G_OBJECT (layer), "solo");
+}
+
+/**
+ * ges_timeline_layer_get_solo:
+ * @layer: a #GESTimelineLayer
+ *
+ * Returns: %TRUE if @layer is soloed, else %FALSE.
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_timeline_layer_get_solo (GESTimelineLayer * layer)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE_LAYER (layer), FALSE);
+
+  return layer->priv->solo;
+}
+
+/**
+ * ges_timeline_layer_paste_objects:
+ * @layer: a #GESTimelineLayer
+ * @objects: (element-type GESTimelineObject): the #GESTimelineObject-s to
+ * paste
+ * @position: the position at which the earliest of @objects is pasted (in
+ * nanoseconds)
+ *
+ * Adds deep copies of @objects (see ges_timeline_object_copy()) to @layer,
+ * keeping the offsets between them. If @layer is in a timeline, they are all
+ * added in a single batch (see ges_timeline_begin_batch()).
+ *
+ * Returns: (transfer container) (element-type GESTimelineObject): the copies
+ * which could be added to @layer, in the order of @objects. Free the list
+ * with g_list_free().
+ *
+ * Since: 0.10.2
+ */
+GList *
+ges_timeline_layer_paste_objects (GESTimelineLayer * layer, GList * objects,
+    GstClockTime position)
+{
+  GList *tmp, *ret = NULL;
+  GstClockTime earliest = GST_CLOCK_TIME_NONE;
+  GESTimeline *timeline;
+
+  g_return_val_if_fail (GES_IS_TIMELINE_LAYER (layer), NULL);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (position), NULL);
+
+  for (tmp = objects; tmp; tmp = tmp->next)
+    earliest = MIN (earliest, GES_TIMELINE_OBJECT_START (tmp->data));
+
+  GES_TRACE_BEGIN ("timeline-layer-paste-objects");
+
+  /* Keep the timeline around until the batch ends */
+  if ((timeline = layer->timeline)) {
+    g_object_ref (timeline);
+    ges_timeline_begin_batch (timeline);
+  }
+
+  for (tmp = objects; tmp; tmp = tmp->next) {
+    GESTimelineObject *copy = ges_timeline_object_copy (tmp->data, TRUE);
+
+    ges_timeline_object_set_start (copy,
+        position + GES_TIMELINE_OBJECT_START (tmp->data) - earliest);
+
+    if (!ges_timeline_layer_add_object (layer, copy)) {
+      GST_WARNING ("Couldn't paste a copy of %p", tmp->data);
+      g_object_unref (copy);
+      continue;
+    }
+
+    ret = g_list_prepend (ret, copy);
+    GES_TRACE_COUNT (1);
+  }
+
+  if (timeline) {
+    ges_timeline_end_batch (timeline);
+    g_object_unref (timeline);
+  }
+
+  GES_TRACE_END ();
+
+  return g_list_reverse (ret);
+}
+
+/* Whether the objects of @layer should currently be played */
+gboolean
+ges_timeline_layer_is_audible (GESTimelineLayer * layer)
+{
+  if (layer->priv->muted)
+    return FALSE;
+
+  if (layer->priv->solo || layer->timeline == NULL)
+    return TRUE;
+
+  return !ges_timeline_has_solo_layer (layer->timeline);
+}
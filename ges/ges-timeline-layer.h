@@ -111,6 +111,18 @@ void ges_timeline_layer_set_auto_transition (GESTimelineLayer * layer, gboolean
 
 GList*   ges_timeline_layer_get_objects   (GESTimelineLayer * layer);
 
+void     ges_timeline_layer_set_muted     (GESTimelineLayer * layer,
+					   gboolean muted);
+gboolean ges_timeline_layer_get_muted     (GESTimelineLayer * layer);
+
+void     ges_timeline_layer_set_solo      (GESTimelineLayer * layer,
+					   gboolean solo);
+gboolean ges_timeline_layer_get_solo      (GESTimelineLayer * layer);
+
+GList*   ges_timeline_layer_paste_objects (GESTimelineLayer * layer,
+					   GList * objects,
+					   GstClockTime position);
+
 G_END_DECLS
 
 #endif /* _GES_TIMELINE_LAYER */
@@ -0,0 +1,501 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:ges-timeline-nested-source
+ * @short_description: Use a #GESTimeline as a source in another
+ * #GESTimelineLayer
+ *
+ * A #GESTimelineNestedSource outputs the tracks of another #GESTimeline,
+ * which makes it possible to group objects into a compound clip that can be
+ * moved, trimmed and given effects as a whole.
+ *
+ * The nested timeline can keep being edited. Changes are picked up from the
+ * main loop, and replace the track objects of the source, so they show up
+ * in the timelines using it.
+ *
+ * With ges_timeline_nested_source_set_render_cache(), the nested timeline is
+ * also rendered to a file in the background each time it changes, and the
+ * source plays that file instead of the nested timeline once the render is
+ * done.
+ */
+
+#include "ges-internal.h"
+#include "ges-timeline-nested-source.h"
+#include "ges-timeline-source.h"
+#include "ges-timeline-snapshot.h"
+#include "ges-timeline-pipeline.h"
+#include "ges-timeline.h"
+#include "ges-timeline-layer.h"
+#include "ges-track-object.h"
+#include "ges-track-effect.h"
+#include "ges-track-nested-source.h"
+#include "ges-track.h"
+
+G_DEFINE_TYPE (GESTimelineNestedSource, ges_timeline_nested_source,
+    GES_TYPE_TIMELINE_SOURCE);
+
+struct _GESTimelineNestedSourcePrivate
+{
+  GESTimeline *timeline;
+  gulong watch_id;
+  guint update_id;
+
+  /* What the track objects currently output */
+  GESTimelineSnapshot *snapshot;
+
+  /* Render cache */
+  gchar *cache_uri;
+  GstEncodingProfile *cache_profile;
+  GESTimelinePipeline *render;
+  guint render_watch_id;
+  gboolean cached;
+};
+
+enum
+{
+  PROP_0,
+  PROP_TIMELINE,
+};
+
+static GESTrackObject
+    * ges_timeline_nested_source_create_track_object (GESTimelineObject * obj,
+    GESTrack * track);
+static void nested_changed (GESTimelineNestedSource * self);
+
+static void
+ges_timeline_nested_source_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GESTimelineNestedSourcePrivate *priv =
+      GES_TIMELINE_NESTED_SOURCE (object)->priv;
+
+  switch (property_id) {
+    case PROP_TIMELINE:
+      g_value_set_object (value, priv->timeline);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+  }
+}
+
+static GstClockTime
+timeline_duration (GESTimeline * timeline)
+{
+  GList *layers, *objects, *tmp, *otmp;
+  GstClockTime duration = 0;
+
+  layers = ges_timeline_get_layers (timeline);
+  for (tmp = layers; tmp; tmp = tmp->next) {
+    objects = ges_timeline_layer_get_objects (tmp->data);
+    for (otmp = objects; otmp; otmp = otmp->next) {
+      GESTimelineObject *object = otmp->data;
+
+      duration = MAX (duration, GES_TIMELINE_OBJECT_START (object) +
+          GES_TIMELINE_OBJECT_DURATION (object));
+      g_object_unref (object);
+    }
+    g_list_free (objects);
+    g_object_unref (tmp->data);
+  }
+  g_list_free (layers);
+
+  return duration;
+}
+
+static void
+set_timeline (GESTimelineNestedSource * self, GESTimeline * timeline)
+{
+  GESTimelineNestedSourcePrivate *priv = self->priv;
+  GESTimelineObject *object = (GESTimelineObject *) self;
+
+  if (timeline == NULL)
+    return;
+
+  priv->timeline = g_object_ref (timeline);
+  priv->snapshot = ges_timeline_snapshot_new (timeline);
+  priv->watch_id = ges_timeline_snapshot_watch (timeline,
+      (GHookFunc) nested_changed, self, NULL);
+
+  ges_timeline_object_set_supported_formats (object,
+      ges_timeline_snapshot_get_track_types (priv->snapshot));
+
+  if (object->duration == 0)
+    g_object_set (self, "duration", timeline_duration (timeline), NULL);
+}
+
+static void
+ges_timeline_nested_source_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GESTimelineNestedSource *self = GES_TIMELINE_NESTED_SOURCE (object);
+
+  switch (property_id) {
+    case PROP_TIMELINE:
+      set_timeline (self, g_value_get_object (value));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+  }
+}
+
+static void
+stop_render (GESTimelineNestedSource * self)
+{
+  GESTimelineNestedSourcePrivate *priv = self->priv;
+
+  if (priv->render_watch_id) {
+    g_source_remove (priv->render_watch_id);
+    priv->render_watch_id = 0;
+  }
+
+  if (priv->render) {
+    gst_element_set_state (GST_ELEMENT (priv->render), GST_STATE_NULL);
+    gst_object_unref (priv->render);
+    priv->render = NULL;
+  }
+}
+
+static void
+ges_timeline_nested_source_dispose (GObject * object)
+{
+  GESTimelineNestedSourcePrivate *priv =
+      GES_TIMELINE_NESTED_SOURCE (object)->priv;
+
+  if (priv->update_id) {
+    g_source_remove (priv->update_id);
+    priv->update_id = 0;
+  }
+
+  stop_render ((GESTimelineNestedSource *) object);
+
+  if (priv->timeline) {
+    ges_timeline_snapshot_unwatch (priv->timeline, priv->watch_id);
+    g_object_unref (priv->timeline);
+    priv->timeline = NULL;
+  }
+
+  if (priv->snapshot) {
+    ges_timeline_snapshot_unref (priv->snapshot);
+    priv->snapshot = NULL;
+  }
+
+  if (priv->cache_profile) {
+    gst_encoding_profile_unref (priv->cache_profile);
+    priv->cache_profile = NULL;
+  }
+
+  G_OBJECT_CLASS (ges_timeline_nested_source_parent_class)->dispose (object);
+}
+
+static void
+ges_timeline_nested_source_finalize (GObject * object)
+{
+  g_free (GES_TIMELINE_NESTED_SOURCE (object)->priv->cache_uri);
+
+  G_OBJECT_CLASS (ges_timeline_nested_source_parent_class)->finalize (object);
+}
+
+static void
+ges_timeline_nested_source_class_init (GESTimelineNestedSourceClass * klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GESTimelineObjectClass *timobj_class = GES_TIMELINE_OBJECT_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (GESTimelineNestedSourcePrivate));
+
+  object_class->get_property = ges_timeline_nested_source_get_property;
+  object_class->set_property = ges_timeline_nested_source_set_property;
+  object_class->dispose = ges_timeline_nested_source_dispose;
+  object_class->finalize = ges_timeline_nested_source_finalize;
+
+  /**
+   * GESTimelineNestedSource:timeline:
+   *
+   * The #GESTimeline to output. It must not be used in a pipeline.
+   *
+   * Since: 0.10.2
+   */
+  g_object_class_install_property (object_class, PROP_TIMELINE,
+      g_param_spec_object ("timeline", "Timeline", "The timeline to output",
+          GES_TYPE_TIMELINE, G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
+  timobj_class->create_track_object =
+      ges_timeline_nested_source_create_track_object;
+  timobj_class->need_fill_track = FALSE;
+}
+
+static void
+ges_timeline_nested_source_init (GESTimelineNestedSource * self)
+{
+  self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
+      GES_TYPE_TIMELINE_NESTED_SOURCE, GESTimelineNestedSourcePrivate);
+
+  GES_TIMELINE_OBJECT (self)->duration = 0;
+}
+
+static GESTrackObject *
+ges_timeline_nested_source_create_track_object (GESTimelineObject * obj,
+    GESTrack * track)
+{
+  GESTimelineNestedSourcePrivate *priv =
+      GES_TIMELINE_NESTED_SOURCE (obj)->priv;
+
+  if (priv->snapshot == NULL ||
+      !(ges_timeline_snapshot_get_track_types (priv->snapshot) & track->type)) {
+    GST_DEBUG ("The nested timeline has no track of type %d", track->type);
+    return NULL;
+  }
+
+  return (GESTrackObject *) ges_track_nested_source_new (priv->snapshot,
+      priv->cached ? priv->cache_uri : NULL);
+}
+
+/* Replaces our track objects by new ones, which output the current snapshot,
+ * or the render cache */
+static void
+recreate_track_objects (GESTimelineNestedSource * self)
+{
+  GESTimelineObject *object = (GESTimelineObject *) self;
+  GESTimelineLayer *layer;
+  GESTimeline *timeline = NULL;
+  GList *trackobjects, *tmp;
+
+  layer = ges_timeline_object_get_layer (object);
+  if (layer) {
+    timeline = layer->timeline;
+    g_object_unref (layer);
+  }
+
+  if (timeline)
+    ges_timeline_begin_batch (timeline);
+
+  trackobjects = ges_timeline_object_get_track_objects (object);
+  for (tmp = trackobjects; tmp; tmp = tmp->next) {
+    GESTrackObject *trobj = (GESTrackObject *) tmp->data;
+    GESTrack *track = ges_track_object_get_track (trobj);
+
+    /* The effects on the source stay where they are */
+    if (GES_IS_TRACK_EFFECT (trobj) || track == NULL)
+      continue;
+
+    GST_DEBUG_OBJECT (self, "Replacing track object %p", trobj);
+
+    gst_object_ref (track);
+    ges_track_remove_object (track, trobj);
+    ges_timeline_object_release_track_object (object, trobj);
+
+    if (!ges_timeline_object_create_track_objects (object, track))
+      GST_WARNING_OBJECT (self, "error creating track objects");
+    gst_object_unref (track);
+  }
+  g_list_foreach (trackobjects, (GFunc) g_object_unref, NULL);
+  g_list_free (trackobjects);
+
+  if (timeline)
+    ges_timeline_end_batch (timeline);
+}
+
+static gboolean
+render_bus_cb (GstBus * bus, GstMessage * message,
+    GESTimelineNestedSource * self)
+{
+  GESTimelineNestedSourcePrivate *priv = self->priv;
+
+  switch (GST_MESSAGE_TYPE (message)) {
+    case GST_MESSAGE_EOS:
+      GST_DEBUG_OBJECT (self, "Render cache %s is ready", priv->cache_uri);
+
+      priv->render_watch_id = 0;
+      stop_render (self);
+      priv->cached = TRUE;
+      recreate_track_objects (self);
+      return FALSE;
+    case GST_MESSAGE_ERROR:
+      GST_WARNING_OBJECT (self, "Error rendering to %s, not using the cache",
+          priv->cache_uri);
+
+      priv->render_watch_id = 0;
+      stop_render (self);
+      return FALSE;
+    default:
+      return TRUE;
+  }
+}
+
+static void
+start_render (GESTimelineNestedSource * self)
+{
+  GESTimelineNestedSourcePrivate *priv = self->priv;
+  GstBus *bus;
+
+  priv->render = ges_timeline_pipeline_render_background
+      (ges_timeline_snapshot_create_timeline (priv->snapshot),
+      priv->cache_uri, priv->cache_profile);
+  if (priv->render == NULL) {
+    GST_WARNING_OBJECT (self, "Couldn't start rendering to %s",
+        priv->cache_uri);
+    return;
+  }
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (priv->render));
+  priv->render_watch_id = gst_bus_add_watch (bus, (GstBusFunc) render_bus_cb,
+      self);
+  gst_object_unref (bus);
+}
+
+static gboolean
+nested_update (GESTimelineNestedSource * self)
+{
+  GESTimelineNestedSourcePrivate *priv = self->priv;
+  GESTimelineSnapshot *snapshot;
+
+  priv->update_id = 0;
+
+  snapshot = ges_timeline_snapshot_new (priv->timeline);
+  if (ges_timeline_snapshot_equal (snapshot, priv->snapshot)) {
+    ges_timeline_snapshot_unref (snapshot);
+    return FALSE;
+  }
+
+  GST_DEBUG_OBJECT (self, "Nested timeline changed");
+
+  ges_timeline_snapshot_unref (priv->snapshot);
+  priv->snapshot = snapshot;
+  priv->cached = FALSE;
+  stop_render (self);
+
+  ges_timeline_object_set_supported_formats ((GESTimelineObject *) self,
+      ges_timeline_snapshot_get_track_types (snapshot));
+  recreate_track_objects (self);
+
+  if (priv->cache_uri)
+    start_render (self);
+
+  return FALSE;
+}
+
+/* Changes usually come in bursts, they are all handled at once */
+static void
+nested_changed (GESTimelineNestedSource * self)
+{
+  if (!self->priv->update_id)
+    self->priv->update_id = g_idle_add ((GSourceFunc) nested_update, self);
+}
+
+/**
+ * ges_timeline_nested_source_new:
+ * @timeline: the #GESTimeline to output
+ *
+ * Creates a new #GESTimelineNestedSource outputting @timeline. Its duration
+ * is the one of the content of @timeline.
+ *
+ * Returns: The newly created #GESTimelineNestedSource, or %NULL if there was
+ * an error.
+ *
+ * Since: 0.10.2
+ */
+GESTimelineNestedSource *
+ges_timeline_nested_source_new (GESTimeline * timeline)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), NULL);
+
+  return g_object_new (GES_TYPE_TIMELINE_NESTED_SOURCE, "timeline", timeline,
+      NULL);
+}
+
+/**
+ * ges_timeline_nested_source_get_timeline:
+ * @self: a #GESTimelineNestedSource
+ *
+ * Get the #GESTimeline @self outputs.
+ *
+ * Returns: (transfer none): the #GESTimeline @self outputs.
+ *
+ * Since: 0.10.2
+ */
+GESTimeline *
+ges_timeline_nested_source_get_timeline (GESTimelineNestedSource * self)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE_NESTED_SOURCE (self), NULL);
+
+  return self->priv->timeline;
+}
+
+/**
+ * ges_timeline_nested_source_set_render_cache:
+ * @self: a #GESTimelineNestedSource
+ * @uri: (allow-none): the URI to render the nested timeline to, or %NULL
+ * @profile: (allow-none): the #GstEncodingProfile to render with, with a
+ * stream for each track of the nested timeline
+ *
+ * Renders the nested timeline of @self to @uri in the background, now and
+ * each time it changes, and outputs the file instead of the nested timeline
+ * when the render is done. This makes heavy nested timelines cheap to play.
+ *
+ * A %NULL @uri stops using the render cache.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_timeline_nested_source_set_render_cache (GESTimelineNestedSource * self,
+    const gchar * uri, GstEncodingProfile * profile)
+{
+  GESTimelineNestedSourcePrivate *priv;
+  gboolean was_cached;
+
+  g_return_if_fail (GES_IS_TIMELINE_NESTED_SOURCE (self));
+  g_return_if_fail (uri == NULL || profile != NULL);
+
+  priv = self->priv;
+
+  GST_DEBUG_OBJECT (self, "render cache: %s", GST_STR_NULL (uri));
+
+  stop_render (self);
+  was_cached = priv->cached;
+  priv->cached = FALSE;
+
+  g_free (priv->cache_uri);
+  priv->cache_uri = g_strdup (uri);
+  if (priv->cache_profile)
+    gst_encoding_profile_unref (priv->cache_profile);
+  priv->cache_profile = uri ? gst_encoding_profile_ref (profile) : NULL;
+
+  if (was_cached)
+    recreate_track_objects (self);
+
+  if (priv->cache_uri && priv->snapshot)
+    start_render (self);
+}
+
+/**
+ * ges_timeline_nested_source_is_cached:
+ * @self: a #GESTimelineNestedSource
+ *
+ * Returns: %TRUE if @self outputs the render cache of its nested timeline,
+ * %FALSE if it outputs the nested timeline itself.
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_timeline_nested_source_is_cached (GESTimelineNestedSource * self)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE_NESTED_SOURCE (self), FALSE);
+
+  return self->priv->cached;
+}
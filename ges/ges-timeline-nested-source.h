@@ -0,0 +1,86 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _GES_TIMELINE_NESTED_SOURCE
+#define _GES_TIMELINE_NESTED_SOURCE
+
+#include <glib-object.h>
+#include <gst/pbutils/encoding-profile.h>
+#include <ges/ges-types.h>
+#include <ges/ges-timeline-source.h>
+
+G_BEGIN_DECLS
+
+#define GES_TYPE_TIMELINE_NESTED_SOURCE ges_timeline_nested_source_get_type()
+
+#define GES_TIMELINE_NESTED_SOURCE(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST ((obj), GES_TYPE_TIMELINE_NESTED_SOURCE, GESTimelineNestedSource))
+
+#define GES_TIMELINE_NESTED_SOURCE_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST ((klass), GES_TYPE_TIMELINE_NESTED_SOURCE, GESTimelineNestedSourceClass))
+
+#define GES_IS_TIMELINE_NESTED_SOURCE(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GES_TYPE_TIMELINE_NESTED_SOURCE))
+
+#define GES_IS_TIMELINE_NESTED_SOURCE_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE ((klass), GES_TYPE_TIMELINE_NESTED_SOURCE))
+
+#define GES_TIMELINE_NESTED_SOURCE_GET_CLASS(obj) \
+  (G_TYPE_INSTANCE_GET_CLASS ((obj), GES_TYPE_TIMELINE_NESTED_SOURCE, GESTimelineNestedSourceClass))
+
+typedef struct _GESTimelineNestedSourcePrivate GESTimelineNestedSourcePrivate;
+
+/**
+ * GESTimelineNestedSource:
+ */
+struct _GESTimelineNestedSource {
+  GESTimelineSource parent;
+
+  /*< private >*/
+  GESTimelineNestedSourcePrivate *priv;
+
+  /* Padding for API extension */
+  gpointer _ges_reserved[GES_PADDING];
+};
+
+/**
+ * GESTimelineNestedSourceClass:
+ */
+struct _GESTimelineNestedSourceClass {
+  /*< private >*/
+  GESTimelineSourceClass parent_class;
+
+  /* Padding for API extension */
+  gpointer _ges_reserved[GES_PADDING];
+};
+
+GType ges_timeline_nested_source_get_type (void);
+
+GESTimelineNestedSource* ges_timeline_nested_source_new (GESTimeline * timeline);
+
+GESTimeline *ges_timeline_nested_source_get_timeline (GESTimelineNestedSource * self);
+
+void ges_timeline_nested_source_set_render_cache (GESTimelineNestedSource * self,
+                                                  const gchar * uri,
+                                                  GstEncodingProfile * profile);
+
+gboolean ges_timeline_nested_source_is_cached (GESTimelineNestedSource * self);
+
+G_END_DECLS
+
+#endif /* _GES_TIMELINE_NESTED_SOURCE */
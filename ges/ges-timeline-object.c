@@ -66,9 +66,6 @@ static void
 get_layer_priorities (GESTimelineLayer * layer, guint32 * layer_min_gnl_prio,
     guint32 * layer_max_gnl_prio);
 
-static GESTimelineObject *ges_timeline_object_copy (GESTimelineObject * object,
-    gboolean * deep);
-
 G_DEFINE_ABSTRACT_TYPE (GESTimelineObject, ges_timeline_object,
     G_TYPE_INITIALLY_UNOWNED);
 
@@ -85,14 +82,17 @@ typedef struct
   gint64 inpoint_offset;
   gint32 priority_offset;
 
-  guint start_notifyid;
-  guint duration_notifyid;
-  guint inpoint_notifyid;
-  guint priority_notifyid;
+  /* Whether the changes of the object are followed */
+  gboolean listening;
+
+  /* The priority of the object in GESTimelineObjectPrivate.priorities */
+  GSequenceIter *priority_iter;
 
   /* track mapping ?? */
 } ObjectMapping;
 
+static void track_priority (GESTimelineObject * object, ObjectMapping * map);
+
 enum
 {
   EFFECT_ADDED,
@@ -122,6 +122,9 @@ struct _GESTimelineObjectPrivate
 
   GList *mappings;
 
+  /* The priorities of the track objects, sorted, to know the height */
+  GSequence *priorities;
+
   guint nb_effects;
 
   GESTrackObject *initiated_move;
@@ -206,6 +209,25 @@ ges_timeline_object_set_property (GObject * object, guint property_id,
   }
 }
 
+static void
+ges_timeline_object_finalize (GObject * object)
+{
+  g_sequence_free (GES_TIMELINE_OBJECT (object)->priv->priorities);
+
+  G_OBJECT_CLASS (ges_timeline_object_parent_class)->finalize (object);
+}
+
+static void
+ges_timeline_object_dispatch_properties_changed (GObject * object,
+    guint n_pspecs, GParamSpec ** pspecs)
+{
+  /* Any notified property change makes the cached snapshot record stale */
+  ges_timeline_snapshot_object_changed (GES_TIMELINE_OBJECT (object));
+
+  G_OBJECT_CLASS (ges_timeline_object_parent_class)->dispatch_properties_changed
+      (object, n_pspecs, pspecs);
+}
+
 static void
 ges_timeline_object_class_init (GESTimelineObjectClass * klass)
 {
@@ -215,6 +237,9 @@ ges_timeline_object_class_init (GESTimelineObjectClass * klass)
 
   object_class->get_property = ges_timeline_object_get_property;
   object_class->set_property = ges_timeline_object_set_property;
+  object_class->finalize = ges_timeline_object_finalize;
+  object_class->dispatch_properties_changed =
+      ges_timeline_object_dispatch_properties_changed;
   klass->create_track_objects = ges_timeline_object_create_track_objects_func;
   klass->track_object_added = NULL;
   klass->track_object_released = NULL;
@@ -373,6 +398,7 @@ ges_timeline_object_init (GESTimelineObject * self)
   self->priv->layer = NULL;
   self->priv->nb_effects = 0;
   self->priv->is_moving = FALSE;
+  self->priv->priorities = g_sequence_new (NULL);
 }
 
 /**
@@ -439,7 +465,13 @@ ges_timeline_object_create_track_objects (GESTimelineObject * object,
     GST_WARNING ("no GESTimelineObject::create_track_objects implentation");
     return FALSE;
   }
-  return klass->create_track_objects (object, track);
+  if (!klass->create_track_objects (object, track))
+    return FALSE;
+
+  /* Deep copies get the effects and track object state of their original */
+  ges_timeline_snapshot_apply_pending (object, track);
+
+  return TRUE;
 }
 
 /*
@@ -496,7 +528,11 @@ ges_timeline_object_add_track_object (GESTimelineObject * object, GESTrackObject
   if (!trobj)
     return FALSE;
 
+  GES_TRACE_BEGIN ("timeline-object-add-track-object");
+  GES_TRACE_COUNT (1);
+
   ges_track_object_set_timeline_object (trobj, object);
+  ges_timeline_snapshot_object_changed (object);
 
   g_object_ref (trobj);
 
@@ -511,6 +547,11 @@ ges_timeline_object_add_track_object (GESTimelineObject * object, GESTrackObject
 
   mapping->priority_offset = priv->nb_effects;
 
+  /* Every effect pushes the other children one priority down */
+  if (priv->layer)
+    ges_timeline_layer_reserve_height (priv->layer, object->priority +
+        MAX (object->height, g_list_length (priv->trackobjects)) + 1);
+
   /* If the trackobject is an effect:
    *  - We add it on top of the list of TrackEffect
    *  - We put all TrackObject present in the TimelineObject
@@ -531,6 +572,7 @@ ges_timeline_object_add_track_object (GESTimelineObject * object, GESTrackObject
       ges_track_object_set_priority (tmpo,
           ges_track_object_get_priority (tmpo) + 1);
       ges_track_object_set_locked (tmpo, TRUE);
+      GES_TRACE_COUNT (1);
     }
 
     priv->nb_effects++;
@@ -552,19 +594,10 @@ ges_timeline_object_add_track_object (GESTimelineObject * object, GESTrackObject
         G_OBJECT_CLASS_NAME (klass));
   }
 
-  /* Listen to all property changes */
-  mapping->start_notifyid =
-      g_signal_connect (G_OBJECT (trobj), "notify::start",
-      G_CALLBACK (track_object_start_changed_cb), object);
-  mapping->duration_notifyid =
-      g_signal_connect (G_OBJECT (trobj), "notify::duration",
-      G_CALLBACK (track_object_duration_changed_cb), object);
-  mapping->inpoint_notifyid =
-      g_signal_connect (G_OBJECT (trobj), "notify::inpoint",
-      G_CALLBACK (track_object_inpoint_changed_cb), object);
-  mapping->priority_notifyid =
-      g_signal_connect (G_OBJECT (trobj), "notify::priority",
-      G_CALLBACK (track_object_priority_changed_cb), object);
+  /* Listen to all property changes,
+   * see ges_timeline_object_track_object_changed() */
+  mapping->listening = TRUE;
+  track_priority (object, mapping);
 
   get_layer_priorities (priv->layer, &min_prio, &max_prio);
   ges_track_object_set_priority (trobj, min_prio + object->priority
@@ -580,6 +613,8 @@ ges_timeline_object_add_track_object (GESTimelineObject * object, GESTrackObject
         GES_TRACK_EFFECT (trobj));
   }
 
+  GES_TRACE_END ();
+
   return TRUE;
 }
 
@@ -610,6 +645,9 @@ ges_timeline_object_release_track_object (GESTimelineObject * object,
     return FALSE;
   }
 
+  GES_TRACE_BEGIN ("timeline-object-release-track-object");
+  GES_TRACE_COUNT (1);
+
   for (tmp = object->priv->mappings; tmp; tmp = tmp->next) {
     mapping = (ObjectMapping *) tmp->data;
     if (mapping->object == trackobject)
@@ -617,12 +655,8 @@ ges_timeline_object_release_track_object (GESTimelineObject * object,
   }
 
   if (tmp && mapping) {
-
-    /* Disconnect all notify listeners */
-    g_signal_handler_disconnect (trackobject, mapping->start_notifyid);
-    g_signal_handler_disconnect (trackobject, mapping->duration_notifyid);
-    g_signal_handler_disconnect (trackobject, mapping->inpoint_notifyid);
-    g_signal_handler_disconnect (trackobject, mapping->priority_notifyid);
+    if (mapping->priority_iter)
+      g_sequence_remove (mapping->priority_iter);
 
     g_slice_free (ObjectMapping, mapping);
 
@@ -631,6 +665,8 @@ ges_timeline_object_release_track_object (GESTimelineObject * object,
 
   object->priv->trackobjects =
       g_list_remove (object->priv->trackobjects, trackobject);
+  update_height (object);
+  ges_timeline_snapshot_object_changed (object);
 
   if (GES_IS_TRACK_EFFECT (trackobject)) {
     /* emit 'object-removed' */
@@ -653,6 +689,8 @@ ges_timeline_object_release_track_object (GESTimelineObject * object,
 
   /* FIXME : resync properties ? */
 
+  GES_TRACE_END ();
+
   return TRUE;
 }
 
@@ -733,6 +771,8 @@ ges_timeline_object_set_start (GESTimelineObject * object, guint64 start)
   GST_DEBUG ("object:%p, start:%" GST_TIME_FORMAT,
       object, GST_TIME_ARGS (start));
 
+  GES_TRACE_BEGIN ("timeline-object-set-start");
+
   object->priv->ignore_notifies = TRUE;
 
   for (tmp = object->priv->trackobjects; tmp; tmp = g_list_next (tmp)) {
@@ -750,6 +790,7 @@ ges_timeline_object_set_start (GESTimelineObject * object, guint64 start)
       }
 
       ges_track_object_set_start (tr, new_start);
+      GES_TRACE_COUNT (1);
     } else {
       /* ... or update the offset */
       map->start_offset = start - tr->start;
@@ -759,6 +800,11 @@ ges_timeline_object_set_start (GESTimelineObject * object, guint64 start)
   object->priv->ignore_notifies = FALSE;
 
   object->start = start;
+
+  /* The setters don't always notify, invalidate the snapshot record here */
+  ges_timeline_snapshot_object_changed (object);
+
+  GES_TRACE_END ();
 }
 
 /**
@@ -780,15 +826,23 @@ ges_timeline_object_set_inpoint (GESTimelineObject * object, guint64 inpoint)
   GST_DEBUG ("object:%p, inpoint:%" GST_TIME_FORMAT,
       object, GST_TIME_ARGS (inpoint));
 
+  GES_TRACE_BEGIN ("timeline-object-set-inpoint");
+
   for (tmp = object->priv->trackobjects; tmp; tmp = g_list_next (tmp)) {
     tr = (GESTrackObject *) tmp->data;
 
-    if (ges_track_object_is_locked (tr))
+    if (ges_track_object_is_locked (tr)) {
       /* call set_inpoint on each trackobject */
       ges_track_object_set_inpoint (tr, inpoint);
+      GES_TRACE_COUNT (1);
+    }
   }
 
   object->inpoint = inpoint;
+
+  ges_timeline_snapshot_object_changed (object);
+
+  GES_TRACE_END ();
 }
 
 /**
@@ -809,15 +863,23 @@ ges_timeline_object_set_duration (GESTimelineObject * object, guint64 duration)
   GST_DEBUG ("object:%p, duration:%" GST_TIME_FORMAT,
       object, GST_TIME_ARGS (duration));
 
+  GES_TRACE_BEGIN ("timeline-object-set-duration");
+
   for (tmp = object->priv->trackobjects; tmp; tmp = g_list_next (tmp)) {
     tr = (GESTrackObject *) tmp->data;
 
-    if (ges_track_object_is_locked (tr))
+    if (ges_track_object_is_locked (tr)) {
       /* call set_duration on each trackobject */
       ges_track_object_set_duration (tr, duration);
+      GES_TRACE_COUNT (1);
+    }
   }
 
   object->duration = duration;
+
+  ges_timeline_snapshot_object_changed (object);
+
+  GES_TRACE_END ();
 }
 
 /**
@@ -885,12 +947,15 @@ ges_timeline_object_move_to_layer (GESTimelineObject * object, GESTimelineLayer
     return ges_timeline_layer_add_object (layer, object);
   }
 
+  GES_TRACE_BEGIN ("timeline-object-move-to-layer");
+
   object->priv->is_moving = TRUE;
   g_object_ref (object);
   ret = ges_timeline_layer_remove_object (current_layer, object);
 
   if (!ret) {
     g_object_unref (object);
+    GES_TRACE_END ();
     return FALSE;
   }
 
@@ -899,6 +964,8 @@ ges_timeline_object_move_to_layer (GESTimelineObject * object, GESTimelineLayer
 
   g_object_unref (object);
 
+  GES_TRACE_END ();
+
   return ret;
 }
 
@@ -922,11 +989,18 @@ ges_timeline_object_set_priority (GESTimelineObject * object, guint priority)
 
   GST_DEBUG ("object:%p, priority:%" G_GUINT32_FORMAT, object, priority);
 
+  GES_TRACE_BEGIN ("timeline-object-set-priority");
+
   priv = object->priv;
   priv->ignore_notifies = TRUE;
 
   object->priv->ignore_notifies = TRUE;
 
+  /* Make room for all our children in the layer */
+  if (priv->layer)
+    ges_timeline_layer_reserve_height (priv->layer,
+        priority + MAX (object->height, 1));
+
   get_layer_priorities (priv->layer, &layer_min_gnl_prio, &layer_max_gnl_prio);
 
   for (tmp = priv->trackobjects; tmp; tmp = g_list_next (tmp)) {
@@ -948,6 +1022,7 @@ ges_timeline_object_set_priority (GESTimelineObject * object, guint priority)
       }
 
       ges_track_object_set_priority (tr, real_tck_prio);
+      GES_TRACE_COUNT (1);
 
     } else {
       /* ... or update the offset */
@@ -960,6 +1035,10 @@ ges_timeline_object_set_priority (GESTimelineObject * object, guint priority)
   priv->ignore_notifies = FALSE;
 
   object->priority = priority;
+
+  ges_timeline_snapshot_object_changed (object);
+
+  GES_TRACE_END ();
 }
 
 /**
@@ -1178,12 +1257,15 @@ ges_timeline_object_set_top_effect_priority (GESTimelineObject * object,
     return FALSE;
   }
 
+  GES_TRACE_BEGIN ("timeline-object-set-top-effect-priority");
+
   if (tck_obj->priority < newpriority)
     inc = -1;
   else
     inc = +1;
 
   ges_track_object_set_priority (tck_obj, newpriority);
+  GES_TRACE_COUNT (1);
   for (tmp = priv->trackobjects; tmp; tmp = tmp->next) {
     GESTrackObject *tmpo = GES_TRACK_OBJECT (tmp->data);
     guint tck_priority = ges_track_object_get_priority (tmpo);
@@ -1191,11 +1273,15 @@ ges_timeline_object_set_top_effect_priority (GESTimelineObject * object,
     if ((inc == +1 && tck_priority >= newpriority) ||
         (inc == -1 && tck_priority <= newpriority)) {
       ges_track_object_set_priority (tmpo, tck_priority + inc);
+      GES_TRACE_COUNT (1);
     }
   }
 
   priv->trackobjects = g_list_sort_with_data (priv->trackobjects,
       (GCompareDataFunc) sort_track_effects, object);
+  ges_timeline_snapshot_object_changed (object);
+
+  GES_TRACE_END ();
 
   return TRUE;
 }
@@ -1284,13 +1370,16 @@ ges_timeline_object_split (GESTimelineObject * object, gint64 position)
 
   g_return_val_if_fail (GES_IS_TIMELINE_OBJECT (object), NULL);
 
+  GES_TRACE_BEGIN ("timeline-object-split");
+
   g_object_get (object, "duration", &duration, "start", &start, "in-point",
       &inpoint, NULL);
 
   track_objects = ges_timeline_object_get_track_objects (object);
+  GES_TRACE_COUNT (g_list_length (track_objects));
   layer = ges_timeline_object_get_layer (object);
 
-  new_object = ges_timeline_object_copy (object, FALSE);
+  new_object = ges_timeline_object_copy (object, TRUE);
 
   if (g_list_length (track_objects) == 2) {
     g_object_set (new_object, "start", position, NULL);
@@ -1310,12 +1399,33 @@ ges_timeline_object_split (GESTimelineObject * object, gint64 position)
 
   ges_timeline_layer_add_object (layer, new_object);
 
+  GES_TRACE_END ();
+
   return new_object;
 }
 
-/* TODO implement the deep parameter, and make it public */
-static GESTimelineObject *
-ges_timeline_object_copy (GESTimelineObject * object, gboolean * deep)
+/**
+ * ges_timeline_object_copy:
+ * @object: the #GESTimelineObject to copy
+ * @deep: whether the effects and track objects of @object are copied too
+ *
+ * Creates a copy of @object with the same properties, including the media
+ * information of file sources, so the copy doesn't need to be discovered
+ * again.
+ *
+ * The track objects of a copy are created when it is added to a layer. If
+ * @deep is %TRUE, the effects of @object are then added to the copy, and
+ * the state and child properties of its track objects are copied, in the
+ * tracks of the same type. The state of @object is recorded when it is
+ * copied, and shared by all its copies and #GESTimelineSnapshot-s until it
+ * changes, so copying an object many times only records it once.
+ *
+ * Returns: (transfer floating): The copy of @object
+ *
+ * Since: 0.10.2
+ */
+GESTimelineObject *
+ges_timeline_object_copy (GESTimelineObject * object, gboolean deep)
 {
   GESTimelineObject *ret = NULL;
   GParameter *params;
@@ -1324,39 +1434,47 @@ ges_timeline_object_copy (GESTimelineObject * object, gboolean * deep)
 
   g_return_val_if_fail (GES_IS_TIMELINE_OBJECT (object), NULL);
 
-  specs =
-      g_object_class_list_properties (G_OBJECT_GET_CLASS (object), &n_specs);
-  params = g_new0 (GParameter, n_specs);
-  n_params = 0;
-
-  for (n = 0; n < n_specs; ++n) {
-    if (strcmp (specs[n]->name, "parent") &&
-        (specs[n]->flags & G_PARAM_READWRITE) == G_PARAM_READWRITE) {
-      params[n_params].name = g_intern_string (specs[n]->name);
-      g_value_init (&params[n_params].value, specs[n]->value_type);
-      g_object_get_property (G_OBJECT (object), specs[n]->name,
-          &params[n_params].value);
-      ++n_params;
+  if (deep)
+    ret = ges_timeline_snapshot_copy_object (object);
+  else {
+    specs =
+        g_object_class_list_properties (G_OBJECT_GET_CLASS (object), &n_specs);
+    params = g_new0 (GParameter, n_specs);
+    n_params = 0;
+
+    for (n = 0; n < n_specs; ++n) {
+      if (strcmp (specs[n]->name, "parent") &&
+          (specs[n]->flags & G_PARAM_READWRITE) == G_PARAM_READWRITE) {
+        params[n_params].name = g_intern_string (specs[n]->name);
+        g_value_init (&params[n_params].value, specs[n]->value_type);
+        g_object_get_property (G_OBJECT (object), specs[n]->name,
+            &params[n_params].value);
+        ++n_params;
+      }
     }
-  }
 
-  ret = g_object_newv (G_TYPE_FROM_INSTANCE (object), n_params, params);
+    ret = g_object_newv (G_TYPE_FROM_INSTANCE (object), n_params, params);
 
+    for (n = 0; n < n_params; ++n)
+      g_value_unset (&params[n].value);
+    g_free (specs);
+    g_free (params);
+  }
+
+  /* A file source only in one track stays in that track */
   if (GES_IS_TIMELINE_FILE_SOURCE (ret)) {
     GList *tck_objects;
+    GESTrack *track;
+
     tck_objects = ges_timeline_object_get_track_objects (object);
-    if (g_list_length (tck_objects) == 1) {
-      GESTrackType type;
-      type = ges_track_object_get_track (tck_objects->data)->type;
+    if (g_list_length (tck_objects) == 1 &&
+        (track = ges_track_object_get_track (tck_objects->data)))
       ges_timeline_filesource_set_supported_formats (GES_TIMELINE_FILE_SOURCE
-          (ret), type);
-    }
+          (ret), track->type);
+    g_list_foreach (tck_objects, (GFunc) g_object_unref, NULL);
     g_list_free (tck_objects);
   }
 
-  g_free (specs);
-  g_free (params);
-
   return ret;
 }
 
@@ -1420,26 +1538,46 @@ ges_timeline_object_objects_set_locked (GESTimelineObject * object,
   }
 }
 
+static gint
+compare_priorities (gconstpointer a, gconstpointer b,
+    gpointer udata G_GNUC_UNUSED)
+{
+  guint prio_a = GPOINTER_TO_UINT (a), prio_b = GPOINTER_TO_UINT (b);
+
+  return prio_a < prio_b ? -1 : (prio_a > prio_b ? 1 : 0);
+}
+
+/* Puts the current priority of the object of @map in the sorted
+ * priorities of @object */
 static void
-update_height (GESTimelineObject * object)
+track_priority (GESTimelineObject * object, ObjectMapping * map)
 {
-  GList *tmp;
-  guint32 min_prio = G_MAXUINT32, max_prio = 0;
+  if (map->priority_iter)
+    g_sequence_remove (map->priority_iter);
 
-  /* Go over all childs and check if height has changed */
-  for (tmp = object->priv->trackobjects; tmp; tmp = tmp->next) {
-    guint tck_priority =
-        ges_track_object_get_priority (GES_TRACK_OBJECT (tmp->data));
+  map->priority_iter = g_sequence_insert_sorted (object->priv->priorities,
+      GUINT_TO_POINTER (ges_track_object_get_priority (map->object)),
+      compare_priorities, NULL);
+}
 
-    if (tck_priority < min_prio)
-      min_prio = tck_priority;
-    if (tck_priority > max_prio)
-      max_prio = tck_priority;
+static void
+update_height (GESTimelineObject * object)
+{
+  GSequence *priorities = object->priv->priorities;
+  GSequenceIter *first = g_sequence_get_begin_iter (priorities);
+  guint32 min_prio, max_prio, height = 1;
+
+  /* The height goes from the lowest to the highest priority of the
+   * children, and can shrink as well as grow */
+  if (!g_sequence_iter_is_end (first)) {
+    min_prio = GPOINTER_TO_UINT (g_sequence_get (first));
+    max_prio = GPOINTER_TO_UINT (g_sequence_get (g_sequence_iter_prev
+            (g_sequence_get_end_iter (priorities))));
+    height = max_prio - min_prio + 1;
   }
 
-  /* FIXME : We only grow the height */
-  if (object->height < (max_prio - min_prio + 1)) {
-    object->height = max_prio - min_prio + 1;
+  if (object->height != height) {
+    object->height = height;
     GST_DEBUG ("Updating height %i", object->height);
 #if GLIB_CHECK_VERSION(2,26,0)
     g_object_notify_by_pspec (G_OBJECT (object), properties[PROP_HEIGHT]);
@@ -1453,6 +1591,42 @@ update_height (GESTimelineObject * object)
  * PROPERTY NOTIFICATIONS FROM TRACK OBJECTS
  */
 
+/* ges_timeline_object_track_object_changed:
+ * @object: a #GESTimelineObject
+ * @child: one of its #GESTrackObject
+ * @type: what changed
+ *
+ * Called by @child itself whenever it changes, instead of going through
+ * its "notify::" signals.
+ */
+void
+ges_timeline_object_track_object_changed (GESTimelineObject * object,
+    GESTrackObject * child, GESChangeType type)
+{
+  ObjectMapping *map = find_object_mapping (object, child);
+
+  if (map == NULL || !map->listening)
+    return;
+
+  switch (type) {
+    case GES_CHANGE_START:
+      track_object_start_changed_cb (child, NULL, object);
+      break;
+    case GES_CHANGE_INPOINT:
+      track_object_inpoint_changed_cb (child, NULL, object);
+      break;
+    case GES_CHANGE_DURATION:
+      track_object_duration_changed_cb (child, NULL, object);
+      break;
+    case GES_CHANGE_PRIORITY:
+      track_priority (object, map);
+      track_object_priority_changed_cb (child, NULL, object);
+      break;
+    default:
+      break;
+  }
+}
+
 static void
 track_object_start_changed_cb (GESTrackObject * child,
     GParamSpec * arg G_GNUC_UNUSED, GESTimelineObject * object)
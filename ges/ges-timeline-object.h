@@ -292,6 +292,9 @@ ges_timeline_object_set_supported_formats   (GESTimelineObject * object,
 GESTimelineObject *
 ges_timeline_object_split                   (GESTimelineObject * object, gint64 position);
 
+GESTimelineObject *
+ges_timeline_object_copy                    (GESTimelineObject * object, gboolean deep);
+
 gboolean
 ges_timeline_object_trim_start              (GESTimelineObject * object, gint64 position);
 
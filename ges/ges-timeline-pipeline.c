@@ -32,20 +32,45 @@
 #include "ges-internal.h"
 #include "ges-timeline-pipeline.h"
 #include "ges-screenshot.h"
+#include "gesmarshal.h"
 
 #define DEFAULT_TIMELINE_MODE  TIMELINE_MODE_PREVIEW
+#define DEFAULT_PROGRESS_INTERVAL GST_SECOND
+#define DEFAULT_QUEUE_MAX_TIME GST_SECOND
+#define DEFAULT_QUEUE_MAX_BYTES (10 * 1024 * 1024)
 
 /* Structure corresponding to a timeline - sink link */
 
 typedef struct
 {
   GESTrack *track;
+  GstElement *queue;            /* Decouples the track from its consumers */
   GstElement *tee;
+  GstElement *encodequeue;      /* Decouples the encoder from the preview */
   GstPad *srcpad;               /* Timeline source pad */
   GstPad *playsinkpad;
   GstPad *encodebinpad;
+
+  GESTimelinePipeline *pipeline;
+  GstClockTime next_frame;      /* Next preview frame not to skip */
 } OutputChain;
 
+/* Caps of a video track while previewing at a reduced quality */
+
+typedef struct
+{
+  GstCaps *full;                /* The caps the track had before */
+  GstCaps *preview;             /* The caps we set on it */
+} PreviewCaps;
+
+/* A [start, stop) range of the timeline to render */
+
+typedef struct
+{
+  GstClockTime start;
+  GstClockTime stop;
+} RenderRange;
+
 G_DEFINE_TYPE (GESTimelinePipeline, ges_timeline_pipeline, GST_TYPE_PIPELINE);
 
 struct _GESTimelinePipelinePrivate
@@ -61,8 +86,66 @@ struct _GESTimelinePipelinePrivate
   GList *chains;
 
   GstEncodingProfile *profile;
+
+  /* Render ranges, protected by the object lock */
+  GArray *ranges;
+  guint current_range;
+  guint nb_tracks;              /* Tracks we wait for before seeking */
+  guint nb_blocked;             /* Track pads blocked so far */
+
+  GESPreviewQuality preview_quality;
+  guint preview_frame_skip;
+  GstClockTime preview_frame_duration;  /* Of the reference format */
+
+  /* Seek-latency mode, protected by the object lock */
+  gboolean seek_latency;
+  GstEvent *last_seek;          /* Last seek performed */
+  gboolean seeking;             /* A flushing seek is prerolling */
+  GstEvent *pending_seek;       /* Latest seek received meanwhile */
+
+  /* Render progress, protected by the object lock */
+  GstClockTime progress_interval;
+  gulong progress_probe;
+  GstClockTime progress_position;       /* How much was encoded */
+  guint progress_range;         /* Render range of the last encoded buffer */
+  GstClockTime progress_offset; /* Length of the ranges before it */
+  GstClockTime progress_first;  /* Wall time of the first encoded buffer */
+  GstClockTime progress_last;   /* Wall time of the last report */
+  guint progress_source;        /* Pending report */
+
+  /* Limits of the queues of the output chains */
+  GstClockTime queue_max_time;
+  guint queue_max_bytes;
+
+  /* Throttling of the render, in timeline seconds per second (0 = none) */
+  gdouble max_render_speed;
+  GstClock *throttle_clock;
+  GstClockTime throttle_start;  /* Clock time of the first buffer since the
+                                 * last flush */
+  GstClockTime throttle_base;   /* Timestamp of that buffer */
+  GstClockID throttle_id;       /* Wait of the streaming thread */
+  gboolean background;          /* Render snapshot, runs at low priority */
+};
+
+enum
+{
+  PROP_0,
+  PROP_QUEUE_MAX_TIME,
+  PROP_QUEUE_MAX_BYTES,
+  PROP_MAX_RENDER_SPEED
+};
+
+enum
+{
+  RENDER_PROGRESS,
+  LAST_SIGNAL
 };
 
+static guint ges_timeline_pipeline_signals[LAST_SIGNAL] = { 0 };
+
+static GQuark preview_caps_quark;
+static GQuark negotiated_caps_quark;
+
 static GstStateChangeReturn ges_timeline_pipeline_change_state (GstElement *
     element, GstStateChange transition);
 
@@ -72,12 +155,26 @@ static OutputChain *new_output_chain_for_track (GESTimelinePipeline * self,
     GESTrack * track);
 static gboolean play_sink_multiple_seeks_send_event (GstElement * element,
     GstEvent * event);
+static void ges_timeline_pipeline_handle_message (GstBin * bin,
+    GstMessage * message);
+static gboolean render_ranges_active (GESTimelinePipeline * self);
+static gboolean ges_timeline_pipeline_send_event (GstElement * element,
+    GstEvent * event);
+static void seek_latency_reset (GESTimelinePipeline * self);
+static void render_progress_start (GESTimelinePipeline * self);
+static void render_progress_stop (GESTimelinePipeline * self);
+static void render_progress_schedule (GESTimelinePipeline * self);
+static void render_progress_unthrottle (GESTimelinePipeline * self);
+static void configure_chain_queues (GESTimelinePipeline * self);
 
 static void
 ges_timeline_pipeline_dispose (GObject * object)
 {
   GESTimelinePipeline *self = GES_TIMELINE_PIPELINE (object);
 
+  seek_latency_reset (self);
+  render_progress_stop (self);
+
   if (self->priv->playsink) {
     if (self->priv->mode & (TIMELINE_MODE_PREVIEW))
       gst_bin_remove (GST_BIN (object), self->priv->playsink);
@@ -102,18 +199,156 @@ ges_timeline_pipeline_dispose (GObject * object)
   G_OBJECT_CLASS (ges_timeline_pipeline_parent_class)->dispose (object);
 }
 
+static void
+ges_timeline_pipeline_finalize (GObject * object)
+{
+  GESTimelinePipeline *self = GES_TIMELINE_PIPELINE (object);
+
+  g_array_free (self->priv->ranges, TRUE);
+  gst_object_unref (self->priv->throttle_clock);
+
+  G_OBJECT_CLASS (ges_timeline_pipeline_parent_class)->finalize (object);
+}
+
+static void
+ges_timeline_pipeline_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GESTimelinePipeline *self = GES_TIMELINE_PIPELINE (object);
+
+  switch (property_id) {
+    case PROP_QUEUE_MAX_TIME:
+      g_value_set_uint64 (value, self->priv->queue_max_time);
+      break;
+    case PROP_QUEUE_MAX_BYTES:
+      g_value_set_uint (value, self->priv->queue_max_bytes);
+      break;
+    case PROP_MAX_RENDER_SPEED:
+      GST_OBJECT_LOCK (self);
+      g_value_set_double (value, self->priv->max_render_speed);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+  }
+}
+
+static void
+ges_timeline_pipeline_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GESTimelinePipeline *self = GES_TIMELINE_PIPELINE (object);
+
+  switch (property_id) {
+    case PROP_QUEUE_MAX_TIME:
+      self->priv->queue_max_time = g_value_get_uint64 (value);
+      configure_chain_queues (self);
+      break;
+    case PROP_QUEUE_MAX_BYTES:
+      self->priv->queue_max_bytes = g_value_get_uint (value);
+      configure_chain_queues (self);
+      break;
+    case PROP_MAX_RENDER_SPEED:
+      GST_OBJECT_LOCK (self);
+      self->priv->max_render_speed = g_value_get_double (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+  }
+}
+
 static void
 ges_timeline_pipeline_class_init (GESTimelinePipelineClass * klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  GstBinClass *bin_class = GST_BIN_CLASS (klass);
 
   g_type_class_add_private (klass, sizeof (GESTimelinePipelinePrivate));
 
+  object_class->get_property = ges_timeline_pipeline_get_property;
+  object_class->set_property = ges_timeline_pipeline_set_property;
   object_class->dispose = ges_timeline_pipeline_dispose;
+  object_class->finalize = ges_timeline_pipeline_finalize;
 
   element_class->change_state =
       GST_DEBUG_FUNCPTR (ges_timeline_pipeline_change_state);
+  element_class->send_event =
+      GST_DEBUG_FUNCPTR (ges_timeline_pipeline_send_event);
+
+  bin_class->handle_message =
+      GST_DEBUG_FUNCPTR (ges_timeline_pipeline_handle_message);
+
+  preview_caps_quark = g_quark_from_static_string ("ges-preview-caps");
+  negotiated_caps_quark = g_quark_from_static_string ("ges-negotiated-caps");
+
+  /**
+   * GESTimelinePipeline:queue-max-time:
+   *
+   * The maximum amount of data, in nanoseconds, each queue of the pipeline
+   * holds. Every track is followed by a queue, and so is every encoder input,
+   * so that the tracks, the preview sinks and the encoders all run in their
+   * own streaming threads. 0 means no limit.
+   *
+   * Since: 0.10.2
+   */
+  g_object_class_install_property (object_class, PROP_QUEUE_MAX_TIME,
+      g_param_spec_uint64 ("queue-max-time", "Queue max time",
+          "Maximum amount of data held by each queue, in nanoseconds "
+          "(0 = unlimited)", 0, G_MAXUINT64, DEFAULT_QUEUE_MAX_TIME,
+          G_PARAM_READWRITE));
+
+  /**
+   * GESTimelinePipeline:queue-max-bytes:
+   *
+   * The maximum amount of data, in bytes, each queue of the pipeline holds.
+   * See #GESTimelinePipeline:queue-max-time. 0 means no limit.
+   *
+   * Since: 0.10.2
+   */
+  g_object_class_install_property (object_class, PROP_QUEUE_MAX_BYTES,
+      g_param_spec_uint ("queue-max-bytes", "Queue max bytes",
+          "Maximum amount of data held by each queue, in bytes "
+          "(0 = unlimited)", 0, G_MAXUINT, DEFAULT_QUEUE_MAX_BYTES,
+          G_PARAM_READWRITE));
+
+  /**
+   * GESTimelinePipeline:max-render-speed:
+   *
+   * The maximum number of seconds of the timeline rendered per second of
+   * wall time, 0 for no limit. The encoders are held back once they get
+   * ahead, which leaves CPU time to a preview running next to a render
+   * started with ges_timeline_pipeline_render_snapshot().
+   *
+   * Since: 0.10.2
+   */
+  g_object_class_install_property (object_class, PROP_MAX_RENDER_SPEED,
+      g_param_spec_double ("max-render-speed", "Max render speed",
+          "Maximum number of seconds of the timeline rendered per second "
+          "(0 = unlimited)", 0, G_MAXDOUBLE, 0, G_PARAM_READWRITE));
+
+  /**
+   * GESTimelinePipeline::render-progress:
+   * @pipeline: the #GESTimelinePipeline
+   * @position: how much of the timeline was encoded so far
+   * @duration: how much of the timeline is to be rendered in total
+   * @speed: how many seconds of the timeline are encoded per second
+   * @eta: estimated time left until the render is over, or
+   * #GST_CLOCK_TIME_NONE if it can't be estimated yet
+   *
+   * Emitted from the main context while rendering, at the interval set with
+   * ges_timeline_pipeline_set_progress_interval(), and once more at the end
+   * of the stream. The figures come from the timestamps of the buffers
+   * leaving the encoders, the pipeline isn't queried.
+   *
+   * Since: 0.10.2
+   */
+  ges_timeline_pipeline_signals[RENDER_PROGRESS] =
+      g_signal_new ("render-progress", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, 0, NULL, NULL,
+      ges_marshal_VOID__UINT64_UINT64_DOUBLE_UINT64, G_TYPE_NONE, 4,
+      G_TYPE_UINT64, G_TYPE_UINT64, G_TYPE_DOUBLE, G_TYPE_UINT64);
 
   /* TODO : Add state_change handlers
    * Don't change state if we don't have a timeline */
@@ -128,12 +363,20 @@ ges_timeline_pipeline_init (GESTimelinePipeline * self)
   self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
       GES_TYPE_TIMELINE_PIPELINE, GESTimelinePipelinePrivate);
 
+  self->priv->ranges = g_array_new (FALSE, FALSE, sizeof (RenderRange));
+  self->priv->preview_quality = GES_PREVIEW_QUALITY_FULL;
+  self->priv->preview_frame_duration = GST_CLOCK_TIME_NONE;
+  self->priv->progress_interval = DEFAULT_PROGRESS_INTERVAL;
+  self->priv->throttle_clock = gst_system_clock_obtain ();
+  self->priv->queue_max_time = DEFAULT_QUEUE_MAX_TIME;
+  self->priv->queue_max_bytes = DEFAULT_QUEUE_MAX_BYTES;
+
   self->priv->playsink =
       gst_element_factory_make ("playsink", "internal-sinks");
   self->priv->encodebin =
       gst_element_factory_make ("encodebin", "internal-encodebin");
-  /* Limit encodebin buffering to 1 buffer since we know the various
-   * stream fed to it are decoupled already */
+  /* Limit encodebin buffering to 1 buffer since the various streams fed
+   * to it are decoupled already by the queues of the output chains */
   g_object_set (self->priv->encodebin, "queue-buffers-max", (guint32) 1,
       "queue-bytes-max", (guint32) 0, "queue-time-max", (guint64) 0,
       "avoid-reencoding", TRUE, NULL);
@@ -248,6 +491,257 @@ ges_timeline_pipeline_update_caps (GESTimelinePipeline * self)
   return TRUE;
 }
 
+/* Preview quality
+ *
+ * When previewing at a reduced quality, the video tracks get caps which
+ * prefer a reduced size (and frame rate if frames are skipped) followed by
+ * the caps the track had. Sources able to produce any size (test sources,
+ * titles, images) and the compositing on top of them then work on fewer
+ * pixels, while sources which can't scale (decoded files) still negotiate
+ * through the fallback structures. The previous caps are restored as soon
+ * as the pipeline goes to PAUSED in a mode which isn't a preview one.
+ *
+ * The reduced size is relative to the restriction of the video profile, or
+ * to the size the track caps fix. Failing both, it is relative to the size
+ * the video track last negotiated at full quality, which is only known once
+ * the pipeline prerolled. */
+
+static void
+preview_caps_free (PreviewCaps * pcaps)
+{
+  gst_caps_unref (pcaps->full);
+  gst_caps_unref (pcaps->preview);
+  g_slice_free (PreviewCaps, pcaps);
+}
+
+static gboolean
+get_video_format (const GstCaps * caps, gint * width, gint * height,
+    gint * fps_n, gint * fps_d)
+{
+  guint i;
+
+  if (caps == NULL)
+    return FALSE;
+
+  for (i = 0; i < gst_caps_get_size (caps); i++) {
+    GstStructure *structure = gst_caps_get_structure (caps, i);
+
+    if (gst_structure_get_int (structure, "width", width) &&
+        gst_structure_get_int (structure, "height", height)) {
+      if (!gst_structure_get_fraction (structure, "framerate", fps_n, fps_d))
+        *fps_n = 0;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/* Remembers the caps a video track negotiated at full quality, streaming
+ * thread */
+static void
+video_caps_notify_cb (GstPad * pad, GParamSpec * arg, GESTrack * track)
+{
+  GstCaps *caps = gst_pad_get_negotiated_caps (pad);
+
+  if (caps == NULL)
+    return;
+
+  GST_OBJECT_LOCK (track);
+  if (g_object_get_qdata ((GObject *) track, preview_caps_quark) == NULL) {
+    g_object_set_qdata_full ((GObject *) track, negotiated_caps_quark, caps,
+        (GDestroyNotify) gst_caps_unref);
+    caps = NULL;
+  }
+  GST_OBJECT_UNLOCK (track);
+
+  if (caps)
+    gst_caps_unref (caps);
+}
+
+/* The format we render to: the restriction of the video profile if there is
+ * one, else whatever size the track caps fix, else the size the track last
+ * negotiated */
+static gboolean
+get_reference_format (GESTimelinePipeline * self, GESTrack * track,
+    const GstCaps * full, gint * width, gint * height, gint * fps_n,
+    gint * fps_d)
+{
+  gboolean ret;
+
+  if (self->priv->profile &&
+      GST_IS_ENCODING_CONTAINER_PROFILE (self->priv->profile)) {
+    const GList *tmp;
+
+    for (tmp = gst_encoding_container_profile_get_profiles (
+            (GstEncodingContainerProfile *) self->priv->profile); tmp;
+        tmp = tmp->next) {
+      GstEncodingProfile *prof = (GstEncodingProfile *) tmp->data;
+
+      if (GST_IS_ENCODING_VIDEO_PROFILE (prof) &&
+          get_video_format (gst_encoding_profile_get_restriction (prof),
+              width, height, fps_n, fps_d))
+        return TRUE;
+    }
+  }
+
+  if (get_video_format (full, width, height, fps_n, fps_d))
+    return TRUE;
+
+  GST_OBJECT_LOCK (track);
+  ret = get_video_format (g_object_get_qdata ((GObject *) track,
+          negotiated_caps_quark), width, height, fps_n, fps_d);
+  GST_OBJECT_UNLOCK (track);
+
+  return ret;
+}
+
+static GstCaps *
+make_preview_caps (GESTimelinePipeline * self, GESTrack * track,
+    const GstCaps * full)
+{
+  GESTimelinePipelinePrivate *priv = self->priv;
+  gint width, height, fps_n, fps_d;
+  GstCaps *caps;
+  guint i;
+
+  if (!get_reference_format (self, track, full, &width, &height, &fps_n,
+          &fps_d)) {
+    GST_WARNING_OBJECT (self, "No reference size known for track %p, "
+        "previewing at full quality until it is prerolled once. Set fixed "
+        "caps on it or a render profile to avoid this", track);
+    return NULL;
+  }
+
+  /* Keep the sizes even, most YUV formats require it */
+  width = MAX (2, (width / priv->preview_quality) & ~1);
+  height = MAX (2, (height / priv->preview_quality) & ~1);
+
+  if (fps_n > 0) {
+    priv->preview_frame_duration =
+        gst_util_uint64_scale_int (GST_SECOND, fps_d, fps_n);
+    fps_d *= priv->preview_frame_skip + 1;
+  }
+
+  GST_DEBUG_OBJECT (self, "Previewing at %dx%d, %d/%d fps", width, height,
+      fps_n, fps_d);
+
+  caps = gst_caps_new_empty ();
+  for (i = 0; i < gst_caps_get_size (full); i++) {
+    GstStructure *structure =
+        gst_structure_copy (gst_caps_get_structure (full, i));
+
+    gst_structure_set (structure, "width", G_TYPE_INT, width, "height",
+        G_TYPE_INT, height, NULL);
+    if (fps_n > 0)
+      gst_structure_set (structure, "framerate", GST_TYPE_FRACTION, fps_n,
+          fps_d, NULL);
+    gst_caps_append_structure (caps, structure);
+  }
+  gst_caps_append (caps, gst_caps_copy (full));
+
+  return caps;
+}
+
+static void
+ges_timeline_pipeline_update_preview_caps (GESTimelinePipeline * self)
+{
+  GESTimelinePipelinePrivate *priv = self->priv;
+  GList *tracks, *tmp;
+  gboolean reduce;
+
+  reduce = !(priv->mode & (TIMELINE_MODE_RENDER | TIMELINE_MODE_SMART_RENDER))
+      && (priv->preview_quality != GES_PREVIEW_QUALITY_FULL ||
+      priv->preview_frame_skip);
+
+  priv->preview_frame_duration = GST_CLOCK_TIME_NONE;
+  tracks = ges_timeline_get_tracks (priv->timeline);
+
+  for (tmp = tracks; tmp; tmp = tmp->next) {
+    GESTrack *track = (GESTrack *) tmp->data;
+    PreviewCaps *pcaps;
+    GstCaps *caps;
+
+    if (track->type != GES_TRACK_TYPE_VIDEO)
+      goto next;
+
+    pcaps = g_object_get_qdata ((GObject *) track, preview_caps_quark);
+
+    /* The caps were changed behind our back, those are the new full caps */
+    if (pcaps && !gst_caps_is_equal (pcaps->preview,
+            ges_track_get_caps (track))) {
+      g_object_set_qdata ((GObject *) track, preview_caps_quark, NULL);
+      pcaps = NULL;
+    }
+
+    if (!reduce) {
+      if (pcaps) {
+        GST_DEBUG_OBJECT (self, "Restoring full caps on %p", track);
+        ges_track_set_caps (track, pcaps->full);
+        g_object_set_qdata ((GObject *) track, preview_caps_quark, NULL);
+      }
+      goto next;
+    }
+
+    caps = make_preview_caps (self, track,
+        pcaps ? pcaps->full : ges_track_get_caps (track));
+    if (caps == NULL)
+      goto next;
+
+    if (pcaps == NULL) {
+      pcaps = g_slice_new (PreviewCaps);
+      pcaps->full = gst_caps_copy (ges_track_get_caps (track));
+      pcaps->preview = NULL;
+      g_object_set_qdata_full ((GObject *) track, preview_caps_quark, pcaps,
+          (GDestroyNotify) preview_caps_free);
+    } else
+      gst_caps_unref (pcaps->preview);
+    pcaps->preview = caps;
+
+    ges_track_set_caps (track, caps);
+
+  next:
+    g_object_unref (track);
+  }
+
+  g_list_free (tracks);
+}
+
+/* Drops the frames coming less than (skip + 1) frames after the last one
+ * shown, whatever rate the sources ended up producing */
+static gboolean
+preview_skip_frames_probe (GstPad * pad, GstMiniObject * obj,
+    OutputChain * chain)
+{
+  GESTimelinePipelinePrivate *priv = chain->pipeline->priv;
+  GstClockTime ts, interval;
+
+  if (GST_IS_EVENT (obj)) {
+    if (GST_EVENT_TYPE (obj) == GST_EVENT_FLUSH_STOP ||
+        GST_EVENT_TYPE (obj) == GST_EVENT_NEWSEGMENT)
+      chain->next_frame = GST_CLOCK_TIME_NONE;
+    return TRUE;
+  }
+
+  ts = GST_BUFFER_TIMESTAMP (obj);
+  if (priv->preview_frame_skip == 0 || !GST_CLOCK_TIME_IS_VALID (ts))
+    return TRUE;
+
+  if (GST_CLOCK_TIME_IS_VALID (chain->next_frame) && ts < chain->next_frame) {
+    GST_LOG ("Skipping frame at %" GST_TIME_FORMAT, GST_TIME_ARGS (ts));
+    return FALSE;
+  }
+
+  interval = priv->preview_frame_duration;
+  if (!GST_CLOCK_TIME_IS_VALID (interval))
+    interval = GST_BUFFER_DURATION (obj);
+  if (GST_CLOCK_TIME_IS_VALID (interval))
+    chain->next_frame = ts + interval * (priv->preview_frame_skip + 1) -
+        interval / 2;
+
+  return TRUE;
+}
+
 static GstStateChangeReturn
 ges_timeline_pipeline_change_state (GstElement * element,
     GstStateChange transition)
@@ -275,6 +769,27 @@ ges_timeline_pipeline_change_state (GstElement * element,
       }
       /* Set caps on all tracks according to profile if present */
       /* FIXME : Add a new SMART_RENDER mode to avoid decoding */
+      ges_timeline_pipeline_update_preview_caps (self);
+
+      if (render_ranges_active (self)) {
+        GList *tracks = ges_timeline_get_tracks (self->priv->timeline);
+
+        GST_OBJECT_LOCK (self);
+        self->priv->nb_tracks = g_list_length (tracks);
+        self->priv->nb_blocked = 0;
+        self->priv->current_range = 0;
+        GST_OBJECT_UNLOCK (self);
+
+        g_list_foreach (tracks, (GFunc) g_object_unref, NULL);
+        g_list_free (tracks);
+      }
+
+      if (self->priv->mode & (TIMELINE_MODE_RENDER | TIMELINE_MODE_SMART_RENDER))
+        render_progress_start (self);
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* The encoders' streaming thread can't be stopped while it waits */
+      render_progress_unthrottle (self);
       break;
     default:
       break;
@@ -284,10 +799,631 @@ ges_timeline_pipeline_change_state (GstElement * element,
       GST_ELEMENT_CLASS (ges_timeline_pipeline_parent_class)->change_state
       (element, transition);
 
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY) {
+    seek_latency_reset (self);
+    render_progress_stop (self);
+  }
+
 done:
   return ret;
 }
 
+/* Render ranges
+ *
+ * The track pads are blocked as soon as they appear so that nothing reaches
+ * the encoders. Once all of them are blocked, a flushing seek to the first
+ * range is sent to every track and the pads are unblocked. Each range but
+ * the last is a segment seek, and the next range is chained with a
+ * non-flushing seek when the timeline posts its SEGMENT_DONE, so running
+ * time keeps increasing and the ranges end up back to back in the output.
+ *
+ * Seeks are sent from a separate thread since they can't be done from the
+ * streaming threads. */
+
+static gboolean
+render_ranges_active (GESTimelinePipeline * self)
+{
+  return self->priv->ranges->len > 0 &&
+      (self->priv->mode & (TIMELINE_MODE_RENDER | TIMELINE_MODE_SMART_RENDER));
+}
+
+static gpointer
+render_range_seek_thread (GESTimelinePipeline * self)
+{
+  RenderRange range;
+  GstSeekFlags flags = GST_SEEK_FLAG_ACCURATE;
+  GstEvent *event;
+  GList *tmp, *pads = NULL;
+  gboolean first;
+
+  GST_OBJECT_LOCK (self);
+  /* The chains come and go with the track pads while we're seeking */
+  for (tmp = self->priv->chains; tmp; tmp = tmp->next) {
+    OutputChain *chain = (OutputChain *) tmp->data;
+
+    if (chain->srcpad)
+      pads = g_list_prepend (pads, gst_object_ref (chain->srcpad));
+  }
+  first = (self->priv->current_range == 0);
+  range = g_array_index (self->priv->ranges, RenderRange,
+      self->priv->current_range);
+  if (self->priv->current_range + 1 < self->priv->ranges->len)
+    flags |= GST_SEEK_FLAG_SEGMENT;
+  GST_OBJECT_UNLOCK (self);
+
+  if (first)
+    flags |= GST_SEEK_FLAG_FLUSH;
+
+  GST_DEBUG_OBJECT (self, "Seeking to range %" GST_TIME_FORMAT " -- %"
+      GST_TIME_FORMAT, GST_TIME_ARGS (range.start), GST_TIME_ARGS (range.stop));
+
+  event = gst_event_new_seek (1.0, GST_FORMAT_TIME, flags,
+      GST_SEEK_TYPE_SET, range.start, GST_SEEK_TYPE_SET, range.stop);
+
+  for (tmp = pads; tmp; tmp = tmp->next) {
+    GstPad *pad = (GstPad *) tmp->data;
+
+    if (!gst_pad_send_event (pad, gst_event_ref (event)))
+      GST_WARNING_OBJECT (self, "Couldn't seek pad %s:%s",
+          GST_DEBUG_PAD_NAME (pad));
+
+    if (first)
+      gst_pad_set_blocked (pad, FALSE);
+  }
+
+  gst_event_unref (event);
+  g_list_foreach (pads, (GFunc) gst_object_unref, NULL);
+  g_list_free (pads);
+  gst_object_unref (self);
+
+  return NULL;
+}
+
+static void
+render_range_seek (GESTimelinePipeline * self)
+{
+  GError *err = NULL;
+
+  gst_object_ref (self);
+  if (!g_thread_create ((GThreadFunc) render_range_seek_thread, self, FALSE,
+          &err)) {
+    GST_ERROR_OBJECT (self, "Couldn't start seeking thread: %s", err->message);
+    g_error_free (err);
+    gst_object_unref (self);
+  }
+}
+
+static void
+render_range_pad_blocked_cb (GstPad * pad, gboolean blocked,
+    GESTimelinePipeline * self)
+{
+  gboolean all_blocked;
+
+  if (!blocked)
+    return;
+
+  GST_OBJECT_LOCK (self);
+  self->priv->nb_blocked++;
+  all_blocked = (self->priv->nb_blocked == self->priv->nb_tracks);
+  GST_OBJECT_UNLOCK (self);
+
+  GST_DEBUG_OBJECT (self, "pad %s:%s blocked, all blocked: %d",
+      GST_DEBUG_PAD_NAME (pad), all_blocked);
+
+  if (all_blocked)
+    render_range_seek (self);
+}
+
+/* Render progress
+ *
+ * A probe on the source pad of encodebin keeps track of the end of the last
+ * buffer leaving the encoders. With render ranges, the timestamps are
+ * mapped to how much of the ranges was rendered: the length of the ranges
+ * completed so far plus the part of the current one. Reports are scheduled
+ * from there on the main context at most once per progress interval. The
+ * speed is measured from the first encoded buffer on, so that setting up
+ * and prerolling the pipeline doesn't skew the estimate.
+ *
+ * With a maximum render speed, the probe holds the streaming thread until
+ * the clock catches up with the data encoded since the first buffer after
+ * the last flush. The wait is unscheduled when flushing or stopping. */
+
+/* How much of the timeline is rendered in total */
+static GstClockTime
+render_progress_duration (GESTimelinePipeline * self)
+{
+  GstClockTime duration = 0, total = 0;
+  guint i;
+
+  if (self->priv->timeline)
+    g_object_get (self->priv->timeline, "duration", &duration, NULL);
+
+  GST_OBJECT_LOCK (self);
+  if (!render_ranges_active (self))
+    total = duration;
+  for (i = 0; i < self->priv->ranges->len && render_ranges_active (self); i++) {
+    RenderRange *range = &g_array_index (self->priv->ranges, RenderRange, i);
+    GstClockTime stop = GST_CLOCK_TIME_IS_VALID (range->stop) ?
+        range->stop : duration;
+
+    if (stop > range->start)
+      total += stop - range->start;
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  return total;
+}
+
+/* Maps the @start and @stop timestamps of an encoded buffer to how much of
+ * the render ranges was rendered, following the ranges in order. Call with
+ * the object lock taken */
+static void
+render_progress_map (GESTimelinePipeline * self, GstClockTime * start,
+    GstClockTime * stop)
+{
+  GESTimelinePipelinePrivate *priv = self->priv;
+  RenderRange *range;
+  guint i;
+
+  if (!render_ranges_active (self) || priv->progress_range >= priv->ranges->len)
+    return;
+
+  /* Move on to the range the buffer is in, if it's a later one */
+  for (i = priv->progress_range; i < priv->ranges->len; i++) {
+    range = &g_array_index (priv->ranges, RenderRange, i);
+    if (*start >= range->start && *start < range->stop)
+      break;
+  }
+  for (; i < priv->ranges->len && priv->progress_range < i;
+      priv->progress_range++) {
+    range = &g_array_index (priv->ranges, RenderRange, priv->progress_range);
+    priv->progress_offset += range->stop - range->start;
+  }
+
+  range = &g_array_index (priv->ranges, RenderRange, priv->progress_range);
+  *start = priv->progress_offset +
+      CLAMP (*start, range->start, range->stop) - range->start;
+  *stop = priv->progress_offset +
+      CLAMP (*stop, range->start, range->stop) - range->start;
+}
+
+static gboolean
+render_progress_report (GESTimelinePipeline * self)
+{
+  GESTimelinePipelinePrivate *priv = self->priv;
+  GstClockTime position, first, duration, elapsed;
+  GstClockTime eta = GST_CLOCK_TIME_NONE;
+  gdouble speed = 0.0;
+
+  GST_OBJECT_LOCK (self);
+  priv->progress_source = 0;
+  position = priv->progress_position;
+  first = priv->progress_first;
+  GST_OBJECT_UNLOCK (self);
+
+  if (!GST_CLOCK_TIME_IS_VALID (first))
+    return FALSE;
+
+  duration = render_progress_duration (self);
+  elapsed = gst_util_get_timestamp () - first;
+  if (elapsed > 0)
+    speed = (gdouble) position / elapsed;
+
+  if (position >= duration)
+    eta = 0;
+  else if (speed > 0.0)
+    eta = (GstClockTime) ((duration - position) / speed);
+
+  GST_LOG_OBJECT (self, "position %" GST_TIME_FORMAT " of %" GST_TIME_FORMAT
+      ", speed %f, eta %" GST_TIME_FORMAT, GST_TIME_ARGS (position),
+      GST_TIME_ARGS (duration), speed, GST_TIME_ARGS (eta));
+
+  g_signal_emit (self, ges_timeline_pipeline_signals[RENDER_PROGRESS], 0,
+      (guint64) position, (guint64) duration, speed, (guint64) eta);
+
+  return FALSE;
+}
+
+/* Call with the object lock */
+static void
+render_progress_schedule_unlocked (GESTimelinePipeline * self)
+{
+  if (self->priv->progress_probe && !self->priv->progress_source)
+    self->priv->progress_source = g_idle_add_full (G_PRIORITY_DEFAULT,
+        (GSourceFunc) render_progress_report, gst_object_ref (self),
+        (GDestroyNotify) gst_object_unref);
+}
+
+static void
+render_progress_schedule (GESTimelinePipeline * self)
+{
+  GST_OBJECT_LOCK (self);
+  render_progress_schedule_unlocked (self);
+  GST_OBJECT_UNLOCK (self);
+}
+
+static void
+render_progress_unthrottle (GESTimelinePipeline * self)
+{
+  GST_OBJECT_LOCK (self);
+  self->priv->throttle_start = GST_CLOCK_TIME_NONE;
+  if (self->priv->throttle_id)
+    gst_clock_id_unschedule (self->priv->throttle_id);
+  GST_OBJECT_UNLOCK (self);
+}
+
+static gboolean
+render_progress_probe (GstPad * pad, GstMiniObject * obj,
+    GESTimelinePipeline * self)
+{
+  GESTimelinePipelinePrivate *priv = self->priv;
+  GstBuffer *buffer;
+  GstClockTime now, start, end, due;
+  GstClockID id = NULL;
+
+  if (GST_IS_EVENT (obj)) {
+    if (GST_EVENT_TYPE (obj) == GST_EVENT_FLUSH_START)
+      render_progress_unthrottle (self);
+    return TRUE;
+  }
+
+  buffer = GST_BUFFER_CAST (obj);
+  if (!GST_BUFFER_TIMESTAMP_IS_VALID (buffer))
+    return TRUE;
+
+  start = end = GST_BUFFER_TIMESTAMP (buffer);
+  if (GST_BUFFER_DURATION_IS_VALID (buffer))
+    end += GST_BUFFER_DURATION (buffer);
+  now = gst_util_get_timestamp ();
+
+  GST_OBJECT_LOCK (self);
+  render_progress_map (self, &start, &end);
+  if (!GST_CLOCK_TIME_IS_VALID (priv->progress_first))
+    priv->progress_first = priv->progress_last = now;
+  if (end > priv->progress_position)
+    priv->progress_position = end;
+
+  if (priv->progress_interval &&
+      now - priv->progress_last >= priv->progress_interval) {
+    priv->progress_last = now;
+    render_progress_schedule_unlocked (self);
+  }
+
+  /* Clock time at which this much data may be done */
+  if (priv->max_render_speed > 0) {
+    now = gst_clock_get_time (priv->throttle_clock);
+    if (!GST_CLOCK_TIME_IS_VALID (priv->throttle_start)) {
+      priv->throttle_start = now;
+      priv->throttle_base = start;
+    }
+
+    if (end > priv->throttle_base) {
+      due = priv->throttle_start +
+          (GstClockTime) ((end - priv->throttle_base) /
+          priv->max_render_speed);
+      if (due > now)
+        id = priv->throttle_id =
+            gst_clock_new_single_shot_id (priv->throttle_clock, due);
+    }
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  /* Holding the muxer back fills the queues and stalls the encoders */
+  if (id) {
+    gst_clock_id_wait (id, NULL);
+
+    GST_OBJECT_LOCK (self);
+    priv->throttle_id = NULL;
+    GST_OBJECT_UNLOCK (self);
+    gst_clock_id_unref (id);
+  }
+
+  return TRUE;
+}
+
+static void
+render_progress_start (GESTimelinePipeline * self)
+{
+  GstPad *pad;
+
+  render_progress_stop (self);
+
+  pad = gst_element_get_static_pad (self->priv->encodebin, "src");
+  if (G_UNLIKELY (pad == NULL)) {
+    GST_WARNING_OBJECT (self, "encodebin has no source pad");
+    return;
+  }
+
+  GST_OBJECT_LOCK (self);
+  self->priv->progress_position = 0;
+  self->priv->progress_range = 0;
+  self->priv->progress_offset = 0;
+  self->priv->progress_first = GST_CLOCK_TIME_NONE;
+  self->priv->throttle_start = GST_CLOCK_TIME_NONE;
+  self->priv->progress_probe = gst_pad_add_data_probe (pad,
+      G_CALLBACK (render_progress_probe), self);
+  GST_OBJECT_UNLOCK (self);
+
+  gst_object_unref (pad);
+}
+
+static void
+render_progress_stop (GESTimelinePipeline * self)
+{
+  GESTimelinePipelinePrivate *priv = self->priv;
+  gulong probe;
+  guint source;
+  GstPad *pad;
+
+  render_progress_unthrottle (self);
+
+  GST_OBJECT_LOCK (self);
+  probe = priv->progress_probe;
+  source = priv->progress_source;
+  priv->progress_probe = 0;
+  priv->progress_source = 0;
+  GST_OBJECT_UNLOCK (self);
+
+  if (source)
+    g_source_remove (source);
+
+  if (probe && priv->encodebin &&
+      (pad = gst_element_get_static_pad (priv->encodebin, "src"))) {
+    gst_pad_remove_data_probe (pad, probe);
+    gst_object_unref (pad);
+  }
+}
+
+/* Seek-latency mode
+ *
+ * While scrubbing, flushing seeks pile up while the previous one is still
+ * prerolling, each of them causing a full flush of the pipeline and
+ * possibly a rebuild of the stack of the compositions.
+ *
+ * In seek-latency mode, flushing seeks received while a previous one is
+ * prerolling are coalesced: only the latest is sent once the playsink is
+ * prerolled again. Seeks identical to the one the pipeline is already
+ * prerolled for are dropped. */
+
+static void
+seek_latency_reset (GESTimelinePipeline * self)
+{
+  GstEvent *pending, *last;
+
+  GST_OBJECT_LOCK (self);
+  pending = self->priv->pending_seek;
+  last = self->priv->last_seek;
+  self->priv->pending_seek = NULL;
+  self->priv->last_seek = NULL;
+  self->priv->seeking = FALSE;
+  GST_OBJECT_UNLOCK (self);
+
+  if (pending)
+    gst_event_unref (pending);
+  if (last)
+    gst_event_unref (last);
+}
+
+/* Whether seeking with @a and @b gives the same result */
+static gboolean
+seek_equal (GstEvent * a, GstEvent * b)
+{
+  gdouble arate, brate;
+  GstFormat aformat, bformat;
+  GstSeekFlags aflags, bflags;
+  GstSeekType astart_type, bstart_type, astop_type, bstop_type;
+  gint64 astart, bstart, astop, bstop;
+
+  gst_event_parse_seek (a, &arate, &aformat, &aflags, &astart_type, &astart,
+      &astop_type, &astop);
+  gst_event_parse_seek (b, &brate, &bformat, &bflags, &bstart_type, &bstart,
+      &bstop_type, &bstop);
+
+  return arate == brate && aformat == bformat && aflags == bflags &&
+      astart_type == bstart_type && astart == bstart &&
+      astop_type == bstop_type && (astop_type == GST_SEEK_TYPE_NONE ||
+      astop == bstop);
+}
+
+/* Records @event as the seek being performed. Call with the object lock
+ * taken */
+static void
+seek_latency_record (GESTimelinePipeline * self, GstEvent * event)
+{
+  GESTimelinePipelinePrivate *priv = self->priv;
+
+  if (priv->last_seek)
+    gst_event_unref (priv->last_seek);
+  priv->last_seek = gst_event_ref (event);
+  priv->seeking = TRUE;
+}
+
+static gboolean
+seek_latency_forward (GESTimelinePipeline * self, GstEvent * event)
+{
+  GstEvent *last;
+  gboolean res;
+
+  res =
+      GST_ELEMENT_CLASS (ges_timeline_pipeline_parent_class)->send_event
+      (GST_ELEMENT_CAST (self), event);
+
+  if (!res) {
+    GST_WARNING_OBJECT (self, "Seek failed");
+    GST_OBJECT_LOCK (self);
+    last = self->priv->last_seek;
+    self->priv->seeking = FALSE;
+    self->priv->last_seek = NULL;
+    GST_OBJECT_UNLOCK (self);
+
+    if (last)
+      gst_event_unref (last);
+  }
+
+  return res;
+}
+
+static gpointer
+seek_latency_pending_thread (GESTimelinePipeline * self)
+{
+  GstEvent *event;
+
+  GST_OBJECT_LOCK (self);
+  event = self->priv->pending_seek;
+  self->priv->pending_seek = NULL;
+  GST_OBJECT_UNLOCK (self);
+
+  if (event) {
+    GST_DEBUG_OBJECT (self, "Sending coalesced seek");
+    seek_latency_forward (self, event);
+  }
+
+  gst_object_unref (self);
+
+  return NULL;
+}
+
+static void
+seek_latency_prerolled (GESTimelinePipeline * self)
+{
+  GESTimelinePipelinePrivate *priv = self->priv;
+  GError *err = NULL;
+  gboolean send = FALSE;
+
+  GST_OBJECT_LOCK (self);
+  if (priv->seeking) {
+    if (priv->pending_seek) {
+      seek_latency_record (self, priv->pending_seek);
+      send = TRUE;
+    } else
+      priv->seeking = FALSE;
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  if (!send)
+    return;
+
+  /* We can't seek from the streaming thread posting the message */
+  gst_object_ref (self);
+  if (!g_thread_create ((GThreadFunc) seek_latency_pending_thread, self,
+          FALSE, &err)) {
+    GST_ERROR_OBJECT (self, "Couldn't start seeking thread: %s", err->message);
+    g_error_free (err);
+    gst_object_unref (self);
+    seek_latency_reset (self);
+  }
+}
+
+static gboolean
+ges_timeline_pipeline_send_event (GstElement * element, GstEvent * event)
+{
+  GESTimelinePipeline *self = GES_TIMELINE_PIPELINE (element);
+  GESTimelinePipelinePrivate *priv = self->priv;
+  GstFormat format;
+  GstSeekFlags flags;
+  GstSeekType start_type;
+  GstClockTime start;
+  GstState state, pending;
+  GstEvent *old = NULL;
+  gboolean forward = TRUE;
+
+  if (GST_EVENT_TYPE (event) != GST_EVENT_SEEK)
+    goto parent;
+
+  gst_event_parse_seek (event, NULL, &format, &flags, &start_type, &start,
+      NULL, NULL);
+
+  /* Don't wait for the muxers to forward the flush to release the encoders */
+  if (flags & GST_SEEK_FLAG_FLUSH)
+    render_progress_unthrottle (self);
+
+  GST_OBJECT_LOCK (self);
+  state = GST_STATE (self);
+  pending = GST_STATE_PENDING (self);
+  if (!priv->seek_latency || !(priv->mode & TIMELINE_MODE_PREVIEW) ||
+      render_ranges_active (self) || format != GST_FORMAT_TIME ||
+      !(flags & GST_SEEK_FLAG_FLUSH) || start_type != GST_SEEK_TYPE_SET ||
+      state < GST_STATE_PAUSED) {
+    GST_OBJECT_UNLOCK (self);
+    goto parent;
+  }
+
+  if (priv->seeking) {
+    GST_LOG_OBJECT (self, "Previous seek still prerolling, coalescing seek to %"
+        GST_TIME_FORMAT, GST_TIME_ARGS (start));
+    old = priv->pending_seek;
+    priv->pending_seek = event;
+    forward = FALSE;
+  } else if (priv->last_seek && seek_equal (event, priv->last_seek) &&
+      state == GST_STATE_PAUSED && pending == GST_STATE_VOID_PENDING) {
+    GST_LOG_OBJECT (self, "Already prerolled at %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (start));
+    old = event;
+    forward = FALSE;
+  } else
+    seek_latency_record (self, event);
+  GST_OBJECT_UNLOCK (self);
+
+  if (old)
+    gst_event_unref (old);
+
+  if (!forward)
+    return TRUE;
+
+  return seek_latency_forward (self, event);
+
+parent:
+  return
+      GST_ELEMENT_CLASS (ges_timeline_pipeline_parent_class)->send_event
+      (element, event);
+}
+
+static void
+ges_timeline_pipeline_handle_message (GstBin * bin, GstMessage * message)
+{
+  GESTimelinePipeline *self = GES_TIMELINE_PIPELINE (bin);
+  gboolean next = FALSE;
+
+  if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_SEGMENT_DONE &&
+      GST_MESSAGE_SRC (message) == GST_OBJECT_CAST (self->priv->timeline) &&
+      render_ranges_active (self)) {
+    GST_OBJECT_LOCK (self);
+    if (self->priv->current_range + 1 < self->priv->ranges->len) {
+      self->priv->current_range++;
+      next = TRUE;
+    }
+    GST_OBJECT_UNLOCK (self);
+
+    if (next)
+      render_range_seek (self);
+  } else if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_ASYNC_DONE &&
+      GST_MESSAGE_SRC (message) == GST_OBJECT_CAST (self->priv->playsink)) {
+    seek_latency_prerolled (self);
+  } else if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_EOS) {
+    /* Report the end of the render */
+    render_progress_schedule (self);
+  } else if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_STREAM_STATUS &&
+      self->priv->background) {
+    GstStreamStatusType type;
+    GstElement *owner;
+    const GValue *val;
+
+    /* Posted synchronously before the streaming thread is started. This is
+     * only a hint: GLib may ignore thread priorities, and does under the
+     * default scheduling policy of Linux, where max-render-speed is what
+     * actually leaves CPU time to the preview */
+    gst_message_parse_stream_status (message, &type, &owner);
+    val = gst_message_get_stream_status_object (message);
+    if (type == GST_STREAM_STATUS_TYPE_CREATE && val &&
+        G_VALUE_TYPE (val) == GST_TYPE_TASK)
+      gst_task_set_priority (GST_TASK (g_value_get_object (val)),
+          G_THREAD_PRIORITY_LOW);
+  }
+
+  GST_BIN_CLASS (ges_timeline_pipeline_parent_class)->handle_message (bin,
+      message);
+}
+
 static OutputChain *
 new_output_chain_for_track (GESTimelinePipeline * self, GESTrack * track)
 {
@@ -295,6 +1431,8 @@ new_output_chain_for_track (GESTimelinePipeline * self, GESTrack * track)
 
   chain = g_new0 (OutputChain, 1);
   chain->track = track;
+  chain->pipeline = self;
+  chain->next_frame = GST_CLOCK_TIME_NONE;
 
   return chain;
 }
@@ -382,13 +1520,214 @@ no_pad:
   }
 }
 
+static void
+configure_queue (GESTimelinePipeline * self, GstElement * queue)
+{
+  g_object_set (queue, "max-size-buffers", (guint) 0,
+      "max-size-bytes", self->priv->queue_max_bytes,
+      "max-size-time", (guint64) self->priv->queue_max_time, NULL);
+}
+
+static void
+configure_chain_queues (GESTimelinePipeline * self)
+{
+  GList *tmp;
+
+  for (tmp = self->priv->chains; tmp; tmp = tmp->next) {
+    OutputChain *chain = (OutputChain *) tmp->data;
+
+    if (chain->queue)
+      configure_queue (self, chain->queue);
+    if (chain->encodequeue)
+      configure_queue (self, chain->encodequeue);
+  }
+}
+
+static GstElement *
+add_chain_queue (GESTimelinePipeline * self)
+{
+  GstElement *queue;
+
+  if (G_UNLIKELY (!(queue = gst_element_factory_make ("queue", NULL))))
+    return NULL;
+
+  configure_queue (self, queue);
+  gst_bin_add (GST_BIN_CAST (self), queue);
+  gst_element_sync_state_with_parent (queue);
+
+  return queue;
+}
+
+static void
+remove_chain_queue (GESTimelinePipeline * self, GstElement * queue)
+{
+  gst_element_set_state (queue, GST_STATE_NULL);
+  gst_bin_remove (GST_BIN_CAST (self), queue);
+}
+
+static gboolean
+chain_link_playsink (GESTimelinePipeline * self, OutputChain * chain)
+{
+  const gchar *sinkpad_name;
+  GstPad *sinkpad, *tmppad;
+  gboolean reconfigured = FALSE;
+
+  GST_DEBUG_OBJECT (self, "Connecting to playsink");
+
+  switch (chain->track->type) {
+    case GES_TRACK_TYPE_VIDEO:
+      sinkpad_name = "video_sink";
+      break;
+    case GES_TRACK_TYPE_AUDIO:
+      sinkpad_name = "audio_sink";
+      break;
+    case GES_TRACK_TYPE_TEXT:
+      sinkpad_name = "text_sink";
+      break;
+    default:
+      GST_WARNING_OBJECT (self, "Can't handle tracks of type %d yet",
+          chain->track->type);
+      return FALSE;
+  }
+
+  /* Request a sinkpad from playsink */
+  if (G_UNLIKELY (!(sinkpad =
+              gst_element_get_request_pad (self->priv->playsink,
+                  sinkpad_name)))) {
+    GST_ERROR_OBJECT (self, "Couldn't get a pad from the playsink !");
+    return FALSE;
+  }
+
+  tmppad = gst_element_get_request_pad (chain->tee, "src%d");
+  if (G_UNLIKELY (gst_pad_link_full (tmppad, sinkpad,
+              GST_PAD_LINK_CHECK_NOTHING) != GST_PAD_LINK_OK)) {
+    GST_ERROR_OBJECT (self, "Couldn't link track pad to playsink");
+    gst_element_release_request_pad (chain->tee, tmppad);
+    gst_object_unref (tmppad);
+    gst_element_release_request_pad (self->priv->playsink, sinkpad);
+    gst_object_unref (sinkpad);
+    return FALSE;
+  }
+  if (chain->track->type == GES_TRACK_TYPE_VIDEO)
+    gst_pad_add_data_probe (tmppad,
+        G_CALLBACK (preview_skip_frames_probe), chain);
+  gst_object_unref (tmppad);
+
+  GST_DEBUG ("Reconfiguring playsink");
+
+  /* reconfigure playsink */
+  g_signal_emit_by_name (self->priv->playsink, "reconfigure", &reconfigured);
+  GST_DEBUG ("'reconfigure' returned %d", reconfigured);
+
+  /* We still hold a reference on the sinkpad */
+  chain->playsinkpad = sinkpad;
+
+  return TRUE;
+}
+
+static void
+chain_unlink_playsink (GESTimelinePipeline * self, OutputChain * chain)
+{
+  GstPad *peer;
+
+  if (!chain->playsinkpad)
+    return;
+
+  if ((peer = gst_pad_get_peer (chain->playsinkpad))) {
+    gst_pad_unlink (peer, chain->playsinkpad);
+    gst_element_release_request_pad (chain->tee, peer);
+    gst_object_unref (peer);
+  }
+  gst_element_release_request_pad (self->priv->playsink, chain->playsinkpad);
+  gst_object_unref (chain->playsinkpad);
+  chain->playsinkpad = NULL;
+}
+
+static void
+chain_unlink_encodebin (GESTimelinePipeline * self, OutputChain * chain)
+{
+  GstPad *sinkpad, *peer;
+
+  if (chain->encodequeue) {
+    sinkpad = gst_element_get_static_pad (chain->encodequeue, "sink");
+    if ((peer = gst_pad_get_peer (sinkpad))) {
+      gst_pad_unlink (peer, sinkpad);
+      gst_element_release_request_pad (chain->tee, peer);
+      gst_object_unref (peer);
+    }
+    gst_object_unref (sinkpad);
+    /* Removing the queue unlinks it from encodebin */
+    remove_chain_queue (self, chain->encodequeue);
+    chain->encodequeue = NULL;
+  }
+
+  if (chain->encodebinpad) {
+    gst_element_release_request_pad (self->priv->encodebin,
+        chain->encodebinpad);
+    chain->encodebinpad = NULL;
+  }
+}
+
+static gboolean
+chain_link_encodebin (GESTimelinePipeline * self, OutputChain * chain)
+{
+  GstPad *sinkpad, *tmppad;
+
+  GST_DEBUG_OBJECT (self, "Connecting to encodebin");
+
+  if (!chain->encodebinpad) {
+    /* Check for unused static pads */
+    sinkpad = get_compatible_unlinked_pad (self->priv->encodebin,
+        chain->srcpad);
+
+    if (sinkpad == NULL) {
+      GstCaps *caps = gst_pad_get_caps_reffed (chain->srcpad);
+      /* If no compatible static pad is available, request a pad */
+      g_signal_emit_by_name (self->priv->encodebin, "request-pad", caps,
+          &sinkpad);
+      gst_caps_unref (caps);
+      if (G_UNLIKELY (sinkpad == NULL)) {
+        GST_ERROR_OBJECT (self, "Couldn't get a pad from encodebin !");
+        return FALSE;
+      }
+    }
+    chain->encodebinpad = sinkpad;
+  }
+
+  /* The encoder gets its own thread too, so that a slow encoder doesn't
+   * stall the preview, nor the other encoders */
+  if (G_UNLIKELY (!(chain->encodequeue = add_chain_queue (self)))) {
+    GST_ERROR_OBJECT (self, "Couldn't create a queue for the encoder");
+    chain_unlink_encodebin (self, chain);
+    return FALSE;
+  }
+
+  tmppad = gst_element_get_request_pad (chain->tee, "src%d");
+  sinkpad = gst_element_get_static_pad (chain->encodequeue, "sink");
+  gst_pad_link_full (tmppad, sinkpad, GST_PAD_LINK_CHECK_NOTHING);
+  gst_object_unref (tmppad);
+  gst_object_unref (sinkpad);
+
+  tmppad = gst_element_get_static_pad (chain->encodequeue, "src");
+  if (G_UNLIKELY (gst_pad_link_full (tmppad,
+              chain->encodebinpad,
+              GST_PAD_LINK_CHECK_NOTHING) != GST_PAD_LINK_OK)) {
+    GST_WARNING_OBJECT (self, "Couldn't link track pad to encodebin");
+    gst_object_unref (tmppad);
+    chain_unlink_encodebin (self, chain);
+    return FALSE;
+  }
+  gst_object_unref (tmppad);
+
+  return TRUE;
+}
+
 static void
 pad_added_cb (GstElement * timeline, GstPad * pad, GESTimelinePipeline * self)
 {
   OutputChain *chain;
   GESTrack *track;
-  GstPad *sinkpad;
-  gboolean reconfigured = FALSE;
+  GstPad *sinkpad, *srcpad;
 
   GST_DEBUG_OBJECT (self, "new pad %s:%s , caps:%" GST_PTR_FORMAT,
       GST_DEBUG_PAD_NAME (pad), GST_PAD_CAPS (pad));
@@ -416,116 +1755,68 @@ pad_added_cb (GstElement * timeline, GstPad * pad, GESTimelinePipeline * self)
   /* Get an existing chain or create it */
   if (!(chain = get_output_chain_for_track (self, track)))
     chain = new_output_chain_for_track (self, track);
+  GST_OBJECT_LOCK (self);
   chain->srcpad = pad;
+  GST_OBJECT_UNLOCK (self);
+
+  if (track->type == GES_TRACK_TYPE_VIDEO)
+    g_signal_connect (pad, "notify::caps", G_CALLBACK (video_caps_notify_cb),
+        track);
+
+  /* Hold the data until we've seeked to the first range */
+  if (render_ranges_active (self))
+    gst_pad_set_blocked_async (pad, TRUE,
+        (GstPadBlockCallback) render_range_pad_blocked_cb, self);
+
+  /* Adding a queue, so that the track runs in its own streaming thread */
+  if (G_UNLIKELY (!(chain->queue = add_chain_queue (self)))) {
+    GST_ERROR_OBJECT (self, "Couldn't create a queue for the track");
+    goto error;
+  }
 
   /* Adding tee */
   chain->tee = gst_element_factory_make ("tee", NULL);
   gst_bin_add (GST_BIN_CAST (self), chain->tee);
   gst_element_sync_state_with_parent (chain->tee);
 
-  /* Linking pad to tee */
-  sinkpad = gst_element_get_static_pad (chain->tee, "sink");
-  gst_pad_link_full (pad, sinkpad, GST_PAD_LINK_CHECK_NOTHING);
-  gst_object_unref (sinkpad);
-
-  /* Connect playsink */
-  if (self->priv->mode & TIMELINE_MODE_PREVIEW) {
-    const gchar *sinkpad_name;
-    GstPad *tmppad;
-
-    GST_DEBUG_OBJECT (self, "Connecting to playsink");
-
-    switch (track->type) {
-      case GES_TRACK_TYPE_VIDEO:
-        sinkpad_name = "video_sink";
-        break;
-      case GES_TRACK_TYPE_AUDIO:
-        sinkpad_name = "audio_sink";
-        break;
-      case GES_TRACK_TYPE_TEXT:
-        sinkpad_name = "text_sink";
-        break;
-      default:
-        GST_WARNING_OBJECT (self, "Can't handle tracks of type %d yet",
-            track->type);
-        goto error;
-    }
-
-    /* Request a sinkpad from playsink */
-    if (G_UNLIKELY (!(sinkpad =
-                gst_element_get_request_pad (self->priv->playsink,
-                    sinkpad_name)))) {
-      GST_ERROR_OBJECT (self, "Couldn't get a pad from the playsink !");
-      goto error;
-    }
-
-    tmppad = gst_element_get_request_pad (chain->tee, "src%d");
-    if (G_UNLIKELY (gst_pad_link_full (tmppad, sinkpad,
-                GST_PAD_LINK_CHECK_NOTHING) != GST_PAD_LINK_OK)) {
-      GST_ERROR_OBJECT (self, "Couldn't link track pad to playsink");
-      gst_object_unref (tmppad);
-      goto error;
-    }
-    gst_object_unref (tmppad);
-
-    GST_DEBUG ("Reconfiguring playsink");
-
-    /* reconfigure playsink */
-    g_signal_emit_by_name (self->priv->playsink, "reconfigure", &reconfigured);
-    GST_DEBUG ("'reconfigure' returned %d", reconfigured);
+  /* Linking pad to queue and queue to tee */
+  sinkpad = gst_element_get_static_pad (chain->queue, "sink");
+  gst_pad_link_full (pad, sinkpad, GST_PAD_LINK_CHECK_NOTHING);
+  gst_object_unref (sinkpad);
+  srcpad = gst_element_get_static_pad (chain->queue, "src");
+  sinkpad = gst_element_get_static_pad (chain->tee, "sink");
+  gst_pad_link_full (srcpad, sinkpad, GST_PAD_LINK_CHECK_NOTHING);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
 
-    /* We still hold a reference on the sinkpad */
-    chain->playsinkpad = sinkpad;
-  }
+  /* Connect playsink */
+  if ((self->priv->mode & TIMELINE_MODE_PREVIEW) &&
+      !chain_link_playsink (self, chain))
+    goto error;
 
   /* Connect to encodebin */
-  if (self->priv->mode & (TIMELINE_MODE_RENDER | TIMELINE_MODE_SMART_RENDER)) {
-    GstPad *tmppad;
-    GST_DEBUG_OBJECT (self, "Connecting to encodebin");
-
-    if (!chain->encodebinpad) {
-      /* Check for unused static pads */
-      sinkpad = get_compatible_unlinked_pad (self->priv->encodebin, pad);
-
-      if (sinkpad == NULL) {
-        GstCaps *caps = gst_pad_get_caps_reffed (pad);
-        /* If no compatible static pad is available, request a pad */
-        g_signal_emit_by_name (self->priv->encodebin, "request-pad", caps,
-            &sinkpad);
-        gst_caps_unref (caps);
-        if (G_UNLIKELY (sinkpad == NULL)) {
-          GST_ERROR_OBJECT (self, "Couldn't get a pad from encodebin !");
-          goto error;
-        }
-      }
-      chain->encodebinpad = sinkpad;
-    }
-
-    tmppad = gst_element_get_request_pad (chain->tee, "src%d");
-    if (G_UNLIKELY (gst_pad_link_full (tmppad,
-                chain->encodebinpad,
-                GST_PAD_LINK_CHECK_NOTHING) != GST_PAD_LINK_OK)) {
-      GST_WARNING_OBJECT (self, "Couldn't link track pad to playsink");
-      goto error;
-    }
-    gst_object_unref (tmppad);
-
-  }
+  if ((self->priv->mode & (TIMELINE_MODE_RENDER | TIMELINE_MODE_SMART_RENDER))
+      && !chain_link_encodebin (self, chain))
+    goto error;
 
   /* If chain wasn't already present, insert it in list */
-  if (!get_output_chain_for_track (self, track))
+  if (!get_output_chain_for_track (self, track)) {
+    GST_OBJECT_LOCK (self);
     self->priv->chains = g_list_append (self->priv->chains, chain);
+    GST_OBJECT_UNLOCK (self);
+  }
 
   GST_DEBUG ("done");
   return;
 
 error:
   {
+    chain_unlink_playsink (self, chain);
     if (chain->tee) {
       gst_bin_remove (GST_BIN_CAST (self), chain->tee);
     }
-    if (sinkpad)
-      gst_object_unref (sinkpad);
+    if (chain->queue)
+      remove_chain_queue (self, chain->queue);
     g_free (chain);
   }
 }
@@ -550,32 +1841,23 @@ pad_removed_cb (GstElement * timeline, GstPad * pad, GESTimelinePipeline * self)
     return;
   }
 
-  /* Unlink encodebin */
-  if (chain->encodebinpad) {
-    peer = gst_pad_get_peer (chain->encodebinpad);
-    gst_pad_unlink (peer, chain->encodebinpad);
-    gst_object_unref (peer);
-    gst_element_release_request_pad (self->priv->encodebin,
-        chain->encodebinpad);
-  }
+  g_signal_handlers_disconnect_by_func (pad, video_caps_notify_cb, track);
 
-  /* Unlink playsink */
-  if (chain->playsinkpad) {
-    peer = gst_pad_get_peer (chain->playsinkpad);
-    gst_pad_unlink (peer, chain->playsinkpad);
-    gst_object_unref (peer);
-    gst_element_release_request_pad (self->priv->playsink, chain->playsinkpad);
-    gst_object_unref (chain->playsinkpad);
-  }
+  /* Unlink encodebin and playsink */
+  chain_unlink_encodebin (self, chain);
+  chain_unlink_playsink (self, chain);
 
-  /* Unlike/remove tee */
-  peer = gst_element_get_static_pad (chain->tee, "sink");
+  /* Unlink/remove the queue and the tee */
+  peer = gst_element_get_static_pad (chain->queue, "sink");
   gst_pad_unlink (pad, peer);
   gst_object_unref (peer);
+  remove_chain_queue (self, chain->queue);
   gst_element_set_state (chain->tee, GST_STATE_NULL);
   gst_bin_remove (GST_BIN (self), chain->tee);
 
+  GST_OBJECT_LOCK (self);
   self->priv->chains = g_list_remove (self->priv->chains, chain);
+  GST_OBJECT_UNLOCK (self);
   g_free (chain);
 
   GST_DEBUG ("done");
@@ -663,6 +1945,177 @@ ges_timeline_pipeline_set_render_settings (GESTimelinePipeline * pipeline,
   return TRUE;
 }
 
+/* Live mode switching
+ *
+ * While the pipeline is PAUSED or PLAYING the tracks already have their
+ * output chains, so instead of tearing everything down to NULL only the
+ * playsink and encodebin branches are (un)linked from the tees, and the
+ * compositions keep their state and decoders.
+ *
+ * The chains are flushed from the track pads first. A blocked pad wouldn't
+ * do there: prerolled sinks keep the streaming threads inside the branches
+ * until the pipeline plays, so the blocks would never be reached. Once the
+ * branches are relinked, a flushing seek restarts the data flow and
+ * prerolls the new sinks. */
+
+static gboolean
+can_switch_mode_live (GESTimelinePipeline * self, GESPipelineFlags mode)
+{
+  GESPipelineFlags render = TIMELINE_MODE_RENDER | TIMELINE_MODE_SMART_RENDER;
+  GstState target;
+
+  GST_OBJECT_LOCK (self);
+  target = GST_STATE_TARGET (self);
+  GST_OBJECT_UNLOCK (self);
+
+  /* The tracks have no pads yet, there's nothing to keep */
+  if (target < GST_STATE_PAUSED || self->priv->chains == NULL)
+    return FALSE;
+
+  /* encodebin only picks avoid-reencoding up when it's set up */
+  if ((self->priv->mode & render) && (mode & render) &&
+      (self->priv->mode & render) != (mode & render))
+    return FALSE;
+
+  /* Render ranges are armed as the track pads appear */
+  if (!(self->priv->mode & render) && (mode & render) &&
+      self->priv->ranges->len > 0)
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+chains_flush (GESTimelinePipeline * self, gboolean start)
+{
+  GList *tmp;
+
+  for (tmp = self->priv->chains; tmp; tmp = tmp->next) {
+    OutputChain *chain = (OutputChain *) tmp->data;
+
+    gst_pad_push_event (chain->srcpad, start ? gst_event_new_flush_start () :
+        gst_event_new_flush_stop ());
+  }
+}
+
+static gboolean
+switch_mode_live (GESTimelinePipeline * self, GESPipelineFlags mode)
+{
+  GESTimelinePipelinePrivate *priv = self->priv;
+  GESPipelineFlags render = TIMELINE_MODE_RENDER | TIMELINE_MODE_SMART_RENDER;
+  gboolean add_preview, remove_preview, add_render, remove_render;
+  GstFormat format = GST_FORMAT_TIME;
+  gint64 position = 0;
+  GList *tmp;
+
+  add_preview = !(priv->mode & TIMELINE_MODE_PREVIEW) &&
+      (mode & TIMELINE_MODE_PREVIEW);
+  remove_preview = (priv->mode & TIMELINE_MODE_PREVIEW) &&
+      !(mode & TIMELINE_MODE_PREVIEW);
+  add_render = !(priv->mode & render) && (mode & render);
+  remove_render = (priv->mode & render) && !(mode & render);
+
+  GST_DEBUG_OBJECT (self, "Switching mode live, preview +%d -%d, "
+      "render +%d -%d", add_preview, remove_preview, add_render,
+      remove_render);
+
+  if (G_UNLIKELY (add_render && priv->urisink == NULL)) {
+    GST_ERROR_OBJECT (self, "Output URI not set !");
+    return FALSE;
+  }
+
+  if (!add_preview && !remove_preview && !add_render && !remove_render) {
+    priv->mode = mode;
+    return TRUE;
+  }
+
+  /* The encoders want the whole timeline, the preview resumes where it was */
+  if (!add_render)
+    gst_element_query_position (GST_ELEMENT_CAST (self), &format, &position);
+
+  /* Get the streaming threads out of the branches */
+  chains_flush (self, TRUE);
+
+  if (remove_preview) {
+    GST_DEBUG ("Disabling playsink");
+    for (tmp = priv->chains; tmp; tmp = tmp->next)
+      chain_unlink_playsink (self, (OutputChain *) tmp->data);
+    gst_element_set_state (priv->playsink, GST_STATE_NULL);
+    g_object_ref (priv->playsink);
+    gst_bin_remove (GST_BIN_CAST (self), priv->playsink);
+  }
+  if (remove_render) {
+    GST_DEBUG ("Disabling rendering bin");
+    render_progress_stop (self);
+    for (tmp = priv->chains; tmp; tmp = tmp->next)
+      chain_unlink_encodebin (self, (OutputChain *) tmp->data);
+    gst_element_set_state (priv->encodebin, GST_STATE_NULL);
+    gst_element_set_state (priv->urisink, GST_STATE_NULL);
+    g_object_ref (priv->encodebin);
+    g_object_ref (priv->urisink);
+    gst_bin_remove_many (GST_BIN_CAST (self), priv->encodebin, priv->urisink,
+        NULL);
+  }
+
+  priv->mode = mode;
+
+  if (add_preview) {
+    GST_DEBUG ("Adding playsink");
+    if (!gst_bin_add (GST_BIN_CAST (self), priv->playsink)) {
+      GST_ERROR_OBJECT (self, "Couldn't add playsink");
+      goto failed;
+    }
+    for (tmp = priv->chains; tmp; tmp = tmp->next)
+      chain_link_playsink (self, (OutputChain *) tmp->data);
+    gst_element_sync_state_with_parent (priv->playsink);
+  }
+  if (add_render) {
+    GST_DEBUG ("Adding render bin");
+    if (!gst_bin_add (GST_BIN_CAST (self), priv->encodebin)) {
+      GST_ERROR_OBJECT (self, "Couldn't add encodebin");
+      goto failed;
+    }
+    if (!gst_bin_add (GST_BIN_CAST (self), priv->urisink)) {
+      GST_ERROR_OBJECT (self, "Couldn't add URI sink");
+      goto failed;
+    }
+    g_object_set (priv->encodebin, "avoid-reencoding",
+        !(!(mode & TIMELINE_MODE_SMART_RENDER)), NULL);
+    gst_element_link_pads_full (priv->encodebin, "src", priv->urisink, "sink",
+        GST_PAD_LINK_CHECK_NOTHING);
+
+    /* The tracks get the caps of the profile before being linked to it */
+    ges_timeline_pipeline_update_caps (self);
+    for (tmp = priv->chains; tmp; tmp = tmp->next)
+      chain_link_encodebin (self, (OutputChain *) tmp->data);
+    gst_element_sync_state_with_parent (priv->urisink);
+    gst_element_sync_state_with_parent (priv->encodebin);
+    render_progress_start (self);
+  }
+
+  /* Previewing at a reduced quality only applies when not rendering */
+  if (add_render || remove_render)
+    ges_timeline_pipeline_update_preview_caps (self);
+
+  /* Flush the new branches and restart the tracks */
+  if (!gst_element_seek_simple (GST_ELEMENT_CAST (self), GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE, position)) {
+    GST_ERROR_OBJECT (self, "Couldn't restart the tracks at %"
+        GST_TIME_FORMAT, GST_TIME_ARGS (position));
+    goto failed;
+  }
+
+  return TRUE;
+
+failed:
+  {
+    /* Don't leave the branches flushing, the caller can still set the
+     * pipeline to NULL and start over */
+    chains_flush (self, FALSE);
+    return FALSE;
+  }
+}
+
 /**
  * ges_timeline_pipeline_set_mode:
  * @pipeline: a #GESTimelinePipeline
@@ -671,9 +2124,17 @@ ges_timeline_pipeline_set_render_settings (GESTimelinePipeline * pipeline,
  * switches the @pipeline to the specified @mode. The default mode when
  * creating a #GESTimelinePipeline is #TIMELINE_MODE_PREVIEW.
  *
- * Note: The @pipeline will be set to #GST_STATE_NULL during this call due to
- * the internal changes that happen. The caller will therefore have to 
- * set the @pipeline to the requested state after calling this method.
+ * If the @pipeline is #GST_STATE_PAUSED or #GST_STATE_PLAYING, the preview
+ * and render outputs are added and removed without stopping the timeline,
+ * and the @pipeline keeps its state. Previewing resumes at the current
+ * position while rendering starts from the beginning of the timeline.
+ * Switching between #TIMELINE_MODE_RENDER and #TIMELINE_MODE_SMART_RENDER,
+ * or starting to render with render ranges set, can't be done that way.
+ *
+ * Note: Otherwise, the @pipeline will be set to #GST_STATE_NULL during this
+ * call due to the internal changes that happen. The caller will therefore
+ * have to set the @pipeline to the requested state after calling this method.
+ * The same goes when switching without stopping fails and %FALSE is returned.
  *
  * Returns: %TRUE if the mode was properly set, else %FALSE.
  **/
@@ -688,9 +2149,8 @@ ges_timeline_pipeline_set_mode (GESTimelinePipeline * pipeline,
   if (mode == pipeline->priv->mode)
     return TRUE;
 
-  /* FIXME: It would be nice if we are only (de)activating preview
-   * modes to not set the whole pipeline to NULL, but instead just
-   * do the proper (un)linking to playsink. */
+  if (can_switch_mode_live (pipeline, mode))
+    return switch_mode_live (pipeline, mode);
 
   /* Switch pipeline to NULL since we're changing the configuration */
   gst_element_set_state (GST_ELEMENT_CAST (pipeline), GST_STATE_NULL);
@@ -953,6 +2413,384 @@ ges_timeline_pipeline_preview_set_audio_sink (GESTimelinePipeline * self,
   g_object_set (self->priv->playsink, "audio-sink", sink, NULL);
 };
 
+/**
+ * ges_timeline_pipeline_add_render_range:
+ * @pipeline: a #GESTimelinePipeline
+ * @start: the start of the range, in the timeline
+ * @stop: the end of the range (exclusive), in the timeline
+ *
+ * Adds the [@start, @stop) range to the list of ranges to render. When render
+ * ranges are set, only those parts of the timeline are rendered, one after
+ * the other in the order they were added, instead of the whole timeline.
+ *
+ * This has to be called before setting @pipeline to %GST_STATE_PAUSED in
+ * #TIMELINE_MODE_RENDER or #TIMELINE_MODE_SMART_RENDER, and has no effect
+ * in the other modes.
+ *
+ * Returns: %TRUE if the range was added, else %FALSE.
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_timeline_pipeline_add_render_range (GESTimelinePipeline * pipeline,
+    GstClockTime start, GstClockTime stop)
+{
+  RenderRange range;
+
+  g_return_val_if_fail (GES_IS_TIMELINE_PIPELINE (pipeline), FALSE);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (start), FALSE);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (stop), FALSE);
+
+  if (G_UNLIKELY (stop <= start)) {
+    GST_WARNING_OBJECT (pipeline, "Empty range %" GST_TIME_FORMAT " -- %"
+        GST_TIME_FORMAT, GST_TIME_ARGS (start), GST_TIME_ARGS (stop));
+    return FALSE;
+  }
+
+  range.start = start;
+  range.stop = stop;
+
+  GST_OBJECT_LOCK (pipeline);
+  g_array_append_val (pipeline->priv->ranges, range);
+  GST_OBJECT_UNLOCK (pipeline);
+
+  return TRUE;
+}
+
+/**
+ * ges_timeline_pipeline_set_render_range:
+ * @pipeline: a #GESTimelinePipeline
+ * @start: the start of the range, in the timeline
+ * @stop: the end of the range (exclusive), in the timeline
+ *
+ * Only render the [@start, @stop) range of the timeline. This replaces any
+ * previously set render range. See ges_timeline_pipeline_add_render_range().
+ *
+ * Returns: %TRUE if the range was set, else %FALSE.
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_timeline_pipeline_set_render_range (GESTimelinePipeline * pipeline,
+    GstClockTime start, GstClockTime stop)
+{
+  ges_timeline_pipeline_clear_render_ranges (pipeline);
+
+  return ges_timeline_pipeline_add_render_range (pipeline, start, stop);
+}
+
+/**
+ * ges_timeline_pipeline_clear_render_ranges:
+ * @pipeline: a #GESTimelinePipeline
+ *
+ * Removes all the render ranges, the whole timeline will be rendered.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_timeline_pipeline_clear_render_ranges (GESTimelinePipeline * pipeline)
+{
+  g_return_if_fail (GES_IS_TIMELINE_PIPELINE (pipeline));
+
+  GST_OBJECT_LOCK (pipeline);
+  g_array_set_size (pipeline->priv->ranges, 0);
+  GST_OBJECT_UNLOCK (pipeline);
+}
+
+/**
+ * ges_timeline_pipeline_set_preview_quality:
+ * @pipeline: a #GESTimelinePipeline
+ * @quality: the #GESPreviewQuality to preview video at
+ *
+ * Sets the resolution video is previewed at. The video tracks are given
+ * caps preferring the reduced resolution when the pipeline goes to PAUSED in
+ * one of the preview modes, and get back their previous caps when it goes to
+ * PAUSED in one of the render modes.
+ *
+ * The reference resolution is taken from the restriction of the video
+ * profile set with ges_timeline_pipeline_set_render_settings(), or else from
+ * the caps of the video tracks if they fix a size. Failing both, it is the
+ * size the video tracks negotiated the last time the pipeline prerolled at
+ * full quality, so the first preview of such a timeline is at full quality.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_timeline_pipeline_set_preview_quality (GESTimelinePipeline * pipeline,
+    GESPreviewQuality quality)
+{
+  g_return_if_fail (GES_IS_TIMELINE_PIPELINE (pipeline));
+  g_return_if_fail (quality == GES_PREVIEW_QUALITY_FULL ||
+      quality == GES_PREVIEW_QUALITY_HALF ||
+      quality == GES_PREVIEW_QUALITY_QUARTER);
+
+  pipeline->priv->preview_quality = quality;
+}
+
+/**
+ * ges_timeline_pipeline_get_preview_quality:
+ * @pipeline: a #GESTimelinePipeline
+ *
+ * Returns: the #GESPreviewQuality video is previewed at.
+ *
+ * Since: 0.10.2
+ */
+GESPreviewQuality
+ges_timeline_pipeline_get_preview_quality (GESTimelinePipeline * pipeline)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE_PIPELINE (pipeline),
+      GES_PREVIEW_QUALITY_FULL);
+
+  return pipeline->priv->preview_quality;
+}
+
+/**
+ * ges_timeline_pipeline_set_preview_frame_skip:
+ * @pipeline: a #GESTimelinePipeline
+ * @skip: the number of frames to skip after each shown frame, 0 to show them
+ * all
+ *
+ * Only shows one video frame every @skip + 1 frames when previewing. This
+ * applies to the pipeline right away, and lowers the frame rate the video
+ * tracks prefer the next time the pipeline goes to PAUSED.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_timeline_pipeline_set_preview_frame_skip (GESTimelinePipeline * pipeline,
+    guint skip)
+{
+  g_return_if_fail (GES_IS_TIMELINE_PIPELINE (pipeline));
+
+  pipeline->priv->preview_frame_skip = skip;
+}
+
+/**
+ * ges_timeline_pipeline_get_preview_frame_skip:
+ * @pipeline: a #GESTimelinePipeline
+ *
+ * Returns: the number of frames skipped after each previewed frame.
+ *
+ * Since: 0.10.2
+ */
+guint
+ges_timeline_pipeline_get_preview_frame_skip (GESTimelinePipeline * pipeline)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE_PIPELINE (pipeline), 0);
+
+  return pipeline->priv->preview_frame_skip;
+}
+
+/**
+ * ges_timeline_pipeline_set_seek_latency_mode:
+ * @pipeline: a #GESTimelinePipeline
+ * @enabled: whether to optimize the pipeline for seek latency
+ *
+ * Optimizes previewing for frequent seeking, such as scrubbing. Flushing
+ * seeks sent to @pipeline while a previous one is still prerolling are
+ * coalesced so that only the latest one is performed, and seeks identical
+ * to the one the pipeline is already prerolled for are ignored.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_timeline_pipeline_set_seek_latency_mode (GESTimelinePipeline * pipeline,
+    gboolean enabled)
+{
+  g_return_if_fail (GES_IS_TIMELINE_PIPELINE (pipeline));
+
+  GST_OBJECT_LOCK (pipeline);
+  pipeline->priv->seek_latency = enabled;
+  GST_OBJECT_UNLOCK (pipeline);
+
+  if (!enabled)
+    seek_latency_reset (pipeline);
+}
+
+/**
+ * ges_timeline_pipeline_get_seek_latency_mode:
+ * @pipeline: a #GESTimelinePipeline
+ *
+ * Returns: %TRUE if @pipeline is optimized for seek latency.
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_timeline_pipeline_get_seek_latency_mode (GESTimelinePipeline * pipeline)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE_PIPELINE (pipeline), FALSE);
+
+  return pipeline->priv->seek_latency;
+}
+
+/**
+ * ges_timeline_pipeline_set_progress_interval:
+ * @pipeline: a #GESTimelinePipeline
+ * @interval: the minimum time between two #GESTimelinePipeline::render-progress
+ * signals, or 0 to only report the end of the render
+ *
+ * Sets how often the progress of a render is reported. The default is
+ * every second.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_timeline_pipeline_set_progress_interval (GESTimelinePipeline * pipeline,
+    GstClockTime interval)
+{
+  g_return_if_fail (GES_IS_TIMELINE_PIPELINE (pipeline));
+  g_return_if_fail (GST_CLOCK_TIME_IS_VALID (interval));
+
+  GST_OBJECT_LOCK (pipeline);
+  pipeline->priv->progress_interval = interval;
+  GST_OBJECT_UNLOCK (pipeline);
+}
+
+/**
+ * ges_timeline_pipeline_get_progress_interval:
+ * @pipeline: a #GESTimelinePipeline
+ *
+ * Returns: the minimum time between two render progress reports.
+ *
+ * Since: 0.10.2
+ */
+GstClockTime
+ges_timeline_pipeline_get_progress_interval (GESTimelinePipeline * pipeline)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE_PIPELINE (pipeline),
+      GST_CLOCK_TIME_NONE);
+
+  return pipeline->priv->progress_interval;
+}
+
+/* Adds @timeline to the @render pipeline and starts rendering it. Takes
+ * ownership of both, and returns @render or NULL if it couldn't be started */
+static GESTimelinePipeline *
+start_background_render (GESTimelinePipeline * render, GESTimeline * timeline,
+    const gchar * output_uri, GstEncodingProfile * profile)
+{
+  render->priv->background = TRUE;
+
+  if (!ges_timeline_pipeline_add_timeline (render, timeline)) {
+    g_object_unref (timeline);
+    goto error;
+  }
+
+  if (!ges_timeline_pipeline_set_render_settings (render,
+          (gchar *) output_uri, profile) ||
+      !ges_timeline_pipeline_set_mode (render, TIMELINE_MODE_RENDER))
+    goto error;
+
+  if (gst_element_set_state (GST_ELEMENT_CAST (render),
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+    goto error;
+
+  GST_DEBUG_OBJECT (render, "Rendering %p in the background", timeline);
+
+  return render;
+
+error:
+  {
+    GST_ERROR_OBJECT (render, "Couldn't start rendering in the background");
+    gst_element_set_state (GST_ELEMENT_CAST (render), GST_STATE_NULL);
+    gst_object_unref (render);
+    return NULL;
+  }
+}
+
+/* ges_timeline_pipeline_render_background:
+ * @timeline: (transfer full): a #GESTimeline which isn't used elsewhere
+ * @output_uri: the URI to which the timeline will be rendered
+ * @profile: the #GstEncodingProfile to use to render the timeline
+ *
+ * Renders @timeline in the background, with the defaults of a new pipeline,
+ * like ges_timeline_pipeline_render_snapshot() does.
+ *
+ * Returns: (transfer full): the rendering #GESTimelinePipeline, or %NULL
+ */
+GESTimelinePipeline *
+ges_timeline_pipeline_render_background (GESTimeline * timeline,
+    const gchar * output_uri, GstEncodingProfile * profile)
+{
+  return start_background_render (ges_timeline_pipeline_new (), timeline,
+      output_uri, profile);
+}
+
+/* Copies @timeline through a #GESTimelineSnapshot */
+static GESTimeline *
+copy_timeline (GESTimeline * timeline)
+{
+  GESTimelineSnapshot *snapshot;
+  GESTimeline *copy;
+
+  snapshot = ges_timeline_snapshot_new (timeline);
+  copy = ges_timeline_snapshot_create_timeline (snapshot);
+  ges_timeline_snapshot_unref (snapshot);
+
+  return copy;
+}
+
+/**
+ * ges_timeline_pipeline_render_snapshot:
+ * @pipeline: a #GESTimelinePipeline with a timeline
+ * @output_uri: the URI to which the timeline will be rendered
+ * @profile: the #GstEncodingProfile to use to render the timeline.
+ *
+ * Renders the timeline of @pipeline as it currently is, in the background.
+ *
+ * The timeline is copied into a new #GESTimelinePipeline which is started in
+ * #TIMELINE_MODE_RENDER right away, while @pipeline is left untouched, so
+ * the timeline can keep being edited and previewed during the render. The
+ * render ranges, queue sizes and #GESTimelinePipeline:max-render-speed of
+ * @pipeline are carried over. The latter can be changed on the returned
+ * pipeline at any time to throttle the render further.
+ *
+ * The streaming threads of the render are given a low priority, but GLib
+ * is free to ignore thread priorities, and does on Linux with the default
+ * scheduling policy. Set #GESTimelinePipeline:max-render-speed to make sure
+ * the render leaves enough CPU time to the preview.
+ *
+ * The caller watches the bus of the returned pipeline, or its
+ * #GESTimelinePipeline::render-progress signal, for the end of the render,
+ * then sets it to #GST_STATE_NULL and unrefs it.
+ *
+ * Returns: (transfer full): the rendering #GESTimelinePipeline, or %NULL if
+ * the timeline couldn't be copied or the render couldn't be started.
+ *
+ * Since: 0.10.2
+ */
+GESTimelinePipeline *
+ges_timeline_pipeline_render_snapshot (GESTimelinePipeline * pipeline,
+    const gchar * output_uri, GstEncodingProfile * profile)
+{
+  GESTimelinePipeline *render;
+  GESTimeline *copy;
+
+  g_return_val_if_fail (GES_IS_TIMELINE_PIPELINE (pipeline), NULL);
+  g_return_val_if_fail (pipeline->priv->timeline != NULL, NULL);
+  g_return_val_if_fail (output_uri != NULL, NULL);
+  g_return_val_if_fail (profile != NULL, NULL);
+
+  if (G_UNLIKELY (!(copy = copy_timeline (pipeline->priv->timeline)))) {
+    GST_ERROR_OBJECT (pipeline, "Couldn't copy the timeline");
+    return NULL;
+  }
+
+  render = ges_timeline_pipeline_new ();
+  render->priv->queue_max_time = pipeline->priv->queue_max_time;
+  render->priv->queue_max_bytes = pipeline->priv->queue_max_bytes;
+
+  GST_OBJECT_LOCK (pipeline);
+  render->priv->max_render_speed = pipeline->priv->max_render_speed;
+  g_array_append_vals (render->priv->ranges, pipeline->priv->ranges->data,
+      pipeline->priv->ranges->len);
+  GST_OBJECT_UNLOCK (pipeline);
+
+  if ((render = start_background_render (render, copy, output_uri, profile)))
+    GST_DEBUG_OBJECT (pipeline, "Rendering a snapshot with %p", render);
+
+  return render;
+}
 
 static gboolean
 play_sink_multiple_seeks_send_event (GstElement * element, GstEvent * event)
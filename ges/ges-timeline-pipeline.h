@@ -113,6 +113,49 @@ void
 ges_timeline_pipeline_preview_set_audio_sink (GESTimelinePipeline * self,
     GstElement * sink);
 
+gboolean
+ges_timeline_pipeline_set_render_range (GESTimelinePipeline * pipeline,
+    GstClockTime start, GstClockTime stop);
+
+gboolean
+ges_timeline_pipeline_add_render_range (GESTimelinePipeline * pipeline,
+    GstClockTime start, GstClockTime stop);
+
+void
+ges_timeline_pipeline_clear_render_ranges (GESTimelinePipeline * pipeline);
+
+void
+ges_timeline_pipeline_set_preview_quality (GESTimelinePipeline * pipeline,
+    GESPreviewQuality quality);
+
+GESPreviewQuality
+ges_timeline_pipeline_get_preview_quality (GESTimelinePipeline * pipeline);
+
+void
+ges_timeline_pipeline_set_preview_frame_skip (GESTimelinePipeline * pipeline,
+    guint skip);
+
+guint
+ges_timeline_pipeline_get_preview_frame_skip (GESTimelinePipeline * pipeline);
+
+void
+ges_timeline_pipeline_set_seek_latency_mode (GESTimelinePipeline * pipeline,
+    gboolean enabled);
+
+gboolean
+ges_timeline_pipeline_get_seek_latency_mode (GESTimelinePipeline * pipeline);
+
+void
+ges_timeline_pipeline_set_progress_interval (GESTimelinePipeline * pipeline,
+    GstClockTime interval);
+
+GstClockTime
+ges_timeline_pipeline_get_progress_interval (GESTimelinePipeline * pipeline);
+
+GESTimelinePipeline *
+ges_timeline_pipeline_render_snapshot (GESTimelinePipeline * pipeline,
+    const gchar * output_uri, GstEncodingProfile * profile);
+
 G_END_DECLS
 
 #endif /* _GES_TIMELINE_PIPELINE */
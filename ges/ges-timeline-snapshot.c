@@ -0,0 +1,997 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:ges-timeline-snapshot
+ * @short_description: Immutable copies of the state of a timeline
+ *
+ * A #GESTimelineSnapshot holds the state of a #GESTimeline at the time it
+ * was taken: the type and caps of its tracks, its layers, their
+ * #GESTimelineObject and the #GESTrackObject of those, including the
+ * effects and the child properties set on them.
+ *
+ * A snapshot can be turned into a new, independent timeline with
+ * ges_timeline_snapshot_create_timeline(), to render or save it without
+ * holding the edited timeline back, or be used to bring a timeline back to
+ * that state with ges_timeline_snapshot_restore(), to implement undo and
+ * redo.
+ *
+ * Snapshots are immutable and can be used from any thread. The state of
+ * each layer and object is kept in a record that is shared by all the
+ * snapshots taken while it didn't change, so taking a snapshot only costs
+ * recording the layers and objects that changed since the previous one.
+ *
+ * Note that changes made directly on the elements of a #GESTrackObject,
+ * instead of with ges_track_object_set_child_property() and friends, aren't
+ * noticed, the snapshots keep the values recorded before.
+ */
+
+#include <string.h>
+#include <gst/gst.h>
+#include "ges-internal.h"
+#include "ges-timeline-snapshot.h"
+#include "ges.h"
+
+typedef struct
+{
+  guint n_params;
+  GParameter *params;
+} Properties;
+
+/* The track objects which aren't effects are created again by their
+ * timeline object, only their state is restored */
+typedef struct
+{
+  GESTrackType track_type;
+  GType type;
+  gboolean is_effect;
+  Properties props;             /* Effects only */
+  gboolean active;
+  gboolean locked;
+  guint n_children;
+  GParamSpec **children;
+  GValue *values;
+} TrackObjectRecord;
+
+typedef struct
+{
+  volatile gint refcount;
+  GType type;
+  Properties props;
+  guint n_trackobjects;
+  TrackObjectRecord *trackobjects;      /* In priority order */
+} ObjectRecord;
+
+/* A record waiting to be applied to an object created from it, as each of
+ * the tracks it was recorded in gets filled */
+typedef struct
+{
+  ObjectRecord *record;
+  GESTrackType pending;
+} PendingRecord;
+
+typedef struct
+{
+  volatile gint refcount;
+  GType type;
+  Properties props;
+  gboolean auto_transition;
+  guint n_objects;
+  ObjectRecord **objects;
+} LayerRecord;
+
+struct _GESTimelineSnapshot
+{
+  volatile gint refcount;
+
+  guint n_tracks;
+  GESTrackType *track_types;
+  GstCaps **track_caps;
+
+  guint n_layers;
+  LayerRecord **layers;
+};
+
+/* The records of the objects and layers which didn't change since they
+ * were recorded are cached on them. The quarks are only set once the
+ * first snapshot is taken, so that changes are cheap until then. */
+static GQuark object_record_quark = 0;
+static GQuark layer_record_quark = 0;
+static GQuark pending_record_quark = 0;
+static GQuark watchers_quark = 0;
+G_LOCK_DEFINE_STATIC (records);
+
+/* The timing of the effects comes from their timeline object, and their
+ * state is restored separately */
+static const gchar *trackobject_skipped[] = {
+  "start", "in-point", "duration", "priority", "active", "locked", NULL
+};
+
+/* Auto-transitions are recorded as objects of their own */
+static const gchar *layer_skipped[] = { "auto-transition", NULL };
+
+GType
+ges_timeline_snapshot_get_type (void)
+{
+  static volatile gsize type = 0;
+
+  if (g_once_init_enter (&type)) {
+    GType tmp = g_boxed_type_register_static ("GESTimelineSnapshot",
+        (GBoxedCopyFunc) ges_timeline_snapshot_ref,
+        (GBoxedFreeFunc) ges_timeline_snapshot_unref);
+    g_once_init_leave (&type, tmp);
+  }
+
+  return type;
+}
+
+static void
+ensure_quarks (void)
+{
+  if (G_UNLIKELY (!pending_record_quark)) {
+    object_record_quark = g_quark_from_static_string ("ges-object-record");
+    layer_record_quark = g_quark_from_static_string ("ges-layer-record");
+    pending_record_quark =
+        g_quark_from_static_string ("ges-object-pending-record");
+    watchers_quark = g_quark_from_static_string ("ges-timeline-watchers");
+  }
+}
+
+/* Properties */
+
+static gboolean
+is_skipped (const gchar * name, const gchar ** skipped)
+{
+  for (; skipped && *skipped; skipped++)
+    if (!strcmp (name, *skipped))
+      return TRUE;
+
+  return FALSE;
+}
+
+/* Records the readable and writable properties of @object */
+static void
+properties_init (Properties * props, GObject * object, const gchar ** skipped)
+{
+  GParamSpec **specs;
+  guint n, n_specs;
+
+  specs = g_object_class_list_properties (G_OBJECT_GET_CLASS (object),
+      &n_specs);
+  props->params = g_new0 (GParameter, n_specs);
+  props->n_params = 0;
+
+  for (n = 0; n < n_specs; n++) {
+    GParameter *param = &props->params[props->n_params];
+
+    if ((specs[n]->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE ||
+        is_skipped (specs[n]->name, skipped))
+      continue;
+
+    param->name = g_intern_string (specs[n]->name);
+    g_value_init (&param->value, specs[n]->value_type);
+    g_object_get_property (object, specs[n]->name, &param->value);
+    props->n_params++;
+  }
+
+  g_free (specs);
+}
+
+static void
+properties_clear (Properties * props)
+{
+  guint n;
+
+  for (n = 0; n < props->n_params; n++)
+    g_value_unset (&props->params[n].value);
+  g_free (props->params);
+}
+
+static gpointer
+properties_new_object (Properties * props, GType type)
+{
+  return g_object_newv (type, props->n_params, props->params);
+}
+
+/* Track objects */
+
+static void
+track_object_record_init (TrackObjectRecord * record,
+    GESTrackObject * trackobject)
+{
+  GParamSpec **children;
+  guint n, n_children;
+
+  record->track_type = ges_track_object_get_track (trackobject)->type;
+  record->type = G_OBJECT_TYPE (trackobject);
+  record->is_effect = GES_IS_TRACK_EFFECT (trackobject);
+  if (record->is_effect)
+    properties_init (&record->props, G_OBJECT (trackobject),
+        trackobject_skipped);
+  record->active = ges_track_object_is_active (trackobject);
+  record->locked = ges_track_object_is_locked (trackobject);
+
+  children = ges_track_object_list_children_properties (trackobject,
+      &n_children);
+  record->children = g_new (GParamSpec *, n_children);
+  record->values = g_new0 (GValue, n_children);
+  record->n_children = 0;
+
+  for (n = 0; n < n_children; n++) {
+    guint i = record->n_children;
+
+    if ((children[n]->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE ||
+        (children[n]->flags & G_PARAM_CONSTRUCT_ONLY)) {
+      g_param_spec_unref (children[n]);
+      continue;
+    }
+
+    record->children[i] = children[n];
+    g_value_init (&record->values[i], children[n]->value_type);
+    ges_track_object_get_child_property_by_pspec (trackobject, children[n],
+        &record->values[i]);
+    record->n_children++;
+  }
+
+  g_free (children);
+}
+
+static void
+track_object_record_clear (TrackObjectRecord * record)
+{
+  guint n;
+
+  if (record->is_effect)
+    properties_clear (&record->props);
+
+  for (n = 0; n < record->n_children; n++) {
+    g_value_unset (&record->values[n]);
+    g_param_spec_unref (record->children[n]);
+  }
+  g_free (record->values);
+  g_free (record->children);
+}
+
+static void
+track_object_record_apply (TrackObjectRecord * record,
+    GESTrackObject * trackobject)
+{
+  guint n;
+
+  ges_track_object_set_active (trackobject, record->active);
+  ges_track_object_set_locked (trackobject, record->locked);
+
+  for (n = 0; n < record->n_children; n++)
+    ges_track_object_set_child_property_by_pspec (trackobject,
+        record->children[n], &record->values[n]);
+}
+
+/* Timeline objects */
+
+static ObjectRecord *
+object_record_new (GESTimelineObject * object)
+{
+  ObjectRecord *record;
+  GList *trackobjects, *tmp;
+  guint n = 0;
+
+  record = g_slice_new0 (ObjectRecord);
+  record->refcount = 1;
+  record->type = G_OBJECT_TYPE (object);
+  properties_init (&record->props, G_OBJECT (object), NULL);
+
+  trackobjects = ges_timeline_object_get_track_objects (object);
+  record->trackobjects = g_new0 (TrackObjectRecord,
+      g_list_length (trackobjects));
+
+  for (tmp = trackobjects; tmp; tmp = tmp->next) {
+    /* There's nothing to restore it in if it isn't in a track */
+    if (ges_track_object_get_track (tmp->data))
+      track_object_record_init (&record->trackobjects[n++], tmp->data);
+    g_object_unref (tmp->data);
+  }
+  record->n_trackobjects = n;
+
+  g_list_free (trackobjects);
+
+  GES_TRACE_COUNT (1);
+
+  return record;
+}
+
+static ObjectRecord *
+object_record_ref (ObjectRecord * record)
+{
+  g_atomic_int_inc (&record->refcount);
+
+  return record;
+}
+
+static void
+object_record_unref (ObjectRecord * record)
+{
+  guint n;
+
+  if (!g_atomic_int_dec_and_test (&record->refcount))
+    return;
+
+  properties_clear (&record->props);
+  for (n = 0; n < record->n_trackobjects; n++)
+    track_object_record_clear (&record->trackobjects[n]);
+  g_free (record->trackobjects);
+
+  g_slice_free (ObjectRecord, record);
+}
+
+/* Returns the cached record of @object, or records it */
+static ObjectRecord *
+object_record_get (GESTimelineObject * object)
+{
+  ObjectRecord *record;
+
+  G_LOCK (records);
+  record = g_object_get_qdata (G_OBJECT (object), object_record_quark);
+  if (record)
+    object_record_ref (record);
+  G_UNLOCK (records);
+
+  if (record)
+    return record;
+
+  record = object_record_new (object);
+
+  G_LOCK (records);
+  g_object_set_qdata_full (G_OBJECT (object), object_record_quark,
+      object_record_ref (record), (GDestroyNotify) object_record_unref);
+  G_UNLOCK (records);
+
+  return record;
+}
+
+static void
+pending_record_free (PendingRecord * pending)
+{
+  object_record_unref (pending->record);
+  g_slice_free (PendingRecord, pending);
+}
+
+/* Creates a new object from @record. Its track objects are created when it
+ * is added to a layer, the rest of @record is applied to them then */
+static GESTimelineObject *
+object_record_create (ObjectRecord * record)
+{
+  GESTimelineObject *object;
+  PendingRecord *pending;
+  guint n;
+
+  object = properties_new_object (&record->props, record->type);
+  if (record->n_trackobjects == 0)
+    return object;
+
+  pending = g_slice_new0 (PendingRecord);
+  pending->record = object_record_ref (record);
+  for (n = 0; n < record->n_trackobjects; n++)
+    pending->pending |= record->trackobjects[n].track_type;
+
+  g_object_set_qdata_full (G_OBJECT (object), pending_record_quark, pending,
+      (GDestroyNotify) pending_record_free);
+
+  return object;
+}
+
+/* Recreates the effects and restores the state of the track objects of
+ * @object in @track */
+static void
+object_record_apply (ObjectRecord * record, GESTimelineObject * object,
+    GESTrack * track)
+{
+  guint n;
+
+  for (n = 0; n < record->n_trackobjects; n++) {
+    TrackObjectRecord *trecord = &record->trackobjects[n];
+    GESTrackObject *trackobject;
+
+    if (trecord->track_type != track->type)
+      continue;
+
+    if (trecord->is_effect) {
+      /* Added in priority order, they end up in the same order */
+      trackobject = properties_new_object (&trecord->props, trecord->type);
+      if (!ges_timeline_object_add_track_object (object, trackobject)) {
+        g_object_unref (trackobject);
+        continue;
+      }
+      if (!ges_track_add_object (track, trackobject)) {
+        ges_timeline_object_release_track_object (object, trackobject);
+        continue;
+      }
+      g_object_ref (trackobject);
+    } else if (!(trackobject = ges_timeline_object_find_track_object (object,
+                track, trecord->type)))
+      continue;
+
+    track_object_record_apply (trecord, trackobject);
+    g_object_unref (trackobject);
+  }
+}
+
+/* Layers */
+
+static LayerRecord *
+layer_record_new (GESTimelineLayer * layer)
+{
+  LayerRecord *record;
+  GList *objects, *tmp;
+  guint n = 0;
+
+  record = g_slice_new0 (LayerRecord);
+  record->refcount = 1;
+  record->type = G_OBJECT_TYPE (layer);
+  properties_init (&record->props, G_OBJECT (layer), layer_skipped);
+  record->auto_transition = ges_timeline_layer_get_auto_transition (layer);
+
+  objects = ges_timeline_layer_get_objects (layer);
+  record->objects = g_new (ObjectRecord *, g_list_length (objects));
+  for (tmp = objects; tmp; tmp = tmp->next) {
+    record->objects[n++] = object_record_get (tmp->data);
+    g_object_unref (tmp->data);
+  }
+  record->n_objects = n;
+
+  g_list_free (objects);
+
+  return record;
+}
+
+static LayerRecord *
+layer_record_ref (LayerRecord * record)
+{
+  g_atomic_int_inc (&record->refcount);
+
+  return record;
+}
+
+static void
+layer_record_unref (LayerRecord * record)
+{
+  guint n;
+
+  if (!g_atomic_int_dec_and_test (&record->refcount))
+    return;
+
+  properties_clear (&record->props);
+  for (n = 0; n < record->n_objects; n++)
+    object_record_unref (record->objects[n]);
+  g_free (record->objects);
+
+  g_slice_free (LayerRecord, record);
+}
+
+static LayerRecord *
+layer_record_get (GESTimelineLayer * layer)
+{
+  LayerRecord *record;
+
+  G_LOCK (records);
+  record = g_object_get_qdata (G_OBJECT (layer), layer_record_quark);
+  if (record)
+    layer_record_ref (record);
+  G_UNLOCK (records);
+
+  if (record)
+    return record;
+
+  record = layer_record_new (layer);
+
+  G_LOCK (records);
+  g_object_set_qdata_full (G_OBJECT (layer), layer_record_quark,
+      layer_record_ref (record), (GDestroyNotify) layer_record_unref);
+  G_UNLOCK (records);
+
+  return record;
+}
+
+static gboolean
+layer_record_restore (LayerRecord * record, GESTimeline * timeline)
+{
+  GESTimelineLayer *layer;
+  guint n;
+
+  layer = properties_new_object (&record->props, record->type);
+  if (!ges_timeline_add_layer (timeline, layer)) {
+    g_object_unref (layer);
+    return FALSE;
+  }
+
+  for (n = 0; n < record->n_objects; n++) {
+    GESTimelineObject *object = object_record_create (record->objects[n]);
+
+    if (!ges_timeline_layer_add_object (layer, object)) {
+      GST_WARNING ("Couldn't restore an object of type %s",
+          g_type_name (record->objects[n]->type));
+      g_object_unref (object);
+    }
+  }
+
+  /* Only now, the transitions were restored with the other objects */
+  ges_timeline_layer_set_auto_transition (layer, record->auto_transition);
+
+  return TRUE;
+}
+
+static gboolean
+restore_layers (GESTimelineSnapshot * snapshot, GESTimeline * timeline)
+{
+  gboolean ret = TRUE;
+  guint n;
+
+  ges_timeline_begin_batch (timeline);
+  for (n = 0; n < snapshot->n_layers; n++)
+    if (!layer_record_restore (snapshot->layers[n], timeline)) {
+      GST_WARNING ("Couldn't restore layer %u", n);
+      ret = FALSE;
+    }
+  ges_timeline_end_batch (timeline);
+
+  return ret;
+}
+
+/* Copies */
+
+/* ges_timeline_snapshot_copy_object:
+ * @object: a #GESTimelineObject
+ *
+ * Creates a deep copy of @object from its record, which is shared with the
+ * snapshots and the other copies taken while @object doesn't change.
+ *
+ * Returns: (transfer floating): the copy
+ */
+GESTimelineObject *
+ges_timeline_snapshot_copy_object (GESTimelineObject * object)
+{
+  GESTimelineObject *copy;
+  ObjectRecord *record;
+
+  ensure_quarks ();
+
+  record = object_record_get (object);
+  copy = object_record_create (record);
+  object_record_unref (record);
+
+  return copy;
+}
+
+/* ges_timeline_snapshot_apply_pending:
+ * @object: a #GESTimelineObject
+ * @track: a #GESTrack in which @object just created its track objects
+ *
+ * If @object was created from a record, recreates the effects and restores
+ * the state of its track objects in @track.
+ */
+void
+ges_timeline_snapshot_apply_pending (GESTimelineObject * object,
+    GESTrack * track)
+{
+  PendingRecord *pending;
+
+  if (!pending_record_quark)
+    return;
+
+  pending = g_object_get_qdata (G_OBJECT (object), pending_record_quark);
+  if (pending == NULL || !(pending->pending & track->type))
+    return;
+
+  GST_DEBUG_OBJECT (track, "Applying the record of %p", object);
+
+  pending->pending &= ~track->type;
+  object_record_apply (pending->record, object, track);
+
+  if (pending->pending == 0)
+    g_object_set_qdata (G_OBJECT (object), pending_record_quark, NULL);
+}
+
+/* Changes */
+
+/* ges_timeline_snapshot_object_changed:
+ * @object: a #GESTimelineObject
+ *
+ * Drops the records of @object and of its layer, the next snapshot records
+ * them again.
+ */
+void
+ges_timeline_snapshot_object_changed (GESTimelineObject * object)
+{
+  GESTimelineLayer *layer;
+
+  if (!object_record_quark)
+    return;
+
+  G_LOCK (records);
+  g_object_set_qdata (G_OBJECT (object), object_record_quark, NULL);
+  G_UNLOCK (records);
+
+  if ((layer = ges_timeline_object_get_layer (object))) {
+    ges_timeline_snapshot_layer_changed (layer);
+    g_object_unref (layer);
+  }
+}
+
+/* ges_timeline_snapshot_layer_changed:
+ * @layer: a #GESTimelineLayer
+ *
+ * Drops the record of @layer, the next snapshot records it again. The
+ * records of its objects are kept.
+ */
+void
+ges_timeline_snapshot_layer_changed (GESTimelineLayer * layer)
+{
+  if (!layer_record_quark)
+    return;
+
+  G_LOCK (records);
+  g_object_set_qdata (G_OBJECT (layer), layer_record_quark, NULL);
+  G_UNLOCK (records);
+
+  if (layer->timeline)
+    ges_timeline_snapshot_timeline_changed (layer->timeline);
+}
+
+/* ges_timeline_snapshot_timeline_changed:
+ * @timeline: a #GESTimeline
+ *
+ * Calls the functions watching @timeline, the next snapshot of it will be
+ * different.
+ */
+void
+ges_timeline_snapshot_timeline_changed (GESTimeline * timeline)
+{
+  GHookList *watchers;
+
+  if (!watchers_quark)
+    return;
+
+  watchers = g_object_get_qdata (G_OBJECT (timeline), watchers_quark);
+  if (watchers)
+    g_hook_list_invoke (watchers, FALSE);
+}
+
+/* Nesting */
+
+static void
+watchers_free (GHookList * watchers)
+{
+  g_hook_list_clear (watchers);
+  g_slice_free (GHookList, watchers);
+}
+
+/* ges_timeline_snapshot_watch:
+ * @timeline: a #GESTimeline
+ * @func: the function to call when @timeline changes
+ * @data: the data to pass to @func
+ * @destroy: the function to free @data with, or %NULL
+ *
+ * Has @func called on every change of @timeline which shows in its
+ * snapshots, from the thread the change is made in.
+ *
+ * Returns: the id to pass to ges_timeline_snapshot_unwatch()
+ */
+gulong
+ges_timeline_snapshot_watch (GESTimeline * timeline, GHookFunc func,
+    gpointer data, GDestroyNotify destroy)
+{
+  GHookList *watchers;
+  GHook *hook;
+
+  ensure_quarks ();
+
+  watchers = g_object_get_qdata (G_OBJECT (timeline), watchers_quark);
+  if (watchers == NULL) {
+    watchers = g_slice_new0 (GHookList);
+    g_hook_list_init (watchers, sizeof (GHook));
+    g_object_set_qdata_full (G_OBJECT (timeline), watchers_quark, watchers,
+        (GDestroyNotify) watchers_free);
+  }
+
+  hook = g_hook_alloc (watchers);
+  hook->func = func;
+  hook->data = data;
+  hook->destroy = destroy;
+  g_hook_append (watchers, hook);
+
+  return hook->hook_id;
+}
+
+/* ges_timeline_snapshot_unwatch:
+ * @timeline: a #GESTimeline
+ * @id: the id ges_timeline_snapshot_watch() returned
+ */
+void
+ges_timeline_snapshot_unwatch (GESTimeline * timeline, gulong id)
+{
+  GHookList *watchers;
+
+  if (!watchers_quark)
+    return;
+
+  watchers = g_object_get_qdata (G_OBJECT (timeline), watchers_quark);
+  if (watchers)
+    g_hook_destroy (watchers, id);
+}
+
+/* ges_timeline_snapshot_equal:
+ * @snapshot: a #GESTimelineSnapshot
+ * @other: another #GESTimelineSnapshot
+ *
+ * Returns: %TRUE if @snapshot and @other were taken of the same state, which
+ * only costs comparing the records they share.
+ */
+gboolean
+ges_timeline_snapshot_equal (GESTimelineSnapshot * snapshot,
+    GESTimelineSnapshot * other)
+{
+  guint n;
+
+  if (snapshot == other)
+    return TRUE;
+
+  if (snapshot->n_tracks != other->n_tracks ||
+      snapshot->n_layers != other->n_layers)
+    return FALSE;
+
+  for (n = 0; n < snapshot->n_tracks; n++)
+    if (snapshot->track_types[n] != other->track_types[n] ||
+        !gst_caps_is_equal (snapshot->track_caps[n], other->track_caps[n]))
+      return FALSE;
+
+  for (n = 0; n < snapshot->n_layers; n++)
+    if (snapshot->layers[n] != other->layers[n])
+      return FALSE;
+
+  return TRUE;
+}
+
+/* ges_timeline_snapshot_get_track_types:
+ * @snapshot: a #GESTimelineSnapshot
+ *
+ * Returns: the types of the tracks of @snapshot
+ */
+GESTrackType
+ges_timeline_snapshot_get_track_types (GESTimelineSnapshot * snapshot)
+{
+  GESTrackType types = 0;
+  guint n;
+
+  for (n = 0; n < snapshot->n_tracks; n++)
+    types |= snapshot->track_types[n];
+
+  return types;
+}
+
+/* ges_timeline_snapshot_create_timeline_for_types:
+ * @snapshot: a #GESTimelineSnapshot
+ * @types: the types of the tracks to create
+ *
+ * Like ges_timeline_snapshot_create_timeline(), but the new timeline only
+ * has the tracks of @snapshot of one of @types.
+ */
+GESTimeline *
+ges_timeline_snapshot_create_timeline_for_types (GESTimelineSnapshot *
+    snapshot, GESTrackType types)
+{
+  GESTimeline *timeline;
+  guint n;
+
+  timeline = ges_timeline_new ();
+
+  for (n = 0; n < snapshot->n_tracks; n++) {
+    GESTrack *track;
+
+    if (!(snapshot->track_types[n] & types))
+      continue;
+
+    track = ges_track_new (snapshot->track_types[n],
+        gst_caps_copy (snapshot->track_caps[n]));
+    if (!ges_timeline_add_track (timeline, track)) {
+      g_object_unref (track);
+      goto fail;
+    }
+  }
+
+  if (!restore_layers (snapshot, timeline))
+    goto fail;
+
+  return timeline;
+
+fail:
+  {
+    GST_ERROR ("Couldn't create a timeline from snapshot %p", snapshot);
+    g_object_unref (timeline);
+    return NULL;
+  }
+}
+
+/* API */
+
+/**
+ * ges_timeline_snapshot_new:
+ * @timeline: a #GESTimeline
+ *
+ * Takes a snapshot of the current state of @timeline. Only the layers and
+ * objects which changed since the previous snapshot are recorded, the
+ * other ones are shared with it.
+ *
+ * Returns: (transfer full): a new #GESTimelineSnapshot, free with
+ * ges_timeline_snapshot_unref().
+ *
+ * Since: 0.10.2
+ */
+GESTimelineSnapshot *
+ges_timeline_snapshot_new (GESTimeline * timeline)
+{
+  GESTimelineSnapshot *snapshot;
+  GList *tracks, *layers, *tmp;
+  guint n;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), NULL);
+
+  ensure_quarks ();
+
+  GES_TRACE_BEGIN ("timeline-snapshot");
+
+  snapshot = g_slice_new0 (GESTimelineSnapshot);
+  snapshot->refcount = 1;
+
+  tracks = ges_timeline_get_tracks (timeline);
+  snapshot->n_tracks = g_list_length (tracks);
+  snapshot->track_types = g_new (GESTrackType, snapshot->n_tracks);
+  snapshot->track_caps = g_new (GstCaps *, snapshot->n_tracks);
+  for (n = 0, tmp = tracks; tmp; n++, tmp = tmp->next) {
+    GESTrack *track = (GESTrack *) tmp->data;
+
+    snapshot->track_types[n] = track->type;
+    snapshot->track_caps[n] = gst_caps_copy (ges_track_get_caps (track));
+    g_object_unref (track);
+  }
+  g_list_free (tracks);
+
+  layers = ges_timeline_get_layers (timeline);
+  snapshot->n_layers = g_list_length (layers);
+  snapshot->layers = g_new (LayerRecord *, snapshot->n_layers);
+  for (n = 0, tmp = layers; tmp; n++, tmp = tmp->next) {
+    snapshot->layers[n] = layer_record_get (tmp->data);
+    g_object_unref (tmp->data);
+  }
+  g_list_free (layers);
+
+  GES_TRACE_END ();
+
+  return snapshot;
+}
+
+/**
+ * ges_timeline_snapshot_ref:
+ * @snapshot: a #GESTimelineSnapshot
+ *
+ * Increases the reference count of @snapshot.
+ *
+ * Returns: (transfer full): @snapshot
+ *
+ * Since: 0.10.2
+ */
+GESTimelineSnapshot *
+ges_timeline_snapshot_ref (GESTimelineSnapshot * snapshot)
+{
+  g_return_val_if_fail (snapshot != NULL, NULL);
+
+  g_atomic_int_inc (&snapshot->refcount);
+
+  return snapshot;
+}
+
+/**
+ * ges_timeline_snapshot_unref:
+ * @snapshot: a #GESTimelineSnapshot
+ *
+ * Decreases the reference count of @snapshot, and frees it when it reaches
+ * zero.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_timeline_snapshot_unref (GESTimelineSnapshot * snapshot)
+{
+  guint n;
+
+  g_return_if_fail (snapshot != NULL);
+
+  if (!g_atomic_int_dec_and_test (&snapshot->refcount))
+    return;
+
+  for (n = 0; n < snapshot->n_tracks; n++)
+    gst_caps_unref (snapshot->track_caps[n]);
+  g_free (snapshot->track_caps);
+  g_free (snapshot->track_types);
+
+  for (n = 0; n < snapshot->n_layers; n++)
+    layer_record_unref (snapshot->layers[n]);
+  g_free (snapshot->layers);
+
+  g_slice_free (GESTimelineSnapshot, snapshot);
+}
+
+/**
+ * ges_timeline_snapshot_create_timeline:
+ * @snapshot: a #GESTimelineSnapshot
+ *
+ * Creates a new #GESTimeline with the tracks, layers and objects of
+ * @snapshot. It doesn't share anything with the timeline the snapshot was
+ * taken of.
+ *
+ * Returns: (transfer full): a new #GESTimeline, or %NULL if a track or a
+ * layer couldn't be added to it.
+ *
+ * Since: 0.10.2
+ */
+GESTimeline *
+ges_timeline_snapshot_create_timeline (GESTimelineSnapshot * snapshot)
+{
+  g_return_val_if_fail (snapshot != NULL, NULL);
+
+  return ges_timeline_snapshot_create_timeline_for_types (snapshot,
+      ges_timeline_snapshot_get_track_types (snapshot));
+}
+
+/**
+ * ges_timeline_snapshot_restore:
+ * @snapshot: a #GESTimelineSnapshot
+ * @timeline: a #GESTimeline
+ *
+ * Replaces the layers of @timeline by the ones of @snapshot, in a single
+ * batch (see ges_timeline_begin_batch()). The tracks of @timeline are
+ * kept, the objects of @snapshot are only restored in the tracks of
+ * @timeline of the same #GESTrackType.
+ *
+ * Returns: %TRUE if all the layers could be restored, else %FALSE.
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_timeline_snapshot_restore (GESTimelineSnapshot * snapshot,
+    GESTimeline * timeline)
+{
+  GList *layers, *tmp;
+  gboolean ret;
+
+  g_return_val_if_fail (snapshot != NULL, FALSE);
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), FALSE);
+
+  ges_timeline_begin_batch (timeline);
+
+  layers = ges_timeline_get_layers (timeline);
+  for (tmp = layers; tmp; tmp = tmp->next) {
+    ges_timeline_remove_layer (timeline, tmp->data);
+    g_object_unref (tmp->data);
+  }
+  g_list_free (layers);
+
+  ret = restore_layers (snapshot, timeline);
+
+  ges_timeline_end_batch (timeline);
+
+  return ret;
+}
@@ -0,0 +1,42 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _GES_TIMELINE_SNAPSHOT
+#define _GES_TIMELINE_SNAPSHOT
+
+#include <glib-object.h>
+#include <ges/ges-types.h>
+
+G_BEGIN_DECLS
+
+#define GES_TYPE_TIMELINE_SNAPSHOT ges_timeline_snapshot_get_type()
+
+GType ges_timeline_snapshot_get_type (void);
+
+GESTimelineSnapshot *ges_timeline_snapshot_new     (GESTimeline * timeline);
+
+GESTimelineSnapshot *ges_timeline_snapshot_ref     (GESTimelineSnapshot * snapshot);
+void                 ges_timeline_snapshot_unref   (GESTimelineSnapshot * snapshot);
+
+GESTimeline *ges_timeline_snapshot_create_timeline (GESTimelineSnapshot * snapshot);
+gboolean     ges_timeline_snapshot_restore         (GESTimelineSnapshot * snapshot,
+                                                    GESTimeline * timeline);
+
+G_END_DECLS
+
+#endif /* _GES_TIMELINE_SNAPSHOT */
@@ -37,6 +37,8 @@
  */
 
 #include "gesmarshal.h"
+#include <string.h>
+
 #include "ges-internal.h"
 #include "ges-timeline.h"
 #include "ges-track.h"
@@ -62,6 +64,19 @@ struct _GESTimelinePrivate
   GList *pendingobjects;
   /* Whether we are changing state asynchronously or not */
   gboolean async_pending;
+
+  /* Number of soloed layers and tracks */
+  guint nb_solo_layers;
+  guint nb_solo_tracks;
+
+  /* Whether the track objects gather processing statistics */
+  gboolean stats_enabled;
+
+  /* Nesting depth of ges_timeline_begin_batch() */
+  guint batch_depth;
+  /* Objects whose notifications are held until the batch ends */
+  GHashTable *held;
+  GList *held_objects;
 };
 
 /* private structure to contain our track-related information */
@@ -135,11 +150,31 @@ ges_timeline_set_property (GObject * object, guint property_id,
   }
 }
 
+/* Lets the held notifications out */
+static void
+ges_timeline_release_notify (GESTimeline * timeline)
+{
+  GESTimelinePrivate *priv = timeline->priv;
+  GList *tmp, *held;
+
+  held = g_list_reverse (priv->held_objects);
+  priv->held_objects = NULL;
+  g_hash_table_remove_all (priv->held);
+
+  for (tmp = held; tmp; tmp = tmp->next) {
+    g_object_thaw_notify (tmp->data);
+    g_object_unref (tmp->data);
+  }
+  g_list_free (held);
+}
+
 static void
 ges_timeline_dispose (GObject * object)
 {
   GESTimelinePrivate *priv = GES_TIMELINE (object)->priv;
 
+  ges_timeline_release_notify (GES_TIMELINE (object));
+
   if (priv->discoverer) {
     gst_discoverer_stop (priv->discoverer);
     g_object_unref (priv->discoverer);
@@ -167,6 +202,8 @@ ges_timeline_dispose (GObject * object)
 static void
 ges_timeline_finalize (GObject * object)
 {
+  g_hash_table_destroy (GES_TIMELINE (object)->priv->held);
+
   G_OBJECT_CLASS (ges_timeline_parent_class)->finalize (object);
 }
 
@@ -261,6 +298,7 @@ ges_timeline_init (GESTimeline * self)
   self->priv->layers = NULL;
   self->priv->tracks = NULL;
   self->priv->duration = 0;
+  self->priv->held = g_hash_table_new (g_direct_hash, g_direct_equal);
 
   /* New discoverer with a 15s timeout */
   self->priv->discoverer = gst_discoverer_new (15 * GST_SECOND, NULL);
@@ -291,6 +329,203 @@ sort_layers (gpointer a, gpointer b)
   return 0;
 }
 
+/*
+ * LAYER PRIORITY ALLOCATION
+ *
+ * The layers own consecutive bands of gnl priorities, in the order of
+ * their priorities. A band starts at min_gnl_priority and ends right
+ * before the next one, the bands are handed out with gaps so that moving
+ * or growing a layer usually fits in the free space around it, and only
+ * renumbers the objects of that layer.
+ *
+ * When there isn't enough room, the bands of an aligned window of
+ * layers around the one that needs room are spread evenly. The window
+ * doubles until the layers in it use at most half of its priorities,
+ * which keeps the number of layers renumbered logarithmic (amortized) in
+ * the number of layers.
+ */
+
+/* One past the last gnl priority */
+#define PRIORITY_END ((guint64) G_MAXUINT32 + 1)
+
+static inline guint64
+layer_band_end (GESTimelineLayer * layer)
+{
+  return (guint64) layer->min_gnl_priority +
+      ges_timeline_layer_get_height (layer);
+}
+
+/* Sets the end of every band right before the start of the next one */
+static void
+update_layer_ranges (GESTimeline * timeline)
+{
+  GList *tmp;
+  GESTimelineLayer *layer;
+
+  for (tmp = timeline->priv->layers; tmp; tmp = tmp->next) {
+    layer = (GESTimelineLayer *) tmp->data;
+    layer->max_gnl_priority = tmp->next ?
+        ((GESTimelineLayer *) tmp->next->data)->min_gnl_priority - 1 :
+        G_MAXUINT32;
+  }
+}
+
+/* Spreads the bands of the layers around @link, returns FALSE if even
+ * spreading all of them doesn't make enough room */
+static gboolean
+relabel_layers (GESTimeline * timeline, GList * link)
+{
+  GList *layers = timeline->priv->layers, *first, *tmp;
+  guint n = g_list_length (layers), pos = g_list_position (layers, link);
+  guint start, count, width, i;
+  guint64 lo, hi, used, gap, label;
+  GESTimelineLayer *layer;
+  guint32 *labels;
+
+  for (width = 2;; width *= 2) {
+    start = (pos / width) * width;
+    count = MIN (start + width, n) - start;
+    first = g_list_nth (layers, start);
+
+    lo = first->prev ? layer_band_end (first->prev->data) : 0;
+    hi = start + count < n ?
+        ((GESTimelineLayer *) g_list_nth_data (layers, start + count))->
+        min_gnl_priority : PRIORITY_END;
+
+    used = 0;
+    for (tmp = first, i = 0; i < count; tmp = tmp->next, i++)
+      used += ges_timeline_layer_get_height (tmp->data);
+
+    /* Don't spread the last layers to the end of the priorities, keep
+     * that room for new ones */
+    if (start + count == n)
+      hi = MIN (hi, lo + 2 * used + count * LAYER_HEIGHT);
+
+    if (lo + 2 * used <= hi)
+      break;
+
+    if (count == n) {
+      if (lo + used <= hi)
+        break;
+
+      GST_ERROR ("The layers of %p need more than %" G_GUINT64_FORMAT
+          " priorities", timeline, hi - lo);
+      return FALSE;
+    }
+  }
+
+  GST_DEBUG ("Spreading %u layers over [%" G_GUINT64_FORMAT ", %"
+      G_GUINT64_FORMAT "[", count, lo, hi);
+  GES_TRACE_COUNT (count);
+
+  /* Set all the bands first, so that resyncing a layer doesn't find its
+   * neighbours overlapping it */
+  labels = g_new (guint32, count);
+  gap = (hi - lo - used) / count;
+  label = lo + gap / 2;
+  for (tmp = first, i = 0; i < count; tmp = tmp->next, i++) {
+    layer = (GESTimelineLayer *) tmp->data;
+    labels[i] = layer->min_gnl_priority;
+    layer->min_gnl_priority = (guint32) label;
+    label += ges_timeline_layer_get_height (layer) + gap;
+  }
+  update_layer_ranges (timeline);
+
+  for (tmp = first, i = 0; i < count; tmp = tmp->next, i++) {
+    layer = (GESTimelineLayer *) tmp->data;
+    if (labels[i] != layer->min_gnl_priority) {
+      guint32 min = layer->min_gnl_priority;
+
+      layer->min_gnl_priority = labels[i];
+      ges_timeline_layer_set_gnl_range (layer, min, layer->max_gnl_priority);
+    }
+  }
+  g_free (labels);
+
+  return TRUE;
+}
+
+/* Finds a band for the layer of @link between its neighbours, keeping
+ * the one it has if it still fits */
+static void
+allocate_layer (GESTimeline * timeline, GList * link)
+{
+  GESTimelineLayer *layer = (GESTimelineLayer *) link->data;
+  guint64 lo, hi, height, label;
+
+  lo = link->prev ? layer_band_end (link->prev->data) : 0;
+  hi = link->next ?
+      ((GESTimelineLayer *) link->next->data)->min_gnl_priority : PRIORITY_END;
+  height = ges_timeline_layer_get_height (layer);
+
+  /* Where it would be if all layers were LAYER_HEIGHT high */
+  label = (guint64) ges_timeline_layer_get_priority (layer) * LAYER_HEIGHT;
+
+  if (layer->min_gnl_priority >= lo &&
+      layer->min_gnl_priority + height <= hi) {
+    label = layer->min_gnl_priority;
+  } else if (label < lo || label + height > hi) {
+    if (hi - lo < height) {
+      relabel_layers (timeline, link);
+      return;
+    }
+
+    /* Stay close to the previous layer at the end, else take the middle of
+     * the free space */
+    if (link->next)
+      label = lo + (hi - lo - height) / 2;
+    else
+      label = lo;
+  }
+
+  ges_timeline_layer_set_gnl_range (layer, (guint32) label,
+      link->next ? (guint32) (hi - 1) : G_MAXUINT32);
+  update_layer_ranges (timeline);
+}
+
+/* ges_timeline_place_layer:
+ * @timeline: a #GESTimeline
+ * @layer: a #GESTimelineLayer of @timeline, or about to be added to it
+ *
+ * Puts @layer at its place in the layers of @timeline, after the ones
+ * with a lower or the same priority, and gives it a priority band there.
+ */
+void
+ges_timeline_place_layer (GESTimeline * timeline, GESTimelineLayer * layer)
+{
+  GESTimelinePrivate *priv = timeline->priv;
+  guint priority = ges_timeline_layer_get_priority (layer);
+  GList *tmp;
+  guint pos = 0;
+
+  priv->layers = g_list_remove (priv->layers, layer);
+  for (tmp = priv->layers; tmp; tmp = tmp->next, pos++)
+    if (ges_timeline_layer_get_priority (tmp->data) > priority)
+      break;
+  priv->layers = g_list_insert (priv->layers, layer, pos);
+
+  allocate_layer (timeline, g_list_nth (priv->layers, pos));
+}
+
+/* ges_timeline_grow_layer:
+ * @timeline: a #GESTimeline
+ * @layer: a #GESTimelineLayer of @timeline
+ *
+ * Called when @layer doesn't fit in its priority band anymore.
+ */
+void
+ges_timeline_grow_layer (GESTimeline * timeline, GESTimelineLayer * layer)
+{
+  GList *link = g_list_find (timeline->priv->layers, layer);
+
+  if (G_UNLIKELY (link == NULL))
+    return;
+
+  GES_TRACE_BEGIN ("timeline-grow-layer");
+  allocate_layer (timeline, link);
+  GES_TRACE_END ();
+}
+
 /**
  * ges_timeline_new:
  *
@@ -433,13 +668,18 @@ add_object_to_tracks (GESTimeline * timeline, GESTimelineObject * object)
 {
   GList *tmp;
 
+  GES_TRACE_BEGIN ("timeline-add-object-to-tracks");
+
   for (tmp = timeline->priv->tracks; tmp; tmp = g_list_next (tmp)) {
     TrackPrivate *tr_priv = (TrackPrivate *) tmp->data;
     GESTrack *track = tr_priv->track;
 
     GST_LOG ("Trying with track %p", track);
     add_object_to_track (object, track);
+    GES_TRACE_COUNT (1);
   }
+
+  GES_TRACE_END ();
 }
 
 
@@ -617,8 +857,21 @@ layer_object_added_cb (GESTimelineLayer * layer, GESTimelineObject * object,
     GESTimeline * timeline)
 {
   if (ges_timeline_object_is_moving_from_layer (object)) {
-    GST_DEBUG ("TimelineObject %p is moving from a layer to another, not doing"
-        " anything on it", object);
+    GList *trackobjects, *tmp;
+
+    GST_DEBUG ("TimelineObject %p is moving from a layer to another, only "
+        "checking whether it's still audible", object);
+
+    /* The new layer might be muted when the old one wasn't, or the reverse */
+    trackobjects = ges_timeline_object_get_track_objects (object);
+    for (tmp = trackobjects; tmp; tmp = tmp->next) {
+      GESTrack *track = ges_track_object_get_track (tmp->data);
+
+      if (track)
+        ges_track_resync_muted_object (track, tmp->data);
+      g_object_unref (tmp->data);
+    }
+    g_list_free (trackobjects);
     return;
   }
 
@@ -653,11 +906,57 @@ layer_object_added_cb (GESTimelineLayer * layer, GESTimelineObject * object,
 }
 
 static void
-layer_priority_changed_cb (GESTimelineLayer * layer,
+resync_muted_objects (GESTimeline * timeline)
+{
+  GList *tmp;
+
+  for (tmp = timeline->priv->tracks; tmp; tmp = tmp->next)
+    ges_track_resync_muted_objects (((TrackPrivate *) tmp->data)->track);
+}
+
+static void
+layer_muted_changed_cb (GESTimelineLayer * layer,
     GParamSpec * arg G_GNUC_UNUSED, GESTimeline * timeline)
 {
-  timeline->priv->layers = g_list_sort (timeline->priv->layers, (GCompareFunc)
-      sort_layers);
+  resync_muted_objects (timeline);
+}
+
+static void
+layer_solo_changed_cb (GESTimelineLayer * layer,
+    GParamSpec * arg G_GNUC_UNUSED, GESTimeline * timeline)
+{
+  if (ges_timeline_layer_get_solo (layer))
+    timeline->priv->nb_solo_layers++;
+  else
+    timeline->priv->nb_solo_layers--;
+
+  resync_muted_objects (timeline);
+}
+
+/* Whether at least one layer of @timeline is soloed */
+gboolean
+ges_timeline_has_solo_layer (GESTimeline * timeline)
+{
+  return timeline->priv->nb_solo_layers > 0;
+}
+
+static void
+track_solo_changed_cb (GESTrack * track, GParamSpec * arg G_GNUC_UNUSED,
+    GESTimeline * timeline)
+{
+  if (ges_track_get_solo (track))
+    timeline->priv->nb_solo_tracks++;
+  else
+    timeline->priv->nb_solo_tracks--;
+
+  resync_muted_objects (timeline);
+}
+
+/* Whether at least one track of @timeline is soloed */
+gboolean
+ges_timeline_has_solo_track (GESTimeline * timeline)
+{
+  return timeline->priv->nb_solo_tracks > 0;
 }
 
 static void
@@ -755,8 +1054,7 @@ ges_timeline_add_layer (GESTimeline * timeline, GESTimelineLayer * layer)
   }
 
   g_object_ref_sink (layer);
-  priv->layers = g_list_insert_sorted (priv->layers, layer,
-      (GCompareFunc) sort_layers);
+  ges_timeline_place_layer (timeline, layer);
 
   /* Inform the layer that it belongs to a new timeline */
   ges_timeline_layer_set_timeline (layer, timeline);
@@ -766,8 +1064,16 @@ ges_timeline_add_layer (GESTimeline * timeline, GESTimelineLayer * layer)
       timeline);
   g_signal_connect (layer, "object-removed",
       G_CALLBACK (layer_object_removed_cb), timeline);
-  g_signal_connect (layer, "notify::priority",
-      G_CALLBACK (layer_priority_changed_cb), timeline);
+  g_signal_connect (layer, "notify::muted",
+      G_CALLBACK (layer_muted_changed_cb), timeline);
+  g_signal_connect (layer, "notify::solo",
+      G_CALLBACK (layer_solo_changed_cb), timeline);
+
+  /* A soloed layer silences the ones already there */
+  if (ges_timeline_layer_get_solo (layer)) {
+    priv->nb_solo_layers++;
+    resync_muted_objects (timeline);
+  }
 
   GST_DEBUG ("Done adding layer, emitting 'layer-added' signal");
   g_signal_emit (timeline, ges_timeline_signals[LAYER_ADDED], 0, layer);
@@ -781,6 +1087,8 @@ ges_timeline_add_layer (GESTimeline * timeline, GESTimelineLayer * layer)
   }
   g_list_free (objects);
 
+  ges_timeline_snapshot_timeline_changed (timeline);
+
   return TRUE;
 }
 
@@ -824,8 +1132,18 @@ ges_timeline_remove_layer (GESTimeline * timeline, GESTimelineLayer * layer)
   g_signal_handlers_disconnect_by_func (layer, layer_object_added_cb, timeline);
   g_signal_handlers_disconnect_by_func (layer, layer_object_removed_cb,
       timeline);
+  g_signal_handlers_disconnect_by_func (layer, layer_muted_changed_cb,
+      timeline);
+  g_signal_handlers_disconnect_by_func (layer, layer_solo_changed_cb,
+      timeline);
 
   priv->layers = g_list_remove (priv->layers, layer);
+  update_layer_ranges (timeline);
+
+  if (ges_timeline_layer_get_solo (layer)) {
+    priv->nb_solo_layers--;
+    resync_muted_objects (timeline);
+  }
 
   ges_timeline_layer_set_timeline (layer, NULL);
 
@@ -833,6 +1151,8 @@ ges_timeline_remove_layer (GESTimeline * timeline, GESTimelineLayer * layer)
 
   g_object_unref (layer);
 
+  ges_timeline_snapshot_timeline_changed (timeline);
+
   return TRUE;
 }
 
@@ -939,10 +1259,17 @@ ges_timeline_add_track (GESTimeline * timeline, GESTrack * track)
   /* Listen to pad-added/-removed */
   g_signal_connect (track, "pad-added", (GCallback) pad_added_cb, tr_priv);
   g_signal_connect (track, "pad-removed", (GCallback) pad_removed_cb, tr_priv);
+  g_signal_connect (track, "notify::solo", G_CALLBACK (track_solo_changed_cb),
+      timeline);
 
   /* Inform the track that it's currently being used by ourself */
   ges_track_set_timeline (track, timeline);
 
+  if (priv->batch_depth) {
+    ges_track_enable_update (track, FALSE);
+    ges_track_set_batch (track, TRUE);
+  }
+
   GST_DEBUG ("Done adding track, emitting 'track-added' signal");
 
   /* emit 'track-added' */
@@ -969,6 +1296,15 @@ ges_timeline_add_track (GESTimeline * timeline, GESTrack * track)
       G_CALLBACK (track_duration_cb), timeline);
   track_duration_cb (GST_ELEMENT (track), NULL, timeline);
 
+  /* A soloed track silences the ones already there, or is silenced */
+  if (ges_track_get_solo (track)) {
+    priv->nb_solo_tracks++;
+    resync_muted_objects (timeline);
+  } else if (priv->nb_solo_tracks)
+    ges_track_resync_muted_objects (track);
+
+  ges_timeline_snapshot_timeline_changed (timeline);
+
   return TRUE;
 }
 
@@ -1010,6 +1346,11 @@ ges_timeline_remove_track (GESTimeline * timeline, GESTrack * track)
 
   ges_track_set_timeline (track, NULL);
 
+  if (priv->batch_depth) {
+    ges_track_set_batch (track, FALSE);
+    ges_track_enable_update (track, TRUE);
+  }
+
   /* Remove ghost pad */
   if (tr_priv->ghostpad) {
     GST_DEBUG ("Removing ghostpad");
@@ -1023,6 +1364,16 @@ ges_timeline_remove_track (GESTimeline * timeline, GESTrack * track)
   g_signal_handlers_disconnect_by_func (track, pad_removed_cb, tr_priv);
   g_signal_handlers_disconnect_by_func (track, track_duration_cb,
       tr_priv->track);
+  g_signal_handlers_disconnect_by_func (track, track_solo_changed_cb,
+      timeline);
+
+  /* Out of the timeline, only its own mute applies to the track */
+  if (ges_track_get_solo (track)) {
+    priv->nb_solo_tracks--;
+    resync_muted_objects (timeline);
+  }
+  if (priv->nb_solo_tracks || ges_track_get_solo (track))
+    ges_track_resync_muted_objects (track);
 
   /* Signal track removal to all layers/objects */
   g_signal_emit (timeline, ges_timeline_signals[TRACK_REMOVED], 0, track);
@@ -1043,6 +1394,8 @@ ges_timeline_remove_track (GESTimeline * timeline, GESTrack * track)
 
   g_free (tr_priv);
 
+  ges_timeline_snapshot_timeline_changed (timeline);
+
   return TRUE;
 }
 
@@ -1139,6 +1492,7 @@ ges_timeline_enable_update (GESTimeline * timeline, gboolean enabled)
     if (!ges_track_enable_update (tmp->data, enabled)) {
       res = FALSE;
     }
+    g_object_unref (tmp->data);
   }
 
   g_list_free (tracks);
@@ -1146,6 +1500,201 @@ ges_timeline_enable_update (GESTimeline * timeline, gboolean enabled)
   return res;
 }
 
+/**
+ * ges_timeline_begin_batch:
+ * @timeline: a #GESTimeline
+ *
+ * Starts a batch of edits on @timeline. Until the matching
+ * ges_timeline_end_batch(), the compositions of the tracks aren't updated
+ * and the tracks don't keep their objects sorted after each change, so a
+ * large number of edits only pays for those once. Property notifications
+ * of the changed track objects are also held back and emitted once per
+ * property when the batch ends.
+ *
+ * Batches can be nested, the edits are applied when the outermost batch
+ * ends.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_timeline_begin_batch (GESTimeline * timeline)
+{
+  GList *tmp;
+
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+
+  if (timeline->priv->batch_depth++)
+    return;
+
+  GST_DEBUG_OBJECT (timeline, "Starting a batch");
+
+  ges_timeline_enable_update (timeline, FALSE);
+  for (tmp = timeline->priv->tracks; tmp; tmp = tmp->next)
+    ges_track_set_batch (((TrackPrivate *) tmp->data)->track, TRUE);
+}
+
+/**
+ * ges_timeline_end_batch:
+ * @timeline: a #GESTimeline
+ *
+ * Ends a batch of edits started with ges_timeline_begin_batch(). When the
+ * outermost batch ends, the tracks are sorted and their compositions
+ * updated with all the edits at once.
+ *
+ * Returns: %TRUE if the tracks could be updated, else %FALSE.
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_timeline_end_batch (GESTimeline * timeline)
+{
+  GList *tmp;
+  gboolean res;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), FALSE);
+  g_return_val_if_fail (timeline->priv->batch_depth > 0, FALSE);
+
+  if (--timeline->priv->batch_depth)
+    return TRUE;
+
+  GST_DEBUG_OBJECT (timeline, "Ending a batch");
+
+  GES_TRACE_BEGIN ("timeline-end-batch");
+  for (tmp = timeline->priv->tracks; tmp; tmp = tmp->next)
+    ges_track_set_batch (((TrackPrivate *) tmp->data)->track, FALSE);
+  res = ges_timeline_enable_update (timeline, TRUE);
+  GES_TRACE_COUNT (g_hash_table_size (timeline->priv->held));
+  ges_timeline_release_notify (timeline);
+  GES_TRACE_END ();
+
+  return res;
+}
+
+/* ges_timeline_hold_notify:
+ * @timeline: a #GESTimeline
+ * @object: an object of @timeline about to change
+ *
+ * While a batch is going on, freezes the notifications of @object until
+ * the batch ends, so that each of its changed properties is only notified
+ * once.
+ */
+void
+ges_timeline_hold_notify (GESTimeline * timeline, GObject * object)
+{
+  GESTimelinePrivate *priv = timeline->priv;
+
+  if (!priv->batch_depth || g_hash_table_lookup (priv->held, object))
+    return;
+
+  g_hash_table_insert (priv->held, object, object);
+  priv->held_objects = g_list_prepend (priv->held_objects,
+      g_object_ref (object));
+  g_object_freeze_notify (object);
+}
+
+/**
+ * ges_timeline_set_stats_enabled:
+ * @timeline: a #GESTimeline
+ * @enabled: whether to gather processing statistics
+ *
+ * Enables or disables the gathering of processing statistics on all the
+ * #GESTrackObject of @timeline, including the ones added later on. See
+ * ges_track_object_set_stats_enabled().
+ *
+ * Since: 0.10.2
+ */
+void
+ges_timeline_set_stats_enabled (GESTimeline * timeline, gboolean enabled)
+{
+  GList *tracks, *ltrack, *objects, *tmp;
+
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+
+  GST_DEBUG_OBJECT (timeline, "%s statistics",
+      enabled ? "Enabling" : "Disabling");
+
+  timeline->priv->stats_enabled = enabled;
+
+  tracks = ges_timeline_get_tracks (timeline);
+  for (ltrack = tracks; ltrack; ltrack = ltrack->next) {
+    objects = ges_track_get_objects ((GESTrack *) ltrack->data);
+    for (tmp = objects; tmp; tmp = tmp->next) {
+      ges_track_object_set_stats_enabled ((GESTrackObject *) tmp->data,
+          enabled);
+      g_object_unref (tmp->data);
+    }
+    g_list_free (objects);
+    g_object_unref (ltrack->data);
+  }
+  g_list_free (tracks);
+}
+
+/**
+ * ges_timeline_get_stats_enabled:
+ * @timeline: a #GESTimeline
+ *
+ * Returns: %TRUE if the track objects of @timeline gather processing
+ * statistics.
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_timeline_get_stats_enabled (GESTimeline * timeline)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), FALSE);
+
+  return timeline->priv->stats_enabled;
+}
+
+/**
+ * ges_timeline_get_stats:
+ * @timeline: a #GESTimeline
+ * @stats: (out): the #GESTrackObjectStats to fill
+ *
+ * Gets a snapshot of the processing statistics of all the #GESTrackObject
+ * of @timeline. The buffers, dropped buffers and latencies are summed up,
+ * the peak latency is the highest of all.
+ *
+ * Returns: %TRUE if @stats was filled, %FALSE if statistics aren't enabled
+ * on @timeline.
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_timeline_get_stats (GESTimeline * timeline, GESTrackObjectStats * stats)
+{
+  GList *tracks, *ltrack, *objects, *tmp;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), FALSE);
+  g_return_val_if_fail (stats != NULL, FALSE);
+
+  if (!timeline->priv->stats_enabled)
+    return FALSE;
+
+  memset (stats, 0, sizeof (GESTrackObjectStats));
+
+  tracks = ges_timeline_get_tracks (timeline);
+  for (ltrack = tracks; ltrack; ltrack = ltrack->next) {
+    objects = ges_track_get_objects ((GESTrack *) ltrack->data);
+    for (tmp = objects; tmp; tmp = tmp->next) {
+      GESTrackObjectStats ostats;
+
+      if (ges_track_object_get_stats ((GESTrackObject *) tmp->data, &ostats)) {
+        stats->buffers += ostats.buffers;
+        stats->dropped += ostats.dropped;
+        stats->total_latency += ostats.total_latency;
+        stats->peak_latency = MAX (stats->peak_latency, ostats.peak_latency);
+      }
+      g_object_unref (tmp->data);
+    }
+    g_list_free (objects);
+    g_object_unref (ltrack->data);
+  }
+  g_list_free (tracks);
+
+  return TRUE;
+}
+
 static void
 track_duration_cb (GstElement * track,
     GParamSpec * arg G_GNUC_UNUSED, GESTimeline * timeline)
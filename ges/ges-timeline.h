@@ -101,6 +101,14 @@ GList *ges_timeline_get_tracks (GESTimeline *timeline);
 
 gboolean ges_timeline_enable_update(GESTimeline * timeline, gboolean enabled);
 
+void ges_timeline_begin_batch (GESTimeline * timeline);
+gboolean ges_timeline_end_batch (GESTimeline * timeline);
+
+void ges_timeline_set_stats_enabled (GESTimeline * timeline, gboolean enabled);
+gboolean ges_timeline_get_stats_enabled (GESTimeline * timeline);
+gboolean ges_timeline_get_stats (GESTimeline * timeline,
+                                 GESTrackObjectStats * stats);
+
 G_END_DECLS
 
 #endif /* _GES_TIMELINE */
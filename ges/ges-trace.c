@@ -0,0 +1,341 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:ges-trace
+ * @short_description: Edit-latency tracing
+ *
+ * When enabled, every public mutation of #GESTimelineObject,
+ * #GESTimelineLayer and #GESTrack records a span covering the time spent
+ * in the call, including the signal handlers it triggered. Spans nest, so
+ * each one knows how much of its duration was spent in nested mutations
+ * and how much in its own code. Spans also carry the number of objects
+ * the mutation had to touch.
+ *
+ * The collected spans can be written out with ges_trace_save() in the
+ * Chrome trace-event format, which can be opened with chrome://tracing
+ * or any compatible viewer.
+ *
+ * Tracing is disabled by default and costs a single branch per mutation
+ * in that case. It can be removed entirely at build time by configuring
+ * with --disable-tracing, in which case the functions below are no-ops.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+
+#include <glib/gstdio.h>
+
+#include "ges-internal.h"
+#include "ges-trace.h"
+
+#ifndef GES_DISABLE_TRACING
+
+/* Upper bound on the number of recorded events, so that a forgotten
+ * trace doesn't grow without limit */
+#define TRACE_MAX_EVENTS (1 << 20)
+
+typedef struct
+{
+  const gchar *name;
+  GstClockTime start;
+  GstClockTime children;
+  guint objects;
+  gint generation;
+} TraceSpan;
+
+typedef struct
+{
+  const gchar *name;
+  GstClockTime start;
+  GstClockTime duration;
+  GstClockTime self;
+  guint objects;
+  guint tid;
+} TraceEvent;
+
+typedef struct
+{
+  GQueue spans;
+  guint tid;
+} TraceThread;
+
+gboolean _ges_trace_enabled = FALSE;
+
+static gint trace_generation = 0;
+static gint trace_next_tid = 0;
+static GStaticPrivate trace_thread_key = G_STATIC_PRIVATE_INIT;
+
+G_LOCK_DEFINE_STATIC (trace_events);
+static GArray *trace_events = NULL;
+static GstClockTime trace_base = GST_CLOCK_TIME_NONE;
+static gboolean trace_overflow = FALSE;
+
+static void
+trace_thread_free (TraceThread * thread)
+{
+  TraceSpan *span;
+
+  while ((span = g_queue_pop_head (&thread->spans)))
+    g_slice_free (TraceSpan, span);
+
+  g_slice_free (TraceThread, thread);
+}
+
+static TraceThread *
+trace_thread_get (void)
+{
+  TraceThread *thread = g_static_private_get (&trace_thread_key);
+
+  if (G_UNLIKELY (thread == NULL)) {
+    thread = g_slice_new0 (TraceThread);
+    g_queue_init (&thread->spans);
+    thread->tid = g_atomic_int_exchange_and_add (&trace_next_tid, 1) + 1;
+    g_static_private_set (&trace_thread_key, thread,
+        (GDestroyNotify) trace_thread_free);
+  }
+
+  return thread;
+}
+
+/* Drops the spans opened before tracing was last toggled, their end
+ * will never be (or should not be) recorded */
+static void
+trace_thread_drop_stale (TraceThread * thread, gint generation)
+{
+  TraceSpan *span;
+
+  while ((span = g_queue_peek_head (&thread->spans)) &&
+      span->generation != generation)
+    g_slice_free (TraceSpan, g_queue_pop_head (&thread->spans));
+}
+
+void
+_ges_trace_begin (const gchar * name)
+{
+  TraceThread *thread = trace_thread_get ();
+  gint generation = g_atomic_int_get (&trace_generation);
+  TraceSpan *span;
+
+  trace_thread_drop_stale (thread, generation);
+
+  span = g_slice_new0 (TraceSpan);
+  span->name = name;
+  span->generation = generation;
+  span->start = gst_util_get_timestamp ();
+
+  g_queue_push_head (&thread->spans, span);
+}
+
+void
+_ges_trace_count (guint objects)
+{
+  TraceThread *thread = trace_thread_get ();
+  TraceSpan *span = g_queue_peek_head (&thread->spans);
+
+  if (span)
+    span->objects += objects;
+}
+
+void
+_ges_trace_end (void)
+{
+  TraceThread *thread = trace_thread_get ();
+  GstClockTime now = gst_util_get_timestamp ();
+  TraceSpan *span, *parent;
+  TraceEvent event;
+
+  span = g_queue_pop_head (&thread->spans);
+  if (span == NULL)
+    return;
+
+  if (span->generation != g_atomic_int_get (&trace_generation)) {
+    g_slice_free (TraceSpan, span);
+    return;
+  }
+
+  event.name = span->name;
+  event.start = span->start;
+  event.duration = now - span->start;
+  event.self = event.duration > span->children ?
+      event.duration - span->children : 0;
+  event.objects = span->objects;
+  event.tid = thread->tid;
+
+  parent = g_queue_peek_head (&thread->spans);
+  if (parent)
+    parent->children += event.duration;
+
+  g_slice_free (TraceSpan, span);
+
+  G_LOCK (trace_events);
+  if (G_UNLIKELY (trace_events == NULL))
+    trace_events = g_array_new (FALSE, FALSE, sizeof (TraceEvent));
+
+  if (!GST_CLOCK_TIME_IS_VALID (trace_base) || event.start < trace_base)
+    trace_base = event.start;
+
+  if (trace_events->len < TRACE_MAX_EVENTS)
+    g_array_append_val (trace_events, event);
+  else if (!trace_overflow) {
+    trace_overflow = TRUE;
+    GST_WARNING ("Trace buffer full, dropping further events");
+  }
+  G_UNLOCK (trace_events);
+}
+
+static void
+write_time_us (FILE * file, GstClockTime time)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  fputs (g_ascii_formatd (buf, sizeof (buf), "%.3f",
+          (gdouble) time / GST_USECOND), file);
+}
+
+#endif /* GES_DISABLE_TRACING */
+
+/**
+ * ges_trace_set_enabled:
+ * @enabled: whether to record edit-latency spans
+ *
+ * Starts or stops recording spans for timeline mutations. Already
+ * recorded spans are kept, use ges_trace_clear() to drop them.
+ *
+ * Has no effect if GES was built with tracing disabled.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_trace_set_enabled (gboolean enabled)
+{
+#ifndef GES_DISABLE_TRACING
+  if (enabled == _ges_trace_enabled)
+    return;
+
+  GST_DEBUG ("%s edit-latency tracing", enabled ? "Enabling" : "Disabling");
+
+  g_atomic_int_inc (&trace_generation);
+  _ges_trace_enabled = enabled;
+#else
+  if (enabled)
+    GST_WARNING ("GES was built without tracing support");
+#endif
+}
+
+/**
+ * ges_trace_get_enabled:
+ *
+ * Returns: %TRUE if timeline mutations are currently being traced.
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_trace_get_enabled (void)
+{
+#ifndef GES_DISABLE_TRACING
+  return _ges_trace_enabled;
+#else
+  return FALSE;
+#endif
+}
+
+/**
+ * ges_trace_clear:
+ *
+ * Drops all the spans recorded so far.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_trace_clear (void)
+{
+#ifndef GES_DISABLE_TRACING
+  G_LOCK (trace_events);
+  if (trace_events)
+    g_array_set_size (trace_events, 0);
+  trace_base = GST_CLOCK_TIME_NONE;
+  trace_overflow = FALSE;
+  G_UNLOCK (trace_events);
+#endif
+}
+
+/**
+ * ges_trace_save:
+ * @filename: the file to write the trace to
+ *
+ * Writes all the recorded spans to @filename as a Chrome trace-event JSON
+ * document. Each span is a complete ("X") event whose arguments contain
+ * the number of objects the mutation touched and the time spent in the
+ * mutation itself, excluding nested mutations.
+ *
+ * Returns: %TRUE if the trace could be written, %FALSE otherwise.
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_trace_save (const gchar * filename)
+{
+#ifndef GES_DISABLE_TRACING
+  FILE *file;
+  guint i;
+  gboolean ret;
+
+  g_return_val_if_fail (filename != NULL, FALSE);
+
+  file = g_fopen (filename, "w");
+  if (file == NULL)
+    goto open_failed;
+
+  fputs ("{\"traceEvents\":[", file);
+
+  G_LOCK (trace_events);
+  for (i = 0; trace_events && i < trace_events->len; i++) {
+    TraceEvent *event = &g_array_index (trace_events, TraceEvent, i);
+
+    fprintf (file, "%s\n{\"name\":\"%s\",\"cat\":\"ges\",\"ph\":\"X\",\"ts\":",
+        i ? "," : "", event->name);
+    write_time_us (file, event->start - trace_base);
+    fputs (",\"dur\":", file);
+    write_time_us (file, event->duration);
+    fprintf (file, ",\"pid\":1,\"tid\":%u,\"args\":{\"objects\":%u,"
+        "\"self_us\":", event->tid, event->objects);
+    write_time_us (file, event->self);
+    fputs ("}}", file);
+  }
+  G_UNLOCK (trace_events);
+
+  fputs ("\n],\"displayTimeUnit\":\"ns\"}\n", file);
+
+  ret = !ferror (file);
+  if (fclose (file) != 0)
+    ret = FALSE;
+
+  return ret;
+
+open_failed:
+  {
+    GST_WARNING ("Couldn't open %s for writing: %s", filename,
+        g_strerror (errno));
+    return FALSE;
+  }
+#else
+  GST_WARNING ("GES was built without tracing support");
+  return FALSE;
+#endif
+}
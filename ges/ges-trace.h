@@ -0,0 +1,34 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _GES_TRACE
+#define _GES_TRACE
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+void     ges_trace_set_enabled (gboolean enabled);
+gboolean ges_trace_get_enabled (void);
+
+void     ges_trace_clear       (void);
+gboolean ges_trace_save        (const gchar * filename);
+
+G_END_DECLS
+
+#endif /* _GES_TRACE */
@@ -26,9 +26,17 @@
  * Outputs the video stream from a given file as a still frame. The frame
  * chosen will be determined by the in-point property on the track object. For
  * image files, do not set the in-point property.
+ *
+ * Decoded frames are kept in a process-wide cache, keyed by URI and track
+ * caps, so that using the same image several times (or seeking in it) does
+ * not require decoding, scaling and converting it again. Images are decoded
+ * on a worker thread as soon as the source is added to a track.
  */
 
+#include <gst/base/gstbasesrc.h>
+
 #include "ges-internal.h"
+#include "ges-track.h"
 #include "ges-track-object.h"
 #include "ges-track-image-source.h"
 
@@ -110,12 +118,487 @@ pad_added_cb (GstElement * timeline, GstPad * pad, GstElement * scale)
   GST_DEBUG ("pad failed to link properly");
 }
 
+/* Decoded image cache
+ *
+ * Maps the URI of an image and the caps of the track it is used in to a
+ * GstBuffer holding its frame, decoded, scaled and converted to those caps,
+ * so that the elements only have to output it.
+ *
+ * The frames are decoded on a worker thread as soon as an element needs
+ * them, which is when the track object is added to its track, so they are
+ * normally ready long before the playback reaches them. The streaming
+ * thread only waits for the decoding when it isn't over yet.
+ *
+ * The size of all the frames, cached or still used by an element, is
+ * bounded by the maximum size of the cache: the least recently used frames
+ * which no element uses anymore are dropped first. Frames in use are never
+ * dropped, so the cache can go over its maximum size while they are all
+ * needed. */
+
+#define IMAGE_CACHE_MAX_SIZE (256 * 1024 * 1024)
+#define IMAGE_DECODE_TIMEOUT (5 * GST_SECOND)
+
+typedef struct
+{
+  gchar *key;                   /* "caps uri" */
+  gchar *uri;
+  GstCaps *caps;                /* Caps of the track */
+  GstBuffer *frame;             /* NULL until decoded, or if that failed */
+  gboolean decoded;
+  guint users;                  /* Elements outputting the frame */
+  GList *link;                  /* In image_cache_lru once decoded, NULL
+                                 * once dropped */
+} ImageCacheEntry;
+
+G_LOCK_DEFINE_STATIC (image_cache);
+static GCond *image_cache_cond = NULL;  /* Signalled when a frame is decoded
+                                         * or a source unlocked */
+static GHashTable *image_cache = NULL;
+static GQueue image_cache_lru = G_QUEUE_INIT;   /* Least recent first */
+static guint64 image_cache_size = 0;
+static guint64 image_cache_max_size = IMAGE_CACHE_MAX_SIZE;
+static guint image_cache_decodes = 0;
+static GThreadPool *image_decode_pool = NULL;
+
+static void
+image_cache_entry_free (ImageCacheEntry * entry)
+{
+  g_free (entry->key);
+  g_free (entry->uri);
+  gst_caps_unref (entry->caps);
+  if (entry->frame)
+    gst_buffer_unref (entry->frame);
+  g_slice_free (ImageCacheEntry, entry);
+}
+
+/* Drops the least recently used frames no element uses until the cache
+ * fits in its maximum size. Must be called with the lock */
+static void
+image_cache_trim (void)
+{
+  GList *tmp, *next;
+
+  for (tmp = image_cache_lru.head;
+      tmp && image_cache_size > image_cache_max_size; tmp = next) {
+    ImageCacheEntry *entry = (ImageCacheEntry *) tmp->data;
+
+    next = tmp->next;
+    if (entry->users)
+      continue;
+
+    GST_DEBUG ("Dropping %s from the image cache", entry->key);
+
+    g_queue_delete_link (&image_cache_lru, tmp);
+    g_hash_table_remove (image_cache, entry->key);
+    image_cache_size -= GST_BUFFER_SIZE (entry->frame);
+    image_cache_entry_free (entry);
+  }
+}
+
+static void
+decode_pad_added_cb (GstElement * decodebin, GstPad * pad, GstElement * scale)
+{
+  GstPad *sinkpad;
+  GstCaps *caps;
+  const gchar *name;
+
+  caps = gst_pad_get_caps_reffed (pad);
+  name = gst_structure_get_name (gst_caps_get_structure (caps, 0));
+
+  if (g_str_has_prefix (name, "video/")) {
+    sinkpad = gst_element_get_static_pad (scale, "sink");
+    if (!gst_pad_is_linked (sinkpad))
+      gst_pad_link (pad, sinkpad);
+    gst_object_unref (sinkpad);
+  }
+
+  gst_caps_unref (caps);
+}
+
+/* Decodes the first frame of @uri, and scales and converts it to @caps */
+static GstBuffer *
+decode_image (const gchar * uri, GstCaps * caps)
+{
+  GstElement *pipeline, *source, *scale, *iconv, *filter, *sink;
+  GstStateChangeReturn ret;
+  GstBuffer *frame = NULL;
+
+  pipeline = gst_pipeline_new ("image-decoder");
+  source = gst_element_factory_make ("uridecodebin", NULL);
+  scale = gst_element_factory_make ("videoscale", NULL);
+  iconv = gst_element_factory_make ("ffmpegcolorspace", NULL);
+  filter = gst_element_factory_make ("capsfilter", NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+
+  if (!source || !scale || !iconv || !filter || !sink) {
+    GST_WARNING ("Missing elements to decode images");
+    goto missing_elements;
+  }
+
+  g_object_set (source, "uri", uri, NULL);
+  g_object_set (scale, "add-borders", TRUE, NULL);
+  g_object_set (filter, "caps", caps, NULL);
+  g_object_set (sink, "sync", FALSE, NULL);
+
+  gst_bin_add_many (GST_BIN (pipeline), source, scale, iconv, filter, sink,
+      NULL);
+  gst_element_link_many (scale, iconv, filter, sink, NULL);
+  g_signal_connect (source, "pad-added", G_CALLBACK (decode_pad_added_cb),
+      scale);
+
+  gst_element_set_state (pipeline, GST_STATE_PAUSED);
+  ret = gst_element_get_state (pipeline, NULL, NULL, IMAGE_DECODE_TIMEOUT);
+
+  if (ret == GST_STATE_CHANGE_SUCCESS)
+    g_object_get (sink, "last-buffer", &frame, NULL);
+  else
+    GST_DEBUG ("Could not decode %s", uri);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return frame;
+
+missing_elements:
+  {
+    if (source)
+      gst_object_unref (source);
+    if (scale)
+      gst_object_unref (scale);
+    if (iconv)
+      gst_object_unref (iconv);
+    if (filter)
+      gst_object_unref (filter);
+    if (sink)
+      gst_object_unref (sink);
+    gst_object_unref (pipeline);
+    return NULL;
+  }
+}
+
+static void
+image_decode_func (ImageCacheEntry * entry, gpointer user_data)
+{
+  GstBuffer *frame = decode_image (entry->uri, entry->caps);
+
+  G_LOCK (image_cache);
+  image_cache_decodes++;
+  entry->frame = frame;
+  entry->decoded = TRUE;
+
+  if (frame) {
+    g_queue_push_tail (&image_cache_lru, entry);
+    entry->link = image_cache_lru.tail;
+    image_cache_size += GST_BUFFER_SIZE (frame);
+    image_cache_trim ();
+  } else {
+    /* Let the next element try again, this one is freed by its last user */
+    g_hash_table_remove (image_cache, entry->key);
+    if (entry->users == 0)
+      image_cache_entry_free (entry);
+  }
+
+  g_cond_broadcast (image_cache_cond);
+  G_UNLOCK (image_cache);
+}
+
+/* Returns the entry of @uri for a track with @caps, starting to decode it if
+ * it isn't in the cache yet, and counts one more user of it. Wait for the
+ * frame with image_cache_wait() and release it with image_cache_release() */
+static ImageCacheEntry *
+image_cache_acquire (const gchar * uri, const GstCaps * caps)
+{
+  ImageCacheEntry *entry;
+  gchar *caps_str, *key;
+
+  caps_str = gst_caps_to_string (caps);
+  key = g_strdup_printf ("%s %s", caps_str, uri);
+  g_free (caps_str);
+
+  G_LOCK (image_cache);
+  if (G_UNLIKELY (image_cache == NULL)) {
+    image_cache = g_hash_table_new (g_str_hash, g_str_equal);
+    image_cache_cond = g_cond_new ();
+  }
+
+  entry = g_hash_table_lookup (image_cache, key);
+  if (entry) {
+    GST_DEBUG ("Found %s in the image cache", key);
+    g_free (key);
+    entry->users++;
+    if (entry->link) {
+      g_queue_unlink (&image_cache_lru, entry->link);
+      g_queue_push_tail_link (&image_cache_lru, entry->link);
+    }
+    G_UNLOCK (image_cache);
+    return entry;
+  }
+
+  entry = g_slice_new0 (ImageCacheEntry);
+  entry->key = key;
+  entry->uri = g_strdup (uri);
+  entry->caps = gst_caps_copy (caps);
+  entry->users = 1;
+  g_hash_table_insert (image_cache, entry->key, entry);
+
+  if (G_UNLIKELY (image_decode_pool == NULL)) {
+    GError *err = NULL;
+
+    image_decode_pool = g_thread_pool_new ((GFunc) image_decode_func, NULL,
+        1, FALSE, &err);
+    if (image_decode_pool == NULL) {
+      GST_ERROR ("Couldn't create the image decoding thread: %s",
+          err->message);
+      g_error_free (err);
+    }
+  }
+  G_UNLOCK (image_cache);
+
+  if (G_LIKELY (image_decode_pool))
+    g_thread_pool_push (image_decode_pool, entry, NULL);
+  else
+    image_decode_func (entry, NULL);
+
+  return entry;
+}
+
+/* Waits for the frame of @entry to be decoded, returns a reference to it,
+ * or %NULL if it couldn't be decoded or *@unlocked got set */
+static GstBuffer *
+image_cache_wait (ImageCacheEntry * entry, gboolean * unlocked)
+{
+  GstBuffer *frame = NULL;
+
+  G_LOCK (image_cache);
+  while (!entry->decoded && !*unlocked) {
+    GST_DEBUG ("Waiting for %s to be decoded", entry->key);
+    g_cond_wait (image_cache_cond,
+        g_static_mutex_get_mutex (&G_LOCK_NAME (image_cache)));
+  }
+  if (entry->frame)
+    frame = gst_buffer_ref (entry->frame);
+  G_UNLOCK (image_cache);
+
+  return frame;
+}
+
+static void
+image_cache_release (ImageCacheEntry * entry)
+{
+  G_LOCK (image_cache);
+  entry->users--;
+  /* Entries which failed to decode are out of the cache already */
+  if (entry->users == 0 && entry->decoded && entry->frame == NULL)
+    image_cache_entry_free (entry);
+  image_cache_trim ();
+  G_UNLOCK (image_cache);
+}
+
+/* ges_track_image_source_cache_set_max_size:
+ * @size: the maximum size of the decoded image cache, in bytes
+ *
+ * Sets the maximum size of the frames of the image cache, and drops frames
+ * no element uses anymore until it fits.
+ */
+void
+ges_track_image_source_cache_set_max_size (guint64 size)
+{
+  G_LOCK (image_cache);
+  image_cache_max_size = size;
+  if (image_cache)
+    image_cache_trim ();
+  G_UNLOCK (image_cache);
+}
+
+/* ges_track_image_source_cache_get_stats:
+ * @size: (out) (allow-none): the size of the frames in the cache
+ * @n_frames: (out) (allow-none): the number of frames in the cache
+ * @decodes: (out) (allow-none): the number of images decoded so far
+ */
+void
+ges_track_image_source_cache_get_stats (guint64 * size, guint * n_frames,
+    guint * decodes)
+{
+  G_LOCK (image_cache);
+  if (size)
+    *size = image_cache_size;
+  if (n_frames)
+    *n_frames = image_cache_lru.length;
+  if (decodes)
+    *decodes = image_cache_decodes;
+  G_UNLOCK (image_cache);
+}
+
+/* GESImageFrameSrc: outputs the frame of an image from the cache, again
+ * after each seek */
+
+#define GES_TYPE_IMAGE_FRAME_SRC ges_image_frame_src_get_type()
+#define GES_IMAGE_FRAME_SRC(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST ((obj), GES_TYPE_IMAGE_FRAME_SRC, GESImageFrameSrc))
+
+typedef struct
+{
+  GstBaseSrc parent;
+
+  ImageCacheEntry *entry;
+  gboolean pushed;
+  gboolean unlocked;            /* Protected by the image cache lock */
+} GESImageFrameSrc;
+
+typedef struct
+{
+  GstBaseSrcClass parent_class;
+} GESImageFrameSrcClass;
+
+static GType ges_image_frame_src_get_type (void);
+
+G_DEFINE_TYPE (GESImageFrameSrc, ges_image_frame_src, GST_TYPE_BASE_SRC);
+
+static gboolean
+ges_image_frame_src_is_seekable (GstBaseSrc * src)
+{
+  return TRUE;
+}
+
+static gboolean
+ges_image_frame_src_do_seek (GstBaseSrc * src, GstSegment * segment)
+{
+  GES_IMAGE_FRAME_SRC (src)->pushed = FALSE;
+
+  return TRUE;
+}
+
+static gboolean
+ges_image_frame_src_unlock (GstBaseSrc * src)
+{
+  G_LOCK (image_cache);
+  GES_IMAGE_FRAME_SRC (src)->unlocked = TRUE;
+  g_cond_broadcast (image_cache_cond);
+  G_UNLOCK (image_cache);
+
+  return TRUE;
+}
+
+static gboolean
+ges_image_frame_src_unlock_stop (GstBaseSrc * src)
+{
+  G_LOCK (image_cache);
+  GES_IMAGE_FRAME_SRC (src)->unlocked = FALSE;
+  G_UNLOCK (image_cache);
+
+  return TRUE;
+}
+
+static GstFlowReturn
+ges_image_frame_src_create (GstBaseSrc * src, guint64 offset, guint size,
+    GstBuffer ** buf)
+{
+  GESImageFrameSrc *self = GES_IMAGE_FRAME_SRC (src);
+  GstBuffer *frame, *outbuf;
+
+  if (self->pushed)
+    return GST_FLOW_UNEXPECTED;
+
+  frame = image_cache_wait (self->entry, &self->unlocked);
+  if (frame == NULL) {
+    if (self->unlocked)
+      return GST_FLOW_WRONG_STATE;
+
+    GST_ELEMENT_ERROR (src, STREAM, DECODE, (NULL),
+        ("Could not decode %s", self->entry->uri));
+    return GST_FLOW_ERROR;
+  }
+
+  /* Shares the data with the cached frame */
+  outbuf = gst_buffer_make_metadata_writable (frame);
+  GST_BUFFER_TIMESTAMP (outbuf) = src->segment.start;
+  GST_BUFFER_DURATION (outbuf) = GST_CLOCK_TIME_NONE;
+  GST_BUFFER_OFFSET (outbuf) = GST_BUFFER_OFFSET_NONE;
+  GST_BUFFER_OFFSET_END (outbuf) = GST_BUFFER_OFFSET_NONE;
+
+  self->pushed = TRUE;
+  *buf = outbuf;
+
+  return GST_FLOW_OK;
+}
+
+static void
+ges_image_frame_src_finalize (GObject * object)
+{
+  GESImageFrameSrc *self = GES_IMAGE_FRAME_SRC (object);
+
+  if (self->entry)
+    image_cache_release (self->entry);
+
+  G_OBJECT_CLASS (ges_image_frame_src_parent_class)->finalize (object);
+}
+
+static void
+ges_image_frame_src_class_init (GESImageFrameSrcClass * klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GstBaseSrcClass *basesrc_class = GST_BASE_SRC_CLASS (klass);
+  static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+      GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+  gst_element_class_add_pad_template (GST_ELEMENT_CLASS (klass),
+      gst_static_pad_template_get (&src_template));
+
+  object_class->finalize = ges_image_frame_src_finalize;
+
+  basesrc_class->is_seekable = ges_image_frame_src_is_seekable;
+  basesrc_class->do_seek = ges_image_frame_src_do_seek;
+  basesrc_class->unlock = ges_image_frame_src_unlock;
+  basesrc_class->unlock_stop = ges_image_frame_src_unlock_stop;
+  basesrc_class->create = ges_image_frame_src_create;
+}
+
+static void
+ges_image_frame_src_init (GESImageFrameSrc * self)
+{
+  gst_base_src_set_format (GST_BASE_SRC (self), GST_FORMAT_TIME);
+}
+
+/* The frame is already in the format of the track, it only needs to be
+ * repeated */
+static GstElement *
+create_cached_element (const gchar * uri, const GstCaps * caps)
+{
+  GstElement *bin, *source, *freeze;
+  GstPad *src, *target;
+
+  bin = GST_ELEMENT (gst_bin_new ("still-image-bin"));
+  source = g_object_new (GES_TYPE_IMAGE_FRAME_SRC, NULL);
+  freeze = gst_element_factory_make ("imagefreeze", NULL);
+
+  GES_IMAGE_FRAME_SRC (source)->entry = image_cache_acquire (uri, caps);
+
+  gst_bin_add_many (GST_BIN (bin), source, freeze, NULL);
+  gst_element_link_pads_full (source, "src", freeze, "sink",
+      GST_PAD_LINK_CHECK_NOTHING);
+
+  target = gst_element_get_static_pad (freeze, "src");
+
+  src = gst_ghost_pad_new ("src", target);
+  gst_element_add_pad (bin, src);
+  gst_object_unref (target);
+
+  return bin;
+}
+
 static GstElement *
 ges_track_image_source_create_element (GESTrackObject * object)
 {
+  GESTrack *track = ges_track_object_get_track (object);
   GstElement *bin, *source, *scale, *freeze, *iconv;
   GstPad *src, *target;
 
+  /* Only whole image files can be cached, video frames picked with the
+   * in-point go through the decoder */
+  if (GES_TRACK_OBJECT_INPOINT (object) == 0 && track)
+    return create_cached_element (((GESTrackImageSource *) object)->uri,
+        ges_track_get_caps (track));
+
   bin = GST_ELEMENT (gst_bin_new ("still-image-bin"));
   source = gst_element_factory_make ("uridecodebin", NULL);
   scale = gst_element_factory_make ("videoscale", NULL);
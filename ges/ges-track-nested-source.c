@@ -0,0 +1,216 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:ges-track-nested-source
+ * @short_description: outputs a track of a timeline snapshot
+ *
+ * Outputs the track of a #GESTimelineSnapshot of the same type as the track
+ * which contains the object, by playing a copy of the timeline created from
+ * the snapshot, or by playing the file it was rendered to.
+ */
+
+#include "ges-internal.h"
+#include "ges-track-object.h"
+#include "ges-track-nested-source.h"
+#include "ges-timeline-snapshot.h"
+#include "ges-timeline.h"
+#include "ges-track.h"
+
+G_DEFINE_TYPE (GESTrackNestedSource, ges_track_nested_source,
+    GES_TYPE_TRACK_SOURCE);
+
+struct _GESTrackNestedSourcePrivate
+{
+  GESTimelineSnapshot *snapshot;
+  gchar *cache_uri;
+};
+
+enum
+{
+  PROP_0,
+  PROP_SNAPSHOT,
+  PROP_CACHE_URI
+};
+
+static void
+ges_track_nested_source_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GESTrackNestedSourcePrivate *priv = GES_TRACK_NESTED_SOURCE (object)->priv;
+
+  switch (property_id) {
+    case PROP_SNAPSHOT:
+      g_value_set_boxed (value, priv->snapshot);
+      break;
+    case PROP_CACHE_URI:
+      g_value_set_string (value, priv->cache_uri);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+  }
+}
+
+static void
+ges_track_nested_source_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GESTrackNestedSourcePrivate *priv = GES_TRACK_NESTED_SOURCE (object)->priv;
+
+  switch (property_id) {
+    case PROP_SNAPSHOT:
+      priv->snapshot = g_value_dup_boxed (value);
+      break;
+    case PROP_CACHE_URI:
+      priv->cache_uri = g_value_dup_string (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+  }
+}
+
+static void
+ges_track_nested_source_dispose (GObject * object)
+{
+  GESTrackNestedSourcePrivate *priv = GES_TRACK_NESTED_SOURCE (object)->priv;
+
+  if (priv->snapshot) {
+    ges_timeline_snapshot_unref (priv->snapshot);
+    priv->snapshot = NULL;
+  }
+
+  G_OBJECT_CLASS (ges_track_nested_source_parent_class)->dispose (object);
+}
+
+static void
+ges_track_nested_source_finalize (GObject * object)
+{
+  g_free (GES_TRACK_NESTED_SOURCE (object)->priv->cache_uri);
+
+  G_OBJECT_CLASS (ges_track_nested_source_parent_class)->finalize (object);
+}
+
+static GstElement *
+ges_track_nested_source_create_element (GESTrackObject * object)
+{
+  GESTrackNestedSourcePrivate *priv = GES_TRACK_NESTED_SOURCE (object)->priv;
+  GESTrack *track = ges_track_object_get_track (object);
+  GESTimeline *timeline;
+  GstElement *element;
+
+  if (!track) {
+    GST_WARNING
+        ("The object %p should be in a Track for the element to be created",
+        object);
+    return NULL;
+  }
+
+  /* The render of the nested timeline, only the stream of our track */
+  if (priv->cache_uri) {
+    GST_DEBUG ("Playing the render cache %s", priv->cache_uri);
+
+    element = gst_element_factory_make ("uridecodebin", NULL);
+    g_object_set (element, "uri", priv->cache_uri, "caps",
+        ges_track_get_caps (track), NULL);
+
+    return element;
+  }
+
+  if (priv->snapshot == NULL ||
+      !(ges_timeline_snapshot_get_track_types (priv->snapshot) & track->type)) {
+    GST_DEBUG ("The nested timeline has no track of type %d", track->type);
+    return NULL;
+  }
+
+  /* Each track gets its own copy, an element can only be in one of them */
+  timeline = ges_timeline_snapshot_create_timeline_for_types (priv->snapshot,
+      track->type);
+
+  return (GstElement *) timeline;
+}
+
+static void
+ges_track_nested_source_class_init (GESTrackNestedSourceClass * klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GESTrackObjectClass *track_class = GES_TRACK_OBJECT_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (GESTrackNestedSourcePrivate));
+
+  object_class->get_property = ges_track_nested_source_get_property;
+  object_class->set_property = ges_track_nested_source_set_property;
+  object_class->dispose = ges_track_nested_source_dispose;
+  object_class->finalize = ges_track_nested_source_finalize;
+
+  /**
+   * GESTrackNestedSource:snapshot:
+   *
+   * The snapshot of the timeline to output.
+   *
+   * Since: 0.10.2
+   */
+  g_object_class_install_property (object_class, PROP_SNAPSHOT,
+      g_param_spec_boxed ("snapshot", "Snapshot",
+          "The snapshot of the timeline to output", GES_TYPE_TIMELINE_SNAPSHOT,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
+  /**
+   * GESTrackNestedSource:cache-uri:
+   *
+   * The URI of a file the snapshot was rendered to, which is played instead
+   * of the snapshot, or %NULL.
+   *
+   * Since: 0.10.2
+   */
+  g_object_class_install_property (object_class, PROP_CACHE_URI,
+      g_param_spec_string ("cache-uri", "Cache URI",
+          "URI of the render of the snapshot", NULL,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
+  track_class->create_element = ges_track_nested_source_create_element;
+}
+
+static void
+ges_track_nested_source_init (GESTrackNestedSource * self)
+{
+  self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
+      GES_TYPE_TRACK_NESTED_SOURCE, GESTrackNestedSourcePrivate);
+}
+
+/**
+ * ges_track_nested_source_new:
+ * @snapshot: the #GESTimelineSnapshot to output
+ * @cache_uri: (allow-none): the URI of a file @snapshot was rendered to,
+ * or %NULL
+ *
+ * Creates a new #GESTrackNestedSource outputting @snapshot, from the file
+ * at @cache_uri if it is not %NULL.
+ *
+ * Returns: The newly created #GESTrackNestedSource
+ *
+ * Since: 0.10.2
+ */
+GESTrackNestedSource *
+ges_track_nested_source_new (GESTimelineSnapshot * snapshot,
+    const gchar * cache_uri)
+{
+  g_return_val_if_fail (snapshot != NULL, NULL);
+
+  return g_object_new (GES_TYPE_TRACK_NESTED_SOURCE, "snapshot", snapshot,
+      "cache-uri", cache_uri, NULL);
+}
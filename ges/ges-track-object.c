@@ -34,7 +34,9 @@
 #include "gesmarshal.h"
 #include "ges-track-object.h"
 #include "ges-timeline-object.h"
+#include "ges-track.h"
 #include <gobject/gvaluecollector.h>
+#include <string.h>
 
 G_DEFINE_ABSTRACT_TYPE (GESTrackObject, ges_track_object,
     G_TYPE_INITIALLY_UNOWNED);
@@ -63,8 +65,23 @@ struct _GESTrackObjectPrivate
 
   gboolean locked;              /* If TRUE, then moves in sync with its controlling
                                  * GESTimelineObject */
+
+  /* Processing statistics, only gathered when enabled */
+  gboolean stats_enabled;
+  GMutex *stats_lock;           /* Protects the fields below */
+  GESTrackObjectStats stats;
+  GstClockTime first_input;     /* When the oldest unprocessed input arrived */
+  GList *stats_probes;          /* List of StatsProbe */
+  gulong stats_pad_added_id;
+  gulong stats_pad_removed_id;
 };
 
+typedef struct
+{
+  GstPad *pad;
+  gulong id;
+} StatsProbe;
+
 enum
 {
   PROP_0,
@@ -128,6 +145,11 @@ ges_track_object_set_locked_internal (GESTrackObject * object, gboolean locked);
 static GParamSpec **default_list_children_properties (GESTrackObject * object,
     guint * n_properties);
 
+static void ges_track_object_changed (GESTrackObject * object,
+    GESChangeType type, gboolean notify);
+static void stats_install_probes (GESTrackObject * object);
+static void stats_remove_probes (GESTrackObject * object);
+
 static void
 ges_track_object_get_property (GObject * object, guint property_id,
     GValue * value, GParamSpec * pspec)
@@ -166,16 +188,24 @@ ges_track_object_set_property (GObject * object, guint property_id,
 
   switch (property_id) {
     case PROP_START:
-      ges_track_object_set_start_internal (tobj, g_value_get_uint64 (value));
+      if (ges_track_object_set_start_internal (tobj,
+              g_value_get_uint64 (value)))
+        ges_track_object_changed (tobj, GES_CHANGE_START, FALSE);
       break;
     case PROP_INPOINT:
-      ges_track_object_set_inpoint_internal (tobj, g_value_get_uint64 (value));
+      if (ges_track_object_set_inpoint_internal (tobj,
+              g_value_get_uint64 (value)))
+        ges_track_object_changed (tobj, GES_CHANGE_INPOINT, FALSE);
       break;
     case PROP_DURATION:
-      ges_track_object_set_duration_internal (tobj, g_value_get_uint64 (value));
+      if (ges_track_object_set_duration_internal (tobj,
+              g_value_get_uint64 (value)))
+        ges_track_object_changed (tobj, GES_CHANGE_DURATION, FALSE);
       break;
     case PROP_PRIORITY:
-      ges_track_object_set_priority_internal (tobj, g_value_get_uint (value));
+      if (ges_track_object_set_priority_internal (tobj,
+              g_value_get_uint (value)))
+        ges_track_object_changed (tobj, GES_CHANGE_PRIORITY, FALSE);
       break;
     case PROP_ACTIVE:
       ges_track_object_set_active (tobj, g_value_get_boolean (value));
@@ -195,15 +225,47 @@ ges_track_object_dispose (GObject * object)
   if (priv->properties_hashtable)
     g_hash_table_destroy (priv->properties_hashtable);
 
+  stats_remove_probes (GES_TRACK_OBJECT (object));
+
   G_OBJECT_CLASS (ges_track_object_parent_class)->dispose (object);
 }
 
 static void
 ges_track_object_finalize (GObject * object)
 {
+  GESTrackObjectPrivate *priv = GES_TRACK_OBJECT (object)->priv;
+
+  if (priv->stats_lock)
+    g_mutex_free (priv->stats_lock);
+
   G_OBJECT_CLASS (ges_track_object_parent_class)->finalize (object);
 }
 
+static void
+ges_track_object_dispatch_properties_changed (GObject * object,
+    guint n_pspecs, GParamSpec ** pspecs)
+{
+  GESTrackObject *tckobj = GES_TRACK_OBJECT (object);
+  guint i;
+
+  /* Timing and priority are derived from the controlling timeline object, so
+   * only the other properties make its snapshot record stale */
+  if (tckobj->priv->timelineobj) {
+    for (i = 0; i < n_pspecs; i++) {
+      if (pspecs[i] != properties[PROP_START] &&
+          pspecs[i] != properties[PROP_INPOINT] &&
+          pspecs[i] != properties[PROP_DURATION] &&
+          pspecs[i] != properties[PROP_PRIORITY]) {
+        ges_timeline_snapshot_object_changed (tckobj->priv->timelineobj);
+        break;
+      }
+    }
+  }
+
+  G_OBJECT_CLASS (ges_track_object_parent_class)->dispatch_properties_changed
+      (object, n_pspecs, pspecs);
+}
+
 static void
 ges_track_object_class_init (GESTrackObjectClass * klass)
 {
@@ -215,6 +277,8 @@ ges_track_object_class_init (GESTrackObjectClass * klass)
   object_class->set_property = ges_track_object_set_property;
   object_class->dispose = ges_track_object_dispose;
   object_class->finalize = ges_track_object_finalize;
+  object_class->dispatch_properties_changed =
+      ges_track_object_dispatch_properties_changed;
 
   /**
    * GESTrackObject:start
@@ -334,6 +398,38 @@ ges_track_object_init (GESTrackObject * self)
   self->priv->properties_hashtable = NULL;
 }
 
+/* Dispatches a change of @object to its timeline object and its track, and
+ * notifies it if @notify is %TRUE (else GObject does it). While the
+ * timeline is batching edits, the notifications of @object are held until
+ * the batch ends, so they are only emitted once per property. */
+static void
+ges_track_object_changed (GESTrackObject * object, GESChangeType type,
+    gboolean notify)
+{
+  static const guint props[] = { PROP_START, PROP_INPOINT, PROP_DURATION,
+    PROP_PRIORITY
+  };
+  GESTrack *track = object->priv->track;
+  GESTimeline *timeline;
+
+  if (track && (timeline = ges_track_get_timeline (track)))
+    ges_timeline_hold_notify (timeline, G_OBJECT (object));
+
+  if (object->priv->timelineobj)
+    ges_timeline_object_track_object_changed (object->priv->timelineobj,
+        object, type);
+  if (track)
+    ges_track_track_object_changed (track, object, type);
+
+  if (notify)
+#if GLIB_CHECK_VERSION(2,26,0)
+    g_object_notify_by_pspec (G_OBJECT (object), properties[props[type]]);
+#else
+    g_object_notify (G_OBJECT (object),
+        g_param_spec_get_name (properties[props[type]]));
+#endif
+}
+
 static inline gboolean
 ges_track_object_set_start_internal (GESTrackObject * object, guint64 start)
 {
@@ -361,11 +457,7 @@ void
 ges_track_object_set_start (GESTrackObject * object, guint64 start)
 {
   if (ges_track_object_set_start_internal (object, start))
-#if GLIB_CHECK_VERSION(2,26,0)
-    g_object_notify_by_pspec (G_OBJECT (object), properties[PROP_START]);
-#else
-    g_object_notify (G_OBJECT (object), "start");
-#endif
+    ges_track_object_changed (object, GES_CHANGE_START, TRUE);
 }
 
 static inline gboolean
@@ -397,11 +489,7 @@ void
 ges_track_object_set_inpoint (GESTrackObject * object, guint64 inpoint)
 {
   if (ges_track_object_set_inpoint_internal (object, inpoint))
-#if GLIB_CHECK_VERSION(2,26,0)
-    g_object_notify_by_pspec (G_OBJECT (object), properties[PROP_INPOINT]);
-#else
-    g_object_notify (G_OBJECT (object), "in-point");
-#endif
+    ges_track_object_changed (object, GES_CHANGE_INPOINT, TRUE);
 }
 
 static inline gboolean
@@ -434,11 +522,7 @@ void
 ges_track_object_set_duration (GESTrackObject * object, guint64 duration)
 {
   if (ges_track_object_set_duration_internal (object, duration))
-#if GLIB_CHECK_VERSION(2,26,0)
-    g_object_notify_by_pspec (G_OBJECT (object), properties[PROP_DURATION]);
-#else
-    g_object_notify (G_OBJECT (object), "duration");
-#endif
+    ges_track_object_changed (object, GES_CHANGE_DURATION, TRUE);
 }
 
 static inline gboolean
@@ -474,11 +558,7 @@ void
 ges_track_object_set_priority (GESTrackObject * object, guint32 priority)
 {
   if (ges_track_object_set_priority_internal (object, priority))
-#if GLIB_CHECK_VERSION(2,26,0)
-    g_object_notify_by_pspec (G_OBJECT (object), properties[PROP_PRIORITY]);
-#else
-    g_object_notify (G_OBJECT (object), "priority");
-#endif
+    ges_track_object_changed (object, GES_CHANGE_PRIORITY, TRUE);
 }
 
 
@@ -504,6 +584,8 @@ ges_track_object_set_active (GESTrackObject * object, gboolean active)
     g_object_set (object->priv->gnlobject, "active", active, NULL);
   } else
     object->priv->pending_active = active;
+  if (object->priv->timelineobj)
+    ges_timeline_snapshot_object_changed (object->priv->timelineobj);
   return TRUE;
 }
 
@@ -642,6 +724,9 @@ gnlobject_active_cb (GstElement * gnlobject, GParamSpec * arg G_GNUC_UNUSED,
     obj->active = active;
     if (klass->active_changed)
       klass->active_changed (obj, active);
+    if (obj->priv->track)
+      ges_track_track_object_changed (obj->priv->track, obj,
+          GES_CHANGE_ACTIVE);
   }
 }
 
@@ -677,6 +762,17 @@ ges_track_object_create_gnl_object_func (GESTrackObject * self)
     if (G_UNLIKELY (!child))
       goto child_failure;
 
+    /* Get rid of the colourspace conversions the track doesn't need */
+    if (GST_IS_BIN (child) && self->priv->track &&
+        self->priv->track->type == GES_TRACK_TYPE_VIDEO) {
+      guint removed;
+
+      removed = ges_bin_remove_redundant_converters (GST_BIN (child),
+          ges_track_get_caps (self->priv->track));
+      GST_DEBUG ("Removed %d redundant converters from %s", removed,
+          GST_ELEMENT_NAME (child));
+    }
+
     if (!gst_bin_add (GST_BIN (gnlobject), child))
       goto add_failure;
 
@@ -803,6 +899,9 @@ ensure_gnl_object (GESTrackObject * object)
           connect_properties_signals (object);
         }
       }
+
+      if (object->priv->stats_enabled)
+        stats_install_probes (object);
     }
   }
 
@@ -844,6 +943,8 @@ ges_track_object_set_track (GESTrackObject * object, GESTrack * track)
   GST_DEBUG ("object:%p, track:%p", object, track);
 
   object->priv->track = track;
+  if (object->priv->timelineobj)
+    ges_timeline_snapshot_object_changed (object->priv->timelineobj);
 
   if (object->priv->track)
     return ensure_gnl_object (object);
@@ -1156,6 +1257,8 @@ ges_track_object_set_child_property_by_pspec (GESTrackObject * object,
     goto not_found;
 
   g_object_set_property (G_OBJECT (element), pspec->name, value);
+  if (priv->timelineobj)
+    ges_timeline_snapshot_object_changed (priv->timelineobj);
 
   return;
 
@@ -1220,6 +1323,8 @@ ges_track_object_set_child_property_valist (GESTrackObject * object,
       goto cant_copy;
 
     g_object_set_property (G_OBJECT (element), pspec->name, &value);
+    if (object->priv->timelineobj)
+      ges_timeline_snapshot_object_changed (object->priv->timelineobj);
 
     g_object_unref (element);
     g_value_unset (&value);
@@ -1479,3 +1584,288 @@ ges_track_object_trim_start (GESTrackObject * object, guint64 position)
 
   return class->trim_start (object, position);
 }
+
+/* Statistics
+ *
+ * The buffers leaving the gnlobject are counted by a probe on its source
+ * pad, which also sees the QoS events coming back from the sinks. For
+ * objects with inputs (effects, transitions) the latency of a buffer is the
+ * time between the arrival of the first input buffer it is made from and
+ * its output, both probes running before the buffer is pushed further.
+ * Sources have no input to measure from: the time between two of their
+ * outputs also covers waiting on full queues or paused sinks downstream, so
+ * no latency is reported for them. */
+
+static void
+stats_reset_timing (GESTrackObjectPrivate * priv)
+{
+  priv->first_input = GST_CLOCK_TIME_NONE;
+}
+
+static gboolean
+stats_input_probe (GstPad * pad, GstBuffer * buffer, GESTrackObject * object)
+{
+  GESTrackObjectPrivate *priv = object->priv;
+
+  g_mutex_lock (priv->stats_lock);
+  if (!GST_CLOCK_TIME_IS_VALID (priv->first_input))
+    priv->first_input = gst_util_get_timestamp ();
+  g_mutex_unlock (priv->stats_lock);
+
+  return TRUE;
+}
+
+static gboolean
+stats_output_probe (GstPad * pad, GstMiniObject * obj,
+    GESTrackObject * object)
+{
+  GESTrackObjectPrivate *priv = object->priv;
+  GstClockTime latency;
+
+  if (GST_IS_EVENT (obj)) {
+    GstEvent *event = GST_EVENT_CAST (obj);
+
+    g_mutex_lock (priv->stats_lock);
+    switch (GST_EVENT_TYPE (event)) {
+      case GST_EVENT_FLUSH_STOP:
+      case GST_EVENT_NEWSEGMENT:
+        stats_reset_timing (priv);
+        break;
+      case GST_EVENT_QOS:{
+        GstClockTimeDiff diff;
+
+        /* A sink got one of our buffers too late */
+        gst_event_parse_qos (event, NULL, &diff, NULL);
+        if (diff > 0)
+          priv->stats.dropped++;
+        break;
+      }
+      default:
+        break;
+    }
+    g_mutex_unlock (priv->stats_lock);
+
+    return TRUE;
+  }
+
+  g_mutex_lock (priv->stats_lock);
+  if (GST_CLOCK_TIME_IS_VALID (priv->first_input)) {
+    latency = gst_util_get_timestamp () - priv->first_input;
+    priv->stats.total_latency += latency;
+    priv->stats.peak_latency = MAX (priv->stats.peak_latency, latency);
+  }
+  priv->stats.buffers++;
+  priv->first_input = GST_CLOCK_TIME_NONE;
+  g_mutex_unlock (priv->stats_lock);
+
+  return TRUE;
+}
+
+static void
+stats_probe_free (StatsProbe * probe)
+{
+  if (GST_PAD_IS_SRC (probe->pad))
+    gst_pad_remove_data_probe (probe->pad, probe->id);
+  else
+    gst_pad_remove_buffer_probe (probe->pad, probe->id);
+  gst_object_unref (probe->pad);
+  g_slice_free (StatsProbe, probe);
+}
+
+static void
+stats_probe_pad (GESTrackObject * object, GstPad * pad)
+{
+  StatsProbe *probe = g_slice_new (StatsProbe);
+
+  probe->pad = gst_object_ref (pad);
+  if (GST_PAD_IS_SRC (pad))
+    probe->id = gst_pad_add_data_probe (pad,
+        G_CALLBACK (stats_output_probe), object);
+  else
+    probe->id = gst_pad_add_buffer_probe (pad,
+        G_CALLBACK (stats_input_probe), object);
+
+  g_mutex_lock (object->priv->stats_lock);
+  object->priv->stats_probes =
+      g_list_prepend (object->priv->stats_probes, probe);
+  g_mutex_unlock (object->priv->stats_lock);
+}
+
+static void
+stats_pad_added_cb (GstElement * gnlobject, GstPad * pad,
+    GESTrackObject * object)
+{
+  GST_DEBUG ("Watching new pad %s:%s", GST_DEBUG_PAD_NAME (pad));
+
+  stats_probe_pad (object, pad);
+}
+
+static void
+stats_pad_removed_cb (GstElement * gnlobject, GstPad * pad,
+    GESTrackObject * object)
+{
+  GESTrackObjectPrivate *priv = object->priv;
+  StatsProbe *probe = NULL;
+  GList *tmp;
+
+  g_mutex_lock (priv->stats_lock);
+  for (tmp = priv->stats_probes; tmp; tmp = tmp->next) {
+    if (((StatsProbe *) tmp->data)->pad == pad) {
+      probe = (StatsProbe *) tmp->data;
+      priv->stats_probes = g_list_delete_link (priv->stats_probes, tmp);
+      break;
+    }
+  }
+  g_mutex_unlock (priv->stats_lock);
+
+  if (probe) {
+    GST_DEBUG ("Pad %s:%s went away", GST_DEBUG_PAD_NAME (pad));
+    stats_probe_free (probe);
+  }
+}
+
+static void
+stats_install_probes (GESTrackObject * object)
+{
+  GstIterator *it;
+  gpointer pad;
+  gboolean done = FALSE;
+
+  /* The gnlobject pads come and go with its content */
+  object->priv->stats_pad_added_id =
+      g_signal_connect (object->priv->gnlobject, "pad-added",
+      G_CALLBACK (stats_pad_added_cb), object);
+  object->priv->stats_pad_removed_id =
+      g_signal_connect (object->priv->gnlobject, "pad-removed",
+      G_CALLBACK (stats_pad_removed_cb), object);
+
+  it = gst_element_iterate_pads (object->priv->gnlobject);
+  while (!done) {
+    switch (gst_iterator_next (it, &pad)) {
+      case GST_ITERATOR_OK:
+        stats_probe_pad (object, (GstPad *) pad);
+        gst_object_unref (pad);
+        break;
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync (it);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  gst_iterator_free (it);
+}
+
+static void
+stats_remove_probes (GESTrackObject * object)
+{
+  GESTrackObjectPrivate *priv = object->priv;
+  GList *probes;
+
+  if (priv->stats_pad_added_id) {
+    g_signal_handler_disconnect (priv->gnlobject, priv->stats_pad_added_id);
+    priv->stats_pad_added_id = 0;
+  }
+  if (priv->stats_pad_removed_id) {
+    g_signal_handler_disconnect (priv->gnlobject, priv->stats_pad_removed_id);
+    priv->stats_pad_removed_id = 0;
+  }
+
+  if (!priv->stats_lock)
+    return;
+
+  g_mutex_lock (priv->stats_lock);
+  probes = priv->stats_probes;
+  priv->stats_probes = NULL;
+  g_mutex_unlock (priv->stats_lock);
+
+  g_list_foreach (probes, (GFunc) stats_probe_free, NULL);
+  g_list_free (probes);
+}
+
+/**
+ * ges_track_object_set_stats_enabled:
+ * @object: a #GESTrackObject
+ * @enabled: whether to gather processing statistics
+ *
+ * Starts or stops gathering processing statistics on @object, to be
+ * retrieved with ges_track_object_get_stats(). Enabling them resets the
+ * statistics. Nothing is measured while disabled, which is the default.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_track_object_set_stats_enabled (GESTrackObject * object, gboolean enabled)
+{
+  GESTrackObjectPrivate *priv;
+
+  g_return_if_fail (GES_IS_TRACK_OBJECT (object));
+
+  priv = object->priv;
+  if (priv->stats_enabled == enabled)
+    return;
+
+  GST_DEBUG ("object:%p, enabled:%d", object, enabled);
+
+  priv->stats_enabled = enabled;
+  if (enabled) {
+    if (!priv->stats_lock)
+      priv->stats_lock = g_mutex_new ();
+    memset (&priv->stats, 0, sizeof (GESTrackObjectStats));
+    stats_reset_timing (priv);
+
+    if (priv->gnlobject)
+      stats_install_probes (object);
+  } else
+    stats_remove_probes (object);
+}
+
+/**
+ * ges_track_object_get_stats_enabled:
+ * @object: a #GESTrackObject
+ *
+ * Returns: %TRUE if processing statistics are gathered on @object.
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_track_object_get_stats_enabled (GESTrackObject * object)
+{
+  g_return_val_if_fail (GES_IS_TRACK_OBJECT (object), FALSE);
+
+  return object->priv->stats_enabled;
+}
+
+/**
+ * ges_track_object_get_stats:
+ * @object: a #GESTrackObject
+ * @stats: (out): the #GESTrackObjectStats to fill
+ *
+ * Gets a snapshot of the processing statistics of @object, gathered since
+ * they were enabled with ges_track_object_set_stats_enabled().
+ *
+ * Returns: %TRUE if @stats was filled, %FALSE if statistics aren't enabled
+ * on @object.
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_track_object_get_stats (GESTrackObject * object,
+    GESTrackObjectStats * stats)
+{
+  GESTrackObjectPrivate *priv;
+
+  g_return_val_if_fail (GES_IS_TRACK_OBJECT (object), FALSE);
+  g_return_val_if_fail (stats != NULL, FALSE);
+
+  priv = object->priv;
+  if (!priv->stats_enabled)
+    return FALSE;
+
+  g_mutex_lock (priv->stats_lock);
+  *stats = priv->stats;
+  g_mutex_unlock (priv->stats_lock);
+
+  return TRUE;
+}
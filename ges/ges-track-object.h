@@ -147,6 +147,29 @@ struct _GESTrackObjectClass {
   gpointer _ges_reserved[GES_PADDING - 2];
 };
 
+/**
+ * GESTrackObjectStats:
+ * @buffers: number of buffers output by the object
+ * @dropped: number of those buffers the sinks reported as late
+ * @total_latency: cumulated latency of the buffers, in nanoseconds
+ * @peak_latency: highest latency of a buffer, in nanoseconds
+ *
+ * Processing statistics of a #GESTrackObject, see
+ * ges_track_object_get_stats().
+ *
+ * For objects with inputs (effects, transitions) the latency of a buffer is
+ * the time between the arrival of the first input buffer it is made from
+ * and its output. Sources have no input, and always report a latency of 0.
+ *
+ * Since: 0.10.2
+ */
+struct _GESTrackObjectStats {
+  guint64 buffers;
+  guint64 dropped;
+  GstClockTime total_latency;
+  GstClockTime peak_latency;
+};
+
 GType ges_track_object_get_type (void);
 
 gboolean ges_track_object_set_track  (GESTrackObject * object,
@@ -213,5 +236,11 @@ void ges_track_object_set_child_property (GESTrackObject * object,
 gboolean ges_track_object_trim_start (GESTrackObject * object,
                                       guint64 position);
 
+void     ges_track_object_set_stats_enabled (GESTrackObject * object,
+                                             gboolean enabled);
+gboolean ges_track_object_get_stats_enabled (GESTrackObject * object);
+gboolean ges_track_object_get_stats         (GESTrackObject * object,
+                                             GESTrackObjectStats * stats);
+
 G_END_DECLS
 #endif /* _GES_TRACK_OBJECT */
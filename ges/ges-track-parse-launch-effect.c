@@ -25,6 +25,7 @@
  * @Since: 0.10.2
  */
 
+#include <string.h>
 #include "ges-internal.h"
 #include "ges-track-object.h"
 #include "ges-track-effect.h"
@@ -49,6 +50,28 @@ enum
   PROP_BIN_DESCRIPTION,
 };
 
+typedef struct
+{
+  GstElementFactory *factory;
+  gchar *name;
+  guint n_params;
+  GParameter *params;
+} TemplateElement;
+
+/* The elements of an effect bin which is a single chain, in the order they
+ * are linked, with the properties its description set on them */
+typedef struct
+{
+  guint n_elements;
+  TemplateElement *elements;
+} EffectTemplate;
+
+/* Templates of the effect bins parsed so far, by bin description, or NULL
+ * for the ones which can't be rebuilt from a template. Like the registry
+ * they come from, they are kept until the process exits. */
+static GHashTable *templates = NULL;
+G_LOCK_DEFINE_STATIC (templates);
+
 static void
 ges_track_parse_launch_effect_get_property (GObject * object,
     guint property_id, GValue * value, GParamSpec * pspec)
@@ -140,10 +163,208 @@ ges_track_parse_launch_effect_finalize (GObject * object)
       (object);
 }
 
+/* Effect templates */
+
+static void
+template_element_clear (TemplateElement * telement)
+{
+  guint n;
+
+  if (telement->factory)
+    gst_object_unref (telement->factory);
+  g_free (telement->name);
+  for (n = 0; n < telement->n_params; n++)
+    g_value_unset (&telement->params[n].value);
+  g_free (telement->params);
+}
+
+static gboolean
+template_element_init (TemplateElement * telement, GstElement * element)
+{
+  GParamSpec **specs;
+  guint n, n_specs;
+  gboolean ret = TRUE;
+
+  if (!(telement->factory = gst_element_get_factory (element)))
+    return FALSE;
+
+  gst_object_ref (telement->factory);
+  telement->name = gst_object_get_name (GST_OBJECT (element));
+
+  specs = g_object_class_list_properties (G_OBJECT_GET_CLASS (element),
+      &n_specs);
+  telement->params = g_new0 (GParameter, n_specs);
+
+  for (n = 0; n < n_specs && ret; n++) {
+    GParameter *param = &telement->params[telement->n_params];
+
+    if ((specs[n]->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE ||
+        !strcmp (specs[n]->name, "name"))
+      continue;
+
+    g_value_init (&param->value, specs[n]->value_type);
+    g_object_get_property (G_OBJECT (element), specs[n]->name, &param->value);
+
+    if (g_param_value_defaults (specs[n], &param->value)) {
+      g_value_unset (&param->value);
+      continue;
+    }
+
+    /* Those can't be set after creation, or shared with another element */
+    if ((specs[n]->flags & G_PARAM_CONSTRUCT_ONLY) ||
+        G_VALUE_HOLDS_OBJECT (&param->value) ||
+        G_VALUE_HOLDS_POINTER (&param->value)) {
+      GST_DEBUG ("Can't template property %s of %s", specs[n]->name,
+          telement->name);
+      g_value_unset (&param->value);
+      ret = FALSE;
+      continue;
+    }
+
+    param->name = g_intern_string (specs[n]->name);
+    telement->n_params++;
+  }
+
+  g_free (specs);
+
+  return ret;
+}
+
+static gboolean
+pad_is_always (GstPad * pad)
+{
+  GstPadTemplate *templ = GST_PAD_PAD_TEMPLATE (pad);
+
+  return templ && GST_PAD_TEMPLATE_PRESENCE (templ) == GST_PAD_ALWAYS;
+}
+
+static void
+effect_template_free (EffectTemplate * template)
+{
+  guint n;
+
+  if (template == NULL)
+    return;
+
+  for (n = 0; n < template->n_elements; n++)
+    template_element_clear (&template->elements[n]);
+  g_free (template->elements);
+  g_slice_free (EffectTemplate, template);
+}
+
+/* Records the chain of elements of a freshly parsed @bin, or returns NULL if
+ * it isn't a single chain of elements with static pads */
+static EffectTemplate *
+effect_template_new (GstElement * bin)
+{
+  EffectTemplate *template;
+  GArray *elements;
+  GstElement *element = NULL;
+  GstPad *pad, *peer;
+
+  elements = g_array_new (FALSE, TRUE, sizeof (TemplateElement));
+
+  if ((pad = gst_element_get_static_pad (bin, "sink"))) {
+    if ((peer = gst_ghost_pad_get_target (GST_GHOST_PAD (pad)))) {
+      element = gst_pad_get_parent_element (peer);
+      gst_object_unref (peer);
+    }
+    gst_object_unref (pad);
+  }
+
+  while (element) {
+    TemplateElement telement = { 0, };
+
+    if (element->numsinkpads != 1 || element->numsrcpads != 1 ||
+        !pad_is_always (element->sinkpads->data) ||
+        !pad_is_always (element->srcpads->data) ||
+        !template_element_init (&telement, element)) {
+      template_element_clear (&telement);
+      gst_object_unref (element);
+      goto not_a_chain;
+    }
+    g_array_append_val (elements, telement);
+
+    /* The last one is linked to the src ghost pad, which has no element */
+    peer = gst_pad_get_peer (element->srcpads->data);
+    gst_object_unref (element);
+    element = NULL;
+    if (peer) {
+      element = gst_pad_get_parent_element (peer);
+      gst_object_unref (peer);
+    }
+  }
+
+  if (elements->len == 0 || elements->len != GST_BIN_NUMCHILDREN (bin))
+    goto not_a_chain;
+
+  template = g_slice_new0 (EffectTemplate);
+  template->n_elements = elements->len;
+  template->elements = (TemplateElement *) g_array_free (elements, FALSE);
+
+  return template;
+
+not_a_chain:
+  {
+    guint n;
+
+    for (n = 0; n < elements->len; n++)
+      template_element_clear (&g_array_index (elements, TemplateElement, n));
+    g_array_free (elements, TRUE);
+
+    return NULL;
+  }
+}
+
+/* Builds the same bin as gst_parse_bin_from_description() would, without
+ * parsing the description and looking the elements up again */
+static GstElement *
+effect_template_create_bin (EffectTemplate * template)
+{
+  GstElement *bin, *element, *first = NULL, *last = NULL;
+  guint n, i;
+
+  bin = gst_bin_new (NULL);
+
+  for (n = 0; n < template->n_elements; n++) {
+    TemplateElement *telement = &template->elements[n];
+
+    element = gst_element_factory_create (telement->factory, telement->name);
+    if (G_UNLIKELY (element == NULL))
+      goto fail;
+
+    for (i = 0; i < telement->n_params; i++)
+      g_object_set_property (G_OBJECT (element), telement->params[i].name,
+          &telement->params[i].value);
+
+    gst_bin_add (GST_BIN (bin), element);
+    if (last && !gst_element_link (last, element))
+      goto fail;
+
+    if (first == NULL)
+      first = element;
+    last = element;
+  }
+
+  gst_element_add_pad (bin, gst_ghost_pad_new ("sink", first->sinkpads->data));
+  gst_element_add_pad (bin, gst_ghost_pad_new ("src", last->srcpads->data));
+
+  return bin;
+
+fail:
+  {
+    GST_WARNING ("Couldn't create an effect bin from its template");
+    gst_object_unref (bin);
+    return NULL;
+  }
+}
+
 static GstElement *
 ges_track_parse_launch_effect_create_element (GESTrackObject * object)
 {
   GstElement *effect;
+  EffectTemplate *template = NULL;
+  gboolean known;
   gchar *bin_desc;
 
   GError *error = NULL;
@@ -170,17 +391,47 @@ ges_track_parse_launch_effect_create_element (GESTrackObject * object)
     return NULL;
   }
 
-  effect = gst_parse_bin_from_description (bin_desc, TRUE, &error);
+  G_LOCK (templates);
+  if (G_UNLIKELY (templates == NULL))
+    templates = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+        (GDestroyNotify) effect_template_free);
+  known = g_hash_table_lookup_extended (templates, bin_desc, NULL,
+      (gpointer *) & template);
+  G_UNLOCK (templates);
 
-  g_free (bin_desc);
+  /* Templates are never removed, they can be used without the lock */
+  if (template && (effect = effect_template_create_bin (template))) {
+    GST_DEBUG ("Created effect %p from its template", effect);
+    g_free (bin_desc);
+    return effect;
+  }
+
+  effect = gst_parse_bin_from_description (bin_desc, TRUE, &error);
 
   if (error != NULL) {
     GST_ERROR ("An error occured while creating the GstElement: %s",
         error->message);
     g_error_free (error);
+    g_free (bin_desc);
     return NULL;
   }
 
+  if (!known) {
+    template = effect_template_new (effect);
+
+    G_LOCK (templates);
+    if (!g_hash_table_lookup_extended (templates, bin_desc, NULL, NULL)) {
+      g_hash_table_insert (templates, bin_desc, template);
+      bin_desc = NULL;
+      template = NULL;
+    }
+    G_UNLOCK (templates);
+
+    effect_template_free (template);
+  }
+
+  g_free (bin_desc);
+
   GST_DEBUG ("Created effect %p", effect);
 
   return effect;
@@ -31,11 +31,42 @@
 
 #include "ges-internal.h"
 #include "ges-track.h"
+#include "ges-timeline.h"
 #include "ges-track-object.h"
+#include "ges-timeline-layer.h"
+#include "ges-track-filesource.h"
 #include "gesmarshal.h"
 
 G_DEFINE_TYPE (GESTrack, ges_track, GST_TYPE_BIN);
 
+#define DEFAULT_LOOKAHEAD_WINDOW (5 * GST_SECOND)
+#define DEFAULT_LOOKAHEAD_MEMORY (64 * 1024 * 1024)
+
+/* A single source standing in for a run of contiguous file sources */
+typedef struct
+{
+  GstElement *gnlobject;
+  GList *members;               /* The GESTrackObject-s it stands in for */
+  GstClockTime start;
+  GstClockTime stop;
+  GstClockTime media_stop;
+} MergedSource;
+
+/* A single operation running a chain of effects of a timeline object */
+typedef struct
+{
+  GstElement *gnlobject;
+  GstElement *chain;            /* The bin in gnlobject */
+  GList *members;               /* The GESTrackEffect-s, top one first */
+  GList *elements;              /* Their elements */
+  gboolean swapped;             /* Whether the members are out of the
+                                 * composition */
+  GstClockTime start;
+  GstClockTime duration;
+  GstClockTime inpoint;
+  guint32 priority;
+} FusedEffects;
+
 struct _GESTrackPrivate
 {
   /*< private > */
@@ -48,6 +79,35 @@ struct _GESTrackPrivate
   GstElement *composition;      /* The composition associated with this track */
   GstElement *background;       /* The backgrond, handle the gaps in the track */
   GstPad *srcpad;               /* The source GhostPad */
+
+  gboolean muted;
+  gboolean solo;
+  GHashTable *muted_objects;    /* TrackObjects whose gnlobject was taken out
+                                 * of the composition */
+
+  /* While batching, re-sorting the objects is delayed until they are
+   * looked at */
+  gboolean batch;
+  gboolean sort_pending;
+
+  gboolean share_decoders;
+  GList *merged;                /* MergedSource-s standing in for runs of
+                                 * contiguous file sources */
+  guint merge_source_id;        /* Pending merge update */
+
+  gboolean fuse_effects;
+  GList *fused;                 /* FusedEffects-s standing in for chains of
+                                 * effects */
+  guint fuse_source_id;         /* Pending fusion update */
+
+  /* Look-ahead pre-rolling, the position is protected by the object lock */
+  guint lookahead_sources;
+  GstClockTime lookahead_window;
+  guint64 lookahead_memory;
+  GHashTable *prerolls;         /* "in-point URI" -> Preroll */
+  GstClockTime position;        /* Last position output */
+  GstClockTime next_lookahead;  /* Position of the next update */
+  gboolean lookahead_pending;
 };
 
 enum
@@ -56,6 +116,13 @@ enum
   ARG_CAPS,
   ARG_TYPE,
   ARG_DURATION,
+  ARG_MUTED,
+  ARG_SOLO,
+  ARG_SHARE_DECODERS,
+  ARG_FUSE_EFFECTS,
+  ARG_LOOKAHEAD_SOURCES,
+  ARG_LOOKAHEAD_WINDOW,
+  ARG_LOOKAHEAD_MEMORY,
   ARG_LAST,
   TRACK_OBJECT_ADDED,
   TRACK_OBJECT_REMOVED,
@@ -77,6 +144,23 @@ sort_track_objects_cb (GESTrackObject * child,
 
 static void timeline_duration_cb (GESTimeline * timeline,
     GParamSpec * arg G_GNUC_UNUSED, GESTrack * track);
+static void ges_track_report_conversions (GESTrack * track);
+static gboolean track_object_is_audible (GESTrack * track,
+    GESTrackObject * object);
+static gboolean lookahead_probe (GstPad * pad, GstBuffer * buffer,
+    GESTrack * track);
+static void lookahead_drop (GESTrack * track, GESTrackObject * object);
+static void lookahead_schedule (GESTrack * track);
+static void track_objects_ensure_sorted (GESTrack * track);
+static void share_decoders_dissolve (GESTrack * track,
+    GESTrackObject * object);
+static void share_decoders_schedule (GESTrack * track);
+static void share_decoders_object_changed_cb (GESTrackObject * object,
+    GParamSpec * arg G_GNUC_UNUSED, GESTrack * track);
+static void fuse_effects_dissolve (GESTrack * track, GESTrackObject * object);
+static void fuse_effects_schedule (GESTrack * track);
+static void fuse_effects_object_changed (GESTrack * track,
+    GESTrackObject * object, GESChangeType type);
 
 static void
 ges_track_get_property (GObject * object, guint property_id,
@@ -94,6 +178,27 @@ ges_track_get_property (GObject * object, guint property_id,
     case ARG_DURATION:
       g_value_set_uint64 (value, track->priv->duration);
       break;
+    case ARG_MUTED:
+      g_value_set_boolean (value, track->priv->muted);
+      break;
+    case ARG_SOLO:
+      g_value_set_boolean (value, track->priv->solo);
+      break;
+    case ARG_SHARE_DECODERS:
+      g_value_set_boolean (value, track->priv->share_decoders);
+      break;
+    case ARG_FUSE_EFFECTS:
+      g_value_set_boolean (value, track->priv->fuse_effects);
+      break;
+    case ARG_LOOKAHEAD_SOURCES:
+      g_value_set_uint (value, track->priv->lookahead_sources);
+      break;
+    case ARG_LOOKAHEAD_WINDOW:
+      g_value_set_uint64 (value, track->priv->lookahead_window);
+      break;
+    case ARG_LOOKAHEAD_MEMORY:
+      g_value_set_uint64 (value, track->priv->lookahead_memory);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -112,6 +217,30 @@ ges_track_set_property (GObject * object, guint property_id,
     case ARG_TYPE:
       track->type = g_value_get_flags (value);
       break;
+    case ARG_MUTED:
+      ges_track_set_muted (track, g_value_get_boolean (value));
+      break;
+    case ARG_SOLO:
+      ges_track_set_solo (track, g_value_get_boolean (value));
+      break;
+    case ARG_SHARE_DECODERS:
+      ges_track_set_share_decoders (track, g_value_get_boolean (value));
+      break;
+    case ARG_FUSE_EFFECTS:
+      ges_track_set_fuse_effects (track, g_value_get_boolean (value));
+      break;
+    case ARG_LOOKAHEAD_SOURCES:
+      ges_track_set_lookahead (track, g_value_get_uint (value),
+          track->priv->lookahead_window, track->priv->lookahead_memory);
+      break;
+    case ARG_LOOKAHEAD_WINDOW:
+      ges_track_set_lookahead (track, track->priv->lookahead_sources,
+          g_value_get_uint64 (value), track->priv->lookahead_memory);
+      break;
+    case ARG_LOOKAHEAD_MEMORY:
+      ges_track_set_lookahead (track, track->priv->lookahead_sources,
+          track->priv->lookahead_window, g_value_get_uint64 (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -123,6 +252,20 @@ ges_track_dispose (GObject * object)
   GESTrack *track = (GESTrack *) object;
   GESTrackPrivate *priv = track->priv;
 
+  priv->share_decoders = FALSE;
+  if (priv->merge_source_id) {
+    g_source_remove (priv->merge_source_id);
+    priv->merge_source_id = 0;
+  }
+  share_decoders_dissolve (track, NULL);
+
+  priv->fuse_effects = FALSE;
+  if (priv->fuse_source_id) {
+    g_source_remove (priv->fuse_source_id);
+    priv->fuse_source_id = 0;
+  }
+  fuse_effects_dissolve (track, NULL);
+
   while (priv->trackobjects) {
     GESTrackObject *trobj = GES_TRACK_OBJECT (priv->trackobjects->data);
     ges_track_remove_object (track, trobj);
@@ -130,6 +273,8 @@ ges_track_dispose (GObject * object)
         ges_track_object_get_timeline_object (trobj), trobj);
   }
 
+  lookahead_drop (track, NULL);
+
   if (priv->composition) {
     gst_bin_remove (GST_BIN (object), priv->composition);
     priv->composition = NULL;
@@ -188,16 +333,47 @@ ges_track_constructed (GObject * object)
 static void
 ges_track_finalize (GObject * object)
 {
+  GESTrack *track = (GESTrack *) object;
+
+  g_hash_table_destroy (track->priv->prerolls);
+  g_hash_table_destroy (track->priv->muted_objects);
+
   G_OBJECT_CLASS (ges_track_parent_class)->finalize (object);
 }
 
+static GstStateChangeReturn
+ges_track_change_state (GstElement * element, GstStateChange transition)
+{
+  GESTrack *track = GES_TRACK (element);
+  GstStateChangeReturn ret;
+
+  ret = GST_ELEMENT_CLASS (ges_track_parent_class)->change_state (element,
+      transition);
+
+  if (transition == GST_STATE_CHANGE_READY_TO_PAUSED)
+    ges_track_report_conversions (track);
+
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY) {
+    lookahead_drop (track, NULL);
+    GST_OBJECT_LOCK (track);
+    track->priv->position = GST_CLOCK_TIME_NONE;
+    track->priv->next_lookahead = GST_CLOCK_TIME_NONE;
+    GST_OBJECT_UNLOCK (track);
+  }
+
+  return ret;
+}
+
 static void
 ges_track_class_init (GESTrackClass * klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
 
   g_type_class_add_private (klass, sizeof (GESTrackPrivate));
 
+  element_class->change_state = GST_DEBUG_FUNCPTR (ges_track_change_state);
+
   object_class->get_property = ges_track_get_property;
   object_class->set_property = ges_track_set_property;
   object_class->dispose = ges_track_dispose;
@@ -248,6 +424,108 @@ ges_track_class_init (GESTrackClass * klass)
   g_object_class_install_property (object_class, ARG_TYPE,
       properties[ARG_TYPE]);
 
+  /**
+   * GESTrack:muted
+   *
+   * Whether the track is muted. The #GESTrackObject(s) of a muted track are
+   * taken out of its composition, so they don't use any resources until the
+   * track is unmuted.
+   *
+   * Since: 0.10.2
+   */
+  properties[ARG_MUTED] = g_param_spec_boolean ("muted", "Muted",
+      "Whether the track is muted", FALSE, G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, ARG_MUTED,
+      properties[ARG_MUTED]);
+
+  /**
+   * GESTrack:solo
+   *
+   * Whether the track is soloed. When at least one track of a timeline is
+   * soloed, the #GESTrackObject(s) of its other tracks are taken out of
+   * their compositions.
+   *
+   * Since: 0.10.2
+   */
+  properties[ARG_SOLO] = g_param_spec_boolean ("solo", "Solo",
+      "Whether the track is soloed", FALSE, G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, ARG_SOLO,
+      properties[ARG_SOLO]);
+
+  /**
+   * GESTrack:share-decoders
+   *
+   * Whether back-to-back clips of the same file should share a decoder.
+   * See ges_track_set_share_decoders().
+   *
+   * Since: 0.10.2
+   */
+  properties[ARG_SHARE_DECODERS] =
+      g_param_spec_boolean ("share-decoders", "Share decoders",
+      "Whether back-to-back clips of the same file share a decoder", FALSE,
+      G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, ARG_SHARE_DECODERS,
+      properties[ARG_SHARE_DECODERS]);
+
+  /**
+   * GESTrack:fuse-effects
+   *
+   * Whether the effects of a clip should run in a single operation.
+   * See ges_track_set_fuse_effects().
+   *
+   * Since: 0.10.2
+   */
+  properties[ARG_FUSE_EFFECTS] =
+      g_param_spec_boolean ("fuse-effects", "Fuse effects",
+      "Whether the effects of a clip run in a single operation", FALSE,
+      G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, ARG_FUSE_EFFECTS,
+      properties[ARG_FUSE_EFFECTS]);
+
+  /**
+   * GESTrack:lookahead-sources
+   *
+   * Number of upcoming file sources to pre-roll while the track is playing,
+   * 0 disables pre-rolling. See ges_track_set_lookahead().
+   *
+   * Since: 0.10.2
+   */
+  properties[ARG_LOOKAHEAD_SOURCES] =
+      g_param_spec_uint ("lookahead-sources", "Look-ahead sources",
+      "Number of upcoming file sources to pre-roll (0 = disabled)",
+      0, G_MAXUINT, 0, G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, ARG_LOOKAHEAD_SOURCES,
+      properties[ARG_LOOKAHEAD_SOURCES]);
+
+  /**
+   * GESTrack:lookahead-window
+   *
+   * How far ahead of the current position, in nanoseconds, file sources are
+   * pre-rolled.
+   *
+   * Since: 0.10.2
+   */
+  properties[ARG_LOOKAHEAD_WINDOW] =
+      g_param_spec_uint64 ("lookahead-window", "Look-ahead window",
+      "How far ahead of the current position sources are pre-rolled",
+      0, G_MAXUINT64, DEFAULT_LOOKAHEAD_WINDOW, G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, ARG_LOOKAHEAD_WINDOW,
+      properties[ARG_LOOKAHEAD_WINDOW]);
+
+  /**
+   * GESTrack:lookahead-memory
+   *
+   * Estimated memory, in bytes, the pre-rolled sources may use at most.
+   *
+   * Since: 0.10.2
+   */
+  properties[ARG_LOOKAHEAD_MEMORY] =
+      g_param_spec_uint64 ("lookahead-memory", "Look-ahead memory",
+      "Estimated memory the pre-rolled sources may use at most",
+      0, G_MAXUINT64, DEFAULT_LOOKAHEAD_MEMORY, G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, ARG_LOOKAHEAD_MEMORY,
+      properties[ARG_LOOKAHEAD_MEMORY]);
+
   /**
    * GESTrack::track-object-added
    * @object: the #GESTrack
@@ -285,6 +563,14 @@ ges_track_init (GESTrack * self)
 
   self->priv->composition = gst_element_factory_make ("gnlcomposition", NULL);
 
+  self->priv->lookahead_window = DEFAULT_LOOKAHEAD_WINDOW;
+  self->priv->lookahead_memory = DEFAULT_LOOKAHEAD_MEMORY;
+  self->priv->prerolls = g_hash_table_new_full (g_str_hash, g_str_equal,
+      g_free, NULL);
+  self->priv->muted_objects = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->priv->position = GST_CLOCK_TIME_NONE;
+  self->priv->next_lookahead = GST_CLOCK_TIME_NONE;
+
   g_signal_connect (G_OBJECT (self->priv->composition), "notify::duration",
       G_CALLBACK (composition_duration_cb), self);
   g_signal_connect (self->priv->composition, "pad-added",
@@ -390,12 +676,15 @@ void
 ges_track_set_caps (GESTrack * track, const GstCaps * caps)
 {
   GESTrackPrivate *priv;
+  GList *tmp;
 
   g_return_if_fail (GES_IS_TRACK (track));
   g_return_if_fail (GST_IS_CAPS (caps));
 
   GST_DEBUG ("track:%p, caps:%" GST_PTR_FORMAT, track, caps);
 
+  GES_TRACE_BEGIN ("track-set-caps");
+
   priv = track->priv;
 
   if (priv->caps)
@@ -403,7 +692,24 @@ ges_track_set_caps (GESTrack * track, const GstCaps * caps)
   priv->caps = gst_caps_copy (caps);
 
   g_object_set (priv->composition, "caps", caps, NULL);
-  /* FIXME : update all trackobjects ? */
+
+  /* The gnlobjects got the caps the track had when they were created, keep
+   * them in sync so that they are taken into account on the next
+   * negotiation */
+  for (tmp = priv->trackobjects; tmp; tmp = tmp->next) {
+    GstElement *gnlobject =
+        ges_track_object_get_gnlobject ((GESTrackObject *) tmp->data);
+
+    if (gnlobject) {
+      g_object_set (gnlobject, "caps", caps, NULL);
+      GES_TRACE_COUNT (1);
+    }
+  }
+
+  for (tmp = priv->merged; tmp; tmp = tmp->next)
+    g_object_set (((MergedSource *) tmp->data)->gnlobject, "caps", caps, NULL);
+
+  GES_TRACE_END ();
 }
 
 
@@ -460,34 +766,56 @@ ges_track_add_object (GESTrack * track, GESTrackObject * object)
     return FALSE;
   }
 
+  GES_TRACE_BEGIN ("track-add-object");
+  GES_TRACE_COUNT (1);
+
   if (G_UNLIKELY (!ges_track_object_set_track (object, track))) {
     GST_ERROR ("Couldn't properly add the object to the Track");
+    GES_TRACE_END ();
     return FALSE;
   }
 
-  GST_DEBUG ("Adding object %s to ourself %s",
-      GST_OBJECT_NAME (ges_track_object_get_gnlobject (object)),
-      GST_OBJECT_NAME (track->priv->composition));
+  if (track->priv->timeline &&
+      ges_timeline_get_stats_enabled (track->priv->timeline))
+    ges_track_object_set_stats_enabled (object, TRUE);
 
-  if (G_UNLIKELY (!gst_bin_add (GST_BIN (track->priv->composition),
-              ges_track_object_get_gnlobject (object)))) {
-    GST_WARNING ("Couldn't add object to the GnlComposition");
-    return FALSE;
+  if (G_UNLIKELY (!track_object_is_audible (track, object))) {
+    GST_DEBUG ("Object %p is muted, not adding it to the composition",
+        object);
+    gst_object_ref_sink (ges_track_object_get_gnlobject (object));
+    g_hash_table_insert (track->priv->muted_objects, object, object);
+  } else {
+    GST_DEBUG ("Adding object %s to ourself %s",
+        GST_OBJECT_NAME (ges_track_object_get_gnlobject (object)),
+        GST_OBJECT_NAME (track->priv->composition));
+
+    if (G_UNLIKELY (!gst_bin_add (GST_BIN (track->priv->composition),
+                ges_track_object_get_gnlobject (object)))) {
+      GST_WARNING ("Couldn't add object to the GnlComposition");
+      GES_TRACE_END ();
+      return FALSE;
+    }
   }
 
   g_object_ref_sink (object);
-  track->priv->trackobjects =
-      g_list_insert_sorted (track->priv->trackobjects, object,
-      (GCompareFunc) objects_start_compare);
+  if (track->priv->batch) {
+    track->priv->trackobjects =
+        g_list_prepend (track->priv->trackobjects, object);
+    track->priv->sort_pending = TRUE;
+  } else
+    track->priv->trackobjects =
+        g_list_insert_sorted (track->priv->trackobjects, object,
+        (GCompareFunc) objects_start_compare);
 
   g_signal_emit (track, ges_track_signals[TRACK_OBJECT_ADDED], 0,
       GES_TRACK_OBJECT (object));
 
-  g_signal_connect (GES_TRACK_OBJECT (object), "notify::start",
-      G_CALLBACK (sort_track_objects_cb), track);
+  /* The changes of the object are followed in
+   * ges_track_track_object_changed() */
+  share_decoders_object_changed_cb (object, NULL, track);
+  fuse_effects_object_changed (track, object, GES_CHANGE_PRIORITY);
 
-  g_signal_connect (GES_TRACK_OBJECT (object), "notify::priority",
-      G_CALLBACK (sort_track_objects_cb), track);
+  GES_TRACE_END ();
 
   return TRUE;
 }
@@ -509,6 +837,7 @@ ges_track_get_objects (GESTrack * track)
 
   g_return_val_if_fail (GES_IS_TRACK (track), NULL);
 
+  track_objects_ensure_sorted (track);
   for (tmp = track->priv->trackobjects; tmp; tmp = tmp->next) {
     ret = g_list_prepend (ret, tmp->data);
     g_object_ref (tmp->data);
@@ -549,15 +878,30 @@ ges_track_remove_object (GESTrack * track, GESTrackObject * object)
     return FALSE;
   }
 
-  if ((gnlobject = ges_track_object_get_gnlobject (object))) {
+  GES_TRACE_BEGIN ("track-remove-object");
+  GES_TRACE_COUNT (1);
+
+  /* Put its gnlobject back in the composition if it was merged */
+  share_decoders_dissolve (track, object);
+  share_decoders_schedule (track);
+  fuse_effects_dissolve (track, object);
+  fuse_effects_schedule (track);
+
+  if (g_hash_table_remove (priv->muted_objects, object)) {
+    /* Not in the composition, just drop our reference */
+    gst_object_unref (ges_track_object_get_gnlobject (object));
+  } else if ((gnlobject = ges_track_object_get_gnlobject (object))) {
     GST_DEBUG ("Removing GnlObject '%s' from composition '%s'",
         GST_ELEMENT_NAME (gnlobject), GST_ELEMENT_NAME (priv->composition));
     if (!gst_bin_remove (GST_BIN (priv->composition), gnlobject)) {
       GST_WARNING ("Failed to remove gnlobject from composition");
+      GES_TRACE_END ();
       return FALSE;
     }
   }
 
+  lookahead_drop (track, object);
+
   ges_track_object_set_track (object, NULL);
 
   g_signal_emit (track, ges_track_signals[TRACK_OBJECT_REMOVED], 0,
@@ -567,6 +911,8 @@ ges_track_remove_object (GESTrack * track, GESTrackObject * object)
 
   g_object_unref (object);
 
+  GES_TRACE_END ();
+
   return TRUE;
 }
 
@@ -580,6 +926,9 @@ pad_added_cb (GstElement * element, GstPad * pad, GESTrack * track)
   /* ghost the pad */
   priv->srcpad = gst_ghost_pad_new ("src", pad);
 
+  gst_pad_add_buffer_probe (priv->srcpad, G_CALLBACK (lookahead_probe),
+      track);
+
   gst_pad_set_active (priv->srcpad, TRUE);
 
   gst_element_add_pad (GST_ELEMENT (track), priv->srcpad);
@@ -631,11 +980,103 @@ static void
 sort_track_objects_cb (GESTrackObject * child,
     GParamSpec * arg G_GNUC_UNUSED, GESTrack * track)
 {
+  if (track->priv->batch) {
+    track->priv->sort_pending = TRUE;
+    return;
+  }
+
+  GES_TRACE_BEGIN ("track-sort-objects");
+  GES_TRACE_COUNT (g_list_length (track->priv->trackobjects));
+
+  track->priv->trackobjects =
+      g_list_sort (track->priv->trackobjects,
+      (GCompareFunc) objects_start_compare);
+
+  GES_TRACE_END ();
+}
+
+/* ges_track_track_object_changed:
+ * @track: a #GESTrack
+ * @object: one of its #GESTrackObject
+ * @type: what changed
+ *
+ * Called by @object itself whenever it changes, instead of going through
+ * its "notify::" signals.
+ */
+void
+ges_track_track_object_changed (GESTrack * track, GESTrackObject * object,
+    GESChangeType type)
+{
+  if (type == GES_CHANGE_START || type == GES_CHANGE_PRIORITY)
+    sort_track_objects_cb (object, NULL, track);
+
+  share_decoders_object_changed_cb (object, NULL, track);
+  fuse_effects_object_changed (track, object, type);
+}
+
+static void
+track_objects_ensure_sorted (GESTrack * track)
+{
+  if (!track->priv->sort_pending)
+    return;
+
+  track->priv->sort_pending = FALSE;
   track->priv->trackobjects =
       g_list_sort (track->priv->trackobjects,
       (GCompareFunc) objects_start_compare);
 }
 
+/* ges_track_set_batch:
+ * @track: a #GESTrack
+ * @batch: whether a batch of edits is going on
+ *
+ * While batching, the objects of @track are only sorted once the batch is
+ * over, or when something needs them in order.
+ */
+void
+ges_track_set_batch (GESTrack * track, gboolean batch)
+{
+  GST_DEBUG_OBJECT (track, "batch: %d", batch);
+
+  track->priv->batch = batch;
+  if (!batch) {
+    GES_TRACE_BEGIN ("track-sort-objects");
+    GES_TRACE_COUNT (g_list_length (track->priv->trackobjects));
+    track_objects_ensure_sorted (track);
+    GES_TRACE_END ();
+  }
+}
+
+/* Debug report of the colourspace conversions left in the track, made when
+ * the track starts and after each batch of edits rather than for each
+ * object added, since it goes through all of them */
+static void
+ges_track_report_conversions (GESTrack * track)
+{
+  GList *tmp;
+  GstElement *element;
+  guint count, total = 0;
+
+  if (track->type != GES_TRACK_TYPE_VIDEO ||
+      gst_debug_category_get_threshold (GST_CAT_DEFAULT) < GST_LEVEL_DEBUG)
+    return;
+
+  for (tmp = track->priv->trackobjects; tmp; tmp = tmp->next) {
+    element = ges_track_object_get_element (GES_TRACK_OBJECT (tmp->data));
+    if (element == NULL || !GST_IS_BIN (element))
+      continue;
+
+    count = ges_bin_count_converters (GST_BIN (element));
+    if (count)
+      GST_DEBUG_OBJECT (track, "%s: %d conversion(s)",
+          GST_ELEMENT_NAME (element), count);
+    total += count;
+  }
+
+  GST_DEBUG_OBJECT (track, "%d conversion(s) in %d object(s)", total,
+      g_list_length (track->priv->trackobjects));
+}
+
 static void
 timeline_duration_cb (GESTimeline * timeline,
     GParamSpec * arg G_GNUC_UNUSED, GESTrack * track)
@@ -700,9 +1141,1451 @@ ges_track_enable_update (GESTrack * track, gboolean enabled)
 
   g_object_get (track->priv->composition, "update", &update, NULL);
 
+  if (update)
+    ges_track_report_conversions (track);
+
   if (update == enabled) {
     return TRUE;
   } else {
     return FALSE;
   }
 }
+
+static gboolean
+track_object_is_audible (GESTrack * track, GESTrackObject * object)
+{
+  GESTimelineObject *tlobj;
+  GESTimelineLayer *layer;
+  gboolean res;
+
+  if (track->priv->muted)
+    return FALSE;
+
+  if (!track->priv->solo && track->priv->timeline &&
+      ges_timeline_has_solo_track (track->priv->timeline))
+    return FALSE;
+
+  tlobj = ges_track_object_get_timeline_object (object);
+  if (tlobj == NULL || (layer = ges_timeline_object_get_layer (tlobj)) == NULL)
+    return TRUE;
+
+  res = ges_timeline_layer_is_audible (layer);
+  g_object_unref (layer);
+
+  return res;
+}
+
+/* Takes @object out of the composition if it shouldn't be heard (or seen)
+ * anymore, or puts it back if it should. Returns whether it changed */
+static gboolean
+resync_muted_object (GESTrack * track, GESTrackObject * object)
+{
+  GESTrackPrivate *priv = track->priv;
+  GstElement *gnlobject = ges_track_object_get_gnlobject (object);
+  gboolean muted = g_hash_table_lookup (priv->muted_objects, object) != NULL;
+  gboolean audible = track_object_is_audible (track, object);
+
+  if (audible && muted) {
+    g_hash_table_remove (priv->muted_objects, object);
+    if (!gst_bin_add (GST_BIN (priv->composition), gnlobject))
+      GST_WARNING ("Couldn't add back %s", GST_ELEMENT_NAME (gnlobject));
+    gst_object_unref (gnlobject);
+    return TRUE;
+  } else if (!audible && !muted) {
+    gst_object_ref (gnlobject);
+    if (!gst_bin_remove (GST_BIN (priv->composition), gnlobject)) {
+      GST_WARNING ("Couldn't remove %s", GST_ELEMENT_NAME (gnlobject));
+      gst_object_unref (gnlobject);
+      return FALSE;
+    }
+    g_hash_table_insert (priv->muted_objects, object, object);
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+/* Takes out of the composition the objects that shouldn't be heard (or seen)
+ * anymore, and puts back the ones that should, in a single composition
+ * update. */
+void
+ges_track_resync_muted_objects (GESTrack * track)
+{
+  GESTrackPrivate *priv = track->priv;
+  GList *tmp;
+  gboolean update;
+  guint changed = 0;
+
+  g_object_get (priv->composition, "update", &update, NULL);
+  if (update)
+    g_object_set (priv->composition, "update", FALSE, NULL);
+
+  /* Muted objects can't be part of a merged source or fused effects */
+  share_decoders_dissolve (track, NULL);
+  fuse_effects_dissolve (track, NULL);
+
+  for (tmp = priv->trackobjects; tmp; tmp = tmp->next)
+    if (resync_muted_object (track, GES_TRACK_OBJECT (tmp->data)))
+      changed++;
+
+  GST_DEBUG_OBJECT (track, "%d object(s) changed, %d muted", changed,
+      g_hash_table_size (priv->muted_objects));
+
+  if (update)
+    g_object_set (priv->composition, "update", TRUE, NULL);
+
+  share_decoders_schedule (track);
+  fuse_effects_schedule (track);
+}
+
+/* Same for a single object, which moved to another layer */
+void
+ges_track_resync_muted_object (GESTrack * track, GESTrackObject * object)
+{
+  share_decoders_dissolve (track, object);
+  fuse_effects_dissolve (track, object);
+
+  if (resync_muted_object (track, object))
+    GST_DEBUG_OBJECT (track, "%p is now %s", object,
+        g_hash_table_lookup (track->priv->muted_objects, object) ?
+        "muted" : "audible");
+
+  share_decoders_schedule (track);
+  fuse_effects_schedule (track);
+}
+
+/**
+ * ges_track_set_muted:
+ * @track: a #GESTrack
+ * @muted: whether @track should be muted
+ *
+ * Mutes or unmutes @track. The #GESTrackObject(s) of a muted track are removed
+ * from its composition (freeing their decoders) and are put back when it is
+ * unmuted.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_track_set_muted (GESTrack * track, gboolean muted)
+{
+  g_return_if_fail (GES_IS_TRACK (track));
+
+  if (track->priv->muted == muted)
+    return;
+
+  track->priv->muted = muted;
+  ges_track_resync_muted_objects (track);
+
+#if GLIB_CHECK_VERSION(2,26,0)
+  g_object_notify_by_pspec (G_OBJECT (track), properties[ARG_MUTED]);
+#else
+  g_object_notify (G_OBJECT (track), "muted");
+#endif
+}
+
+/**
+ * ges_track_get_muted:
+ * @track: a #GESTrack
+ *
+ * Returns: %TRUE if @track is muted, else %FALSE.
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_track_get_muted (GESTrack * track)
+{
+  g_return_val_if_fail (GES_IS_TRACK (track), FALSE);
+
+  return track->priv->muted;
+}
+
+/**
+ * ges_track_set_solo:
+ * @track: a #GESTrack
+ * @solo: whether @track should be soloed
+ *
+ * Solos or unsolos @track. When at least one track of the timeline is
+ * soloed, the #GESTrackObject(s) of the other tracks are removed from their
+ * compositions.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_track_set_solo (GESTrack * track, gboolean solo)
+{
+  g_return_if_fail (GES_IS_TRACK (track));
+
+  if (track->priv->solo == solo)
+    return;
+
+  /* The timeline resyncs all of its tracks */
+  track->priv->solo = solo;
+
+#if GLIB_CHECK_VERSION(2,26,0)
+  g_object_notify_by_pspec (G_OBJECT (track), properties[ARG_SOLO]);
+#else
+  g_object_notify (G_OBJECT (track), "solo");
+#endif
+}
+
+/**
+ * ges_track_get_solo:
+ * @track: a #GESTrack
+ *
+ * Returns: %TRUE if @track is soloed, else %FALSE.
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_track_get_solo (GESTrack * track)
+{
+  g_return_val_if_fail (GES_IS_TRACK (track), FALSE);
+
+  return track->priv->solo;
+}
+
+/* Decoder sharing
+ *
+ * Every GESTrackFileSource has its own gnlurisource, so a clip that was
+ * split in many pieces gets its file opened, typefound and its decoders
+ * set up again at each cut, and playing across a cut means starting the
+ * next piece from a seek.
+ *
+ * When decoder sharing is enabled, runs of file sources of the same URI
+ * that follow each other both in the timeline and in the media (the
+ * in-point of each piece is the out-point of the previous one), at the same
+ * priority and with nothing else overlapping them, are played by a single
+ * gnlurisource covering the whole run. The gnlobjects of the pieces are
+ * taken out of the composition, as is done for muted objects, and the
+ * merged source decodes straight through the cuts.
+ *
+ * Inactive pieces are never merged. Any change to a piece, deactivating it
+ * included, or anything added over a run, dissolves the run right away.
+ * The runs are then looked for again from the main context once the edits
+ * are over. */
+
+static gboolean
+merge_candidate (GESTrack * track, GESTrackObject * object)
+{
+  return G_OBJECT_TYPE (object) == GES_TYPE_TRACK_FILESOURCE &&
+      object->active && object->duration > 0 &&
+      GES_TRACK_FILESOURCE (object)->uri &&
+      ges_track_object_get_gnlobject (object) &&
+      !g_hash_table_lookup (track->priv->muted_objects, object);
+}
+
+static gboolean
+merge_can_extend (MergedSource * run, GESTrackObject * object)
+{
+  GESTrackObject *first = GES_TRACK_OBJECT (run->members->data);
+
+  return object->start == run->stop && object->inpoint == run->media_stop &&
+      object->priority == first->priority &&
+      !g_strcmp0 (GES_TRACK_FILESOURCE (object)->uri,
+      GES_TRACK_FILESOURCE (first)->uri);
+}
+
+static void
+merged_source_free (MergedSource * run)
+{
+  if (run->gnlobject)
+    gst_object_unref (run->gnlobject);
+  g_list_free (run->members);
+  g_slice_free (MergedSource, run);
+}
+
+/* Swaps the gnlobjects of the members of @run for a single gnlurisource */
+static gboolean
+merged_source_apply (GESTrack * track, MergedSource * run)
+{
+  GESTrackPrivate *priv = track->priv;
+  GESTrackObject *first = GES_TRACK_OBJECT (run->members->data);
+  GList *tmp;
+
+  run->gnlobject = gst_element_factory_make ("gnlurisource", NULL);
+  if (G_UNLIKELY (run->gnlobject == NULL))
+    return FALSE;
+
+  g_object_set (run->gnlobject, "uri", GES_TRACK_FILESOURCE (first)->uri,
+      "start", run->start, "duration", run->stop - run->start,
+      "media-start", first->inpoint, "media-duration", run->stop - run->start,
+      "priority", first->priority, NULL);
+  if (priv->caps)
+    g_object_set (run->gnlobject, "caps", priv->caps, NULL);
+
+  /* Keep a reference for ourself */
+  gst_object_ref_sink (run->gnlobject);
+  if (!gst_bin_add (GST_BIN (priv->composition), run->gnlobject)) {
+    GST_WARNING_OBJECT (track, "Couldn't add merged source");
+    return FALSE;
+  }
+
+  for (tmp = run->members; tmp; tmp = tmp->next) {
+    GstElement *gnlobject =
+        ges_track_object_get_gnlobject (GES_TRACK_OBJECT (tmp->data));
+
+    gst_object_ref (gnlobject);
+    gst_bin_remove (GST_BIN (priv->composition), gnlobject);
+  }
+
+  GST_DEBUG_OBJECT (track, "%d sources of %s share a decoder from %"
+      GST_TIME_FORMAT " to %" GST_TIME_FORMAT, g_list_length (run->members),
+      GES_TRACK_FILESOURCE (first)->uri, GST_TIME_ARGS (run->start),
+      GST_TIME_ARGS (run->stop));
+
+  return TRUE;
+}
+
+/* Puts the gnlobjects of the members of @run back in the composition */
+static void
+merged_source_dissolve (GESTrack * track, MergedSource * run)
+{
+  GESTrackPrivate *priv = track->priv;
+  GList *tmp;
+
+  if (priv->composition)
+    gst_bin_remove (GST_BIN (priv->composition), run->gnlobject);
+
+  for (tmp = run->members; tmp; tmp = tmp->next) {
+    GstElement *gnlobject =
+        ges_track_object_get_gnlobject (GES_TRACK_OBJECT (tmp->data));
+
+    if (priv->composition)
+      gst_bin_add (GST_BIN (priv->composition), gnlobject);
+    gst_object_unref (gnlobject);
+  }
+
+  merged_source_free (run);
+}
+
+/* Dissolves the runs @object is part of or overlaps, or all of them if
+ * @object is %NULL */
+static void
+share_decoders_dissolve (GESTrack * track, GESTrackObject * object)
+{
+  GESTrackPrivate *priv = track->priv;
+  GList *tmp, *next;
+
+  for (tmp = priv->merged; tmp; tmp = next) {
+    MergedSource *run = (MergedSource *) tmp->data;
+
+    next = tmp->next;
+    if (object && !g_list_find (run->members, object) &&
+        (object->start >= run->stop ||
+            object->start + object->duration <= run->start))
+      continue;
+
+    priv->merged = g_list_delete_link (priv->merged, tmp);
+    merged_source_dissolve (track, run);
+  }
+}
+
+/* Closes @run, it is valid if it has several members and nothing overlaps
+ * it. @next_start is the start of the object following it */
+static MergedSource *
+merge_close_run (MergedSource * run, GstClockTime before_stop,
+    GstClockTime next_start)
+{
+  if (run->members->next && before_stop <= run->start &&
+      next_start >= run->stop)
+    return run;
+
+  merged_source_free (run);
+  return NULL;
+}
+
+/* Finds the runs of the track, the track objects being sorted by start */
+static GList *
+share_decoders_find_runs (GESTrack * track)
+{
+  GList *tmp, *runs = NULL;
+  MergedSource *run = NULL;
+  GstClockTime seen_stop = 0, before_stop = 0;
+
+  track_objects_ensure_sorted (track);
+  for (tmp = track->priv->trackobjects; tmp; tmp = tmp->next) {
+    GESTrackObject *object = GES_TRACK_OBJECT (tmp->data);
+    GstClockTime stop = object->start + object->duration;
+    gboolean candidate = merge_candidate (track, object);
+
+    if (run && candidate && merge_can_extend (run, object)) {
+      run->members = g_list_append (run->members, object);
+      run->stop = stop;
+      run->media_stop += object->duration;
+      continue;
+    }
+
+    if (run) {
+      seen_stop = MAX (seen_stop, run->stop);
+      if ((run = merge_close_run (run, before_stop, object->start)))
+        runs = g_list_append (runs, run);
+      run = NULL;
+    }
+
+    if (candidate) {
+      run = g_slice_new0 (MergedSource);
+      run->members = g_list_append (NULL, object);
+      run->start = object->start;
+      run->stop = stop;
+      run->media_stop = object->inpoint + object->duration;
+      before_stop = seen_stop;
+    } else
+      seen_stop = MAX (seen_stop, stop);
+  }
+
+  if (run && (run = merge_close_run (run, before_stop, GST_CLOCK_TIME_NONE)))
+    runs = g_list_append (runs, run);
+
+  return runs;
+}
+
+static gboolean
+merged_source_equal (MergedSource * a, MergedSource * b)
+{
+  GList *ta, *tb;
+
+  for (ta = a->members, tb = b->members; ta && tb && ta->data == tb->data;
+      ta = ta->next, tb = tb->next);
+
+  return !ta && !tb && a->start == b->start && a->stop == b->stop &&
+      a->media_stop == b->media_stop;
+}
+
+static gboolean
+share_decoders_update (GESTrack * track)
+{
+  GESTrackPrivate *priv = track->priv;
+  GList *runs, *tmp, *old, *next;
+  gboolean update;
+
+  priv->merge_source_id = 0;
+
+  if (priv->composition == NULL)
+    return FALSE;
+
+  runs = priv->share_decoders ? share_decoders_find_runs (track) : NULL;
+
+  g_object_get (priv->composition, "update", &update, NULL);
+  if (update)
+    g_object_set (priv->composition, "update", FALSE, NULL);
+
+  /* Keep the runs that didn't change, dissolve the others */
+  for (old = priv->merged; old; old = next) {
+    MergedSource *current = (MergedSource *) old->data;
+
+    next = old->next;
+    for (tmp = runs; tmp; tmp = tmp->next)
+      if (tmp->data && merged_source_equal (tmp->data, current))
+        break;
+
+    if (tmp) {
+      merged_source_free (tmp->data);
+      tmp->data = NULL;
+    } else {
+      priv->merged = g_list_delete_link (priv->merged, old);
+      merged_source_dissolve (track, current);
+    }
+  }
+
+  for (tmp = runs; tmp; tmp = tmp->next) {
+    MergedSource *run = (MergedSource *) tmp->data;
+
+    if (run == NULL)
+      continue;
+
+    if (merged_source_apply (track, run))
+      priv->merged = g_list_prepend (priv->merged, run);
+    else
+      merged_source_free (run);
+  }
+  g_list_free (runs);
+
+  GST_DEBUG_OBJECT (track, "%d merged source(s)", g_list_length (priv->merged));
+
+  if (update)
+    g_object_set (priv->composition, "update", TRUE, NULL);
+
+  return FALSE;
+}
+
+static void
+share_decoders_schedule (GESTrack * track)
+{
+  GESTrackPrivate *priv = track->priv;
+
+  if (priv->share_decoders && !priv->merge_source_id)
+    priv->merge_source_id =
+        g_idle_add ((GSourceFunc) share_decoders_update, track);
+}
+
+static void
+share_decoders_object_changed_cb (GESTrackObject * object,
+    GParamSpec * arg G_GNUC_UNUSED, GESTrack * track)
+{
+  if (!track->priv->share_decoders)
+    return;
+
+  share_decoders_dissolve (track, object);
+  share_decoders_schedule (track);
+}
+
+/**
+ * ges_track_set_share_decoders:
+ * @track: a #GESTrack
+ * @share: whether back-to-back clips of the same file share a decoder
+ *
+ * When enabled, file sources of the same URI that directly follow each
+ * other in @track, both in the timeline and in the media, at the same
+ * priority and with nothing else over them, are played by a single
+ * source. This avoids opening and seeking the file again at each cut of a
+ * split clip.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_track_set_share_decoders (GESTrack * track, gboolean share)
+{
+  GESTrackPrivate *priv;
+
+  g_return_if_fail (GES_IS_TRACK (track));
+
+  priv = track->priv;
+  if (priv->share_decoders == share)
+    return;
+
+  GST_DEBUG_OBJECT (track, "share decoders: %d", share);
+
+  priv->share_decoders = share;
+  if (share)
+    share_decoders_schedule (track);
+  else {
+    if (priv->merge_source_id) {
+      g_source_remove (priv->merge_source_id);
+      priv->merge_source_id = 0;
+    }
+    share_decoders_update (track);
+  }
+
+#if GLIB_CHECK_VERSION(2,26,0)
+  g_object_notify_by_pspec (G_OBJECT (track), properties[ARG_SHARE_DECODERS]);
+#else
+  g_object_notify (G_OBJECT (track), "share-decoders");
+#endif
+}
+
+/**
+ * ges_track_get_share_decoders:
+ * @track: a #GESTrack
+ *
+ * Returns: %TRUE if back-to-back clips of the same file share a decoder in
+ * @track, see ges_track_set_share_decoders().
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_track_get_share_decoders (GESTrack * track)
+{
+  g_return_val_if_fail (GES_IS_TRACK (track), FALSE);
+
+  return track->priv->share_decoders;
+}
+
+/* Effect fusion
+ *
+ * Every GESTrackEffect is a gnloperation of its own, so the buffers of a
+ * clip with five effects cross five gnonlin operations, stacked by
+ * priority in the composition.
+ *
+ * When effect fusion is enabled, the consecutive top effects of a timeline
+ * object that are active and span the same time are run by a single
+ * gnloperation. The elements of the effects are moved, in order, into one
+ * chain inside it, and the gnloperations of the effects are taken out of
+ * the composition, as is done for muted objects. Since the elements
+ * themselves are moved, their properties can still be set through the
+ * effects.
+ *
+ * Moving the clip only moves the fused operation. Any other change to the
+ * effects, like adding, removing, reordering or deactivating one, dissolves
+ * the chain right away, the chains are then looked for again from the main
+ * context once the edits are over. */
+
+static gboolean
+fuse_candidate (GESTrack * track, GESTrackObject * object)
+{
+  GstElement *gnlobject = ges_track_object_get_gnlobject (object);
+
+  return GES_IS_TRACK_EFFECT (object) && object->active &&
+      ges_track_object_get_timeline_object (object) && gnlobject &&
+      GST_BIN_NUMCHILDREN (gnlobject) == 1 &&
+      !g_hash_table_lookup (track->priv->muted_objects, object);
+}
+
+/* Sorts the effects by timeline object, then by priority */
+static gint
+fuse_compare (GESTrackObject * a, GESTrackObject * b)
+{
+  GESTimelineObject *tlobj_a = ges_track_object_get_timeline_object (a);
+  GESTimelineObject *tlobj_b = ges_track_object_get_timeline_object (b);
+
+  if (tlobj_a != tlobj_b)
+    return tlobj_a < tlobj_b ? -1 : 1;
+  if (a->priority != b->priority)
+    return a->priority < b->priority ? -1 : 1;
+
+  return 0;
+}
+
+static gboolean
+fuse_can_extend (FusedEffects * run, GESTrackObject * object)
+{
+  GESTrackObject *last = GES_TRACK_OBJECT (g_list_last (run->members)->data);
+
+  return ges_track_object_get_timeline_object (object) ==
+      ges_track_object_get_timeline_object (last) &&
+      object->priority == last->priority + 1 &&
+      object->start == run->start && object->duration == run->duration &&
+      object->inpoint == run->inpoint;
+}
+
+static void
+fused_effects_free (FusedEffects * run)
+{
+  if (run->gnlobject)
+    gst_object_unref (run->gnlobject);
+  g_list_free (run->members);
+  g_list_free (run->elements);
+  g_slice_free (FusedEffects, run);
+}
+
+/* Puts the elements of the members of @run back in their gnloperation,
+ * and their gnloperation back in the composition */
+static void
+fused_effects_dissolve (GESTrack * track, FusedEffects * run)
+{
+  GESTrackPrivate *priv = track->priv;
+  GList *tmp, *elements;
+
+  if (priv->composition &&
+      GST_OBJECT_PARENT (run->gnlobject) == GST_OBJECT (priv->composition))
+    gst_bin_remove (GST_BIN (priv->composition), run->gnlobject);
+
+  for (tmp = run->members, elements = run->elements; tmp && elements;
+      tmp = tmp->next, elements = elements->next) {
+    GstElement *gnlobject =
+        ges_track_object_get_gnlobject (GES_TRACK_OBJECT (tmp->data));
+    GstElement *element = (GstElement *) elements->data;
+
+    if (GST_OBJECT_PARENT (element) == GST_OBJECT (run->chain)) {
+      gst_object_ref (element);
+      gst_bin_remove (GST_BIN (run->chain), element);
+      gst_bin_add (GST_BIN (gnlobject), element);
+      gst_object_unref (element);
+    }
+
+    if (run->swapped) {
+      if (priv->composition)
+        gst_bin_add (GST_BIN (priv->composition), gnlobject);
+      gst_object_unref (gnlobject);
+    }
+  }
+
+  fused_effects_free (run);
+}
+
+/* Moves the elements of the members of @run in a single gnloperation, and
+ * swaps their gnloperations for it */
+static gboolean
+fused_effects_apply (GESTrack * track, FusedEffects * run)
+{
+  GESTrackPrivate *priv = track->priv;
+  GstElement *element, *previous = NULL;
+  GstPad *pad;
+  GList *tmp;
+
+  run->gnlobject = gst_element_factory_make ("gnloperation", NULL);
+  if (G_UNLIKELY (run->gnlobject == NULL))
+    return FALSE;
+
+  /* Keep a reference for ourself */
+  gst_object_ref_sink (run->gnlobject);
+  run->chain = gst_bin_new (NULL);
+  gst_bin_add (GST_BIN (run->gnlobject), run->chain);
+
+  for (tmp = run->members; tmp; tmp = tmp->next) {
+    GstElement *gnlobject =
+        ges_track_object_get_gnlobject (GES_TRACK_OBJECT (tmp->data));
+
+    run->elements = g_list_append (run->elements,
+        GST_BIN_CHILDREN (gnlobject)->data);
+  }
+
+  /* The data goes through the lowest effect first */
+  for (tmp = g_list_last (run->elements); tmp; tmp = tmp->prev) {
+    GstElement *gnlobject = GST_ELEMENT (GST_OBJECT_PARENT (tmp->data));
+
+    element = (GstElement *) tmp->data;
+    gst_object_ref (element);
+    gst_bin_remove (GST_BIN (gnlobject), element);
+    gst_bin_add (GST_BIN (run->chain), element);
+    gst_object_unref (element);
+
+    if (previous && !gst_element_link (previous, element)) {
+      GST_WARNING_OBJECT (track, "Couldn't link %s to %s",
+          GST_ELEMENT_NAME (previous), GST_ELEMENT_NAME (element));
+      return FALSE;
+    }
+    previous = element;
+  }
+
+  pad = gst_element_get_static_pad (g_list_last (run->elements)->data, "sink");
+  gst_element_add_pad (run->chain, gst_ghost_pad_new ("sink", pad));
+  gst_object_unref (pad);
+  pad = gst_element_get_static_pad (run->elements->data, "src");
+  gst_element_add_pad (run->chain, gst_ghost_pad_new ("src", pad));
+  gst_object_unref (pad);
+
+  g_object_set (run->gnlobject, "start", run->start, "duration",
+      run->duration, "media-start", run->inpoint, "media-duration",
+      run->duration, "priority", run->priority, NULL);
+
+  if (!gst_bin_add (GST_BIN (priv->composition), run->gnlobject)) {
+    GST_WARNING_OBJECT (track, "Couldn't add fused effects");
+    return FALSE;
+  }
+
+  for (tmp = run->members; tmp; tmp = tmp->next) {
+    GstElement *gnlobject =
+        ges_track_object_get_gnlobject (GES_TRACK_OBJECT (tmp->data));
+
+    gst_object_ref (gnlobject);
+    gst_bin_remove (GST_BIN (priv->composition), gnlobject);
+  }
+  run->swapped = TRUE;
+
+  GST_DEBUG_OBJECT (track, "%d effects fused at priority %u from %"
+      GST_TIME_FORMAT, g_list_length (run->members), run->priority,
+      GST_TIME_ARGS (run->start));
+
+  return TRUE;
+}
+
+/* Dissolves the chain @object is part of, or all of them if @object is
+ * %NULL */
+static void
+fuse_effects_dissolve (GESTrack * track, GESTrackObject * object)
+{
+  GESTrackPrivate *priv = track->priv;
+  GList *tmp, *next;
+
+  for (tmp = priv->fused; tmp; tmp = next) {
+    FusedEffects *run = (FusedEffects *) tmp->data;
+
+    next = tmp->next;
+    if (object && !g_list_find (run->members, object))
+      continue;
+
+    priv->fused = g_list_delete_link (priv->fused, tmp);
+    fused_effects_dissolve (track, run);
+  }
+}
+
+static FusedEffects *
+fuse_close_run (FusedEffects * run)
+{
+  if (run->members->next)
+    return run;
+
+  fused_effects_free (run);
+  return NULL;
+}
+
+/* Finds the chains of effects of the track */
+static GList *
+fuse_effects_find_runs (GESTrack * track)
+{
+  GList *tmp, *effects = NULL, *runs = NULL;
+  FusedEffects *run = NULL;
+
+  for (tmp = track->priv->trackobjects; tmp; tmp = tmp->next)
+    if (fuse_candidate (track, tmp->data))
+      effects = g_list_prepend (effects, tmp->data);
+  effects = g_list_sort (effects, (GCompareFunc) fuse_compare);
+
+  for (tmp = effects; tmp; tmp = tmp->next) {
+    GESTrackObject *object = GES_TRACK_OBJECT (tmp->data);
+
+    if (run && fuse_can_extend (run, object)) {
+      run->members = g_list_append (run->members, object);
+      continue;
+    }
+
+    if (run && (run = fuse_close_run (run)))
+      runs = g_list_append (runs, run);
+
+    run = g_slice_new0 (FusedEffects);
+    run->members = g_list_append (NULL, object);
+    run->start = object->start;
+    run->duration = object->duration;
+    run->inpoint = object->inpoint;
+    run->priority = object->priority;
+  }
+
+  if (run && (run = fuse_close_run (run)))
+    runs = g_list_append (runs, run);
+  g_list_free (effects);
+
+  return runs;
+}
+
+static gboolean
+fused_effects_equal (FusedEffects * a, FusedEffects * b)
+{
+  GList *ta, *tb;
+
+  for (ta = a->members, tb = b->members; ta && tb && ta->data == tb->data;
+      ta = ta->next, tb = tb->next);
+
+  return !ta && !tb && a->start == b->start && a->duration == b->duration &&
+      a->inpoint == b->inpoint && a->priority == b->priority;
+}
+
+static gboolean
+fuse_effects_update (GESTrack * track)
+{
+  GESTrackPrivate *priv = track->priv;
+  GList *runs, *tmp, *old, *next;
+  gboolean update;
+
+  priv->fuse_source_id = 0;
+
+  if (priv->composition == NULL)
+    return FALSE;
+
+  runs = priv->fuse_effects ? fuse_effects_find_runs (track) : NULL;
+
+  g_object_get (priv->composition, "update", &update, NULL);
+  if (update)
+    g_object_set (priv->composition, "update", FALSE, NULL);
+
+  /* Keep the chains that didn't change, dissolve the others */
+  for (old = priv->fused; old; old = next) {
+    FusedEffects *current = (FusedEffects *) old->data;
+
+    next = old->next;
+    for (tmp = runs; tmp; tmp = tmp->next)
+      if (tmp->data && fused_effects_equal (tmp->data, current))
+        break;
+
+    if (tmp) {
+      fused_effects_free (tmp->data);
+      tmp->data = NULL;
+    } else {
+      priv->fused = g_list_delete_link (priv->fused, old);
+      fused_effects_dissolve (track, current);
+    }
+  }
+
+  for (tmp = runs; tmp; tmp = tmp->next) {
+    FusedEffects *run = (FusedEffects *) tmp->data;
+
+    if (run == NULL)
+      continue;
+
+    if (fused_effects_apply (track, run))
+      priv->fused = g_list_prepend (priv->fused, run);
+    else
+      fused_effects_dissolve (track, run);
+  }
+  g_list_free (runs);
+
+  GST_DEBUG_OBJECT (track, "%d fused chain(s)", g_list_length (priv->fused));
+
+  if (update)
+    g_object_set (priv->composition, "update", TRUE, NULL);
+
+  return FALSE;
+}
+
+static void
+fuse_effects_schedule (GESTrack * track)
+{
+  GESTrackPrivate *priv = track->priv;
+
+  if (priv->fuse_effects && !priv->fuse_source_id)
+    priv->fuse_source_id = g_idle_add ((GSourceFunc) fuse_effects_update,
+        track);
+}
+
+static void
+fuse_effects_object_changed (GESTrack * track, GESTrackObject * object,
+    GESChangeType type)
+{
+  GESTrackPrivate *priv = track->priv;
+  GList *tmp;
+
+  if (!priv->fuse_effects || !GES_IS_TRACK_EFFECT (object))
+    return;
+
+  for (tmp = priv->fused; tmp; tmp = tmp->next) {
+    FusedEffects *run = (FusedEffects *) tmp->data;
+
+    if (run->members->data != object)
+      continue;
+
+    /* The effects of a clip move along with it, follow the top one and
+     * let the next update check that the others did the same */
+    if (type == GES_CHANGE_START) {
+      run->start = object->start;
+      g_object_set (run->gnlobject, "start", run->start, NULL);
+    } else if (type == GES_CHANGE_DURATION) {
+      run->duration = object->duration;
+      g_object_set (run->gnlobject, "duration", run->duration,
+          "media-duration", run->duration, NULL);
+    } else if (type == GES_CHANGE_INPOINT) {
+      run->inpoint = object->inpoint;
+      g_object_set (run->gnlobject, "media-start", run->inpoint, NULL);
+    } else
+      break;
+
+    fuse_effects_schedule (track);
+    return;
+  }
+
+  if (type != GES_CHANGE_START && type != GES_CHANGE_DURATION &&
+      type != GES_CHANGE_INPOINT)
+    fuse_effects_dissolve (track, object);
+  fuse_effects_schedule (track);
+}
+
+/**
+ * ges_track_set_fuse_effects:
+ * @track: a #GESTrack
+ * @fuse: whether the effects of a clip should run in a single operation
+ *
+ * When enabled, the consecutive top effects of a #GESTimelineObject in
+ * @track that are active and span the same time are run by a single
+ * operation in the composition, instead of one operation per effect.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_track_set_fuse_effects (GESTrack * track, gboolean fuse)
+{
+  GESTrackPrivate *priv;
+
+  g_return_if_fail (GES_IS_TRACK (track));
+
+  priv = track->priv;
+  if (priv->fuse_effects == fuse)
+    return;
+
+  GST_DEBUG_OBJECT (track, "fuse effects: %d", fuse);
+
+  priv->fuse_effects = fuse;
+  if (fuse)
+    fuse_effects_schedule (track);
+  else {
+    if (priv->fuse_source_id) {
+      g_source_remove (priv->fuse_source_id);
+      priv->fuse_source_id = 0;
+    }
+    fuse_effects_update (track);
+  }
+
+#if GLIB_CHECK_VERSION(2,26,0)
+  g_object_notify_by_pspec (G_OBJECT (track), properties[ARG_FUSE_EFFECTS]);
+#else
+  g_object_notify (G_OBJECT (track), "fuse-effects");
+#endif
+}
+
+/**
+ * ges_track_get_fuse_effects:
+ * @track: a #GESTrack
+ *
+ * Returns: %TRUE if the effects of a clip run in a single operation in
+ * @track, see ges_track_set_fuse_effects().
+ *
+ * Since: 0.10.2
+ */
+gboolean
+ges_track_get_fuse_effects (GESTrack * track)
+{
+  g_return_val_if_fail (GES_IS_TRACK (track), FALSE);
+
+  return track->priv->fuse_effects;
+}
+
+/* Look-ahead pre-rolling
+ *
+ * gnlcomposition only brings up the gnlurisource of a clip when the playback
+ * reaches it, so loading the typefinder, demuxer and decoder plugins and
+ * reading the beginning of the file all happen right at the cut.
+ *
+ * While the track is playing, the next lookahead-sources file sources
+ * starting within lookahead-window of the current position get a private
+ * uridecodebin pipeline that is prerolled at their in-point on a worker
+ * thread. The pipelines are torn down as soon as their clip starts, or
+ * drops out of the window.
+ *
+ * The prerolled decoders are not handed to the gnlurisource, which still
+ * typefinds the file and sets up its own decoders at the cut, and the data
+ * around the in-point is decoded twice. What is paid ahead of time is the
+ * loading of the plugins, which stay in memory once loaded, and the reading
+ * of the file, which then comes from the page cache of the OS.
+ *
+ * The memory used by a pre-rolled source is estimated from the size of the
+ * buffers it prerolled plus a fixed overhead for its elements. The sources
+ * are kept closest first as long as the estimate fits in lookahead-memory,
+ * the farther ones are dropped or not pre-rolled at all.
+ *
+ * The pre-rolls are keyed by URI and in-point, and don't reference the
+ * track objects, so that those are never released from the worker thread.
+ * The table is protected by the object lock. The selection of the sources
+ * runs from the main context, since the track objects are only ever
+ * modified from there. */
+
+#define LOOKAHEAD_INTERVAL (GST_SECOND / 2)
+#define LOOKAHEAD_PREROLL_TIMEOUT (5 * GST_SECOND)
+#define LOOKAHEAD_OVERHEAD (512 * 1024)
+
+typedef struct
+{
+  gchar *uri;
+  GstClockTime inpoint;
+  GstCaps *caps;
+
+  GstElement *pipeline;
+  gint bytes;                   /* Estimated memory usage */
+} Preroll;
+
+typedef enum
+{
+  PREROLL_START,
+  PREROLL_STOP
+} PrerollAction;
+
+typedef struct
+{
+  PrerollAction action;
+  Preroll *preroll;
+} PrerollJob;
+
+static GThreadPool *preroll_pool = NULL;
+
+static void
+preroll_handoff_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    Preroll * preroll)
+{
+  g_atomic_int_add (&preroll->bytes, GST_BUFFER_SIZE (buffer));
+}
+
+static void
+preroll_pad_added_cb (GstElement * decodebin, GstPad * pad, Preroll * preroll)
+{
+  GstElement *sink;
+  GstPad *sinkpad;
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  if (G_UNLIKELY (sink == NULL))
+    return;
+
+  g_object_set (sink, "sync", FALSE, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "preroll-handoff", G_CALLBACK (preroll_handoff_cb),
+      preroll);
+
+  gst_bin_add (GST_BIN (preroll->pipeline), sink);
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  if (gst_pad_link (pad, sinkpad) != GST_PAD_LINK_OK)
+    GST_DEBUG ("Couldn't link %s:%s", GST_DEBUG_PAD_NAME (pad));
+  gst_object_unref (sinkpad);
+  gst_element_sync_state_with_parent (sink);
+}
+
+static void
+preroll_start (Preroll * preroll)
+{
+  GstElement *decodebin;
+  GstBus *bus;
+
+  GST_DEBUG ("Pre-rolling %s at %" GST_TIME_FORMAT, preroll->uri,
+      GST_TIME_ARGS (preroll->inpoint));
+
+  decodebin = gst_element_factory_make ("uridecodebin", NULL);
+  if (G_UNLIKELY (decodebin == NULL))
+    return;
+
+  preroll->pipeline = gst_pipeline_new (NULL);
+  /* Nobody watches the bus, don't let the messages pile up on it */
+  bus = gst_pipeline_get_bus (GST_PIPELINE (preroll->pipeline));
+  gst_bus_set_flushing (bus, TRUE);
+  gst_object_unref (bus);
+
+  g_object_set (decodebin, "uri", preroll->uri, NULL);
+  if (preroll->caps)
+    g_object_set (decodebin, "caps", preroll->caps, NULL);
+  g_signal_connect (decodebin, "pad-added",
+      G_CALLBACK (preroll_pad_added_cb), preroll);
+  gst_bin_add (GST_BIN (preroll->pipeline), decodebin);
+
+  if (gst_element_set_state (preroll->pipeline,
+          GST_STATE_PAUSED) == GST_STATE_CHANGE_FAILURE ||
+      gst_element_get_state (preroll->pipeline, NULL, NULL,
+          LOOKAHEAD_PREROLL_TIMEOUT) != GST_STATE_CHANGE_SUCCESS)
+    goto failed;
+
+  /* Get the data around the in-point read */
+  if (preroll->inpoint) {
+    gst_element_seek_simple (preroll->pipeline, GST_FORMAT_TIME,
+        GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT, preroll->inpoint);
+    gst_element_get_state (preroll->pipeline, NULL, NULL,
+        LOOKAHEAD_PREROLL_TIMEOUT);
+  }
+
+  g_atomic_int_add (&preroll->bytes, LOOKAHEAD_OVERHEAD);
+
+  GST_DEBUG ("Pre-rolled %s, ~%d bytes", preroll->uri,
+      g_atomic_int_get (&preroll->bytes));
+
+  return;
+
+failed:
+  {
+    GST_WARNING ("Couldn't pre-roll %s", preroll->uri);
+    gst_element_set_state (preroll->pipeline, GST_STATE_NULL);
+    gst_object_unref (preroll->pipeline);
+    preroll->pipeline = NULL;
+  }
+}
+
+static void
+preroll_free (Preroll * preroll)
+{
+  if (preroll->pipeline) {
+    gst_element_set_state (preroll->pipeline, GST_STATE_NULL);
+    gst_object_unref (preroll->pipeline);
+  }
+
+  if (preroll->caps)
+    gst_caps_unref (preroll->caps);
+  g_free (preroll->uri);
+  g_slice_free (Preroll, preroll);
+}
+
+static void
+preroll_job_func (PrerollJob * job, gpointer user_data)
+{
+  if (job->action == PREROLL_START)
+    preroll_start (job->preroll);
+  else
+    preroll_free (job->preroll);
+
+  g_slice_free (PrerollJob, job);
+}
+
+/* The pool has a single thread, so that the jobs for a given Preroll are
+ * run in the order they are pushed */
+static void
+preroll_push (Preroll * preroll, PrerollAction action)
+{
+  PrerollJob *job = g_slice_new (PrerollJob);
+
+  if (G_UNLIKELY (preroll_pool == NULL)) {
+    GError *err = NULL;
+
+    preroll_pool = g_thread_pool_new ((GFunc) preroll_job_func, NULL, 1,
+        FALSE, &err);
+    if (preroll_pool == NULL) {
+      GST_ERROR ("Couldn't create the pre-roll thread: %s", err->message);
+      g_error_free (err);
+    }
+  }
+
+  job->action = action;
+  job->preroll = preroll;
+
+  if (G_LIKELY (preroll_pool))
+    g_thread_pool_push (preroll_pool, job, NULL);
+  else
+    preroll_job_func (job, NULL);
+}
+
+static gchar *
+preroll_key (GESTrackObject * object)
+{
+  return g_strdup_printf ("%" GST_TIME_FORMAT " %s",
+      GST_TIME_ARGS (object->inpoint), GES_TRACK_FILESOURCE (object)->uri);
+}
+
+static gboolean
+steal_preroll (gchar * key, Preroll * preroll, GList ** stopped)
+{
+  *stopped = g_list_prepend (*stopped, preroll);
+
+  return TRUE;
+}
+
+static void
+prerolls_stop (GList * stopped)
+{
+  GList *tmp;
+
+  for (tmp = stopped; tmp; tmp = tmp->next)
+    preroll_push ((Preroll *) tmp->data, PREROLL_STOP);
+  g_list_free (stopped);
+}
+
+/* Tears down the pre-rolled pipeline of @object, or of all objects if
+ * @object is %NULL */
+static void
+lookahead_drop (GESTrack * track, GESTrackObject * object)
+{
+  GESTrackPrivate *priv = track->priv;
+  GList *stopped = NULL;
+
+  GST_OBJECT_LOCK (track);
+  if (object == NULL)
+    g_hash_table_foreach_steal (priv->prerolls, (GHRFunc) steal_preroll,
+        &stopped);
+  else if (GES_IS_TRACK_FILESOURCE (object)) {
+    gchar *key = preroll_key (object);
+    Preroll *preroll = g_hash_table_lookup (priv->prerolls, key);
+
+    if (preroll) {
+      stopped = g_list_prepend (stopped, preroll);
+      g_hash_table_remove (priv->prerolls, key);
+    }
+    g_free (key);
+  }
+  GST_OBJECT_UNLOCK (track);
+
+  prerolls_stop (stopped);
+}
+
+static gboolean
+lookahead_update (GESTrack * track)
+{
+  GESTrackPrivate *priv = track->priv;
+  GHashTableIter iter;
+  gpointer key, value;
+  GstClockTime position, stop;
+  GList *tmp, *tmpkey, *wanted = NULL, *keys = NULL;
+  GList *stopped = NULL;
+  guint64 used = 0;
+  guint n = 0;
+
+  GST_OBJECT_LOCK (track);
+  position = priv->position;
+  priv->lookahead_pending = FALSE;
+  GST_OBJECT_UNLOCK (track);
+
+  if (priv->lookahead_sources == 0 || !GST_CLOCK_TIME_IS_VALID (position)) {
+    lookahead_drop (track, NULL);
+    goto done;
+  }
+
+  stop = position + priv->lookahead_window;
+
+  /* The objects are sorted by start */
+  track_objects_ensure_sorted (track);
+  for (tmp = priv->trackobjects; tmp && n < priv->lookahead_sources;
+      tmp = tmp->next) {
+    GESTrackObject *object = GES_TRACK_OBJECT (tmp->data);
+    gchar *okey;
+
+    if (object->start <= position)
+      continue;
+    if (object->start > stop)
+      break;
+    if (!GES_IS_TRACK_FILESOURCE (object) ||
+        g_hash_table_lookup (priv->muted_objects, object))
+      continue;
+
+    /* The same piece of a file only needs pre-rolling once */
+    okey = preroll_key (object);
+    if (g_list_find_custom (keys, okey, (GCompareFunc) g_strcmp0)) {
+      g_free (okey);
+      continue;
+    }
+
+    wanted = g_list_append (wanted, object);
+    keys = g_list_append (keys, okey);
+    n++;
+  }
+
+  GST_OBJECT_LOCK (track);
+
+  /* Drop the clips that started or moved out of the window */
+  g_hash_table_iter_init (&iter, priv->prerolls);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    if (!g_list_find_custom (keys, key, (GCompareFunc) g_strcmp0)) {
+      stopped = g_list_prepend (stopped, value);
+      g_hash_table_iter_steal (&iter);
+      g_free (key);
+    }
+  }
+
+  /* Then keep or pre-roll the others closest first, within the budget */
+  for (tmp = wanted, tmpkey = keys; tmp; tmp = tmp->next,
+      tmpkey = tmpkey->next) {
+    GESTrackObject *object = GES_TRACK_OBJECT (tmp->data);
+    gchar *okey = (gchar *) tmpkey->data;
+    Preroll *preroll = g_hash_table_lookup (priv->prerolls, okey);
+
+    if (used >= priv->lookahead_memory) {
+      GST_DEBUG_OBJECT (track, "Look-ahead memory budget used up");
+      if (preroll) {
+        stopped = g_list_prepend (stopped, preroll);
+        g_hash_table_remove (priv->prerolls, okey);
+      }
+      continue;
+    }
+
+    if (preroll == NULL) {
+      preroll = g_slice_new0 (Preroll);
+      preroll->uri = g_strdup (GES_TRACK_FILESOURCE (object)->uri);
+      preroll->inpoint = object->inpoint;
+      preroll->caps = priv->caps ? gst_caps_ref (priv->caps) : NULL;
+      g_hash_table_insert (priv->prerolls, g_strdup (okey), preroll);
+      /* Before anyone else can push its stop job */
+      preroll_push (preroll, PREROLL_START);
+    }
+
+    /* Assume it will take at least the fixed overhead */
+    used += MAX (g_atomic_int_get (&preroll->bytes), LOOKAHEAD_OVERHEAD);
+  }
+
+  GST_OBJECT_UNLOCK (track);
+
+  prerolls_stop (stopped);
+
+  g_list_free (wanted);
+  g_list_foreach (keys, (GFunc) g_free, NULL);
+  g_list_free (keys);
+
+done:
+  g_object_unref (track);
+
+  return FALSE;
+}
+
+/* Runs the selection of the sources to pre-roll right away, as if @track
+ * had just output @position */
+void
+ges_track_lookahead_update (GESTrack * track, GstClockTime position)
+{
+  GST_OBJECT_LOCK (track);
+  track->priv->position = position;
+  GST_OBJECT_UNLOCK (track);
+
+  lookahead_update (g_object_ref (track));
+}
+
+gboolean
+ges_track_is_prerolling (GESTrack * track, GESTrackObject * object)
+{
+  gchar *key = preroll_key (object);
+  gboolean ret;
+
+  GST_OBJECT_LOCK (track);
+  ret = g_hash_table_lookup (track->priv->prerolls, key) != NULL;
+  GST_OBJECT_UNLOCK (track);
+  g_free (key);
+
+  return ret;
+}
+
+static void
+lookahead_schedule (GESTrack * track)
+{
+  gboolean schedule;
+
+  GST_OBJECT_LOCK (track);
+  schedule = !track->priv->lookahead_pending;
+  track->priv->lookahead_pending = TRUE;
+  GST_OBJECT_UNLOCK (track);
+
+  if (schedule)
+    g_idle_add ((GSourceFunc) lookahead_update, g_object_ref (track));
+}
+
+static gboolean
+lookahead_probe (GstPad * pad, GstBuffer * buffer, GESTrack * track)
+{
+  GESTrackPrivate *priv = track->priv;
+  GstClockTime ts = GST_BUFFER_TIMESTAMP (buffer);
+  gboolean update = FALSE;
+
+  if (G_LIKELY (priv->lookahead_sources == 0) || !GST_CLOCK_TIME_IS_VALID (ts))
+    return TRUE;
+
+  GST_OBJECT_LOCK (track);
+  /* Update regularly, and right away after seeking backwards */
+  if (!GST_CLOCK_TIME_IS_VALID (priv->next_lookahead) ||
+      ts >= priv->next_lookahead || ts < priv->position) {
+    priv->next_lookahead = ts + LOOKAHEAD_INTERVAL;
+    update = TRUE;
+  }
+  priv->position = ts;
+  GST_OBJECT_UNLOCK (track);
+
+  if (update)
+    lookahead_schedule (track);
+
+  return TRUE;
+}
+
+/**
+ * ges_track_set_lookahead:
+ * @track: a #GESTrack
+ * @sources: the number of upcoming file sources to pre-roll, 0 to disable
+ * pre-rolling
+ * @window: how far ahead of the current position to look for sources to
+ * pre-roll, in nanoseconds
+ * @memory: the estimated memory the pre-rolled sources may use at most, in
+ * bytes
+ *
+ * While @track is playing, pre-rolls a private decoding pipeline for the
+ * next @sources file sources starting within @window of the current
+ * position, on a worker thread. This gets the plugins the clips need
+ * loaded, and the data around their in-point read into the page cache of
+ * the OS, before the clips start.
+ *
+ * The clips still get typefound and their decoders set up when they start,
+ * and the pre-rolled data is decoded a second time then, so this only helps
+ * with plugin loading and slow storage.
+ *
+ * The sources are selected from the default main context, which needs to
+ * be running for pre-rolling to happen.
+ *
+ * Since: 0.10.2
+ */
+void
+ges_track_set_lookahead (GESTrack * track, guint sources, GstClockTime window,
+    guint64 memory)
+{
+  GESTrackPrivate *priv;
+
+  g_return_if_fail (GES_IS_TRACK (track));
+
+  priv = track->priv;
+
+  g_object_freeze_notify (G_OBJECT (track));
+  if (priv->lookahead_sources != sources) {
+    priv->lookahead_sources = sources;
+    g_object_notify (G_OBJECT (track), "lookahead-sources");
+  }
+  if (priv->lookahead_window != window) {
+    priv->lookahead_window = window;
+    g_object_notify (G_OBJECT (track), "lookahead-window");
+  }
+  if (priv->lookahead_memory != memory) {
+    priv->lookahead_memory = memory;
+    g_object_notify (G_OBJECT (track), "lookahead-memory");
+  }
+  g_object_thaw_notify (G_OBJECT (track));
+
+  /* Drop whatever isn't wanted anymore */
+  if (GST_CLOCK_TIME_IS_VALID (priv->position) || sources == 0)
+    lookahead_schedule (track);
+}
@@ -106,6 +106,22 @@ gboolean ges_track_enable_update          (GESTrack * track, gboolean enabled);
 
 GList* ges_track_get_objects              (GESTrack *track);
 
+void     ges_track_set_muted              (GESTrack * track, gboolean muted);
+gboolean ges_track_get_muted              (GESTrack * track);
+
+void     ges_track_set_solo               (GESTrack * track, gboolean solo);
+gboolean ges_track_get_solo               (GESTrack * track);
+
+void     ges_track_set_share_decoders     (GESTrack * track, gboolean share);
+gboolean ges_track_get_share_decoders     (GESTrack * track);
+
+void     ges_track_set_fuse_effects       (GESTrack * track, gboolean fuse);
+gboolean ges_track_get_fuse_effects       (GESTrack * track);
+
+void     ges_track_set_lookahead          (GESTrack * track, guint sources,
+                                           GstClockTime window,
+                                           guint64 memory);
+
 G_END_DECLS
 
 #endif /* _GES_TRACK */
@@ -47,6 +47,8 @@ typedef struct _GESTimelineOperationClass GESTimelineOperationClass;
 typedef struct _GESTimelinePipeline GESTimelinePipeline;
 typedef struct _GESTimelinePipelineClass GESTimelinePipelineClass;
 
+typedef struct _GESTimelineSnapshot GESTimelineSnapshot;
+
 typedef struct _GESTimelineSource GESTimelineSource;
 typedef struct _GESTimelineSourceClass GESTimelineSourceClass;
 
@@ -65,6 +67,9 @@ typedef struct _GESTimelineStandardTransitionClass GESTimelineStandardTransition
 typedef struct _GESTimelineTestSource GESTimelineTestSource;
 typedef struct _GESTimelineTestSourceClass GESTimelineTestSourceClass;
 
+typedef struct _GESTimelineNestedSource GESTimelineNestedSource;
+typedef struct _GESTimelineNestedSourceClass GESTimelineNestedSourceClass;
+
 typedef struct _GESTimelineTitleSource GESTimelineTitleSource;
 typedef struct _GESTimelineTitleSourceClass GESTimelineTitleSourceClass;
 
@@ -83,6 +88,8 @@ typedef struct _GESTrackClass GESTrackClass;
 typedef struct _GESTrackObject GESTrackObject;
 typedef struct _GESTrackObjectClass GESTrackObjectClass;
 
+typedef struct _GESTrackObjectStats GESTrackObjectStats;
+
 typedef struct _GESTrackSource GESTrackSource;
 typedef struct _GESTrackSourceClass GESTrackSourceClass;
 
@@ -98,6 +105,9 @@ typedef struct _GESTrackParseLaunchEffectClass GESTrackParseLaunchEffectClass;
 typedef struct _GESTrackFileSource GESTrackFileSource;
 typedef struct _GESTrackFileSourceClass GESTrackFileSourceClass;
 
+typedef struct _GESTrackNestedSource GESTrackNestedSource;
+typedef struct _GESTrackNestedSourceClass GESTrackNestedSourceClass;
+
 typedef struct _GESTrackImageSource GESTrackImageSource;
 typedef struct _GESTrackImageSourceClass GESTrackImageSourceClass;
 
@@ -59,3 +59,421 @@ ges_timeline_new_audio_video (void)
 
   return timeline;
 }
+
+/* Colourspace conversion elimination
+ *
+ * Most video track objects wrap their elements between colourspace
+ * converters so that they can cope with whatever the track outputs. When
+ * the formats on both sides of a converter are already compatible, or when
+ * two converters end up back-to-back, the extra conversion is pure overhead.
+ *
+ * The pass below looks at the pad templates around every converter of a
+ * track object bin (following elements that do not alter the colourspace,
+ * and using the track caps at the bin boundaries) and removes the
+ * converters that can never have anything to convert. */
+
+#define CONVERSION_MAX_DEPTH 8
+
+static const gchar *converter_factories[] = {
+  "ffmpegcolorspace", "colorspace", NULL
+};
+
+gboolean
+ges_element_is_colorspace_converter (GstElement * element)
+{
+  GstElementFactory *factory;
+  const gchar *name;
+  guint i;
+
+  factory = gst_element_get_factory (element);
+  if (factory == NULL)
+    return FALSE;
+
+  name = gst_plugin_feature_get_name (GST_PLUGIN_FEATURE (factory));
+  for (i = 0; converter_factories[i]; i++)
+    if (!g_strcmp0 (name, converter_factories[i]))
+      return TRUE;
+
+  return FALSE;
+}
+
+/* Only the fields a colourspace converter cares about */
+static GstCaps *
+get_format_caps (const GstCaps * caps)
+{
+  GstCaps *res;
+  guint i;
+
+  if (caps == NULL)
+    return gst_caps_new_any ();
+
+  res = gst_caps_copy (caps);
+  for (i = 0; i < gst_caps_get_size (res); i++)
+    gst_structure_remove_fields (gst_caps_get_structure (res, i),
+        "width", "height", "framerate", "pixel-aspect-ratio", "interlaced",
+        NULL);
+
+  return res;
+}
+
+static GstPad *
+get_ghost_for_target (GstBin * bin, GstPad * target)
+{
+  GstIterator *it;
+  gpointer data;
+  GstPad *ret = NULL;
+  gboolean done = FALSE;
+
+  it = gst_element_iterate_pads (GST_ELEMENT (bin));
+  while (!done) {
+    switch (gst_iterator_next (it, &data)) {
+      case GST_ITERATOR_OK:
+      {
+        GstPad *pad = GST_PAD (data);
+        GstPad *tmp;
+
+        if (GST_IS_GHOST_PAD (pad)) {
+          tmp = gst_ghost_pad_get_target (GST_GHOST_PAD (pad));
+          if (tmp == target) {
+            ret = gst_object_ref (pad);
+            done = TRUE;
+          }
+          if (tmp)
+            gst_object_unref (tmp);
+        }
+        gst_object_unref (pad);
+        break;
+      }
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync (it);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  gst_iterator_free (it);
+
+  return ret;
+}
+
+/* Returns the pad on the other side of @element which has the same template
+ * caps as @pad, meaning that the formats flowing through @pad go through
+ * the element unchanged. */
+static GstPad *
+get_format_preserving_pad (GstElement * element, GstPad * pad)
+{
+  GstIterator *it;
+  gpointer data;
+  GstPad *ret = NULL;
+  const GstCaps *caps;
+  gboolean done = FALSE;
+
+  /* Bins can contain anything */
+  if (GST_IS_BIN (element) || ges_element_is_colorspace_converter (element))
+    return NULL;
+
+  caps = gst_pad_get_pad_template_caps (pad);
+
+  it = gst_element_iterate_pads (element);
+  while (!done) {
+    switch (gst_iterator_next (it, &data)) {
+      case GST_ITERATOR_OK:
+      {
+        GstPad *other = GST_PAD (data);
+
+        if (GST_PAD_DIRECTION (other) != GST_PAD_DIRECTION (pad) &&
+            gst_caps_is_equal (caps, gst_pad_get_pad_template_caps (other))) {
+          ret = other;
+          done = TRUE;
+        } else
+          gst_object_unref (other);
+        break;
+      }
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync (it);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  gst_iterator_free (it);
+
+  return ret;
+}
+
+static GstCaps *get_neighbour_formats (GstBin * bin, GstPad * pad,
+    const GstCaps * track_caps, guint depth);
+
+/* Formats that can go through @pad */
+static GstCaps *
+get_pad_formats (GstBin * bin, GstPad * pad, const GstCaps * track_caps,
+    guint depth)
+{
+  GstCaps *res, *other_formats, *tmp;
+  GstElement *element;
+  GstPad *other;
+
+  res = get_format_caps (gst_pad_get_pad_template_caps (pad));
+
+  element = gst_pad_get_parent_element (pad);
+  if (element == NULL)
+    return res;
+
+  if (depth < CONVERSION_MAX_DEPTH &&
+      (other = get_format_preserving_pad (element, pad))) {
+    other_formats = get_neighbour_formats (bin, other, track_caps, depth + 1);
+    tmp = gst_caps_intersect (res, other_formats);
+    gst_caps_unref (res);
+    gst_caps_unref (other_formats);
+    gst_object_unref (other);
+    res = tmp;
+  }
+  gst_object_unref (element);
+
+  return res;
+}
+
+/* Formats that the element linked to @pad can produce (if @pad is a sink pad)
+ * or accept (if @pad is a source pad). */
+static GstCaps *
+get_neighbour_formats (GstBin * bin, GstPad * pad, const GstCaps * track_caps,
+    guint depth)
+{
+  GstPad *ghost, *peer;
+  GstCaps *res;
+
+  /* What comes in and goes out of the bin is what the track outputs */
+  if ((ghost = get_ghost_for_target (bin, pad))) {
+    gst_object_unref (ghost);
+    return get_format_caps (track_caps);
+  }
+
+  /* Not linked yet (dynamic pads), we can't know */
+  if (!(peer = gst_pad_get_peer (pad)))
+    return gst_caps_new_any ();
+
+  res = get_pad_formats (bin, peer, track_caps, depth);
+  gst_object_unref (peer);
+
+  return res;
+}
+
+static gboolean
+converter_is_redundant (GstBin * bin, GstElement * conv,
+    const GstCaps * track_caps)
+{
+  GstPad *sink, *src, *peer;
+  GstElement *upstream;
+  GstCaps *produced, *accepted;
+  gboolean res = FALSE;
+
+  sink = gst_element_get_static_pad (conv, "sink");
+  src = gst_element_get_static_pad (conv, "src");
+  if (!sink || !src)
+    goto done;
+
+  /* Back-to-back converters, the first one can do the job of both */
+  if (!(peer = get_ghost_for_target (bin, sink)) &&
+      (peer = gst_pad_get_peer (sink))) {
+    upstream = gst_pad_get_parent_element (peer);
+    if (upstream) {
+      res = ges_element_is_colorspace_converter (upstream);
+      gst_object_unref (upstream);
+    }
+  }
+  if (peer)
+    gst_object_unref (peer);
+  if (res)
+    goto done;
+
+  produced = get_neighbour_formats (bin, sink, track_caps, 0);
+  accepted = get_neighbour_formats (bin, src, track_caps, 0);
+
+  res = !gst_caps_is_empty (produced) && gst_caps_is_subset (produced,
+      accepted);
+
+  GST_LOG_OBJECT (conv, "produced:%" GST_PTR_FORMAT " accepted:%"
+      GST_PTR_FORMAT " redundant:%d", produced, accepted, res);
+
+  gst_caps_unref (produced);
+  gst_caps_unref (accepted);
+
+done:
+  if (sink)
+    gst_object_unref (sink);
+  if (src)
+    gst_object_unref (src);
+
+  return res;
+}
+
+static gboolean
+remove_converter (GstBin * bin, GstElement * conv)
+{
+  GstPad *sink, *src, *sink_ghost, *src_ghost;
+  GstPad *upstream = NULL, *downstream = NULL;
+  gboolean res = FALSE;
+
+  sink = gst_element_get_static_pad (conv, "sink");
+  src = gst_element_get_static_pad (conv, "src");
+  sink_ghost = get_ghost_for_target (bin, sink);
+  src_ghost = get_ghost_for_target (bin, src);
+
+  /* The converter is all there is in the bin, leave it be */
+  if (sink_ghost && src_ghost)
+    goto done;
+
+  if (!sink_ghost && !(upstream = gst_pad_get_peer (sink)))
+    goto done;
+  if (!src_ghost && !(downstream = gst_pad_get_peer (src)))
+    goto done;
+
+  GST_DEBUG_OBJECT (bin, "Removing redundant converter %s",
+      GST_ELEMENT_NAME (conv));
+
+  if (sink_ghost)
+    gst_ghost_pad_set_target (GST_GHOST_PAD (sink_ghost), NULL);
+  if (src_ghost)
+    gst_ghost_pad_set_target (GST_GHOST_PAD (src_ghost), NULL);
+
+  /* This also unlinks the converter */
+  gst_element_set_state (conv, GST_STATE_NULL);
+  gst_bin_remove (bin, conv);
+
+  if (sink_ghost)
+    res = gst_ghost_pad_set_target (GST_GHOST_PAD (sink_ghost), downstream);
+  else if (src_ghost)
+    res = gst_ghost_pad_set_target (GST_GHOST_PAD (src_ghost), upstream);
+  else
+    res = GST_PAD_LINK_SUCCESSFUL (gst_pad_link_full (upstream, downstream,
+            GST_PAD_LINK_CHECK_NOTHING));
+
+  if (G_UNLIKELY (!res))
+    GST_WARNING_OBJECT (bin, "Couldn't relink around the removed converter");
+
+done:
+  gst_object_unref (sink);
+  gst_object_unref (src);
+  if (sink_ghost)
+    gst_object_unref (sink_ghost);
+  if (src_ghost)
+    gst_object_unref (src_ghost);
+  if (upstream)
+    gst_object_unref (upstream);
+  if (downstream)
+    gst_object_unref (downstream);
+
+  return res;
+}
+
+/* One pass over the converters of @bin */
+static guint
+remove_redundant_converters_pass (GstBin * bin, const GstCaps * track_caps)
+{
+  GstIterator *it;
+  gpointer data;
+  GList *converters = NULL, *tmp;
+  gboolean done = FALSE;
+  guint removed = 0;
+
+  it = gst_bin_iterate_elements (bin);
+  while (!done) {
+    switch (gst_iterator_next (it, &data)) {
+      case GST_ITERATOR_OK:
+        if (ges_element_is_colorspace_converter (GST_ELEMENT (data)))
+          converters = g_list_prepend (converters, data);
+        else
+          gst_object_unref (data);
+        break;
+      case GST_ITERATOR_RESYNC:
+        g_list_foreach (converters, (GFunc) gst_object_unref, NULL);
+        g_list_free (converters);
+        converters = NULL;
+        gst_iterator_resync (it);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  gst_iterator_free (it);
+
+  for (tmp = converters; tmp; tmp = tmp->next) {
+    GstElement *conv = GST_ELEMENT (tmp->data);
+
+    if (converter_is_redundant (bin, conv, track_caps) &&
+        remove_converter (bin, conv))
+      removed++;
+    gst_object_unref (conv);
+  }
+  g_list_free (converters);
+
+  return removed;
+}
+
+/*
+ * ges_bin_remove_redundant_converters:
+ * @bin: the #GstBin created by a video #GESTrackObject
+ * @track_caps: the caps of the track the object belongs to
+ *
+ * Removes the colourspace converters of @bin whose input formats are always
+ * accepted by what follows them, and merges back-to-back converters. The
+ * passes are repeated until nothing changes, since removing a converter can
+ * make the one next to it redundant.
+ *
+ * Only the converters inside @bin are considered. The converters at the
+ * edges of different objects, such as the output converter of an effect
+ * followed by the input converter of a transition, are linked by
+ * gnlcomposition when it builds its pipeline and are left alone.
+ *
+ * Returns: the number of converters removed.
+ */
+guint
+ges_bin_remove_redundant_converters (GstBin * bin, const GstCaps * track_caps)
+{
+  guint removed = 0, pass;
+
+  while ((pass = remove_redundant_converters_pass (bin, track_caps)))
+    removed += pass;
+
+  return removed;
+}
+
+/*
+ * ges_bin_count_converters:
+ * @bin: a #GstBin
+ *
+ * Returns: the number of colourspace converters contained in @bin and its
+ * children bins.
+ */
+guint
+ges_bin_count_converters (GstBin * bin)
+{
+  GstIterator *it;
+  gpointer data;
+  gboolean done = FALSE;
+  guint count = 0;
+
+  it = gst_bin_iterate_recurse (bin);
+  while (!done) {
+    switch (gst_iterator_next (it, &data)) {
+      case GST_ITERATOR_OK:
+        if (ges_element_is_colorspace_converter (GST_ELEMENT (data)))
+          count++;
+        gst_object_unref (data);
+        break;
+      case GST_ITERATOR_RESYNC:
+        count = 0;
+        gst_iterator_resync (it);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  gst_iterator_free (it);
+
+  return count;
+}
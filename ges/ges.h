@@ -31,8 +31,10 @@
 #include <ges/ges-simple-timeline-layer.h>
 #include <ges/ges-timeline-object.h>
 #include <ges/ges-timeline-pipeline.h>
+#include <ges/ges-timeline-snapshot.h>
 #include <ges/ges-timeline-source.h>
 #include <ges/ges-timeline-test-source.h>
+#include <ges/ges-timeline-nested-source.h>
 #include <ges/ges-timeline-title-source.h>
 #include <ges/ges-timeline-operation.h>
 #include <ges/ges-timeline-effect.h>
@@ -53,6 +55,7 @@
 
 #include <ges/ges-track-filesource.h>
 #include <ges/ges-track-image-source.h>
+#include <ges/ges-track-nested-source.h>
 #include <ges/ges-track-video-test-source.h>
 #include <ges/ges-track-audio-test-source.h>
 #include <ges/ges-track-title-source.h>
@@ -66,6 +69,7 @@
 #include <ges/ges-keyfile-formatter.h>
 #include <ges/ges-pitivi-formatter.h>
 #include <ges/ges-utils.h>
+#include <ges/ges-trace.h>
 
 G_BEGIN_DECLS
 
@@ -0,0 +1,208 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Times how long a timeline made of test sources takes to render to an
+ * audio/video file, for a given size of the queues that separate the tracks
+ * from the encoders.
+ *
+ * The results are printed as a CSV line:
+ *   benchmark,objects,queue_msec,queue_bytes,seconds,speed
+ * where speed is how many seconds of the timeline were rendered per second.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <ges/ges.h>
+#include <gst/pbutils/encoding-profile.h>
+
+#define OBJECT_DURATION GST_SECOND
+
+static gint nb_objects = 10;
+static gint queue_msec = 1000;
+static gint queue_bytes = 10 * 1024 * 1024;
+static gboolean no_header = FALSE;
+static gchar *output = NULL;
+
+static FILE *out;
+
+static GstEncodingProfile *
+make_encoding_profile (void)
+{
+  GstEncodingContainerProfile *profile;
+  GstEncodingProfile *stream;
+  GstCaps *caps;
+
+  caps = gst_caps_from_string ("application/ogg");
+  profile = gst_encoding_container_profile_new ((gchar *) "ges-render-bench",
+      NULL, caps, NULL);
+  gst_caps_unref (caps);
+
+  caps = gst_caps_from_string ("video/x-theora");
+  stream = (GstEncodingProfile *)
+      gst_encoding_video_profile_new (caps, NULL, NULL, 0);
+  gst_encoding_container_profile_add_profile (profile, stream);
+  gst_caps_unref (caps);
+
+  caps = gst_caps_from_string ("audio/x-vorbis");
+  stream = (GstEncodingProfile *)
+      gst_encoding_audio_profile_new (caps, NULL, NULL, 0);
+  gst_encoding_container_profile_add_profile (profile, stream);
+  gst_caps_unref (caps);
+
+  return (GstEncodingProfile *) profile;
+}
+
+static GESTimelinePipeline *
+make_pipeline (const gchar * uri)
+{
+  GESTimelinePipeline *pipeline;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GstEncodingProfile *profile;
+  gint i;
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_layer_new ();
+  ges_timeline_add_layer (timeline, layer);
+
+  for (i = 0; i < nb_objects; i++) {
+    GESTimelineTestSource *source = ges_timeline_test_source_new ();
+
+    g_object_set (source, "start", (guint64) i * OBJECT_DURATION,
+        "duration", (guint64) OBJECT_DURATION, "vpattern",
+        i % GES_VIDEO_TEST_PATTERN_SMPTE75, NULL);
+    ges_timeline_layer_add_object (layer, GES_TIMELINE_OBJECT (source));
+  }
+
+  pipeline = ges_timeline_pipeline_new ();
+  g_object_set (pipeline, "queue-max-time",
+      (guint64) queue_msec * GST_MSECOND, "queue-max-bytes",
+      (guint) queue_bytes, NULL);
+  ges_timeline_pipeline_add_timeline (pipeline, timeline);
+
+  profile = make_encoding_profile ();
+  ges_timeline_pipeline_set_render_settings (pipeline, (gchar *) uri, profile);
+  gst_encoding_profile_unref (profile);
+  ges_timeline_pipeline_set_mode (pipeline, TIMELINE_MODE_RENDER);
+
+  return pipeline;
+}
+
+int
+main (int argc, gchar ** argv)
+{
+  GError *err = NULL;
+  GOptionContext *ctx;
+  GESTimelinePipeline *pipeline;
+  GstBus *bus;
+  GstMessage *msg;
+  GTimer *timer;
+  gchar *path, *uri;
+  gdouble elapsed;
+  gboolean failed;
+  gchar sbuf[G_ASCII_DTOSTR_BUF_SIZE], speedbuf[G_ASCII_DTOSTR_BUF_SIZE];
+  GOptionEntry options[] = {
+    {"objects", 'n', 0, G_OPTION_ARG_INT, &nb_objects,
+        "Number of one second objects in the timeline (default: 10)", "N"},
+    {"queue-time", 't', 0, G_OPTION_ARG_INT, &queue_msec,
+        "Maximum time held by each queue, in milliseconds (default: 1000)",
+        "MSEC"},
+    {"queue-bytes", 'b', 0, G_OPTION_ARG_INT, &queue_bytes,
+        "Maximum size of each queue, in bytes (default: 10485760)", "BYTES"},
+    {"no-header", 0, 0, G_OPTION_ARG_NONE, &no_header,
+        "Don't print the CSV header", NULL},
+    {"output", 'o', 0, G_OPTION_ARG_FILENAME, &output,
+        "Append the results to this file instead of stdout", "FILE"},
+    {NULL}
+  };
+
+  if (!g_thread_supported ())
+    g_thread_init (NULL);
+
+  ctx = g_option_context_new ("- benchmark rendering");
+  g_option_context_add_main_entries (ctx, options, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (nb_objects < 1 || queue_msec < 0 || queue_bytes < 0) {
+    g_printerr ("Invalid arguments\n");
+    return 1;
+  }
+
+  if (output) {
+    if (!(out = g_fopen (output, "a"))) {
+      g_printerr ("Couldn't open %s\n", output);
+      return 1;
+    }
+  } else
+    out = stdout;
+
+  ges_init ();
+
+  path = g_build_filename (g_get_tmp_dir (), "ges-render-bench.ogg", NULL);
+  uri = g_filename_to_uri (path, NULL, NULL);
+  pipeline = make_pipeline (uri);
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+
+  timer = g_timer_new ();
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  elapsed = g_timer_elapsed (timer, NULL);
+  failed = (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR);
+  gst_message_unref (msg);
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+  g_unlink (path);
+  g_free (path);
+  g_free (uri);
+  g_timer_destroy (timer);
+
+  if (failed) {
+    g_printerr ("Rendering failed\n");
+    return 1;
+  }
+
+  if (!no_header)
+    fprintf (out, "benchmark,objects,queue_msec,queue_bytes,seconds,speed\n");
+
+  g_ascii_formatd (sbuf, sizeof (sbuf), "%.6f", elapsed);
+  g_ascii_formatd (speedbuf, sizeof (speedbuf), "%.3f",
+      nb_objects * ((gdouble) OBJECT_DURATION / GST_SECOND) / elapsed);
+  fprintf (out, "render,%d,%d,%d,%s,%s\n", nb_objects, queue_msec,
+      queue_bytes, sbuf, speedbuf);
+
+  if (out != stdout)
+    fclose (out);
+
+  return 0;
+}
@@ -0,0 +1,231 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Times how long a previewing pipeline takes to preroll again after
+ * flushing seeks to random positions of a timeline made of test sources.
+ *
+ * Seeks are sent in bursts, the way scrubbing does, and each burst is timed
+ * from its first seek until the pipeline is prerolled at the position of
+ * its last one. The results are printed as a CSV line:
+ *   benchmark,objects,seeks,burst,seek_latency,seconds,msec_per_burst,
+ *   max_msec
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <ges/ges.h>
+
+#define OBJECT_DURATION GST_SECOND
+#define PREROLL_TIMEOUT (10 * GST_SECOND)
+
+static gint nb_objects = 20;
+static gint nb_seeks = 100;
+static gint burst = 1;
+static gboolean seek_latency = FALSE;
+static gboolean no_header = FALSE;
+static gchar *output = NULL;
+
+static FILE *out;
+
+static GESTimelinePipeline *
+make_pipeline (void)
+{
+  GESTimelinePipeline *pipeline;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  gint i;
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_layer_new ();
+  ges_timeline_add_layer (timeline, layer);
+
+  for (i = 0; i < nb_objects; i++) {
+    GESTimelineTestSource *source = ges_timeline_test_source_new ();
+
+    /* Change pattern so that the sources don't all look the same */
+    g_object_set (source, "start", (guint64) i * OBJECT_DURATION,
+        "duration", (guint64) OBJECT_DURATION, "vpattern",
+        i % GES_VIDEO_TEST_PATTERN_SMPTE75, NULL);
+    ges_timeline_layer_add_object (layer, GES_TIMELINE_OBJECT (source));
+  }
+
+  pipeline = ges_timeline_pipeline_new ();
+  ges_timeline_pipeline_add_timeline (pipeline, timeline);
+  ges_timeline_pipeline_set_mode (pipeline, TIMELINE_MODE_PREVIEW);
+  ges_timeline_pipeline_preview_set_video_sink (pipeline,
+      gst_element_factory_make ("fakesink", NULL));
+  ges_timeline_pipeline_preview_set_audio_sink (pipeline,
+      gst_element_factory_make ("fakesink", NULL));
+  ges_timeline_pipeline_set_seek_latency_mode (pipeline, seek_latency);
+
+  return pipeline;
+}
+
+/* Waits until @pipeline is prerolled at @position */
+static gboolean
+wait_preroll (GESTimelinePipeline * pipeline, GstBus * bus,
+    GstClockTime position)
+{
+  GstFormat format = GST_FORMAT_TIME;
+  GstMessage *msg;
+  gint64 current;
+
+  while ((msg = gst_bus_timed_pop_filtered (bus, PREROLL_TIMEOUT,
+              GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR))) {
+    gboolean error = (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR);
+
+    gst_message_unref (msg);
+    if (error)
+      return FALSE;
+
+    if (!GST_CLOCK_TIME_IS_VALID (position) ||
+        (gst_element_query_position (GST_ELEMENT (pipeline), &format,
+                &current) && current == (gint64) position))
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+int
+main (int argc, gchar ** argv)
+{
+  GError *err = NULL;
+  GOptionContext *ctx;
+  GESTimelinePipeline *pipeline;
+  GstBus *bus;
+  GTimer *timer, *total;
+  GRand *rand;
+  gdouble max = 0;
+  gchar sbuf[G_ASCII_DTOSTR_BUF_SIZE], avgbuf[G_ASCII_DTOSTR_BUF_SIZE],
+      maxbuf[G_ASCII_DTOSTR_BUF_SIZE];
+  gint i, j, bursts;
+  GOptionEntry options[] = {
+    {"objects", 'n', 0, G_OPTION_ARG_INT, &nb_objects,
+        "Number of one second objects in the timeline (default: 20)", "N"},
+    {"seeks", 's', 0, G_OPTION_ARG_INT, &nb_seeks,
+        "Number of seeks (default: 100)", "N"},
+    {"burst", 'b', 0, G_OPTION_ARG_INT, &burst,
+        "Number of seeks sent back to back before waiting for the preroll "
+          "(default: 1)", "N"},
+    {"seek-latency", 'l', 0, G_OPTION_ARG_NONE, &seek_latency,
+        "Put the pipeline in seek-latency mode", NULL},
+    {"no-header", 0, 0, G_OPTION_ARG_NONE, &no_header,
+        "Don't print the CSV header", NULL},
+    {"output", 'o', 0, G_OPTION_ARG_FILENAME, &output,
+        "Append the results to this file instead of stdout", "FILE"},
+    {NULL}
+  };
+
+  if (!g_thread_supported ())
+    g_thread_init (NULL);
+
+  ctx = g_option_context_new ("- benchmark seek latency");
+  g_option_context_add_main_entries (ctx, options, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (nb_objects < 1 || nb_seeks < 1 || burst < 1) {
+    g_printerr ("Invalid arguments\n");
+    return 1;
+  }
+
+  if (output) {
+    if (!(out = g_fopen (output, "a"))) {
+      g_printerr ("Couldn't open %s\n", output);
+      return 1;
+    }
+  } else
+    out = stdout;
+
+  ges_init ();
+
+  pipeline = make_pipeline ();
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PAUSED);
+  if (!wait_preroll (pipeline, bus, GST_CLOCK_TIME_NONE)) {
+    g_printerr ("Pipeline didn't preroll\n");
+    return 1;
+  }
+
+  if (!no_header)
+    fprintf (out, "benchmark,objects,seeks,burst,seek_latency,seconds,"
+        "msec_per_burst,max_msec\n");
+
+  /* Always seek to the same positions from one run to the other */
+  rand = g_rand_new_with_seed (42);
+  timer = g_timer_new ();
+  total = g_timer_new ();
+  bursts = 0;
+
+  for (i = 0; i < nb_seeks; i += burst) {
+    GstClockTime position = GST_CLOCK_TIME_NONE;
+    gdouble elapsed;
+
+    g_timer_start (timer);
+    for (j = 0; j < burst && i + j < nb_seeks; j++) {
+      /* Milliseconds are precise enough and compare well */
+      position = g_rand_int_range (rand, 0, nb_objects * 1000) * GST_MSECOND;
+      gst_element_seek_simple (GST_ELEMENT (pipeline), GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE, position);
+    }
+
+    if (!wait_preroll (pipeline, bus, position)) {
+      g_printerr ("Pipeline didn't preroll at %" GST_TIME_FORMAT "\n",
+          GST_TIME_ARGS (position));
+      return 1;
+    }
+
+    elapsed = g_timer_elapsed (timer, NULL);
+    max = MAX (max, elapsed);
+    bursts++;
+  }
+
+  g_ascii_formatd (sbuf, sizeof (sbuf), "%.6f", g_timer_elapsed (total, NULL));
+  g_ascii_formatd (avgbuf, sizeof (avgbuf), "%.3f",
+      g_timer_elapsed (total, NULL) * 1000 / bursts);
+  g_ascii_formatd (maxbuf, sizeof (maxbuf), "%.3f", max * 1000);
+  fprintf (out, "seek,%d,%d,%d,%d,%s,%s,%s\n", nb_objects, nb_seeks, burst,
+      seek_latency, sbuf, avgbuf, maxbuf);
+
+  g_timer_destroy (timer);
+  g_timer_destroy (total);
+  g_rand_free (rand);
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  if (out != stdout)
+    fclose (out);
+
+  return 0;
+}
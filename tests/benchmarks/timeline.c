@@ -0,0 +1,393 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Times the editing operations on synthetic timelines made of test sources,
+ * as well as saving and loading them with each formatter.
+ *
+ * Every measurement is printed as a CSV line:
+ *   benchmark,objects,layers,effects,auto_transitions,operations,seconds,
+ *   usec_per_operation,peak_rss_kb
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <ges/ges.h>
+
+#ifdef G_OS_UNIX
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
+#define OBJECT_DURATION GST_SECOND
+
+static gint nb_objects = 1000;
+static gint nb_layers = 1;
+static gint effect_every = 0;
+static gboolean auto_transitions = FALSE;
+static gint nb_edits = 1000;
+static gint nb_ripples = 10;
+static gboolean skip_save_load = FALSE;
+static gboolean no_header = FALSE;
+static gchar *output = NULL;
+
+static FILE *out;
+
+typedef struct
+{
+  GESTimeline *timeline;
+  GESTrack *trackv;
+  GESTrack *tracka;
+  GESTimelineLayer **layers;
+  GPtrArray *objects;
+  GRand *rand;
+} Bench;
+
+static glong
+get_peak_rss (void)
+{
+#ifdef G_OS_UNIX
+  struct rusage usage;
+
+  if (getrusage (RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss;
+#endif
+
+  return -1;
+}
+
+static void
+report (const gchar * name, guint operations, GTimer * timer)
+{
+  gdouble seconds = g_timer_elapsed (timer, NULL);
+  gchar sbuf[G_ASCII_DTOSTR_BUF_SIZE], opbuf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  /* Always use a '.' as decimal separator */
+  g_ascii_formatd (sbuf, sizeof (sbuf), "%.6f", seconds);
+  g_ascii_formatd (opbuf, sizeof (opbuf), "%.3f",
+      operations ? seconds * G_USEC_PER_SEC / operations : 0.0);
+
+  fprintf (out, "%s,%d,%d,%d,%d,%u,%s,%s,%ld\n", name, nb_objects,
+      nb_layers, effect_every, auto_transitions, operations, sbuf, opbuf,
+      get_peak_rss ());
+  fflush (out);
+}
+
+static GESTimelineObject *
+random_object (Bench * bench)
+{
+  return g_ptr_array_index (bench->objects,
+      g_rand_int_range (bench->rand, 0, bench->objects->len));
+}
+
+static void
+add_effect (Bench * bench, GESTimelineObject * object)
+{
+  GESTrackParseLaunchEffect *effect;
+
+  effect = ges_track_parse_launch_effect_new ("identity");
+  if (!ges_timeline_object_add_track_object (object,
+          GES_TRACK_OBJECT (effect)) ||
+      !ges_track_add_object (bench->trackv, GES_TRACK_OBJECT (effect)))
+    g_printerr ("Couldn't add effect\n");
+}
+
+static void
+bench_add (Bench * bench)
+{
+  GTimer *timer = g_timer_new ();
+  GstClockTime step;
+  gint i;
+
+  /* Overlap consecutive objects so that auto-transitions kick in */
+  step = auto_transitions ? OBJECT_DURATION * 3 / 4 : OBJECT_DURATION;
+
+  for (i = 0; i < nb_objects; i++) {
+    GESTimelineObject *object;
+
+    object = (GESTimelineObject *) ges_timeline_test_source_new ();
+    g_object_set (object, "start", (guint64) (i / nb_layers) * step,
+        "duration", (guint64) OBJECT_DURATION, NULL);
+    ges_timeline_layer_add_object (bench->layers[i % nb_layers], object);
+    g_ptr_array_add (bench->objects, object);
+
+    if (effect_every && (i % effect_every) == 0)
+      add_effect (bench, object);
+  }
+
+  report ("add", nb_objects, timer);
+  g_timer_destroy (timer);
+}
+
+static void
+bench_move (Bench * bench)
+{
+  GTimer *timer = g_timer_new ();
+  gint i;
+
+  for (i = 0; i < nb_edits; i++) {
+    GESTimelineObject *object = random_object (bench);
+
+    ges_timeline_object_set_start (object, object->start + GST_MSECOND);
+  }
+
+  report ("move", nb_edits, timer);
+  g_timer_destroy (timer);
+}
+
+static void
+bench_split (Bench * bench)
+{
+  GTimer *timer = g_timer_new ();
+  gint i;
+
+  for (i = 0; i < nb_edits; i++) {
+    GESTimelineObject *object = random_object (bench), *new_object;
+
+    new_object = ges_timeline_object_split (object,
+        object->start + object->duration / 2);
+    if (new_object)
+      g_ptr_array_add (bench->objects, new_object);
+  }
+
+  report ("split", nb_edits, timer);
+  g_timer_destroy (timer);
+}
+
+/* Removes an object and moves all the following ones of its layer back by
+ * its duration, the way an application does it */
+static void
+bench_ripple (Bench * bench)
+{
+  GTimer *timer = g_timer_new ();
+  gint i;
+
+  for (i = 0; i < nb_ripples && bench->objects->len; i++) {
+    GESTimelineObject *object = random_object (bench);
+    GESTimelineLayer *layer = ges_timeline_object_get_layer (object);
+    GstClockTime start = object->start, duration = object->duration;
+    GList *objects, *tmp;
+
+    g_ptr_array_remove_fast (bench->objects, object);
+    ges_timeline_layer_remove_object (layer, object);
+
+    objects = ges_timeline_layer_get_objects (layer);
+    for (tmp = objects; tmp; tmp = tmp->next) {
+      GESTimelineObject *other = (GESTimelineObject *) tmp->data;
+
+      if (other->start > start)
+        ges_timeline_object_set_start (other, other->start - duration);
+      g_object_unref (other);
+    }
+    g_list_free (objects);
+    g_object_unref (layer);
+  }
+
+  report ("ripple", nb_ripples, timer);
+  g_timer_destroy (timer);
+}
+
+static void
+bench_remove (Bench * bench)
+{
+  GTimer *timer = g_timer_new ();
+  gint i;
+
+  for (i = 0; i < nb_edits && bench->objects->len; i++) {
+    GESTimelineObject *object = random_object (bench);
+    GESTimelineLayer *layer = ges_timeline_object_get_layer (object);
+
+    g_ptr_array_remove_fast (bench->objects, object);
+    ges_timeline_layer_remove_object (layer, object);
+    g_object_unref (layer);
+  }
+
+  report ("remove", nb_edits, timer);
+  g_timer_destroy (timer);
+}
+
+static void
+bench_save_load (Bench * bench, const gchar * name, GType formatter_type)
+{
+  GESFormatter *formatter;
+  GESTimeline *timeline;
+  GTimer *timer;
+  gchar *path, *uri, *bname;
+  gint fd;
+
+  fd = g_file_open_tmp ("ges-benchmark-XXXXXX", &path, NULL);
+  if (fd < 0) {
+    g_printerr ("Couldn't create a temporary file\n");
+    return;
+  }
+  close (fd);
+  uri = g_filename_to_uri (path, NULL, NULL);
+
+  timer = g_timer_new ();
+  formatter = g_object_new (formatter_type, NULL);
+  bname = g_strdup_printf ("save-%s", name);
+  if (ges_formatter_save_to_uri (formatter, bench->timeline, uri))
+    report (bname, 1, timer);
+  else
+    g_printerr ("Couldn't save with the %s formatter\n", name);
+  g_free (bname);
+  g_object_unref (formatter);
+
+  /* Load with a new formatter, as an application opening the project would */
+  timeline = ges_timeline_new ();
+  formatter = g_object_new (formatter_type, NULL);
+  g_timer_start (timer);
+  bname = g_strdup_printf ("load-%s", name);
+  if (ges_formatter_load_from_uri (formatter, timeline, uri))
+    report (bname, 1, timer);
+  else
+    g_printerr ("Couldn't load with the %s formatter\n", name);
+  g_free (bname);
+
+  g_object_unref (timeline);
+  g_timer_destroy (timer);
+  g_object_unref (formatter);
+  g_unlink (path);
+  g_free (path);
+  g_free (uri);
+}
+
+static Bench *
+bench_new (void)
+{
+  Bench *bench = g_new0 (Bench, 1);
+  gint i;
+
+  bench->timeline = ges_timeline_new ();
+  bench->trackv = ges_track_video_raw_new ();
+  bench->tracka = ges_track_audio_raw_new ();
+  ges_timeline_add_track (bench->timeline, bench->trackv);
+  ges_timeline_add_track (bench->timeline, bench->tracka);
+
+  bench->layers = g_new0 (GESTimelineLayer *, nb_layers);
+  for (i = 0; i < nb_layers; i++) {
+    bench->layers[i] = ges_timeline_layer_new ();
+    ges_timeline_layer_set_priority (bench->layers[i], i);
+    ges_timeline_layer_set_auto_transition (bench->layers[i],
+        auto_transitions);
+    ges_timeline_add_layer (bench->timeline, bench->layers[i]);
+  }
+
+  bench->objects = g_ptr_array_sized_new (nb_objects);
+  /* Always edit the same objects from one run to the other */
+  bench->rand = g_rand_new_with_seed (42);
+
+  return bench;
+}
+
+static void
+bench_free (Bench * bench)
+{
+  g_object_unref (bench->timeline);
+  g_ptr_array_free (bench->objects, TRUE);
+  g_rand_free (bench->rand);
+  g_free (bench->layers);
+  g_free (bench);
+}
+
+int
+main (int argc, gchar ** argv)
+{
+  GError *err = NULL;
+  GOptionContext *ctx;
+  Bench *bench;
+  GOptionEntry options[] = {
+    {"objects", 'n', 0, G_OPTION_ARG_INT, &nb_objects,
+        "Number of objects in the timeline (default: 1000)", "N"},
+    {"layers", 'l', 0, G_OPTION_ARG_INT, &nb_layers,
+        "Number of layers the objects are spread on (default: 1)", "N"},
+    {"effects", 'e', 0, G_OPTION_ARG_INT, &effect_every,
+        "Add an effect to every N-th object (default: none)", "N"},
+    {"auto-transitions", 't', 0, G_OPTION_ARG_NONE, &auto_transitions,
+        "Overlap the objects and let the layers add transitions", NULL},
+    {"edits", 'm', 0, G_OPTION_ARG_INT, &nb_edits,
+        "Number of moves, splits and removals (default: 1000)", "N"},
+    {"ripples", 'r', 0, G_OPTION_ARG_INT, &nb_ripples,
+        "Number of ripple deletes (default: 10)", "N"},
+    {"skip-save-load", 's', 0, G_OPTION_ARG_NONE, &skip_save_load,
+        "Don't time saving and loading", NULL},
+    {"no-header", 0, 0, G_OPTION_ARG_NONE, &no_header,
+        "Don't print the CSV header", NULL},
+    {"output", 'o', 0, G_OPTION_ARG_FILENAME, &output,
+        "Append the results to this file instead of stdout", "FILE"},
+    {NULL}
+  };
+
+  if (!g_thread_supported ())
+    g_thread_init (NULL);
+
+  ctx = g_option_context_new ("- benchmark timeline edits");
+  g_option_context_add_main_entries (ctx, options, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (nb_objects < 1 || nb_layers < 1 || nb_edits < 0 || nb_ripples < 0) {
+    g_printerr ("Invalid arguments\n");
+    return 1;
+  }
+
+  if (output) {
+    if (!(out = g_fopen (output, "a"))) {
+      g_printerr ("Couldn't open %s\n", output);
+      return 1;
+    }
+  } else
+    out = stdout;
+
+  ges_init ();
+
+  if (!no_header)
+    fprintf (out, "benchmark,objects,layers,effects,auto_transitions,"
+        "operations,seconds,usec_per_operation,peak_rss_kb\n");
+
+  bench = bench_new ();
+
+  bench_add (bench);
+  if (!skip_save_load) {
+    bench_save_load (bench, "keyfile", GES_TYPE_KEYFILE_FORMATTER);
+    bench_save_load (bench, "pitivi", GES_TYPE_PITIVI_FORMATTER);
+  }
+  bench_move (bench);
+  bench_split (bench);
+  bench_ripple (bench);
+  bench_remove (bench);
+
+  bench_free (bench);
+
+  if (out != stdout)
+    fclose (out);
+
+  return 0;
+}
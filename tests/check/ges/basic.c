@@ -19,6 +19,9 @@
 
 #include <ges/ges.h>
 #include <gst/check/gstcheck.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <unistd.h>
 
 GST_START_TEST (test_ges_init)
 {
@@ -553,6 +556,294 @@ GST_START_TEST (test_ges_timeline_remove_track)
 
 GST_END_TEST;
 
+static void
+link_fakesink_cb (GstElement * timeline, GstPad * pad, GstBin * pipeline)
+{
+  GstElement *sink;
+  GstPad *sinkpad;
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "sync", FALSE, NULL);
+  gst_bin_add (pipeline, sink);
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  fail_unless (gst_pad_link (pad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+  gst_element_sync_state_with_parent (sink);
+}
+
+GST_START_TEST (test_ges_timeline_stats)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track;
+  GESTimelineObject *s1, *s2;
+  GESTrackObject *t1, *t2, *effect;
+  GESTrackObjectStats stats, stats1, stats2, estats;
+  GstElement *pipeline;
+  GstMessage *message;
+  GstBus *bus;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_layer_new ();
+  track = ges_track_video_raw_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  s1 = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (s1, "duration", (guint64) GST_SECOND / 2, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, s1));
+  t1 = ges_timeline_object_find_track_object (s1, track, G_TYPE_NONE);
+  fail_unless (t1 != NULL);
+
+  /* Nothing is gathered by default */
+  fail_if (ges_track_object_get_stats_enabled (t1));
+  fail_if (ges_track_object_get_stats (t1, &stats));
+  fail_if (ges_timeline_get_stats (timeline, &stats));
+
+  /* Enabling it on the timeline enables it on the existing objects... */
+  ges_timeline_set_stats_enabled (timeline, TRUE);
+  fail_unless (ges_track_object_get_stats_enabled (t1));
+  fail_unless (ges_track_object_get_stats (t1, &stats));
+  assert_equals_uint64 (stats.buffers, 0);
+  assert_equals_uint64 (stats.dropped, 0);
+  assert_equals_uint64 (stats.peak_latency, 0);
+
+  /* ... and on the ones added later on */
+  s2 = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (s2, "start", (guint64) GST_SECOND / 2, "duration",
+      (guint64) GST_SECOND / 2, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, s2));
+  t2 = ges_timeline_object_find_track_object (s2, track, G_TYPE_NONE);
+  fail_unless (t2 != NULL);
+  fail_unless (ges_track_object_get_stats_enabled (t2));
+
+  /* ... including effects */
+  effect = GES_TRACK_OBJECT (ges_track_parse_launch_effect_new
+      ("identity sleep-time=1000"));
+  fail_unless (ges_timeline_object_add_track_object (s1, effect));
+  fail_unless (ges_track_add_object (track, effect));
+  fail_unless (ges_track_object_get_stats_enabled (effect));
+
+  fail_unless (ges_timeline_get_stats (timeline, &stats));
+  assert_equals_uint64 (stats.buffers, 0);
+
+  /* Play the timeline through */
+  pipeline = gst_pipeline_new (NULL);
+  g_signal_connect (timeline, "pad-added", G_CALLBACK (link_fakesink_cb),
+      pipeline);
+  fail_unless (gst_bin_add (GST_BIN (pipeline), GST_ELEMENT (timeline)));
+  fail_if (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+  bus = gst_element_get_bus (pipeline);
+  message = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (message != NULL);
+  assert_equals_int (GST_MESSAGE_TYPE (message), GST_MESSAGE_EOS);
+  gst_message_unref (message);
+  gst_object_unref (bus);
+
+  /* Both sources output buffers, and the timeline sums them up. Only the
+   * effect has inputs to measure a latency from, it sleeps 1ms per buffer */
+  fail_unless (ges_track_object_get_stats (t1, &stats1));
+  fail_unless (ges_track_object_get_stats (t2, &stats2));
+  fail_unless (ges_track_object_get_stats (effect, &estats));
+  fail_unless (stats1.buffers > 1);
+  fail_unless (stats2.buffers > 1);
+  assert_equals_uint64 (stats1.peak_latency, 0);
+  assert_equals_uint64 (stats2.peak_latency, 0);
+  fail_unless (estats.buffers > 1);
+  fail_unless (estats.peak_latency >= GST_MSECOND);
+  fail_unless (estats.total_latency >= estats.buffers * GST_MSECOND);
+
+  fail_unless (ges_timeline_get_stats (timeline, &stats));
+  assert_equals_uint64 (stats.buffers,
+      stats1.buffers + stats2.buffers + estats.buffers);
+  assert_equals_uint64 (stats.total_latency, estats.total_latency);
+  assert_equals_uint64 (stats.peak_latency, estats.peak_latency);
+
+  /* The pads going away with the content don't leave anything behind */
+  fail_if (gst_element_set_state (pipeline,
+          GST_STATE_NULL) == GST_STATE_CHANGE_FAILURE);
+  fail_unless (ges_track_object_get_stats (t1, &stats));
+  assert_equals_uint64 (stats.buffers, stats1.buffers);
+
+  ges_timeline_set_stats_enabled (timeline, FALSE);
+  fail_if (ges_track_object_get_stats_enabled (t1));
+  fail_if (ges_track_object_get_stats_enabled (t2));
+  fail_if (ges_track_object_get_stats_enabled (effect));
+  fail_if (ges_timeline_get_stats (timeline, &stats));
+
+  g_object_unref (t1);
+  g_object_unref (t2);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ges_timeline_batch)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track;
+  GESTimelineObject *objects[3];
+  GList *trackobjects, *tmp;
+  GstClockTime last = 0;
+  guint i, refcount;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  track = ges_track_new (GES_TRACK_TYPE_CUSTOM, GST_CAPS_ANY);
+  fail_unless (ges_timeline_add_track (timeline, track));
+  refcount = G_OBJECT (track)->ref_count;
+
+  /* Nested batches only end with the outermost one */
+  ges_timeline_begin_batch (timeline);
+  ges_timeline_begin_batch (timeline);
+
+  for (i = 0; i < 3; i++) {
+    objects[i] = (GESTimelineObject *)
+        ges_custom_timeline_source_new (my_fill_track_func, NULL);
+    g_object_set (objects[i], "start", (guint64) (30 - i * 10),
+        "duration", (guint64) 10, NULL);
+    fail_unless (ges_timeline_layer_add_object (layer, objects[i]));
+  }
+  g_object_set (objects[0], "start", (guint64) 5, NULL);
+
+  fail_unless (ges_timeline_end_batch (timeline));
+  fail_unless (ges_timeline_end_batch (timeline));
+
+  /* Batches don't keep the tracks alive */
+  ASSERT_OBJECT_REFCOUNT (track, "track", refcount);
+
+  /* The track objects are sorted again */
+  trackobjects = ges_track_get_objects (track);
+  assert_equals_int (g_list_length (trackobjects), 3);
+  for (tmp = trackobjects; tmp; tmp = tmp->next) {
+    fail_unless (GES_TRACK_OBJECT_START (tmp->data) >= last);
+    last = GES_TRACK_OBJECT_START (tmp->data);
+    g_object_unref (tmp->data);
+  }
+  g_list_free (trackobjects);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+static void
+count_notify_cb (GObject * object, GParamSpec * arg, guint * count)
+{
+  (*count)++;
+}
+
+GST_START_TEST (test_ges_timeline_batch_notify)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track;
+  GESTimelineObject *object;
+  GESTrackObject *trackobject;
+  GList *trackobjects;
+  guint count = 0;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  track = ges_track_new (GES_TRACK_TYPE_CUSTOM, GST_CAPS_ANY);
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  object = (GESTimelineObject *)
+      ges_custom_timeline_source_new (my_fill_track_func, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, object));
+  trackobjects = ges_track_get_objects (track);
+  assert_equals_int (g_list_length (trackobjects), 1);
+  trackobject = trackobjects->data;
+  g_signal_connect (trackobject, "notify::start",
+      G_CALLBACK (count_notify_cb), &count);
+
+  /* Outside of a batch every change is notified */
+  ges_timeline_object_set_start (object, 10);
+  assert_equals_int (count, 1);
+
+  /* Inside a batch, only once when it ends */
+  ges_timeline_begin_batch (timeline);
+  ges_timeline_object_set_start (object, 20);
+  ges_timeline_object_set_start (object, 30);
+  ges_timeline_object_set_start (object, 40);
+  assert_equals_int (count, 1);
+  fail_unless (ges_timeline_end_batch (timeline));
+  assert_equals_int (count, 2);
+  assert_equals_uint64 (GES_TRACK_OBJECT_START (trackobject), 40);
+
+  g_list_foreach (trackobjects, (GFunc) g_object_unref, NULL);
+  g_list_free (trackobjects);
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ges_trace)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track;
+  GESCustomTimelineSource *source;
+  gchar *path, *contents;
+  gint fd;
+
+  ges_init ();
+
+  ges_trace_clear ();
+  ges_trace_set_enabled (TRUE);
+  if (!ges_trace_get_enabled ()) {
+    GST_INFO ("GES was built without tracing support, skipping");
+    return;
+  }
+
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_layer_new ();
+  track = ges_track_new (GES_TRACK_TYPE_CUSTOM, GST_CAPS_ANY);
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  source = ges_custom_timeline_source_new (my_fill_track_func, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer,
+          GES_TIMELINE_OBJECT (source)));
+  ges_timeline_object_set_start (GES_TIMELINE_OBJECT (source), 42);
+
+  ges_trace_set_enabled (FALSE);
+  /* Not recorded */
+  ges_timeline_object_set_duration (GES_TIMELINE_OBJECT (source), 42);
+
+  fd = g_file_open_tmp ("ges-trace-XXXXXX", &path, NULL);
+  fail_unless (fd >= 0);
+  close (fd);
+
+  fail_unless (ges_trace_save (path));
+  fail_unless (g_file_get_contents (path, &contents, NULL, NULL));
+  fail_unless (g_str_has_prefix (contents, "{\"traceEvents\":["));
+  fail_unless (strstr (contents, "\"timeline-layer-add-object\"") != NULL);
+  fail_unless (strstr (contents, "\"track-add-object\"") != NULL);
+  fail_unless (strstr (contents, "\"timeline-object-set-start\"") != NULL);
+  fail_unless (strstr (contents, "\"timeline-object-set-duration\"") == NULL);
+
+  g_unlink (path);
+  g_free (contents);
+  g_free (path);
+  ges_trace_clear ();
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -566,6 +857,10 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_ges_timeline_add_layer);
   tcase_add_test (tc_chain, test_ges_timeline_add_layer_first);
   tcase_add_test (tc_chain, test_ges_timeline_remove_track);
+  tcase_add_test (tc_chain, test_ges_timeline_stats);
+  tcase_add_test (tc_chain, test_ges_timeline_batch);
+  tcase_add_test (tc_chain, test_ges_timeline_batch_notify);
+  tcase_add_test (tc_chain, test_ges_trace);
 
   return s;
 }
@@ -458,6 +458,210 @@ GST_START_TEST (test_tl_obj_signals)
 }
 
 GST_END_TEST;
+static void
+height_notify_cb (GObject * object, GParamSpec * arg, guint * count)
+{
+  (*count)++;
+}
+
+GST_START_TEST (test_tl_object_height)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track_video;
+  GESTrackParseLaunchEffect *track_effect, *track_effect1;
+  GESTimelineTestSource *source;
+  guint count = 0;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_layer_new ();
+  track_video = ges_track_video_raw_new ();
+
+  ges_timeline_add_track (timeline, track_video);
+  ges_timeline_add_layer (timeline, layer);
+
+  source = ges_timeline_test_source_new ();
+  g_object_set (source, "duration", 10 * GST_SECOND, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer,
+          (GESTimelineObject *) source));
+  assert_equals_int (GES_TIMELINE_OBJECT_HEIGHT (source), 1);
+
+  g_signal_connect (source, "notify::height", G_CALLBACK (height_notify_cb),
+      &count);
+
+  track_effect = ges_track_parse_launch_effect_new ("identity");
+  fail_unless (ges_timeline_object_add_track_object (GES_TIMELINE_OBJECT
+          (source), GES_TRACK_OBJECT (track_effect)));
+  fail_unless (ges_track_add_object (track_video,
+          GES_TRACK_OBJECT (track_effect)));
+  track_effect1 = ges_track_parse_launch_effect_new ("identity");
+  fail_unless (ges_timeline_object_add_track_object (GES_TIMELINE_OBJECT
+          (source), GES_TRACK_OBJECT (track_effect1)));
+  fail_unless (ges_track_add_object (track_video,
+          GES_TRACK_OBJECT (track_effect1)));
+  assert_equals_int (GES_TIMELINE_OBJECT_HEIGHT (source), 3);
+  assert_equals_int (count, 2);
+
+  /* Moving the object doesn't change its height */
+  ges_timeline_object_set_priority (GES_TIMELINE_OBJECT (source), 10);
+  assert_equals_int (GES_TIMELINE_OBJECT_HEIGHT (source), 3);
+  assert_equals_int (count, 2);
+
+  /* Removing an effect makes the object shorter again */
+  g_object_ref (track_effect);
+  fail_unless (ges_track_remove_object (track_video,
+          GES_TRACK_OBJECT (track_effect)));
+  fail_unless (ges_timeline_object_release_track_object (GES_TIMELINE_OBJECT
+          (source), GES_TRACK_OBJECT (track_effect)));
+  assert_equals_int (GES_TIMELINE_OBJECT_HEIGHT (source), 2);
+  assert_equals_int (count, 3);
+  g_object_unref (track_effect);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+#define in_composition(trackobject) \
+  (GST_OBJECT_PARENT (ges_track_object_get_gnlobject (trackobject)) != NULL)
+
+GST_START_TEST (test_fuse_effects)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track_video;
+  GESTrackObject *effect, *effect1;
+  GESTimelineTestSource *source;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_layer_new ();
+  track_video = ges_track_video_raw_new ();
+
+  ges_timeline_add_track (timeline, track_video);
+  ges_timeline_add_layer (timeline, layer);
+  ges_track_set_fuse_effects (track_video, TRUE);
+
+  source = ges_timeline_test_source_new ();
+  g_object_set (source, "duration", 10 * GST_SECOND, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer,
+          (GESTimelineObject *) source));
+
+  effect = (GESTrackObject *) ges_track_parse_launch_effect_new ("identity");
+  fail_unless (ges_timeline_object_add_track_object (GES_TIMELINE_OBJECT
+          (source), effect));
+  fail_unless (ges_track_add_object (track_video, effect));
+  effect1 = (GESTrackObject *) ges_track_parse_launch_effect_new ("identity");
+  fail_unless (ges_timeline_object_add_track_object (GES_TIMELINE_OBJECT
+          (source), effect1));
+  fail_unless (ges_track_add_object (track_video, effect1));
+
+  /* The two effects run in one operation once the main context runs */
+  fail_unless (in_composition (effect));
+  while (g_main_context_iteration (NULL, FALSE));
+  fail_if (in_composition (effect));
+  fail_if (in_composition (effect1));
+
+  /* Moving the clip moves the chain along */
+  ges_timeline_object_set_start (GES_TIMELINE_OBJECT (source), GST_SECOND);
+  while (g_main_context_iteration (NULL, FALSE));
+  fail_if (in_composition (effect));
+  assert_equals_uint64 (GES_TRACK_OBJECT_START (effect1), GST_SECOND);
+
+  /* Deactivating an effect splits the chain right away */
+  ges_track_object_set_active (effect1, FALSE);
+  fail_unless (in_composition (effect));
+  fail_unless (in_composition (effect1));
+  while (g_main_context_iteration (NULL, FALSE));
+  fail_unless (in_composition (effect));
+
+  ges_track_object_set_active (effect1, TRUE);
+  while (g_main_context_iteration (NULL, FALSE));
+  fail_if (in_composition (effect1));
+
+  /* Disabling puts everything back */
+  g_object_set (track_video, "fuse-effects", FALSE, NULL);
+  fail_unless (in_composition (effect));
+  fail_unless (in_composition (effect1));
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_effect_template)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track_video;
+  GESTimelineTestSource *source1, *source2;
+  GESTrackObject *effect1, *effect2;
+  GstElement *element1, *element2;
+  guint scratch_lines;
+  gboolean color_aging;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_layer_new ();
+  track_video = ges_track_video_raw_new ();
+
+  ges_timeline_add_track (timeline, track_video);
+  ges_timeline_add_layer (timeline, layer);
+
+  source1 = ges_timeline_test_source_new ();
+  g_object_set (source1, "duration", 10 * GST_SECOND, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer,
+          (GESTimelineObject *) source1));
+  source2 = ges_timeline_test_source_new ();
+  g_object_set (source2, "start", 10 * GST_SECOND, "duration",
+      10 * GST_SECOND, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer,
+          (GESTimelineObject *) source2));
+
+  /* The first effect is parsed, the second one is built from the template
+   * the first one left */
+  effect1 = GES_TRACK_OBJECT (ges_track_parse_launch_effect_new
+      ("agingtv scratch-lines=3 color-aging=false"));
+  fail_unless (ges_timeline_object_add_track_object (GES_TIMELINE_OBJECT
+          (source1), effect1));
+  fail_unless (ges_track_add_object (track_video, effect1));
+
+  effect2 = GES_TRACK_OBJECT (ges_track_parse_launch_effect_new
+      ("agingtv scratch-lines=3 color-aging=false"));
+  fail_unless (ges_timeline_object_add_track_object (GES_TIMELINE_OBJECT
+          (source2), effect2));
+  fail_unless (ges_track_add_object (track_video, effect2));
+
+  element1 = ges_track_object_get_element (effect1);
+  element2 = ges_track_object_get_element (effect2);
+  fail_unless (GST_IS_ELEMENT (element1));
+  fail_unless (GST_IS_ELEMENT (element2));
+  fail_unless (element1 != element2);
+
+  /* Both got the properties of the description */
+  ges_track_object_get_child_property (effect2, "scratch-lines",
+      &scratch_lines, "color-aging", &color_aging, NULL);
+  assert_equals_int (scratch_lines, 3);
+  fail_unless (color_aging == FALSE);
+
+  /* And their elements are independent */
+  ges_track_object_set_child_property (effect1, "scratch-lines", 17, NULL);
+  ges_track_object_get_child_property (effect1, "scratch-lines",
+      &scratch_lines, NULL);
+  assert_equals_int (scratch_lines, 17);
+  ges_track_object_get_child_property (effect2, "scratch-lines",
+      &scratch_lines, NULL);
+  assert_equals_int (scratch_lines, 3);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -473,6 +677,9 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_priorities_tl_object);
   tcase_add_test (tc_chain, test_track_effect_set_properties);
   tcase_add_test (tc_chain, test_tl_obj_signals);
+  tcase_add_test (tc_chain, test_tl_object_height);
+  tcase_add_test (tc_chain, test_fuse_effects);
+  tcase_add_test (tc_chain, test_effect_template);
 
   return s;
 }
@@ -18,7 +18,10 @@
  */
 
 #include <ges/ges.h>
+#include <ges/ges-internal.h>
+#undef GST_CAT_DEFAULT
 #include <gst/check/gstcheck.h>
+#include <glib/gstdio.h>
 
 /* This test uri will eventually have to be fixed */
 #define TEST_URI "http://nowhere/blahblahblah"
@@ -155,6 +158,93 @@ GST_START_TEST (test_filesource_properties)
 
 GST_END_TEST;
 
+#define in_composition(trackobject) \
+  (GST_OBJECT_PARENT (ges_track_object_get_gnlobject (trackobject)) != NULL)
+
+GST_START_TEST (test_filesource_share_decoders)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track;
+  GESTimelineObject *object1, *object2;
+  GESTrackObject *trobj1, *trobj2;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  track = ges_track_new (GES_TRACK_TYPE_AUDIO, GST_CAPS_ANY);
+  fail_unless (ges_timeline_add_track (timeline, track));
+  ges_track_set_share_decoders (track, TRUE);
+
+  /* Two back-to-back pieces of the same file */
+  object1 = (GESTimelineObject *) ges_timeline_filesource_new ((gchar *)
+      "crack:///there/is/no/way/this/exists");
+  g_object_set (object1, "start", (guint64) 0, "duration", (guint64) 10,
+      "in-point", (guint64) 5, "supported-formats", GES_TRACK_TYPE_AUDIO,
+      NULL);
+  object2 = (GESTimelineObject *) ges_timeline_filesource_new ((gchar *)
+      "crack:///there/is/no/way/this/exists");
+  g_object_set (object2, "start", (guint64) 10, "duration", (guint64) 20,
+      "in-point", (guint64) 15, "supported-formats", GES_TRACK_TYPE_AUDIO,
+      NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, object1));
+  fail_unless (ges_timeline_layer_add_object (layer, object2));
+
+  trobj1 = ges_timeline_object_find_track_object (object1, track, G_TYPE_NONE);
+  trobj2 = ges_timeline_object_find_track_object (object2, track, G_TYPE_NONE);
+  fail_unless (trobj1 != NULL);
+  fail_unless (trobj2 != NULL);
+
+  /* They get merged once the main context runs */
+  fail_unless (in_composition (trobj1));
+  while (g_main_context_iteration (NULL, FALSE));
+  fail_if (in_composition (trobj1));
+  fail_if (in_composition (trobj2));
+
+  /* The pieces keep their own values */
+  assert_equals_uint64 (GES_TRACK_OBJECT_DURATION (trobj1), 10);
+  assert_equals_uint64 (GES_TRACK_OBJECT_START (trobj2), 10);
+  assert_equals_uint64 (GES_TRACK_OBJECT_INPOINT (trobj2), 15);
+
+  /* Any gap in the media splits them again, right away */
+  g_object_set (object2, "in-point", (guint64) 16, NULL);
+  fail_unless (in_composition (trobj1));
+  fail_unless (in_composition (trobj2));
+  while (g_main_context_iteration (NULL, FALSE));
+  fail_unless (in_composition (trobj1));
+  fail_unless (in_composition (trobj2));
+
+  g_object_set (object2, "in-point", (guint64) 15, NULL);
+  while (g_main_context_iteration (NULL, FALSE));
+  fail_if (in_composition (trobj2));
+
+  /* Deactivating a piece splits them too, and keeps them apart */
+  ges_track_object_set_active (trobj2, FALSE);
+  fail_unless (in_composition (trobj1));
+  fail_unless (in_composition (trobj2));
+  while (g_main_context_iteration (NULL, FALSE));
+  fail_unless (in_composition (trobj1));
+  fail_unless (in_composition (trobj2));
+
+  ges_track_object_set_active (trobj2, TRUE);
+  while (g_main_context_iteration (NULL, FALSE));
+  fail_if (in_composition (trobj1));
+  fail_if (in_composition (trobj2));
+
+  /* Disabling puts everything back */
+  g_object_set (track, "share-decoders", FALSE, NULL);
+  fail_unless (in_composition (trobj1));
+  fail_unless (in_composition (trobj2));
+
+  g_object_unref (trobj1);
+  g_object_unref (trobj2);
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_filesource_images)
 {
   GESTrackObject *trobj;
@@ -199,6 +289,326 @@ GST_START_TEST (test_filesource_images)
 GST_END_TEST;
 
 
+/* Writes a @width x @height PNG image, returns its URI */
+static gchar *
+make_image (const gchar * path, gint width, gint height)
+{
+  GstElement *pipeline;
+  GstMessage *message;
+  GstBus *bus;
+  gchar *desc;
+
+  desc = g_strdup_printf ("videotestsrc num-buffers=1 ! "
+      "video/x-raw-rgb,width=%d,height=%d ! ffmpegcolorspace ! pngenc ! "
+      "filesink location=\"%s\"", width, height, path);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (pipeline != NULL);
+
+  bus = gst_element_get_bus (pipeline);
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  message = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (message && GST_MESSAGE_TYPE (message) == GST_MESSAGE_EOS);
+  gst_message_unref (message);
+  gst_object_unref (bus);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return g_filename_to_uri (path, NULL, NULL);
+}
+
+static void
+image_handoff_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    GstCaps ** caps)
+{
+  gst_caps_replace (caps, GST_BUFFER_CAPS (buffer));
+}
+
+static void
+image_pad_added_cb (GstElement * timeline, GstPad * pad, GstCaps ** caps)
+{
+  GstElement *sink = gst_element_factory_make ("fakesink", NULL);
+  GstPad *sinkpad;
+
+  g_object_set (sink, "sync", FALSE, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "handoff", G_CALLBACK (image_handoff_cb), caps);
+  gst_bin_add (GST_BIN (GST_OBJECT_PARENT (timeline)), sink);
+  gst_element_sync_state_with_parent (sink);
+
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (pad, sinkpad)));
+  gst_object_unref (sinkpad);
+}
+
+/* Plays @timeline to the end, returns the caps of its last buffer */
+static GstCaps *
+play_timeline (GESTimeline * timeline)
+{
+  GstElement *pipeline;
+  GstMessage *message;
+  GstCaps *caps = NULL;
+  GstBus *bus;
+
+  pipeline = gst_pipeline_new (NULL);
+  g_signal_connect (timeline, "pad-added", G_CALLBACK (image_pad_added_cb),
+      &caps);
+  gst_bin_add (GST_BIN (pipeline), GST_ELEMENT (g_object_ref (timeline)));
+
+  bus = gst_element_get_bus (pipeline);
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  message = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (message && GST_MESSAGE_TYPE (message) == GST_MESSAGE_EOS);
+  gst_message_unref (message);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  g_signal_handlers_disconnect_by_func (timeline, image_pad_added_cb, &caps);
+  gst_bin_remove (GST_BIN (pipeline), GST_ELEMENT (timeline));
+  gst_object_unref (pipeline);
+
+  return caps;
+}
+
+static GESTimelineObject *
+add_image (GESTimelineLayer * layer, const gchar * uri, GstClockTime start)
+{
+  GESTimelineObject *object;
+
+  object = (GESTimelineObject *) ges_timeline_filesource_new ((gchar *) uri);
+  g_object_set (object, "start", start, "duration", GST_SECOND / 2,
+      "max-duration", (guint64) 3600 * GST_SECOND, "supported-formats",
+      GES_TRACK_TYPE_VIDEO, "is-image", TRUE, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, object));
+
+  return object;
+}
+
+GST_START_TEST (test_image_cache)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track;
+  GstCaps *caps;
+  GstStructure *structure;
+  gchar *path, *uri;
+  guint64 size;
+  guint n_frames, decodes, first_decodes, i;
+  gint width, height;
+
+  ges_init ();
+
+  if (!gst_default_registry_check_feature_version ("pngenc", 0, 10, 0)) {
+    GST_WARNING ("pngenc missing, skipping");
+    return;
+  }
+
+  /* Smaller than the track, so it has to be scaled */
+  path = g_build_filename (g_get_tmp_dir (), "ges-image-cache.png", NULL);
+  uri = make_image (path, 64, 48);
+
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  caps = gst_caps_from_string ("video/x-raw-yuv,width=320,height=240,"
+      "framerate=25/1,pixel-aspect-ratio=1/1");
+  track = ges_track_new (GES_TRACK_TYPE_VIDEO, caps);
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  /* The same image twice... */
+  ges_track_image_source_cache_get_stats (NULL, NULL, &first_decodes);
+  add_image (layer, uri, 0);
+  add_image (layer, uri, GST_SECOND / 2);
+
+  /* ... which gets decoded once, before anything plays */
+  for (i = 0; i < 100; i++) {
+    ges_track_image_source_cache_get_stats (&size, &n_frames, &decodes);
+    if (decodes != first_decodes)
+      break;
+    g_usleep (G_USEC_PER_SEC / 20);
+  }
+  assert_equals_int (decodes - first_decodes, 1);
+  assert_equals_int (n_frames, 1);
+  /* and is cached at the size of the track */
+  fail_unless (size >= 320 * 240);
+
+  caps = play_timeline (timeline);
+  fail_unless (caps != NULL);
+  structure = gst_caps_get_structure (caps, 0);
+  fail_unless (gst_structure_get_int (structure, "width", &width));
+  fail_unless (gst_structure_get_int (structure, "height", &height));
+  assert_equals_int (width, 320);
+  assert_equals_int (height, 240);
+  gst_caps_unref (caps);
+
+  /* It was only decoded once, the second source found it in the cache */
+  ges_track_image_source_cache_get_stats (&size, &n_frames, &decodes);
+  assert_equals_int (decodes - first_decodes, 1);
+  assert_equals_int (n_frames, 1);
+  fail_unless (size > 0);
+
+  /* Frames in use aren't dropped... */
+  ges_track_image_source_cache_set_max_size (1);
+  ges_track_image_source_cache_get_stats (&size, &n_frames, NULL);
+  assert_equals_int (n_frames, 1);
+
+  /* ... until their elements are gone */
+  g_object_unref (timeline);
+  ges_track_image_source_cache_get_stats (&size, &n_frames, NULL);
+  assert_equals_int (n_frames, 0);
+  assert_equals_uint64 (size, 0);
+  ges_track_image_source_cache_set_max_size (256 * 1024 * 1024);
+
+  g_unlink (path);
+  g_free (path);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_image_cache_eviction)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track;
+  GstCaps *caps;
+  gchar *path1, *path2, *uri1, *uri2;
+  guint64 size;
+  guint n_frames;
+
+  ges_init ();
+
+  if (!gst_default_registry_check_feature_version ("pngenc", 0, 10, 0)) {
+    GST_WARNING ("pngenc missing, skipping");
+    return;
+  }
+
+  path1 = g_build_filename (g_get_tmp_dir (), "ges-image-cache1.png", NULL);
+  path2 = g_build_filename (g_get_tmp_dir (), "ges-image-cache2.png", NULL);
+  uri1 = make_image (path1, 32, 32);
+  uri2 = make_image (path2, 32, 32);
+
+  /* Room for a single frame */
+  ges_track_image_source_cache_set_max_size (32 * 32 * 4);
+
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  track = ges_track_video_raw_new ();
+  fail_unless (ges_timeline_add_track (timeline, track));
+  add_image (layer, uri1, 0);
+  add_image (layer, uri2, GST_SECOND / 2);
+
+  caps = play_timeline (timeline);
+  fail_unless (caps != NULL);
+  gst_caps_unref (caps);
+
+  /* Both frames are still in use by the elements of the timeline */
+  ges_track_image_source_cache_get_stats (&size, &n_frames, NULL);
+  assert_equals_int (n_frames, 2);
+
+  /* Once they aren't, the least recently used one is dropped */
+  g_object_unref (timeline);
+  ges_track_image_source_cache_get_stats (&size, &n_frames, NULL);
+  assert_equals_int (n_frames, 1);
+  fail_unless (size <= 32 * 32 * 4);
+
+  ges_track_image_source_cache_set_max_size (256 * 1024 * 1024);
+
+  g_unlink (path1);
+  g_unlink (path2);
+  g_free (path1);
+  g_free (path2);
+  g_free (uri1);
+  g_free (uri2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_filesource_lookahead)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track;
+  GESTrackObject *trobjs[4];
+  guint i;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  track = ges_track_new (GES_TRACK_TYPE_AUDIO, GST_CAPS_ANY);
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  /* Four back-to-back clips of 10s, from different pieces of a file */
+  for (i = 0; i < 4; i++) {
+    GESTimelineObject *object;
+
+    object = (GESTimelineObject *) ges_timeline_filesource_new ((gchar *)
+        "crack:///there/is/no/way/this/exists");
+    g_object_set (object, "start", (guint64) i * 10 * GST_SECOND,
+        "duration", (guint64) 10 * GST_SECOND, "in-point", (guint64) i,
+        "supported-formats", GES_TRACK_TYPE_AUDIO, NULL);
+    fail_unless (ges_timeline_layer_add_object (layer, object));
+    trobjs[i] = ges_timeline_object_find_track_object (object, track,
+        G_TYPE_NONE);
+    fail_unless (trobjs[i] != NULL);
+  }
+
+  /* The next two clips starting within the window, not the current one */
+  ges_track_set_lookahead (track, 2, 25 * GST_SECOND, G_MAXUINT64);
+  ges_track_lookahead_update (track, 0);
+  fail_if (ges_track_is_prerolling (track, trobjs[0]));
+  fail_unless (ges_track_is_prerolling (track, trobjs[1]));
+  fail_unless (ges_track_is_prerolling (track, trobjs[2]));
+  fail_if (ges_track_is_prerolling (track, trobjs[3]));
+
+  /* The clip that started is dropped, the next one comes in */
+  ges_track_lookahead_update (track, 15 * GST_SECOND);
+  fail_if (ges_track_is_prerolling (track, trobjs[1]));
+  fail_unless (ges_track_is_prerolling (track, trobjs[2]));
+  fail_unless (ges_track_is_prerolling (track, trobjs[3]));
+
+  /* Moving a clip out of the window drops it too */
+  g_object_set (trobjs[3], "start", (guint64) 45 * GST_SECOND, NULL);
+  ges_track_lookahead_update (track, 15 * GST_SECOND);
+  fail_unless (ges_track_is_prerolling (track, trobjs[2]));
+  fail_if (ges_track_is_prerolling (track, trobjs[3]));
+  g_object_set (trobjs[3], "start", (guint64) 30 * GST_SECOND, NULL);
+  ges_track_lookahead_update (track, 15 * GST_SECOND);
+  fail_unless (ges_track_is_prerolling (track, trobjs[3]));
+
+  /* Over the budget, only the closest one is kept */
+  ges_track_set_lookahead (track, 2, 25 * GST_SECOND, 1);
+  ges_track_lookahead_update (track, 15 * GST_SECOND);
+  fail_unless (ges_track_is_prerolling (track, trobjs[2]));
+  fail_if (ges_track_is_prerolling (track, trobjs[3]));
+
+  /* And no new one is pre-rolled past it */
+  ges_track_lookahead_update (track, GST_CLOCK_TIME_NONE);
+  for (i = 0; i < 4; i++)
+    fail_if (ges_track_is_prerolling (track, trobjs[i]));
+  ges_track_set_lookahead (track, 3, 25 * GST_SECOND, 1);
+  ges_track_lookahead_update (track, 5 * GST_SECOND);
+  fail_unless (ges_track_is_prerolling (track, trobjs[1]));
+  fail_if (ges_track_is_prerolling (track, trobjs[2]));
+  fail_if (ges_track_is_prerolling (track, trobjs[3]));
+
+  /* Disabling drops everything */
+  ges_track_set_lookahead (track, 0, 25 * GST_SECOND, 1);
+  while (g_main_context_iteration (NULL, FALSE));
+  for (i = 0; i < 4; i++) {
+    fail_if (ges_track_is_prerolling (track, trobjs[i]));
+    g_object_unref (trobjs[i]);
+  }
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -210,6 +620,10 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_filesource_basic);
   tcase_add_test (tc_chain, test_filesource_images);
   tcase_add_test (tc_chain, test_filesource_properties);
+  tcase_add_test (tc_chain, test_filesource_share_decoders);
+  tcase_add_test (tc_chain, test_filesource_lookahead);
+  tcase_add_test (tc_chain, test_image_cache);
+  tcase_add_test (tc_chain, test_image_cache_eviction);
 
   return s;
 }
@@ -115,19 +115,20 @@ GST_START_TEST (test_layer_properties)
   gnl_object_check (ges_track_object_get_gnlobject (trackobject), 42, 51, 12,
       51, 0, TRUE);
 
-  /* Change the priority of the layer */
+  /* Change the priority of the layer, it is alone so its objects don't
+   * need to move */
   g_object_set (layer, "priority", 1, NULL);
   assert_equals_int (ges_timeline_layer_get_priority (layer), 1);
   assert_equals_uint64 (GES_TIMELINE_OBJECT_PRIORITY (object), 0);
   gnl_object_check (ges_track_object_get_gnlobject (trackobject), 42, 51, 12,
-      51, LAYER_HEIGHT, TRUE);
+      51, 0, TRUE);
 
   /* Change it to an insanely high value */
   g_object_set (layer, "priority", 31, NULL);
   assert_equals_int (ges_timeline_layer_get_priority (layer), 31);
   assert_equals_uint64 (GES_TIMELINE_OBJECT_PRIORITY (object), 0);
   gnl_object_check (ges_track_object_get_gnlobject (trackobject), 42, 51, 12,
-      51, LAYER_HEIGHT * 31, TRUE);
+      51, 0, TRUE);
 
   /* and back to 0 */
   g_object_set (layer, "priority", 0, NULL);
@@ -225,13 +226,13 @@ GST_START_TEST (test_layer_priorities)
   /* object2 is on the second layer and has a priority of 1 */
   assert_equals_int (prio2, LAYER_HEIGHT + 1);
 
-  assert_equals_int (GES_TIMELINE_OBJECT_PRIORITY (object3), LAYER_HEIGHT - 1);
+  /* Layers aren't limited to LAYER_HEIGHT priorities */
+  assert_equals_int (GES_TIMELINE_OBJECT_PRIORITY (object3), LAYER_HEIGHT + 1);
   gnlobj3 = ges_track_object_get_gnlobject (tckobj3);
   fail_unless (gnlobj3 != NULL);
-  /* object3 is on the third layer and has a priority of LAYER_HEIGHT + 1
-   * it priority must have the maximum priority of this layer*/
+  /* object3 is on the third layer and has a priority of LAYER_HEIGHT + 1 */
   g_object_get (gnlobj3, "priority", &prio3, NULL);
-  assert_equals_int (prio3, LAYER_HEIGHT * 3 - 1);
+  assert_equals_int (prio3, LAYER_HEIGHT * 3 + 1);
 
   /* Move layers around */
   g_object_set (layer1, "priority", 2, NULL);
@@ -244,13 +245,16 @@ GST_START_TEST (test_layer_priorities)
   assert_equals_int (ges_timeline_layer_get_priority (layer3), 1);
   assert_equals_int (GES_TIMELINE_OBJECT_PRIORITY (object1), 0);
   assert_equals_int (GES_TIMELINE_OBJECT_PRIORITY (object2), 1);
-  assert_equals_int (GES_TIMELINE_OBJECT_PRIORITY (object3), LAYER_HEIGHT - 1);
+  assert_equals_int (GES_TIMELINE_OBJECT_PRIORITY (object3), LAYER_HEIGHT + 1);
   g_object_get (gnlobj1, "priority", &prio1, NULL);
   g_object_get (gnlobj2, "priority", &prio2, NULL);
   g_object_get (gnlobj3, "priority", &prio3, NULL);
-  assert_equals_int (prio1, 2 * LAYER_HEIGHT);
-  assert_equals_int (prio2, 1);
-  assert_equals_int (prio3, LAYER_HEIGHT * 2 - 1);
+  /* Only layer1 had to move, the other ones are still in order */
+  assert_equals_int (prio2, LAYER_HEIGHT + 1);
+  assert_equals_int (prio3, LAYER_HEIGHT * 3 + 1);
+  assert_equals_int (prio1, layer1->min_gnl_priority);
+  fail_unless (prio2 < prio3);
+  fail_unless (prio3 < prio1);
 
   /* And move objects around */
   fail_unless (ges_timeline_object_move_to_layer (object2, layer1));
@@ -269,19 +273,19 @@ GST_START_TEST (test_layer_priorities)
   /*  Check their priorities (layer1 priority is now 2) */
   assert_equals_int (GES_TIMELINE_OBJECT_PRIORITY (object1), 0);
   assert_equals_int (GES_TIMELINE_OBJECT_PRIORITY (object2), 1);
-  assert_equals_int (GES_TIMELINE_OBJECT_PRIORITY (object3), LAYER_HEIGHT - 1);
+  assert_equals_int (GES_TIMELINE_OBJECT_PRIORITY (object3), LAYER_HEIGHT + 1);
   g_object_get (gnlobj1, "priority", &prio1, NULL);
   g_object_get (gnlobj2, "priority", &prio2, NULL);
   g_object_get (gnlobj3, "priority", &prio3, NULL);
-  assert_equals_int (prio1, 2 * LAYER_HEIGHT);
-  assert_equals_int (prio2, 2 * LAYER_HEIGHT + 1);
-  assert_equals_int (prio3, LAYER_HEIGHT * 3 - 1);
+  assert_equals_int (prio1, layer1->min_gnl_priority);
+  assert_equals_int (prio2, layer1->min_gnl_priority + 1);
+  assert_equals_int (prio3, layer1->min_gnl_priority + LAYER_HEIGHT + 1);
 
   /* And change TrackObject-s priorities and check that changes are well
    * refected on it containing TimelineObject */
-  ges_track_object_set_priority (tckobj3, LAYER_HEIGHT * 2);
+  ges_track_object_set_priority (tckobj3, layer1->min_gnl_priority);
   g_object_get (gnlobj3, "priority", &prio3, NULL);
-  assert_equals_int (prio3, 2 * LAYER_HEIGHT);
+  assert_equals_int (prio3, layer1->min_gnl_priority);
   assert_equals_int (GES_TIMELINE_OBJECT_PRIORITY (object3), 0);
 
   g_object_unref (tckobj1);
@@ -332,6 +336,246 @@ GST_START_TEST (test_layer_automatic_transition)
 GST_END_TEST;
 
 
+#define in_composition(trackobject) \
+  (GST_OBJECT_PARENT (ges_track_object_get_gnlobject (trackobject)) != NULL)
+
+GST_START_TEST (test_layer_mute_solo)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer1, *layer2;
+  GESTrack *track, *track2;
+  GESTrackObject *trobj1, *trobj2, *trobj3;
+  GESTimelineObject *object1, *object2;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer1 = (GESTimelineLayer *) ges_timeline_layer_new ();
+  layer2 = (GESTimelineLayer *) ges_timeline_layer_new ();
+  ges_timeline_layer_set_priority (layer2, 1);
+  fail_unless (ges_timeline_add_layer (timeline, layer1));
+  fail_unless (ges_timeline_add_layer (timeline, layer2));
+
+  track = ges_track_new (GES_TRACK_TYPE_CUSTOM, GST_CAPS_ANY);
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  object1 = (GESTimelineObject *)
+      ges_custom_timeline_source_new (my_fill_track_func, NULL);
+  object2 = (GESTimelineObject *)
+      ges_custom_timeline_source_new (my_fill_track_func, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer1, object1));
+  fail_unless (ges_timeline_layer_add_object (layer2, object2));
+
+  trobj1 = ges_timeline_object_find_track_object (object1, track, G_TYPE_NONE);
+  trobj2 = ges_timeline_object_find_track_object (object2, track, G_TYPE_NONE);
+  fail_unless (trobj1 != NULL);
+  fail_unless (trobj2 != NULL);
+  fail_unless (in_composition (trobj1));
+  fail_unless (in_composition (trobj2));
+
+  /* Muting a layer takes its objects out of the composition */
+  g_object_set (layer1, "muted", TRUE, NULL);
+  fail_if (in_composition (trobj1));
+  fail_unless (in_composition (trobj2));
+  ges_timeline_layer_set_muted (layer1, FALSE);
+  fail_unless (in_composition (trobj1));
+
+  /* Soloing a layer mutes all the others */
+  ges_timeline_layer_set_solo (layer2, TRUE);
+  fail_if (in_composition (trobj1));
+  fail_unless (in_composition (trobj2));
+
+  /* Objects added to a silenced layer don't enter the composition */
+  fail_unless (ges_timeline_layer_remove_object (layer1, object1));
+  g_object_unref (trobj1);
+  object1 = (GESTimelineObject *)
+      ges_custom_timeline_source_new (my_fill_track_func, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer1, object1));
+  trobj1 = ges_timeline_object_find_track_object (object1, track, G_TYPE_NONE);
+  fail_if (in_composition (trobj1));
+
+  ges_timeline_layer_set_solo (layer2, FALSE);
+  fail_unless (in_composition (trobj1));
+  fail_unless (in_composition (trobj2));
+
+  /* Muting the track silences everything */
+  ges_track_set_muted (track, TRUE);
+  fail_if (in_composition (trobj1));
+  fail_if (in_composition (trobj2));
+  ges_track_set_muted (track, FALSE);
+  fail_unless (in_composition (trobj1));
+  fail_unless (in_composition (trobj2));
+
+  /* Moving an object to a muted layer silences it, and back */
+  ges_timeline_layer_set_muted (layer2, TRUE);
+  fail_unless (ges_timeline_object_move_to_layer (object1, layer2));
+  fail_if (in_composition (trobj1));
+  fail_unless (ges_timeline_object_move_to_layer (object1, layer1));
+  fail_unless (in_composition (trobj1));
+  ges_timeline_layer_set_muted (layer2, FALSE);
+  fail_unless (in_composition (trobj2));
+
+  /* Soloing a track silences the other tracks */
+  track2 = ges_track_new (GES_TRACK_TYPE_CUSTOM, GST_CAPS_ANY);
+  fail_unless (ges_timeline_add_track (timeline, track2));
+  trobj3 = ges_timeline_object_find_track_object (object2, track2,
+      G_TYPE_NONE);
+  fail_unless (trobj3 != NULL);
+  fail_unless (in_composition (trobj3));
+
+  g_object_set (track2, "solo", TRUE, NULL);
+  fail_if (in_composition (trobj1));
+  fail_if (in_composition (trobj2));
+  fail_unless (in_composition (trobj3));
+  ges_track_set_solo (track2, FALSE);
+  fail_unless (in_composition (trobj1));
+  fail_unless (in_composition (trobj2));
+  fail_unless (in_composition (trobj3));
+
+  g_object_unref (trobj1);
+  g_object_unref (trobj2);
+  g_object_unref (trobj3);
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+static guint32
+object_gnl_priority (GESTimelineObject * object, GESTrack * track)
+{
+  GESTrackObject *trobj;
+  guint32 priority;
+
+  trobj = ges_timeline_object_find_track_object (object, track, G_TYPE_NONE);
+  fail_unless (trobj != NULL);
+  g_object_get (ges_track_object_get_gnlobject (trobj), "priority", &priority,
+      NULL);
+  g_object_unref (trobj);
+
+  return priority;
+}
+
+GST_START_TEST (test_layer_sparse_priorities)
+{
+  GESTimeline *timeline;
+  GESTrack *track;
+  GESTimelineLayer *layers[10];
+  GESTimelineObject *objects[10];
+  guint32 before[10];
+  guint i;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  track = ges_track_new (GES_TRACK_TYPE_CUSTOM, GST_CAPS_ANY);
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  for (i = 0; i < 10; i++) {
+    layers[i] = ges_timeline_layer_new ();
+    fail_unless (ges_timeline_append_layer (timeline, layers[i]));
+    objects[i] = (GESTimelineObject *)
+        ges_custom_timeline_source_new (my_fill_track_func, NULL);
+    fail_unless (ges_timeline_layer_add_object (layers[i], objects[i]));
+    before[i] = object_gnl_priority (objects[i], track);
+  }
+
+  /* Move the first layer to the bottom, only its objects are renumbered */
+  ges_timeline_layer_set_priority (layers[0], 10);
+  for (i = 1; i < 10; i++)
+    ges_timeline_layer_set_priority (layers[i], i - 1);
+  ges_timeline_layer_set_priority (layers[0], 9);
+
+  for (i = 1; i < 10; i++)
+    assert_equals_int (object_gnl_priority (objects[i], track), before[i]);
+  fail_unless (object_gnl_priority (objects[0], track) > before[9]);
+
+  /* Growing a layer past the next one makes room without any limit */
+  ges_timeline_object_set_priority (objects[3], 3 * LAYER_HEIGHT);
+  assert_equals_int (GES_TIMELINE_OBJECT_PRIORITY (objects[3]),
+      3 * LAYER_HEIGHT);
+  assert_equals_int (object_gnl_priority (objects[3], track),
+      layers[3]->min_gnl_priority + 3 * LAYER_HEIGHT);
+  fail_unless (object_gnl_priority (objects[3], track) <=
+      layers[3]->max_gnl_priority);
+
+  /* And the layers are still in order */
+  for (i = 2; i < 10; i++) {
+    fail_unless (layers[i]->min_gnl_priority >
+        layers[i - 1]->max_gnl_priority);
+    assert_equals_int (object_gnl_priority (objects[i], track),
+        layers[i]->min_gnl_priority + (i == 3 ? 3 * LAYER_HEIGHT : 0));
+  }
+  fail_unless (layers[0]->min_gnl_priority > layers[9]->max_gnl_priority);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_layer_paste_objects)
+{
+  GESTimeline *timeline;
+  GESTrack *track;
+  GESTimelineLayer *layer;
+  GESTimelineObject *first, *second, *copy;
+  GESTrackParseLaunchEffect *effect;
+  GList *objects, *pasted, *effects;
+  guint scratch_lines;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  track = ges_track_video_raw_new ();
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+
+  first = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (first, "start", (guint64) 10, "duration", (guint64) 10, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, first));
+  second = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (second, "start", (guint64) 30, "duration", (guint64) 5, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, second));
+
+  effect = ges_track_parse_launch_effect_new ("agingtv");
+  fail_unless (ges_timeline_object_add_track_object (second,
+          GES_TRACK_OBJECT (effect)));
+  fail_unless (ges_track_add_object (track, GES_TRACK_OBJECT (effect)));
+  ges_track_object_set_child_property (GES_TRACK_OBJECT (effect),
+      "GstAgingTV::scratch-lines", 17, NULL);
+
+  objects = g_list_append (NULL, second);
+  objects = g_list_append (objects, first);
+  pasted = ges_timeline_layer_paste_objects (layer, objects, 100);
+  g_list_free (objects);
+
+  /* The offsets are kept and the effect comes along */
+  fail_unless (g_list_length (pasted) == 2);
+  copy = pasted->data;
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_START (copy), 120);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_DURATION (copy), 5);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_START (pasted->next->data), 100);
+
+  effects = ges_timeline_object_get_top_effects (copy);
+  fail_unless (g_list_length (effects) == 1);
+  fail_unless (effects->data != effect);
+  ges_track_object_get_child_property (effects->data,
+      "GstAgingTV::scratch-lines", &scratch_lines, NULL);
+  assert_equals_int (scratch_lines, 17);
+  g_list_foreach (effects, (GFunc) g_object_unref, NULL);
+  g_list_free (effects);
+  g_list_free (pasted);
+
+  objects = ges_timeline_layer_get_objects (layer);
+  fail_unless (g_list_length (objects) == 4);
+  g_list_foreach (objects, (GFunc) g_object_unref, NULL);
+  g_list_free (objects);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -342,7 +586,10 @@ ges_suite (void)
 
   tcase_add_test (tc_chain, test_layer_properties);
   tcase_add_test (tc_chain, test_layer_priorities);
+  tcase_add_test (tc_chain, test_layer_sparse_priorities);
   tcase_add_test (tc_chain, test_layer_automatic_transition);
+  tcase_add_test (tc_chain, test_layer_mute_solo);
+  tcase_add_test (tc_chain, test_layer_paste_objects);
 
   return s;
 }
@@ -204,6 +204,80 @@ GST_START_TEST (test_overlay_in_layer)
 
 GST_END_TEST;
 
+static guint
+count_converters (GstElement * element)
+{
+  GstIterator *it;
+  gpointer data;
+  gboolean done = FALSE;
+  guint count = 0;
+
+  it = gst_bin_iterate_recurse (GST_BIN (element));
+  while (!done) {
+    switch (gst_iterator_next (it, &data)) {
+      case GST_ITERATOR_OK:
+        if (!g_strcmp0 (GST_PLUGIN_FEATURE_NAME (gst_element_get_factory
+                    (GST_ELEMENT (data))), "ffmpegcolorspace"))
+          count++;
+        gst_object_unref (data);
+        break;
+      case GST_ITERATOR_RESYNC:
+        count = 0;
+        gst_iterator_resync (it);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  gst_iterator_free (it);
+
+  return count;
+}
+
+GST_START_TEST (test_overlay_conversions)
+{
+  GESTrack *track;
+  GESTrackObject *trackobject;
+  GESTimelineObject *object;
+  GstCaps *caps;
+
+  ges_init ();
+
+  /* The track accepts anything, the output converter is useless */
+  track = ges_track_new (GES_TRACK_TYPE_VIDEO, GST_CAPS_ANY);
+  object = (GESTimelineObject *) ges_timeline_text_overlay_new ();
+  trackobject = ges_timeline_object_create_track_object (object, track);
+  fail_unless (trackobject != NULL);
+  ges_timeline_object_add_track_object (object, trackobject);
+  fail_unless (ges_track_object_set_track (trackobject, track));
+
+  assert_equals_int (count_converters (ges_track_object_get_element
+          (trackobject)), 1);
+
+  ges_timeline_object_release_track_object (object, trackobject);
+  g_object_unref (object);
+  g_object_unref (track);
+
+  /* The track outputs a format textoverlay handles, no conversion needed */
+  caps = gst_caps_from_string ("video/x-raw-yuv,format=(fourcc)I420");
+  track = ges_track_new (GES_TRACK_TYPE_VIDEO, caps);
+  object = (GESTimelineObject *) ges_timeline_text_overlay_new ();
+  trackobject = ges_timeline_object_create_track_object (object, track);
+  fail_unless (trackobject != NULL);
+  ges_timeline_object_add_track_object (object, trackobject);
+  fail_unless (ges_track_object_set_track (trackobject, track));
+
+  assert_equals_int (count_converters (ges_track_object_get_element
+          (trackobject)), 0);
+
+  ges_timeline_object_release_track_object (object, trackobject);
+  g_object_unref (object);
+  g_object_unref (track);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -215,6 +289,7 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_overlay_basic);
   tcase_add_test (tc_chain, test_overlay_properties);
   tcase_add_test (tc_chain, test_overlay_in_layer);
+  tcase_add_test (tc_chain, test_overlay_conversions);
 
   return s;
 }
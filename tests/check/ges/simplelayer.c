@@ -276,13 +276,9 @@ GST_START_TEST (test_gsl_with_transitions)
   fail_unless_equals_uint64 (GES_TIMELINE_OBJECT_DURATION (source1),
       GST_SECOND);
 
-  /* make this source taller than the others, so we can check that
-   * gstlrecalculate handles this properly */
-
   source2 = ges_custom_timeline_source_new (arbitrary_fill_track_func,
       (gpointer) ELEMENT);
   g_object_set (source2, "duration", GST_SECOND, "start", (guint64) 42, NULL);
-  GES_TIMELINE_OBJECT (source2)->height = 4;
   fail_unless_equals_uint64 (GES_TIMELINE_OBJECT_DURATION (source2),
       GST_SECOND);
 
@@ -387,6 +383,11 @@ GST_START_TEST (test_gsl_with_transitions)
   fail_unless_equals_uint64 (GES_TIMELINE_OBJECT_START (source2), HALF_SECOND);
   fail_unless_equals_uint64 (GES_TIMELINE_OBJECT_PRIORITY (source2), 3);
 
+  /* make this source taller than the others, so we can check that
+   * gstlrecalculate handles this properly. The height follows the track
+   * objects, so this has to be done once they are created. */
+  GES_TIMELINE_OBJECT (source2)->height = 4;
+
   /* add the third source before the second transition */
 
   GST_DEBUG ("Adding source3");
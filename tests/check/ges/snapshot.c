@@ -0,0 +1,446 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <ges/ges.h>
+#include <gst/check/gstcheck.h>
+#include <glib/gstdio.h>
+
+static GESTimelineObject *
+get_single_object (GESTimeline * timeline)
+{
+  GList *layers, *objects;
+  GESTimelineObject *object;
+
+  layers = ges_timeline_get_layers (timeline);
+  fail_unless (g_list_length (layers) == 1);
+
+  objects = ges_timeline_layer_get_objects (layers->data);
+  fail_unless (g_list_length (objects) == 1);
+  object = objects->data;
+
+  g_list_free (objects);
+  g_list_foreach (layers, (GFunc) g_object_unref, NULL);
+  g_list_free (layers);
+
+  return object;
+}
+
+GST_START_TEST (test_snapshot_create_timeline)
+{
+  GESTimeline *timeline, *copy;
+  GESTimelineLayer *layer;
+  GESTrack *track;
+  GESTimelineObject *source, *object;
+  GESTrackParseLaunchEffect *effect;
+  GESTimelineSnapshot *snapshot;
+  GList *effects;
+  gint vpattern;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  track = ges_track_video_raw_new ();
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+
+  source = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (source, "start", (guint64) 5 * GST_SECOND, "duration",
+      (guint64) 10 * GST_SECOND, "vpattern", GES_VIDEO_TEST_PATTERN_RED,
+      NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, source));
+
+  effect = ges_track_parse_launch_effect_new ("agingtv");
+  fail_unless (ges_timeline_object_add_track_object (source,
+          GES_TRACK_OBJECT (effect)));
+  fail_unless (ges_track_add_object (track, GES_TRACK_OBJECT (effect)));
+
+  snapshot = ges_timeline_snapshot_new (timeline);
+  fail_unless (snapshot != NULL);
+
+  /* Later changes don't end up in the snapshot */
+  g_object_set (source, "start", (guint64) 20 * GST_SECOND, NULL);
+
+  copy = ges_timeline_snapshot_create_timeline (snapshot);
+  fail_unless (GES_IS_TIMELINE (copy));
+  ges_timeline_snapshot_unref (snapshot);
+
+  object = get_single_object (copy);
+  fail_unless (object != source);
+  fail_unless (GES_IS_TIMELINE_TEST_SOURCE (object));
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_START (object), 5 * GST_SECOND);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_DURATION (object),
+      10 * GST_SECOND);
+  g_object_get (object, "vpattern", &vpattern, NULL);
+  assert_equals_int (vpattern, GES_VIDEO_TEST_PATTERN_RED);
+
+  effects = ges_timeline_object_get_top_effects (object);
+  fail_unless (g_list_length (effects) == 1);
+  fail_unless (GES_IS_TRACK_PARSE_LAUNCH_EFFECT (effects->data));
+  fail_unless (effects->data != effect);
+  g_list_foreach (effects, (GFunc) g_object_unref, NULL);
+  g_list_free (effects);
+  g_object_unref (object);
+
+  g_object_unref (copy);
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_snapshot_restore)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track;
+  GESTimelineObject *source, *object;
+  GESTimelineSnapshot *first, *second;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  track = ges_track_video_raw_new ();
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+
+  source = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (source, "duration", (guint64) 10 * GST_SECOND, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, source));
+
+  first = ges_timeline_snapshot_new (timeline);
+  g_object_set (source, "start", (guint64) 30 * GST_SECOND, NULL);
+  second = ges_timeline_snapshot_new (timeline);
+
+  /* Undo */
+  fail_unless (ges_timeline_snapshot_restore (first, timeline));
+  object = get_single_object (timeline);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_START (object), 0);
+  g_object_unref (object);
+
+  /* Redo */
+  fail_unless (ges_timeline_snapshot_restore (second, timeline));
+  object = get_single_object (timeline);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_START (object), 30 * GST_SECOND);
+  g_object_unref (object);
+
+  ges_timeline_snapshot_unref (first);
+  ges_timeline_snapshot_unref (second);
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_snapshot_setters)
+{
+  GESTimeline *timeline, *copy;
+  GESTimelineLayer *layer;
+  GESTrack *track;
+  GESTimelineObject *source, *object;
+  GESTimelineSnapshot *snapshot;
+  GESTrackObject *trackobject;
+  GList *trackobjects;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  track = ges_track_video_raw_new ();
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+
+  source = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (source, "duration", (guint64) 10 * GST_SECOND, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, source));
+
+  /* Record the object once, so there is a cached record to invalidate */
+  snapshot = ges_timeline_snapshot_new (timeline);
+  ges_timeline_snapshot_unref (snapshot);
+
+  /* The C setters don't notify */
+  ges_timeline_object_set_start (source, 5 * GST_SECOND);
+  ges_timeline_object_set_inpoint (source, 2 * GST_SECOND);
+  ges_timeline_object_set_duration (source, 20 * GST_SECOND);
+
+  snapshot = ges_timeline_snapshot_new (timeline);
+  copy = ges_timeline_snapshot_create_timeline (snapshot);
+  ges_timeline_snapshot_unref (snapshot);
+  object = get_single_object (copy);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_START (object), 5 * GST_SECOND);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_INPOINT (object), 2 * GST_SECOND);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_DURATION (object),
+      20 * GST_SECOND);
+  g_object_unref (object);
+  g_object_unref (copy);
+
+  /* Moving a locked track object moves its timeline object */
+  trackobjects = ges_timeline_object_get_track_objects (source);
+  fail_unless (g_list_length (trackobjects) == 1);
+  trackobject = trackobjects->data;
+  fail_unless (ges_track_object_is_locked (trackobject));
+  ges_track_object_set_start (trackobject, 40 * GST_SECOND);
+  g_list_foreach (trackobjects, (GFunc) g_object_unref, NULL);
+  g_list_free (trackobjects);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_START (source), 40 * GST_SECOND);
+
+  snapshot = ges_timeline_snapshot_new (timeline);
+  copy = ges_timeline_snapshot_create_timeline (snapshot);
+  ges_timeline_snapshot_unref (snapshot);
+  object = get_single_object (copy);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_START (object), 40 * GST_SECOND);
+  g_object_unref (object);
+  g_object_unref (copy);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+/* Returns the track object of @nested in @track */
+static GESTrackObject *
+get_nested_track_object (GESTimelineNestedSource * nested, GESTrack * track)
+{
+  GList *trackobjects;
+  GESTrackObject *trackobject;
+
+  trackobjects =
+      ges_timeline_object_get_track_objects (GES_TIMELINE_OBJECT (nested));
+  fail_unless (g_list_length (trackobjects) == 1);
+  trackobject = trackobjects->data;
+  fail_unless (GES_IS_TRACK_NESTED_SOURCE (trackobject));
+  fail_unless (ges_track_object_get_track (trackobject) == track);
+  g_list_free (trackobjects);
+
+  return trackobject;
+}
+
+/* Checks the single object @trackobject outputs starts at @start */
+static void
+assert_nested_start (GESTrackObject * trackobject, GstClockTime start)
+{
+  GESTimelineSnapshot *snapshot;
+  GESTimeline *timeline;
+  GESTimelineObject *object;
+
+  g_object_get (trackobject, "snapshot", &snapshot, NULL);
+  fail_unless (snapshot != NULL);
+  timeline = ges_timeline_snapshot_create_timeline (snapshot);
+  ges_timeline_snapshot_unref (snapshot);
+
+  object = get_single_object (timeline);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_START (object), start);
+  g_object_unref (object);
+  g_object_unref (timeline);
+}
+
+GST_START_TEST (test_nested_source)
+{
+  GESTimeline *inner, *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track;
+  GESTimelineObject *source;
+  GESTimelineNestedSource *nested;
+  GESTrackObject *trackobject, *other;
+
+  ges_init ();
+
+  inner = ges_timeline_new ();
+  fail_unless (ges_timeline_add_track (inner, ges_track_video_raw_new ()));
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (inner, layer));
+  source = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (source, "start", (guint64) 5 * GST_SECOND, "duration",
+      (guint64) 10 * GST_SECOND, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, source));
+
+  nested = ges_timeline_nested_source_new (inner);
+  fail_unless (nested != NULL);
+  fail_unless (ges_timeline_nested_source_get_timeline (nested) == inner);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_DURATION (nested),
+      15 * GST_SECOND);
+  assert_equals_int (ges_timeline_object_get_supported_formats
+      (GES_TIMELINE_OBJECT (nested)), GES_TRACK_TYPE_VIDEO);
+
+  timeline = ges_timeline_new ();
+  track = ges_track_video_raw_new ();
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  fail_unless (ges_timeline_layer_add_object (layer,
+          GES_TIMELINE_OBJECT (nested)));
+
+  trackobject = get_nested_track_object (nested, track);
+  assert_nested_start (trackobject, 5 * GST_SECOND);
+
+  /* Editing the nested timeline replaces the track object */
+  g_object_set (source, "start", (guint64) 0, NULL);
+  while (g_main_context_iteration (NULL, FALSE));
+
+  other = get_nested_track_object (nested, track);
+  fail_unless (other != trackobject);
+  assert_nested_start (other, 0);
+  g_object_unref (trackobject);
+  trackobject = other;
+
+  /* Including through the C setters, which don't notify */
+  ges_timeline_object_set_start (source, 3 * GST_SECOND);
+  ges_timeline_object_set_duration (source, 4 * GST_SECOND);
+  while (g_main_context_iteration (NULL, FALSE));
+
+  other = get_nested_track_object (nested, track);
+  fail_unless (other != trackobject);
+  assert_nested_start (other, 3 * GST_SECOND);
+  g_object_unref (trackobject);
+  g_object_unref (other);
+
+  fail_if (ges_timeline_nested_source_is_cached (nested));
+
+  g_object_unref (timeline);
+  g_object_unref (inner);
+}
+
+GST_END_TEST;
+
+static gboolean
+set_flag (gboolean * flag)
+{
+  *flag = TRUE;
+
+  return FALSE;
+}
+
+GST_START_TEST (test_nested_source_render_cache)
+{
+  GESTimeline *inner, *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track;
+  GESTimelineObject *source;
+  GESTimelineNestedSource *nested;
+  GESTrackObject *trackobject;
+  GstEncodingContainerProfile *profile;
+  GstCaps *caps;
+  gchar *path, *uri, *cache_uri;
+  gboolean timed_out = FALSE;
+  guint timeout;
+
+  ges_init ();
+
+  if (!gst_default_registry_check_feature_version ("theoraenc", 0, 10, 0) ||
+      !gst_default_registry_check_feature_version ("oggmux", 0, 10, 0)) {
+    GST_WARNING ("theoraenc or oggmux missing, skipping");
+    return;
+  }
+
+  inner = ges_timeline_new ();
+  fail_unless (ges_timeline_add_track (inner, ges_track_video_raw_new ()));
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (inner, layer));
+  source = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (source, "duration", (guint64) GST_SECOND / 2, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, source));
+
+  timeline = ges_timeline_new ();
+  track = ges_track_video_raw_new ();
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  nested = ges_timeline_nested_source_new (inner);
+  fail_unless (ges_timeline_layer_add_object (layer,
+          GES_TIMELINE_OBJECT (nested)));
+
+  caps = gst_caps_from_string ("application/ogg");
+  profile = gst_encoding_container_profile_new ("ogg", NULL, caps, NULL);
+  gst_caps_unref (caps);
+  caps = gst_caps_from_string ("video/x-theora");
+  gst_encoding_container_profile_add_profile (profile,
+      (GstEncodingProfile *) gst_encoding_video_profile_new (caps, NULL, NULL,
+          0));
+  gst_caps_unref (caps);
+
+  path = g_build_filename (g_get_tmp_dir (), "ges-nested-cache.ogg", NULL);
+  uri = g_filename_to_uri (path, NULL, NULL);
+
+  /* The nested timeline is rendered in the background */
+  ges_timeline_nested_source_set_render_cache (nested, uri,
+      (GstEncodingProfile *) profile);
+  fail_if (ges_timeline_nested_source_is_cached (nested));
+
+  timeout = g_timeout_add_seconds (30, (GSourceFunc) set_flag, &timed_out);
+  while (!ges_timeline_nested_source_is_cached (nested) && !timed_out)
+    g_main_context_iteration (NULL, TRUE);
+  fail_if (timed_out);
+  g_source_remove (timeout);
+
+  /* Then its track objects play the render */
+  trackobject = get_nested_track_object (nested, track);
+  g_object_get (trackobject, "cache-uri", &cache_uri, NULL);
+  assert_equals_string (cache_uri, uri);
+  g_free (cache_uri);
+  g_object_unref (trackobject);
+
+  /* Until the cache is disabled */
+  ges_timeline_nested_source_set_render_cache (nested, NULL, NULL);
+  fail_if (ges_timeline_nested_source_is_cached (nested));
+  trackobject = get_nested_track_object (nested, track);
+  g_object_get (trackobject, "cache-uri", &cache_uri, NULL);
+  fail_unless (cache_uri == NULL);
+  g_object_unref (trackobject);
+
+  gst_encoding_profile_unref (profile);
+  g_object_unref (timeline);
+  g_object_unref (inner);
+  g_unlink (path);
+  g_free (path);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+static Suite *
+ges_suite (void)
+{
+  Suite *s = suite_create ("ges-snapshot");
+  TCase *tc_chain = tcase_create ("snapshot");
+
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_snapshot_create_timeline);
+  tcase_add_test (tc_chain, test_snapshot_restore);
+  tcase_add_test (tc_chain, test_snapshot_setters);
+  tcase_add_test (tc_chain, test_nested_source);
+  tcase_add_test (tc_chain, test_nested_source_render_cache);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  int nf;
+
+  Suite *s = ges_suite ();
+  SRunner *sr = srunner_create (s);
+
+  gst_check_init (&argc, &argv);
+
+  srunner_run_all (sr, CK_NORMAL);
+  nf = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return nf;
+}
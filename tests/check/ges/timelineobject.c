@@ -195,6 +195,101 @@ GST_START_TEST (test_object_properties_unlocked)
 }
 
 GST_END_TEST;
+
+GST_START_TEST (test_object_split_single_track)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *audio, *video;
+  GESTimelineObject *object, *new_object;
+  GList *trackobjects, *tmp;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  audio = ges_track_audio_raw_new ();
+  video = ges_track_video_raw_new ();
+  fail_unless (ges_timeline_add_track (timeline, audio));
+  fail_unless (ges_timeline_add_track (timeline, video));
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+
+  /* Fully specified, so it isn't sent to the discoverer */
+  object = (GESTimelineObject *)
+      ges_timeline_filesource_new ((gchar *) "file:///there/is/no/split.ogg");
+  g_object_set (object, "duration", (guint64) 10 * GST_SECOND,
+      "max-duration", (guint64) 100 * GST_SECOND, "supported-formats",
+      GES_TRACK_TYPE_AUDIO | GES_TRACK_TYPE_VIDEO, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, object));
+
+  /* Only keep the audio part */
+  trackobjects = ges_timeline_object_get_track_objects (object);
+  fail_unless (g_list_length (trackobjects) == 2);
+  for (tmp = trackobjects; tmp; tmp = tmp->next) {
+    GESTrackObject *trackobject = tmp->data;
+
+    if (ges_track_object_get_track (trackobject) == video) {
+      ges_track_remove_object (video, trackobject);
+      ges_timeline_object_release_track_object (object, trackobject);
+    }
+    g_object_unref (trackobject);
+  }
+  g_list_free (trackobjects);
+
+  new_object = ges_timeline_object_split (object, 4 * GST_SECOND);
+  fail_unless (new_object != NULL);
+  assert_equals_int (ges_timeline_object_get_supported_formats (new_object),
+      GES_TRACK_TYPE_AUDIO);
+
+  trackobjects = ges_timeline_object_get_track_objects (new_object);
+  fail_unless (g_list_length (trackobjects) == 1);
+  fail_unless (ges_track_object_get_track (trackobjects->data) == audio);
+  g_list_foreach (trackobjects, (GFunc) g_object_unref, NULL);
+  g_list_free (trackobjects);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_object_copy_after_setters)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineObject *object, *copy;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  fail_unless (ges_timeline_add_track (timeline, ges_track_video_raw_new ()));
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+
+  object = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (object, "duration", (guint64) 10 * GST_SECOND, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, object));
+
+  /* The first deep copy records the object */
+  copy = ges_timeline_object_copy (object, TRUE);
+  g_object_ref_sink (copy);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_START (copy), 0);
+  g_object_unref (copy);
+
+  /* Edits through the C setters make a new record */
+  ges_timeline_object_set_start (object, 7 * GST_SECOND);
+  ges_timeline_object_set_duration (object, 3 * GST_SECOND);
+
+  copy = ges_timeline_object_copy (object, TRUE);
+  g_object_ref_sink (copy);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_START (copy), 7 * GST_SECOND);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_DURATION (copy), 3 * GST_SECOND);
+  g_object_unref (copy);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -205,6 +300,8 @@ ges_suite (void)
 
   tcase_add_test (tc_chain, test_object_properties);
   tcase_add_test (tc_chain, test_object_properties_unlocked);
+  tcase_add_test (tc_chain, test_object_split_single_track);
+  tcase_add_test (tc_chain, test_object_copy_after_setters);
 
   return s;
 }
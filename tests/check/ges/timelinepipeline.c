@@ -0,0 +1,567 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <ges/ges.h>
+#include <gst/check/gstcheck.h>
+#include <glib/gstdio.h>
+
+/* A timeline with a single video test source of @duration */
+static GESTimeline *
+make_timeline (GstClockTime duration)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineObject *source;
+
+  timeline = ges_timeline_new ();
+  fail_unless (ges_timeline_add_track (timeline, ges_track_video_raw_new ()));
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  source = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (source, "duration", duration, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, source));
+
+  return timeline;
+}
+
+/* A pipeline previewing @timeline to fakesinks */
+static GESTimelinePipeline *
+make_pipeline (GESTimeline * timeline)
+{
+  GESTimelinePipeline *pipeline;
+
+  pipeline = ges_timeline_pipeline_new ();
+  fail_unless (ges_timeline_pipeline_add_timeline (pipeline, timeline));
+  ges_timeline_pipeline_preview_set_video_sink (pipeline,
+      gst_element_factory_make ("fakesink", NULL));
+  ges_timeline_pipeline_preview_set_audio_sink (pipeline,
+      gst_element_factory_make ("fakesink", NULL));
+
+  return pipeline;
+}
+
+static GstEncodingProfile *
+make_theora_profile (void)
+{
+  GstEncodingContainerProfile *profile;
+  GstCaps *caps;
+
+  caps = gst_caps_from_string ("application/ogg");
+  profile = gst_encoding_container_profile_new ("ogg", NULL, caps, NULL);
+  gst_caps_unref (caps);
+  caps = gst_caps_from_string ("video/x-theora");
+  gst_encoding_container_profile_add_profile (profile,
+      (GstEncodingProfile *) gst_encoding_video_profile_new (caps, NULL, NULL,
+          0));
+  gst_caps_unref (caps);
+
+  return (GstEncodingProfile *) profile;
+}
+
+#define assert_prerolled(pipeline)                                      \
+  assert_equals_int (gst_element_get_state (GST_ELEMENT (pipeline), NULL, \
+          NULL, 10 * GST_SECOND), GST_STATE_CHANGE_SUCCESS)
+
+GST_START_TEST (test_pipeline_switch_mode_live)
+{
+  GESTimelinePipeline *pipeline;
+  GstEncodingProfile *profile;
+  GstState state;
+  gchar *path, *uri;
+
+  ges_init ();
+
+  if (!gst_default_registry_check_feature_version ("theoraenc", 0, 10, 0) ||
+      !gst_default_registry_check_feature_version ("oggmux", 0, 10, 0)) {
+    GST_WARNING ("theoraenc or oggmux missing, skipping");
+    return;
+  }
+
+  pipeline = make_pipeline (make_timeline (2 * GST_SECOND));
+
+  path = g_build_filename (g_get_tmp_dir (), "ges-switch-mode.ogg", NULL);
+  uri = g_filename_to_uri (path, NULL, NULL);
+  profile = make_theora_profile ();
+  fail_unless (ges_timeline_pipeline_set_render_settings (pipeline, uri,
+          profile));
+
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline),
+          GST_STATE_PAUSED) == GST_STATE_CHANGE_FAILURE);
+  assert_prerolled (pipeline);
+
+  /* The outputs are swapped without going through NULL, and the pipeline
+   * prerolls again each time */
+  fail_unless (ges_timeline_pipeline_set_mode (pipeline,
+          TIMELINE_MODE_RENDER));
+  assert_prerolled (pipeline);
+  gst_element_get_state (GST_ELEMENT (pipeline), &state, NULL, 0);
+  assert_equals_int (state, GST_STATE_PAUSED);
+
+  fail_unless (ges_timeline_pipeline_set_mode (pipeline,
+          TIMELINE_MODE_PREVIEW));
+  assert_prerolled (pipeline);
+  gst_element_get_state (GST_ELEMENT (pipeline), &state, NULL, 0);
+  assert_equals_int (state, GST_STATE_PAUSED);
+
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline),
+          GST_STATE_NULL) == GST_STATE_CHANGE_FAILURE);
+  gst_object_unref (pipeline);
+  gst_encoding_profile_unref (profile);
+  g_unlink (path);
+  g_free (path);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+/* Holds the video sink prerolling while set */
+static gboolean hold_preroll = FALSE;
+static GMutex *hold_lock;
+static GCond *hold_cond;
+static gint flushes = 0;
+
+static void
+preroll_handoff_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  g_mutex_lock (hold_lock);
+  while (hold_preroll)
+    g_cond_wait (hold_cond, hold_lock);
+  g_mutex_unlock (hold_lock);
+}
+
+static gboolean
+count_flushes_cb (GstPad * pad, GstEvent * event, gpointer user_data)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_START)
+    g_atomic_int_inc (&flushes);
+
+  return TRUE;
+}
+
+static void
+set_hold_preroll (gboolean hold)
+{
+  g_mutex_lock (hold_lock);
+  hold_preroll = hold;
+  g_cond_broadcast (hold_cond);
+  g_mutex_unlock (hold_lock);
+}
+
+static gboolean
+seek (GESTimelinePipeline * pipeline, GstClockTime start, GstClockTime stop)
+{
+  return gst_element_seek (GST_ELEMENT (pipeline), 1.0, GST_FORMAT_TIME,
+      GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE, GST_SEEK_TYPE_SET, start,
+      GST_CLOCK_TIME_IS_VALID (stop) ? GST_SEEK_TYPE_SET : GST_SEEK_TYPE_NONE,
+      stop);
+}
+
+/* Waits for the pipeline to be prerolled at the frame of @position */
+static void
+wait_prerolled_at (GESTimelinePipeline * pipeline, GstClockTime position)
+{
+  GstFormat format = GST_FORMAT_TIME;
+  gint64 current = -1;
+  guint i;
+
+  for (i = 0; i < 1000; i++) {
+    if (gst_element_get_state (GST_ELEMENT (pipeline), NULL, NULL,
+            0) == GST_STATE_CHANGE_SUCCESS &&
+        gst_element_query_position (GST_ELEMENT (pipeline), &format,
+            &current) && ABS (current - (gint64) position) < GST_SECOND / 20)
+      return;
+    g_usleep (10000);
+  }
+
+  fail ("Not prerolled at %" GST_TIME_FORMAT ", position %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (position), GST_TIME_ARGS (current));
+}
+
+GST_START_TEST (test_pipeline_seek_latency)
+{
+  GESTimelinePipeline *pipeline;
+  GstElement *sink;
+  GstPad *pad;
+
+  ges_init ();
+
+  hold_lock = g_mutex_new ();
+  hold_cond = g_cond_new ();
+
+  pipeline = make_pipeline (make_timeline (2 * GST_SECOND));
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "preroll-handoff", G_CALLBACK (preroll_handoff_cb),
+      NULL);
+  pad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_add_event_probe (pad, G_CALLBACK (count_flushes_cb), NULL);
+  gst_object_unref (pad);
+  ges_timeline_pipeline_preview_set_video_sink (pipeline, sink);
+  ges_timeline_pipeline_set_seek_latency_mode (pipeline, TRUE);
+
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline),
+          GST_STATE_PAUSED) == GST_STATE_CHANGE_FAILURE);
+  assert_prerolled (pipeline);
+
+  /* Seeks received while the first one prerolls are coalesced */
+  set_hold_preroll (TRUE);
+  fail_unless (seek (pipeline, GST_SECOND / 2, GST_CLOCK_TIME_NONE));
+  assert_equals_int (g_atomic_int_get (&flushes), 1);
+  fail_unless (seek (pipeline, GST_SECOND * 6 / 10, GST_CLOCK_TIME_NONE));
+  fail_unless (seek (pipeline, GST_SECOND * 7 / 10, GST_CLOCK_TIME_NONE));
+  assert_equals_int (g_atomic_int_get (&flushes), 1);
+
+  /* Only the latest one is sent once prerolled */
+  set_hold_preroll (FALSE);
+  wait_prerolled_at (pipeline, GST_SECOND * 7 / 10);
+  assert_equals_int (g_atomic_int_get (&flushes), 2);
+
+  /* The same seek again is dropped */
+  fail_unless (seek (pipeline, GST_SECOND * 7 / 10, GST_CLOCK_TIME_NONE));
+  assert_prerolled (pipeline);
+  assert_equals_int (g_atomic_int_get (&flushes), 2);
+
+  /* But not one to the same position with another stop */
+  fail_unless (seek (pipeline, GST_SECOND * 7 / 10, GST_SECOND));
+  assert_prerolled (pipeline);
+  assert_equals_int (g_atomic_int_get (&flushes), 3);
+
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline),
+          GST_STATE_NULL) == GST_STATE_CHANGE_FAILURE);
+  gst_object_unref (pipeline);
+  g_cond_free (hold_cond);
+  g_mutex_free (hold_lock);
+}
+
+GST_END_TEST;
+
+static void
+render_progress_cb (GESTimelinePipeline * pipeline, guint64 position,
+    guint64 duration, gdouble speed, guint64 eta, guint64 * last)
+{
+  /* Never past the end, even though the range doesn't start at 0 */
+  fail_unless (position <= duration);
+  last[0] = position;
+  last[1] = duration;
+}
+
+GST_START_TEST (test_pipeline_render_progress_range)
+{
+  GESTimelinePipeline *pipeline;
+  GstEncodingProfile *profile;
+  GstMessage *message;
+  GstBus *bus;
+  guint64 last[2] = { GST_CLOCK_TIME_NONE, GST_CLOCK_TIME_NONE };
+  gchar *path, *uri;
+
+  ges_init ();
+
+  if (!gst_default_registry_check_feature_version ("theoraenc", 0, 10, 0) ||
+      !gst_default_registry_check_feature_version ("oggmux", 0, 10, 0)) {
+    GST_WARNING ("theoraenc or oggmux missing, skipping");
+    return;
+  }
+
+  pipeline = make_pipeline (make_timeline (2 * GST_SECOND));
+
+  path = g_build_filename (g_get_tmp_dir (), "ges-render-range.ogg", NULL);
+  uri = g_filename_to_uri (path, NULL, NULL);
+  profile = make_theora_profile ();
+  fail_unless (ges_timeline_pipeline_set_render_settings (pipeline, uri,
+          profile));
+  fail_unless (ges_timeline_pipeline_set_mode (pipeline,
+          TIMELINE_MODE_RENDER));
+  fail_unless (ges_timeline_pipeline_set_render_range (pipeline, GST_SECOND,
+          GST_SECOND * 3 / 2));
+  g_signal_connect (pipeline, "render-progress",
+      G_CALLBACK (render_progress_cb), last);
+
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline),
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+  bus = gst_element_get_bus (GST_ELEMENT (pipeline));
+  message = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (message != NULL);
+  assert_equals_int (GST_MESSAGE_TYPE (message), GST_MESSAGE_EOS);
+  gst_message_unref (message);
+  gst_object_unref (bus);
+
+  /* The pipeline handled the EOS, the last report is pending */
+  while (g_main_context_iteration (NULL, FALSE));
+
+  /* The whole range was rendered, and only that */
+  assert_equals_uint64 (last[1], GST_SECOND / 2);
+  assert_equals_uint64 (last[0], GST_SECOND / 2);
+
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline),
+          GST_STATE_NULL) == GST_STATE_CHANGE_FAILURE);
+  gst_object_unref (pipeline);
+  gst_encoding_profile_unref (profile);
+  g_unlink (path);
+  g_free (path);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+/* What reached the video sink */
+typedef struct
+{
+  gint width, height;
+  gint frames;
+} VideoOutput;
+
+static void
+preroll_size_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    VideoOutput * output)
+{
+  GstStructure *structure;
+
+  fail_unless (GST_BUFFER_CAPS (buffer) != NULL);
+  structure = gst_caps_get_structure (GST_BUFFER_CAPS (buffer), 0);
+  fail_unless (gst_structure_get_int (structure, "width", &output->width));
+  fail_unless (gst_structure_get_int (structure, "height", &output->height));
+}
+
+static void
+count_frames_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    VideoOutput * output)
+{
+  g_atomic_int_inc (&output->frames);
+}
+
+static void
+play_to_eos (GESTimelinePipeline * pipeline)
+{
+  GstMessage *message;
+  GstBus *bus;
+
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline),
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+  bus = gst_element_get_bus (GST_ELEMENT (pipeline));
+  message = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (message != NULL);
+  assert_equals_int (GST_MESSAGE_TYPE (message), GST_MESSAGE_EOS);
+  gst_message_unref (message);
+  gst_object_unref (bus);
+}
+
+
+GST_START_TEST (test_pipeline_preview_quality)
+{
+  GESTimelinePipeline *pipeline;
+  GstElement *sink;
+  VideoOutput output = { 0, 0, 0 };
+  gint width, height, frames;
+
+  ges_init ();
+
+  /* The video track caps don't fix a size, and there is no profile */
+  pipeline = make_pipeline (make_timeline (GST_SECOND));
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "sync", FALSE, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "preroll-handoff", G_CALLBACK (preroll_size_cb),
+      &output);
+  g_signal_connect (sink, "handoff", G_CALLBACK (count_frames_cb), &output);
+  ges_timeline_pipeline_preview_set_video_sink (pipeline, sink);
+  ges_timeline_pipeline_set_preview_quality (pipeline,
+      GES_PREVIEW_QUALITY_HALF);
+
+  /* So the first preview is at full quality */
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline),
+          GST_STATE_PAUSED) == GST_STATE_CHANGE_FAILURE);
+  assert_prerolled (pipeline);
+  width = output.width;
+  height = output.height;
+  fail_unless (width > 2 && height > 2);
+
+  /* And the next ones at half the size that was negotiated */
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline),
+          GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline),
+          GST_STATE_PAUSED) == GST_STATE_CHANGE_FAILURE);
+  assert_prerolled (pipeline);
+  assert_equals_int (output.width, (width / 2) & ~1);
+  assert_equals_int (output.height, (height / 2) & ~1);
+
+  /* Back to full quality */
+  ges_timeline_pipeline_set_preview_quality (pipeline,
+      GES_PREVIEW_QUALITY_FULL);
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline),
+          GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+  output.frames = 0;
+  play_to_eos (pipeline);
+  assert_equals_int (output.width, width);
+  assert_equals_int (output.height, height);
+  frames = output.frames;
+  fail_unless (frames > 2);
+
+  /* Skipping every other frame */
+  ges_timeline_pipeline_set_preview_frame_skip (pipeline, 1);
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline),
+          GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+  output.frames = 0;
+  play_to_eos (pipeline);
+  fail_unless (output.frames > 0);
+  fail_unless (output.frames <= frames / 2 + 1, "%d frames out of %d shown",
+      output.frames, frames);
+
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline),
+          GST_STATE_NULL) == GST_STATE_CHANGE_FAILURE);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+/* The duration of the media file at @uri */
+static GstClockTime
+get_file_duration (const gchar * uri)
+{
+  GstElement *playbin;
+  GstFormat format = GST_FORMAT_TIME;
+  gint64 duration = -1;
+
+  playbin = gst_element_factory_make ("playbin2", NULL);
+  fail_unless (playbin != NULL);
+  g_object_set (playbin, "uri", uri, "video-sink",
+      gst_element_factory_make ("fakesink", NULL), "audio-sink",
+      gst_element_factory_make ("fakesink", NULL), NULL);
+  fail_if (gst_element_set_state (playbin,
+          GST_STATE_PAUSED) == GST_STATE_CHANGE_FAILURE);
+  assert_prerolled (playbin);
+  fail_unless (gst_element_query_duration (playbin, &format, &duration));
+  gst_element_set_state (playbin, GST_STATE_NULL);
+  gst_object_unref (playbin);
+
+  return duration;
+}
+
+GST_START_TEST (test_pipeline_render_snapshot)
+{
+  GESTimelinePipeline *pipeline, *render;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineObject *source;
+  GstEncodingProfile *profile;
+  GstMessage *message;
+  GstClockTime started, duration;
+  GList *layers, *objects;
+  GstBus *bus;
+  gchar *path, *uri;
+
+  ges_init ();
+
+  if (!gst_default_registry_check_feature_version ("theoraenc", 0, 10, 0) ||
+      !gst_default_registry_check_feature_version ("oggmux", 0, 10, 0)) {
+    GST_WARNING ("theoraenc or oggmux missing, skipping");
+    return;
+  }
+
+  timeline = make_timeline (GST_SECOND);
+  pipeline = make_pipeline (timeline);
+  layers = ges_timeline_get_layers (timeline);
+  layer = GES_TIMELINE_LAYER (layers->data);
+  objects = ges_timeline_layer_get_objects (layer);
+  source = GES_TIMELINE_OBJECT (objects->data);
+
+  path = g_build_filename (g_get_tmp_dir (), "ges-render-snapshot.ogg", NULL);
+  uri = g_filename_to_uri (path, NULL, NULL);
+  profile = make_theora_profile ();
+
+  /* Twice as fast as real time at most */
+  g_object_set (pipeline, "max-render-speed", 2.0, NULL);
+
+  started = gst_util_get_timestamp ();
+  render = ges_timeline_pipeline_render_snapshot (pipeline, uri, profile);
+  fail_unless (render != NULL);
+  fail_if (render == pipeline);
+
+  /* Editing the timeline while it renders doesn't change the render */
+  g_object_set (source, "duration", (guint64) 3 * GST_SECOND, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer,
+          GES_TIMELINE_OBJECT (ges_timeline_test_source_new ())));
+
+  bus = gst_element_get_bus (GST_ELEMENT (render));
+  message = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (message != NULL);
+  assert_equals_int (GST_MESSAGE_TYPE (message), GST_MESSAGE_EOS);
+  gst_message_unref (message);
+  gst_object_unref (bus);
+
+  /* The render was held back to the maximum speed */
+  fail_unless (gst_util_get_timestamp () - started >= GST_SECOND * 4 / 10);
+
+  fail_if (gst_element_set_state (GST_ELEMENT (render),
+          GST_STATE_NULL) == GST_STATE_CHANGE_FAILURE);
+  gst_object_unref (render);
+
+  /* The output has the duration of the timeline when the render started */
+  duration = get_file_duration (uri);
+  fail_unless (duration >= GST_SECOND * 9 / 10 &&
+      duration <= GST_SECOND * 11 / 10, "Rendered %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (duration));
+
+  g_list_foreach (objects, (GFunc) g_object_unref, NULL);
+  g_list_free (objects);
+  g_list_foreach (layers, (GFunc) g_object_unref, NULL);
+  g_list_free (layers);
+  gst_object_unref (pipeline);
+  gst_encoding_profile_unref (profile);
+  g_unlink (path);
+  g_free (path);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+static Suite *
+ges_suite (void)
+{
+  Suite *s = suite_create ("ges-timeline-pipeline");
+  TCase *tc_chain = tcase_create ("timelinepipeline");
+
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_pipeline_switch_mode_live);
+  tcase_add_test (tc_chain, test_pipeline_seek_latency);
+  tcase_add_test (tc_chain, test_pipeline_render_progress_range);
+  tcase_add_test (tc_chain, test_pipeline_preview_quality);
+  tcase_add_test (tc_chain, test_pipeline_render_snapshot);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  int nf;
+
+  Suite *s = ges_suite ();
+  SRunner *sr = srunner_create (s);
+
+  gst_check_init (&argc, &argv);
+
+  srunner_run_all (sr, CK_NORMAL);
+  nf = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return nf;
+}
@@ -25,10 +25,16 @@
 #include <stdlib.h>
 #include <string.h>
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <ges/ges.h>
 #include <gst/pbutils/encoding-profile.h>
 #include <regex.h>
 
+#ifdef G_OS_UNIX
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
 /* GLOBAL VARIABLE */
 static guint repeat = 0;
 static GESTimelinePipeline *pipeline = NULL;
@@ -116,6 +122,320 @@ str_to_time (char *time)
   return 0;
 }
 
+static gboolean
+add_render_ranges (GESTimelinePipeline * pipeline, gchar ** ranges)
+{
+  gchar **bounds;
+  guint i;
+
+  for (i = 0; ranges[i]; i++) {
+    bounds = g_strsplit (ranges[i], "-", 2);
+
+    if (!bounds[0] || !bounds[1] || !check_time (bounds[0])
+        || !check_time (bounds[1])) {
+      g_printerr ("'%s' is not a valid range (START-STOP)\n", ranges[i]);
+      g_strfreev (bounds);
+      return FALSE;
+    }
+
+    if (!ges_timeline_pipeline_add_render_range (pipeline,
+            str_to_time (bounds[0]), str_to_time (bounds[1]))) {
+      g_printerr ("Couldn't add range '%s'\n", ranges[i]);
+      g_strfreev (bounds);
+      return FALSE;
+    }
+
+    g_printf ("Rendering range %s\n", ranges[i]);
+    g_strfreev (bounds);
+  }
+
+  return TRUE;
+}
+
+/* Benchmark
+ *
+ * Each track gets a buffer probe on its output (the gnlcomposition output)
+ * and on the encodebin pad it ends up feeding, through the queues and the
+ * tee of its output chain. The time between two buffers leaving the track
+ * is spent producing them (including waiting for the queue to accept more
+ * data), and the time a buffer takes from the track to encodebin is spent
+ * in between. The two probes run in different streaming threads, the
+ * output times are queued until the buffers reach encodebin, in order. */
+
+typedef struct
+{
+  GESTrack *track;
+  guint64 buffers;
+  guint64 encoder_buffers;      /* Buffers which reached encodebin */
+  GstClockTime media_duration;  /* Sum of the buffer durations */
+  GstClockTime last_output;     /* When the last buffer left the track */
+  GstClockTime composition_time;
+  GstClockTime link_time;
+  gboolean encoder_probed;
+
+  /* When the buffers on their way to encodebin left the track */
+  GMutex *lock;
+  GQueue outputs;
+} TrackStats;
+
+static GList *benchmark_stats = NULL;
+
+static gboolean
+benchmark_encoder_probe (GstPad * pad, GstBuffer * buffer, TrackStats * stats)
+{
+  GstClockTime now = gst_util_get_timestamp ();
+  GstClockTime *output;
+
+  g_mutex_lock (stats->lock);
+  stats->encoder_buffers++;
+  if ((output = g_queue_pop_head (&stats->outputs))) {
+    stats->link_time += now - *output;
+    g_slice_free (GstClockTime, output);
+  }
+  g_mutex_unlock (stats->lock);
+
+  return TRUE;
+}
+
+static const gchar *
+element_factory_name (GstElement * element)
+{
+  GstElementFactory *factory = gst_element_get_factory (element);
+
+  return factory ? gst_plugin_feature_get_name (GST_PLUGIN_FEATURE (factory))
+      : "";
+}
+
+/* Follows the output chain downstream of @pad, through its queues and its
+ * tee, to the encodebin pad it feeds */
+static GstPad *
+benchmark_find_encoder_pad (GstPad * pad)
+{
+  GstPad *peer, *ret = NULL;
+  GstElement *element;
+  const gchar *name;
+
+  if (!(peer = gst_pad_get_peer (pad)))
+    return NULL;
+
+  if (!(element = gst_pad_get_parent_element (peer))) {
+    gst_object_unref (peer);
+    return NULL;
+  }
+
+  name = element_factory_name (element);
+  if (!g_strcmp0 (name, "encodebin")) {
+    ret = gst_object_ref (peer);
+  } else if (!g_strcmp0 (name, "queue")) {
+    GstPad *srcpad = gst_element_get_static_pad (element, "src");
+
+    ret = benchmark_find_encoder_pad (srcpad);
+    gst_object_unref (srcpad);
+  } else if (!g_strcmp0 (name, "tee")) {
+    GstIterator *it = gst_element_iterate_src_pads (element);
+    gpointer item;
+    gboolean done = FALSE;
+
+    while (!done && !ret) {
+      switch (gst_iterator_next (it, &item)) {
+        case GST_ITERATOR_OK:
+          ret = benchmark_find_encoder_pad ((GstPad *) item);
+          gst_object_unref (item);
+          break;
+        case GST_ITERATOR_RESYNC:
+          gst_iterator_resync (it);
+          break;
+        default:
+          done = TRUE;
+          break;
+      }
+    }
+    gst_iterator_free (it);
+  }
+
+  gst_object_unref (element);
+  gst_object_unref (peer);
+
+  return ret;
+}
+
+static void
+benchmark_probe_encoder_pad (GstPad * pad, TrackStats * stats)
+{
+  GstPad *encoder_pad = benchmark_find_encoder_pad (pad);
+
+  if (!encoder_pad) {
+    g_printerr ("No encoder found downstream of the %s track\n",
+        stats->track->type == GES_TRACK_TYPE_VIDEO ? "video" : "audio");
+    return;
+  }
+
+  gst_pad_add_buffer_probe (encoder_pad,
+      G_CALLBACK (benchmark_encoder_probe), stats);
+  gst_object_unref (encoder_pad);
+}
+
+static gboolean
+benchmark_output_probe (GstPad * pad, GstBuffer * buffer, TrackStats * stats)
+{
+  GstClockTime now = gst_util_get_timestamp ();
+  GstClockTime *output;
+
+  /* The output chain is linked to encodebin by the time data flows */
+  if (!stats->encoder_probed) {
+    benchmark_probe_encoder_pad (pad, stats);
+    stats->encoder_probed = TRUE;
+  }
+
+  if (GST_CLOCK_TIME_IS_VALID (stats->last_output))
+    stats->composition_time += now - stats->last_output;
+  stats->last_output = now;
+
+  output = g_slice_new (GstClockTime);
+  *output = now;
+  g_mutex_lock (stats->lock);
+  g_queue_push_tail (&stats->outputs, output);
+  g_mutex_unlock (stats->lock);
+
+  stats->buffers++;
+  if (GST_BUFFER_DURATION_IS_VALID (buffer))
+    stats->media_duration += GST_BUFFER_DURATION (buffer);
+
+  return TRUE;
+}
+
+static void
+benchmark_track_pad_added_cb (GESTrack * track, GstPad * pad,
+    TrackStats * stats)
+{
+  gst_pad_add_buffer_probe (pad, G_CALLBACK (benchmark_output_probe), stats);
+}
+
+static void
+benchmark_setup (GESTimelinePipeline * pipeline)
+{
+  GstIterator *it;
+  gpointer item;
+  gboolean done = FALSE;
+  GESTimeline *timeline = NULL;
+  GList *tracks, *tmp;
+
+  /* Find back the timeline in the pipeline */
+  it = gst_bin_iterate_elements (GST_BIN (pipeline));
+  while (!done) {
+    switch (gst_iterator_next (it, &item)) {
+      case GST_ITERATOR_OK:
+        if (GES_IS_TIMELINE (item) && !timeline)
+          timeline = (GESTimeline *) item;
+        else
+          gst_object_unref (item);
+        break;
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync (it);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  gst_iterator_free (it);
+
+  if (!timeline)
+    return;
+
+  tracks = ges_timeline_get_tracks (timeline);
+  for (tmp = tracks; tmp; tmp = tmp->next) {
+    TrackStats *stats = g_new0 (TrackStats, 1);
+
+    stats->track = (GESTrack *) tmp->data;
+    stats->last_output = GST_CLOCK_TIME_NONE;
+    stats->lock = g_mutex_new ();
+    g_queue_init (&stats->outputs);
+    g_signal_connect (stats->track, "pad-added",
+        G_CALLBACK (benchmark_track_pad_added_cb), stats);
+
+    benchmark_stats = g_list_append (benchmark_stats, stats);
+  }
+  g_list_free (tracks);
+  gst_object_unref (timeline);
+}
+
+static gdouble
+get_cpu_time (void)
+{
+#ifdef G_OS_UNIX
+  struct rusage usage;
+
+  if (getrusage (RUSAGE_SELF, &usage) == 0)
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+        (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#endif
+
+  return -1;
+}
+
+static glong
+get_peak_rss (void)
+{
+#ifdef G_OS_UNIX
+  struct rusage usage;
+
+  if (getrusage (RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss;
+#endif
+
+  return -1;
+}
+
+/* Locale independent, JSON compatible, doubles */
+static const gchar *
+json_double (gchar * buf, gdouble value)
+{
+  return g_ascii_formatd (buf, G_ASCII_DTOSTR_BUF_SIZE, "%.6f", value);
+}
+
+static void
+benchmark_report (FILE * out, gdouble wall_time, gdouble cpu_time)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+  GstClockTime rendered = 0;
+  GList *tmp;
+
+  for (tmp = benchmark_stats; tmp; tmp = tmp->next)
+    rendered = MAX (rendered, ((TrackStats *) tmp->data)->media_duration);
+
+  fprintf (out, "{\n");
+  fprintf (out, "  \"wall_time\": %s,\n", json_double (buf, wall_time));
+  fprintf (out, "  \"cpu_time\": %s,\n", json_double (buf, cpu_time));
+  fprintf (out, "  \"rendered_duration\": %s,\n",
+      json_double (buf, (gdouble) rendered / GST_SECOND));
+  fprintf (out, "  \"realtime_factor\": %s,\n", json_double (buf,
+          wall_time > 0 ? (gdouble) rendered / GST_SECOND / wall_time : 0));
+  fprintf (out, "  \"peak_rss_kb\": %ld,\n", get_peak_rss ());
+  fprintf (out, "  \"tracks\": [");
+
+  for (tmp = benchmark_stats; tmp; tmp = tmp->next) {
+    TrackStats *stats = (TrackStats *) tmp->data;
+
+    fprintf (out, "%s\n    {\n", tmp == benchmark_stats ? "" : ",");
+    fprintf (out, "      \"type\": \"%s\",\n",
+        stats->track->type == GES_TRACK_TYPE_VIDEO ? "video" :
+        stats->track->type == GES_TRACK_TYPE_AUDIO ? "audio" : "other");
+    fprintf (out, "      \"buffers\": %" G_GUINT64_FORMAT ",\n", stats->buffers);
+    fprintf (out, "      \"buffers_per_second\": %s,\n", json_double (buf,
+            wall_time > 0 ? stats->buffers / wall_time : 0));
+    fprintf (out, "      \"encoder_buffers\": %" G_GUINT64_FORMAT ",\n",
+        stats->encoder_buffers);
+    fprintf (out, "      \"composition_time\": %s,\n",
+        json_double (buf, (gdouble) stats->composition_time / GST_SECOND));
+    fprintf (out, "      \"link_time\": %s\n",
+        json_double (buf, (gdouble) stats->link_time / GST_SECOND));
+    fprintf (out, "    }");
+  }
+
+  fprintf (out, "\n  ]\n}\n");
+}
+
 static GstEncodingProfile *
 make_encoding_profile (gchar * audio, gchar * video, gchar * video_restriction,
     gchar * audio_preset, gchar * video_preset, gchar * container)
@@ -167,8 +487,12 @@ create_timeline (int nbargs, gchar ** argv, gchar * audio, gchar * video)
   if (video)
     trackv = ges_track_video_raw_new ();
 
-  /* We are only going to be doing one layer of timeline objects */
-  layer = (GESTimelineLayer *) ges_simple_timeline_layer_new ();
+  /* We are only going to be doing one layer of timeline objects. Without
+   * any, an edit script fills it and needs the objects to keep their start */
+  if (nbargs >= 3)
+    layer = (GESTimelineLayer *) ges_simple_timeline_layer_new ();
+  else
+    layer = ges_timeline_layer_new ();
 
   /* Add the tracks and the layer to the timeline */
   if (!ges_timeline_add_layer (timeline, layer) ||
@@ -270,9 +594,382 @@ build_failure:
   }
 }
 
+/* Batch edit scripts
+ *
+ * One operation per line, blank lines and lines starting with '#' are
+ * ignored. Arguments are split like in a shell, so they can be quoted.
+ * Times are in seconds, layers are given by priority.
+ *
+ *   add NAME LAYER START DURATION file PATH [INPOINT]
+ *   add NAME LAYER START DURATION pattern|transition NICK
+ *   add NAME LAYER START DURATION title TEXT
+ *   move NAME START [LAYER]
+ *   trim NAME INPOINT DURATION
+ *   split NAME POSITION NEW-NAME
+ *   effect NAME audio|video BIN-DESCRIPTION
+ *   set NAME PROPERTY VALUE
+ *   remove NAME
+ *
+ * The objects of a loaded project are named Object0, Object1, ... in the
+ * order of their layers, like the sections of a keyfile project. Simple
+ * layers place their objects themselves, so objects can't be added or
+ * moved to a START in them.
+ *
+ * The whole script runs in a single batch of the timeline, so the tracks
+ * are only updated once at the end. */
+
+typedef struct
+{
+  GESTimeline *timeline;
+  GHashTable *objects;          /* name -> GESTimelineObject */
+  GHashTable *layers;           /* priority -> GESTimelineLayer */
+} ScriptContext;
+
+static GESTimelineLayer *
+script_get_layer (ScriptContext * ctx, guint priority)
+{
+  GESTimelineLayer *layer;
+  GList *layers, *tmp;
+
+  layer = g_hash_table_lookup (ctx->layers, GUINT_TO_POINTER (priority));
+  if (layer)
+    return layer;
+
+  layers = ges_timeline_get_layers (ctx->timeline);
+  for (tmp = layers; tmp; tmp = tmp->next) {
+    if (!layer && ges_timeline_layer_get_priority (tmp->data) == priority)
+      layer = tmp->data;
+    g_object_unref (tmp->data);
+  }
+  g_list_free (layers);
+
+  if (!layer) {
+    layer = ges_timeline_layer_new ();
+    ges_timeline_layer_set_priority (layer, priority);
+    if (!ges_timeline_add_layer (ctx->timeline, layer))
+      return NULL;
+  }
+
+  g_hash_table_insert (ctx->layers, GUINT_TO_POINTER (priority), layer);
+  return layer;
+}
+
+/* The layers are owned by the timeline, no need to keep a reference */
+static GESTimelineLayer *
+script_object_layer (GESTimelineObject * obj)
+{
+  GESTimelineLayer *layer = ges_timeline_object_get_layer (obj);
+
+  if (layer)
+    g_object_unref (layer);
+  return layer;
+}
+
+static gboolean
+script_parse_time (gchar * str, guint64 * time)
+{
+  if (!check_time (str))
+    return FALSE;
+
+  *time = str_to_time (str);
+  return TRUE;
+}
+
+static GESTimelineObject *
+script_create_object (gchar * type, gchar * arg)
+{
+  GESTimelineObject *obj = NULL;
+
+  if (!g_strcmp0 (type, "file")) {
+    gchar *uri = ensure_uri (arg);
+
+    if (uri)
+      obj = GES_TIMELINE_OBJECT (ges_timeline_filesource_new (uri));
+    g_free (uri);
+  } else if (!g_strcmp0 (type, "pattern"))
+    obj = GES_TIMELINE_OBJECT (ges_timeline_test_source_new_for_nick (arg));
+  else if (!g_strcmp0 (type, "transition"))
+    obj =
+        GES_TIMELINE_OBJECT (ges_timeline_standard_transition_new_for_nick
+        (arg));
+  else if (!g_strcmp0 (type, "title")) {
+    obj = GES_TIMELINE_OBJECT (ges_timeline_title_source_new ());
+    g_object_set (obj, "text", arg, NULL);
+  }
+
+  return obj;
+}
+
+static gboolean
+script_add_effect (GESTimelineObject * obj, gchar * type, gchar * desc)
+{
+  GESTrackType track_type;
+  GESTrackObject *effect;
+  GList *trackobjects, *tmp;
+  GESTrack *track = NULL;
+
+  if (!g_strcmp0 (type, "audio"))
+    track_type = GES_TRACK_TYPE_AUDIO;
+  else if (!g_strcmp0 (type, "video"))
+    track_type = GES_TRACK_TYPE_VIDEO;
+  else
+    return FALSE;
+
+  trackobjects = ges_timeline_object_get_track_objects (obj);
+  for (tmp = trackobjects; tmp; tmp = tmp->next) {
+    GESTrack *candidate = ges_track_object_get_track (tmp->data);
+
+    if (!track && candidate && candidate->type == track_type)
+      track = candidate;
+    g_object_unref (tmp->data);
+  }
+  g_list_free (trackobjects);
+
+  if (!track)
+    return FALSE;
+
+  effect = GES_TRACK_OBJECT (ges_track_parse_launch_effect_new (desc));
+  if (!ges_timeline_object_add_track_object (obj, effect))
+    return FALSE;
+
+  return ges_track_add_object (track, effect);
+}
+
+static gboolean
+script_set_property (GESTimelineObject * obj, gchar * name, gchar * str)
+{
+  GValue value = { 0, };
+  GParamSpec *pspec;
+  gboolean res;
+
+  pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (obj), name);
+  if (!pspec || !(pspec->flags & G_PARAM_WRITABLE))
+    return FALSE;
+
+  g_value_init (&value, pspec->value_type);
+  if (G_VALUE_HOLDS_STRING (&value)) {
+    g_value_set_string (&value, str);
+    res = TRUE;
+  } else
+    res = gst_value_deserialize (&value, str);
+
+  if (res)
+    g_object_set_property (G_OBJECT (obj), name, &value);
+  g_value_unset (&value);
+
+  return res;
+}
+
+/* Runs a single script line, returns an error message on failure */
+static const gchar *
+script_run_operation (ScriptContext * ctx, gint argc, gchar ** argv)
+{
+  GESTimelineObject *obj = NULL;
+  GESTimelineLayer *layer;
+  guint64 start, duration, inpoint;
+
+  if (argc < 2)
+    return "missing arguments";
+
+  if (strcmp (argv[0], "add"))
+    if (!(obj = g_hash_table_lookup (ctx->objects, argv[1])))
+      return "unknown object";
+
+  if (!strcmp (argv[0], "add")) {
+    if (argc < 7 || !script_parse_time (argv[3], &start) ||
+        !script_parse_time (argv[4], &duration))
+      return "usage: add NAME LAYER START DURATION TYPE ARG [INPOINT]";
+    if (g_hash_table_lookup (ctx->objects, argv[1]))
+      return "an object already has that name";
+    if (!(obj = script_create_object (argv[5], argv[6])))
+      return "couldn't create the object";
+
+    g_object_set (obj, "start", start, "duration", duration, NULL);
+    if (argc > 7) {
+      if (!script_parse_time (argv[7], &inpoint)) {
+        g_object_unref (obj);
+        return "invalid in-point";
+      }
+      g_object_set (obj, "in-point", inpoint, NULL);
+    }
+
+    layer = script_get_layer (ctx, atoi (argv[2]));
+    if (layer && GES_IS_SIMPLE_TIMELINE_LAYER (layer)) {
+      g_object_unref (obj);
+      return "simple layers ignore START, use another layer";
+    }
+    if (!layer || !ges_timeline_layer_add_object (layer, obj)) {
+      g_object_unref (obj);
+      return "couldn't add the object";
+    }
+    g_hash_table_insert (ctx->objects, g_strdup (argv[1]), obj);
+
+  } else if (!strcmp (argv[0], "move")) {
+    if (argc < 3 || !script_parse_time (argv[2], &start))
+      return "usage: move NAME START [LAYER]";
+
+    layer = argc > 3 ? script_get_layer (ctx, atoi (argv[3])) :
+        script_object_layer (obj);
+    if (!layer)
+      return "couldn't move to the layer";
+    if (GES_IS_SIMPLE_TIMELINE_LAYER (layer) ||
+        GES_IS_SIMPLE_TIMELINE_LAYER (script_object_layer (obj)))
+      return "simple layers ignore START, use another layer";
+
+    g_object_set (obj, "start", start, NULL);
+    if (layer != script_object_layer (obj) &&
+        !ges_timeline_object_move_to_layer (obj, layer))
+      return "couldn't move to the layer";
+
+  } else if (!strcmp (argv[0], "trim")) {
+    if (argc < 4 || !script_parse_time (argv[2], &inpoint) ||
+        !script_parse_time (argv[3], &duration))
+      return "usage: trim NAME INPOINT DURATION";
+
+    g_object_set (obj, "in-point", inpoint, "duration", duration, NULL);
+
+  } else if (!strcmp (argv[0], "split")) {
+    GESTimelineObject *new_obj;
+
+    if (argc < 4 || !script_parse_time (argv[2], &start))
+      return "usage: split NAME POSITION NEW-NAME";
+    if (g_hash_table_lookup (ctx->objects, argv[3]))
+      return "an object already has that name";
+    if (start <= GES_TIMELINE_OBJECT_START (obj) ||
+        start >= GES_TIMELINE_OBJECT_START (obj) +
+        GES_TIMELINE_OBJECT_DURATION (obj))
+      return "position outside of the object";
+    if (!(new_obj = ges_timeline_object_split (obj, start)))
+      return "couldn't split the object";
+
+    g_hash_table_insert (ctx->objects, g_strdup (argv[3]), new_obj);
+
+  } else if (!strcmp (argv[0], "effect")) {
+    gchar *desc;
+    gboolean res;
+
+    if (argc < 4)
+      return "usage: effect NAME audio|video BIN-DESCRIPTION";
+
+    desc = g_strjoinv (" ", argv + 3);
+    res = script_add_effect (obj, argv[2], desc);
+    g_free (desc);
+    if (!res)
+      return "couldn't add the effect";
+
+  } else if (!strcmp (argv[0], "set")) {
+    if (argc < 4)
+      return "usage: set NAME PROPERTY VALUE";
+    if (!script_set_property (obj, argv[2], argv[3]))
+      return "couldn't set the property";
+
+  } else if (!strcmp (argv[0], "remove")) {
+    layer = script_object_layer (obj);
+    if (!layer || !ges_timeline_layer_remove_object (layer, obj))
+      return "couldn't remove the object";
+    g_hash_table_remove (ctx->objects, argv[1]);
+
+  } else
+    return "unknown operation";
+
+  return NULL;
+}
+
+/* Names the objects already in the timeline, as the keyfile formatter
+ * names the sections of the objects it saves */
+static void
+script_name_objects (ScriptContext * ctx)
+{
+  GList *layers, *tmp, *objects, *otmp;
+  guint n = 0;
+
+  layers = ges_timeline_get_layers (ctx->timeline);
+  for (tmp = layers; tmp; tmp = tmp->next) {
+    objects = ges_timeline_layer_get_objects (tmp->data);
+    for (otmp = objects; otmp; otmp = otmp->next) {
+      g_hash_table_insert (ctx->objects, g_strdup_printf ("Object%u", n++),
+          otmp->data);
+      g_object_unref (otmp->data);
+    }
+    g_list_free (objects);
+    g_object_unref (tmp->data);
+  }
+  g_list_free (layers);
+}
+
+static gboolean
+run_script (GESTimeline * timeline, gchar * path)
+{
+  ScriptContext ctx;
+  gchar *contents, **lines;
+  GError *err = NULL;
+  GTimer *timer;
+  gdouble edit_time;
+  guint i, nops = 0;
+  gboolean res = TRUE;
+
+  if (!g_file_get_contents (path, &contents, NULL, &err)) {
+    g_printerr ("Couldn't read %s: %s\n", path, err->message);
+    g_error_free (err);
+    return FALSE;
+  }
+
+  ctx.timeline = timeline;
+  ctx.objects = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  ctx.layers = g_hash_table_new (g_direct_hash, g_direct_equal);
+  script_name_objects (&ctx);
+
+  lines = g_strsplit (contents, "\n", -1);
+  g_free (contents);
+
+  timer = g_timer_new ();
+  ges_timeline_begin_batch (timeline);
+
+  for (i = 0; lines[i] && res; i++) {
+    gint argc;
+    gchar **argv;
+    const gchar *error;
+    gchar *line = g_strstrip (lines[i]);
+
+    if (*line == '\0' || *line == '#')
+      continue;
+
+    if (!g_shell_parse_argv (line, &argc, &argv, &err)) {
+      g_printerr ("%s:%u: %s\n", path, i + 1, err->message);
+      g_clear_error (&err);
+      res = FALSE;
+      break;
+    }
+
+    if ((error = script_run_operation (&ctx, argc, argv))) {
+      g_printerr ("%s:%u: %s: %s\n", path, i + 1, argv[0], error);
+      res = FALSE;
+    } else
+      nops++;
+    g_strfreev (argv);
+  }
+
+  edit_time = g_timer_elapsed (timer, NULL);
+  g_timer_start (timer);
+  if (!ges_timeline_end_batch (timeline))
+    res = FALSE;
+
+  g_printf ("Ran %u operations from %s in %.3f s (%.2f us/op), "
+      "updated the tracks in %.3f s\n", nops, path, edit_time,
+      nops ? edit_time * G_USEC_PER_SEC / nops : 0.0,
+      g_timer_elapsed (timer, NULL));
+
+  g_timer_destroy (timer);
+  g_strfreev (lines);
+  g_hash_table_destroy (ctx.objects);
+  g_hash_table_destroy (ctx.layers);
+
+  return res;
+}
+
 static GESTimelinePipeline *
-create_pipeline (gchar * load_path, gchar * save_path, int argc, char **argv,
-    gchar * audio, gchar * video)
+create_pipeline (gchar * load_path, gchar * save_path, gchar * script_path,
+    int argc, char **argv, gchar * audio, gchar * video)
 {
   GESTimelinePipeline *pipeline = NULL;
   GESTimeline *timeline = NULL;
@@ -299,6 +996,9 @@ create_pipeline (gchar * load_path, gchar * save_path, int argc, char **argv,
   if (!(timeline = create_timeline (argc, argv, audio, video)))
     goto failure;
 
+  if (script_path && !run_script (timeline, script_path))
+    goto failure;
+
   /* save project if path is given. we do this now in case GES crashes or
    * hangs during playback. */
   if (save_path) {
@@ -370,6 +1070,291 @@ bus_message_cb (GstBus * bus, GstMessage * message, GMainLoop * mainloop)
   }
 }
 
+/* Render server
+ *
+ * Reads render jobs from stdin, one per line:
+ *
+ *   PROJECT OUTPUT-URI [FORMAT [AFORMAT [VFORMAT]]]
+ *
+ * The formats default to the ones given on the command line. The jobs are
+ * rendered by several pipelines at once, reusing the already initialized
+ * GStreamer and GES. */
+
+typedef struct _RenderServer RenderServer;
+
+typedef struct
+{
+  RenderServer *server;
+  guint id;
+  gchar *project;
+  gchar *outputuri;
+  GstEncodingProfile *profile;
+
+  GESTimeline *timeline;
+  GESTimelinePipeline *pipeline;
+  guint bus_watch;
+  GTimer *timer;
+} RenderJob;
+
+struct _RenderServer
+{
+  GMainLoop *mainloop;
+  GQueue *pending;
+  GList *running;
+  guint max_jobs;
+  guint next_id;
+  gboolean input_done;
+  guint done, failed;
+  GstClockTime rendered;
+  GTimer *timer;
+
+  gchar *container, *audio, *video;
+  gchar *video_restriction, *audio_preset, *video_preset;
+};
+
+static void server_schedule (RenderServer * server);
+
+static void
+render_job_free (RenderJob * job)
+{
+  if (job->bus_watch)
+    g_source_remove (job->bus_watch);
+  if (job->pipeline) {
+    gst_element_set_state (GST_ELEMENT (job->pipeline), GST_STATE_NULL);
+    gst_object_unref (job->pipeline);
+  }
+  if (job->profile)
+    gst_encoding_profile_unref (job->profile);
+  if (job->timer)
+    g_timer_destroy (job->timer);
+  g_free (job->project);
+  g_free (job->outputuri);
+  g_slice_free (RenderJob, job);
+}
+
+static gdouble
+render_job_speed (RenderJob * job, GstClockTime position)
+{
+  gdouble elapsed = g_timer_elapsed (job->timer, NULL);
+
+  return elapsed > 0 ? (gdouble) position / GST_SECOND / elapsed : 0.0;
+}
+
+static void
+render_job_finish (RenderJob * job, const gchar * error)
+{
+  RenderServer *server = job->server;
+  GstClockTime duration = 0;
+
+  if (job->timeline)
+    g_object_get (job->timeline, "duration", &duration, NULL);
+
+  if (error) {
+    g_printf ("job %u: failed: %s\n", job->id, error);
+    server->failed++;
+  } else {
+    g_printf ("job %u: done in %.3f s (%.2fx realtime)\n", job->id,
+        g_timer_elapsed (job->timer, NULL), render_job_speed (job, duration));
+    server->done++;
+    server->rendered += duration;
+  }
+
+  server->running = g_list_remove (server->running, job);
+  render_job_free (job);
+  server_schedule (server);
+}
+
+static gboolean
+render_job_bus_cb (GstBus * bus, GstMessage * message, RenderJob * job)
+{
+  switch (GST_MESSAGE_TYPE (message)) {
+    case GST_MESSAGE_ERROR:{
+      GError *err = NULL;
+
+      gst_message_parse_error (message, &err, NULL);
+      /* The watch goes away with the job */
+      job->bus_watch = 0;
+      render_job_finish (job, err->message);
+      g_error_free (err);
+      return FALSE;
+    }
+    case GST_MESSAGE_EOS:
+      job->bus_watch = 0;
+      render_job_finish (job, NULL);
+      return FALSE;
+    default:
+      return TRUE;
+  }
+}
+
+static void
+render_job_progress_cb (GESTimelinePipeline * pipeline, guint64 position,
+    guint64 duration, gdouble speed, guint64 eta, RenderJob * job)
+{
+  if (GST_CLOCK_TIME_IS_VALID (eta))
+    g_printf ("job %u: %.1f%% (%.2fx realtime, %.1f s left)\n", job->id,
+        duration ? 100.0 * position / duration : 100.0, speed,
+        (gdouble) eta / GST_SECOND);
+  else
+    g_printf ("job %u: %.1f%%\n", job->id,
+        duration ? 100.0 * position / duration : 100.0);
+}
+
+static gboolean
+render_job_start (RenderJob * job)
+{
+  GstBus *bus;
+  gchar *uri;
+
+  job->timer = g_timer_new ();
+
+  if (!(uri = ensure_uri (job->project)))
+    return FALSE;
+  job->timeline = ges_timeline_new_from_uri (uri);
+  g_free (uri);
+  if (!job->timeline)
+    return FALSE;
+
+  job->pipeline = ges_timeline_pipeline_new ();
+  if (!ges_timeline_pipeline_add_timeline (job->pipeline, job->timeline) ||
+      !ges_timeline_pipeline_set_render_settings (job->pipeline,
+          job->outputuri, job->profile) ||
+      !ges_timeline_pipeline_set_mode (job->pipeline, TIMELINE_MODE_RENDER))
+    return FALSE;
+
+  g_signal_connect (job->pipeline, "render-progress",
+      G_CALLBACK (render_job_progress_cb), job);
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (job->pipeline));
+  job->bus_watch = gst_bus_add_watch (bus, (GstBusFunc) render_job_bus_cb, job);
+  gst_object_unref (bus);
+
+  return gst_element_set_state (GST_ELEMENT (job->pipeline),
+      GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE;
+}
+
+static void
+server_schedule (RenderServer * server)
+{
+  RenderJob *job;
+
+  while (g_list_length (server->running) < server->max_jobs &&
+      (job = g_queue_pop_head (server->pending))) {
+    g_printf ("job %u: rendering %s to %s\n", job->id, job->project,
+        job->outputuri);
+    server->running = g_list_append (server->running, job);
+    if (!render_job_start (job))
+      render_job_finish (job, "couldn't set up the pipeline");
+  }
+
+  if (server->input_done && !server->running &&
+      g_queue_is_empty (server->pending))
+    g_main_loop_quit (server->mainloop);
+}
+
+static void
+server_add_job (RenderServer * server, gchar * line)
+{
+  RenderJob *job;
+  gchar **argv;
+  gint argc;
+  gchar *formats[3];
+  guint i;
+
+  if (!g_shell_parse_argv (line, &argc, &argv, NULL) || argc < 2) {
+    g_printf ("invalid job: %s\n", line);
+    return;
+  }
+
+  formats[0] = server->container;
+  formats[1] = server->audio;
+  formats[2] = server->video;
+  for (i = 0; i < 3 && i + 2 < (guint) argc; i++)
+    formats[i] = strcmp (argv[i + 2], "none") ? argv[i + 2] : NULL;
+
+  job = g_slice_new0 (RenderJob);
+  job->server = server;
+  job->id = server->next_id++;
+  job->project = g_strdup (argv[0]);
+  job->outputuri = g_strdup (argv[1]);
+  job->profile = make_encoding_profile (formats[1], formats[2],
+      server->video_restriction, server->audio_preset, server->video_preset,
+      formats[0]);
+  g_strfreev (argv);
+
+  g_printf ("job %u: queued\n", job->id);
+  g_queue_push_tail (server->pending, job);
+  server_schedule (server);
+}
+
+static gboolean
+server_input_cb (GIOChannel * channel, GIOCondition cond,
+    RenderServer * server)
+{
+  gchar *line = NULL;
+  GIOStatus status;
+
+  status = g_io_channel_read_line (channel, &line, NULL, NULL, NULL);
+  if (status == G_IO_STATUS_NORMAL) {
+    g_strstrip (line);
+    if (*line && *line != '#')
+      server_add_job (server, line);
+    g_free (line);
+    return TRUE;
+  }
+
+  if (status == G_IO_STATUS_AGAIN)
+    return TRUE;
+
+  server->input_done = TRUE;
+  server_schedule (server);
+  return FALSE;
+}
+
+static int
+run_server (guint max_jobs, gchar * container, gchar * audio, gchar * video,
+    gchar * video_restriction, gchar * audio_preset, gchar * video_preset)
+{
+  RenderServer server = { 0, };
+  GIOChannel *channel;
+  gdouble elapsed;
+
+  server.mainloop = g_main_loop_new (NULL, FALSE);
+  server.pending = g_queue_new ();
+  server.max_jobs = MAX (max_jobs, 1);
+  server.container = container;
+  server.audio = audio;
+  server.video = video;
+  server.video_restriction = video_restriction;
+  server.audio_preset = audio_preset;
+  server.video_preset = video_preset;
+  server.timer = g_timer_new ();
+
+#ifdef G_OS_WIN32
+  channel = g_io_channel_win32_new_fd (0);
+#else
+  channel = g_io_channel_unix_new (0);
+#endif
+  g_io_add_watch (channel, G_IO_IN | G_IO_HUP | G_IO_ERR,
+      (GIOFunc) server_input_cb, &server);
+
+  g_printf ("Rendering up to %u jobs at once, reading jobs from stdin\n",
+      server.max_jobs);
+  g_main_loop_run (server.mainloop);
+
+  elapsed = g_timer_elapsed (server.timer, NULL);
+  g_printf ("%u job(s) done, %u failed in %.3f s (%.2fx realtime)\n",
+      server.done, server.failed, elapsed,
+      elapsed > 0 ? (gdouble) server.rendered / GST_SECOND / elapsed : 0.0);
+
+  g_io_channel_unref (channel);
+  g_timer_destroy (server.timer);
+  g_queue_free (server.pending);
+  g_main_loop_unref (server.mainloop);
+
+  return server.failed ? 1 : 0;
+}
+
 static void
 print_enum (GType enum_type)
 {
@@ -443,6 +1428,16 @@ main (int argc, gchar ** argv)
   gchar *save_path = NULL;
   gchar *load_path = NULL;
   gchar *project_path = NULL;
+  gchar **ranges = NULL;
+  static gboolean benchmark = FALSE;
+  gchar *benchmark_path = NULL;
+  gchar *benchmark_output = NULL;
+  gchar *trace_path = NULL;
+  gchar *script_path = NULL;
+  static gboolean server = FALSE;
+  gint server_jobs = 0;
+  GTimer *timer = NULL;
+  gdouble cpu_time = 0;
   GOptionEntry options[] = {
     {"thumbnail", 'm', 0.0, G_OPTION_ARG_DOUBLE, &thumbinterval,
         "Take thumbnails every n seconds (saved in current directory)", "N"},
@@ -480,6 +1475,26 @@ main (int argc, gchar ** argv)
         "Do not output status information of TYPE", "TYPE1,TYPE2,..."},
     {"load-xptv", 'y', 0, G_OPTION_ARG_STRING, &project_path,
         "Load xptv project from file for previewing", "<path>"},
+    {"range", 0, 0, G_OPTION_ARG_STRING_ARRAY, &ranges,
+          "Only render the given range of the timeline (in seconds). Can be "
+          "repeated, the ranges are rendered one after the other",
+        "START-STOP"},
+    {"benchmark", 'b', 0, G_OPTION_ARG_NONE, &benchmark,
+          "Render as fast as possible (to a temporary file if no outputuri "
+          "is given) and print performance figures as JSON", NULL},
+    {"benchmark-output", 0, 0, G_OPTION_ARG_FILENAME, &benchmark_output,
+        "Write the benchmark results to this file instead of stdout", "<path>"},
+    {"script", 'e', 0, G_OPTION_ARG_FILENAME, &script_path,
+          "Run the edit script in this file on the timeline, as a single "
+          "batch, before playing or rendering it", "<path>"},
+    {"server", 0, 0, G_OPTION_ARG_NONE, &server,
+          "Render the jobs read from stdin, one per line: PROJECT OUTPUT-URI "
+          "[FORMAT [AFORMAT [VFORMAT]]]", NULL},
+    {"jobs", 'j', 0, G_OPTION_ARG_INT, &server_jobs,
+        "Number of jobs rendered at once in server mode", "N"},
+    {"trace", 0, 0, G_OPTION_ARG_FILENAME, &trace_path,
+          "Trace the timeline edits and write them to this file in the "
+          "Chrome trace-event format", "<path>"},
     {NULL}
   };
   GOptionContext *ctx;
@@ -505,7 +1520,19 @@ main (int argc, gchar ** argv)
       "greater than 0)\n\n"
       "Durations in all cases can be fractions of a second.\n\n"
       "Example:\n"
-      "ges-launch file1.avi 0 45 +transition crossfade 3.5 file2.avi 0 0");
+      "ges-launch file1.avi 0 45 +transition crossfade 3.5 file2.avi 0 0\n\n"
+      "An edit script given with -e is a list of operations, one per line:\n"
+      "  add NAME LAYER START DURATION file PATH [INPOINT]\n"
+      "  add NAME LAYER START DURATION pattern|transition|title ARG\n"
+      "  move NAME START [LAYER]\n"
+      "  trim NAME INPOINT DURATION\n"
+      "  split NAME POSITION NEW-NAME\n"
+      "  effect NAME audio|video BIN-DESCRIPTION\n"
+      "  set NAME PROPERTY VALUE\n"
+      "  remove NAME\n"
+      "The objects of a project loaded with -q are named Object0, Object1, ...\n"
+      "in the order of their layers. Objects can't be added or moved to a\n"
+      "START in a simple layer.");
   g_option_context_add_main_entries (ctx, options, NULL);
   g_option_context_add_group (ctx, gst_init_get_option_group ());
 
@@ -535,7 +1562,24 @@ main (int argc, gchar ** argv)
     load_project (project_path);
     exit (0);
   }
-  if (((!load_path && (argc < 4))) || (outputuri && (!render && !smartrender))) {
+
+  if (server) {
+    g_option_context_free (ctx);
+
+    if (server_jobs <= 0) {
+#ifdef G_OS_UNIX
+      server_jobs = sysconf (_SC_NPROCESSORS_ONLN);
+#else
+      server_jobs = 2;
+#endif
+    }
+
+    return run_server (server_jobs, container,
+        strcmp (audio, "none") ? audio : NULL,
+        strcmp (video, "none") ? video : NULL, video_restriction,
+        audio_preset, video_preset);
+  }
+  if (((!load_path && !script_path && (argc < 4))) || (outputuri && (!render && !smartrender && !benchmark))) {
     g_printf ("%s", g_option_context_get_help (ctx, TRUE, NULL));
     g_option_context_free (ctx);
     exit (1);
@@ -549,12 +1593,35 @@ main (int argc, gchar ** argv)
   if (strcmp (video, "none") == 0)
     video = NULL;
 
+  if (trace_path)
+    ges_trace_set_enabled (TRUE);
+
   /* Create the pipeline */
-  pipeline = create_pipeline (load_path, save_path, argc - 1, argv + 1,
-      audio, video);
+  pipeline = create_pipeline (load_path, save_path, script_path, argc - 1,
+      argv + 1, audio, video);
   if (!pipeline)
     exit (1);
 
+  /* Benchmarking renders, to a file we throw away if needed */
+  if (benchmark) {
+    if (!smartrender)
+      render = TRUE;
+
+    if (!outputuri) {
+      gint fd = g_file_open_tmp ("ges-launch-benchmark-XXXXXX",
+          &benchmark_path, NULL);
+
+      if (fd < 0) {
+        g_printerr ("Couldn't create a temporary file to render to\n");
+        exit (1);
+      }
+      close (fd);
+      outputuri = g_filename_to_uri (benchmark_path, NULL, NULL);
+    }
+
+    benchmark_setup (pipeline);
+  }
+
   /* Setup profile/encoding if needed */
   if (render || smartrender) {
     GstEncodingProfile *prof;
@@ -568,6 +1635,10 @@ main (int argc, gchar ** argv)
             smartrender ? TIMELINE_MODE_SMART_RENDER : TIMELINE_MODE_RENDER))
       exit (1);
 
+    if (ranges && !add_render_ranges (pipeline, ranges))
+      exit (1);
+    g_strfreev (ranges);
+
     g_free (outputuri);
     gst_encoding_profile_unref (prof);
   } else {
@@ -593,6 +1664,11 @@ main (int argc, gchar ** argv)
   gst_bus_add_signal_watch (bus);
   g_signal_connect (bus, "message", G_CALLBACK (bus_message_cb), mainloop);
 
+  if (benchmark) {
+    timer = g_timer_new ();
+    cpu_time = get_cpu_time ();
+  }
+
   if (gst_element_set_state (GST_ELEMENT (pipeline),
           GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
     g_error ("Failed to start the encoding\n");
@@ -600,8 +1676,32 @@ main (int argc, gchar ** argv)
   }
   g_main_loop_run (mainloop);
 
+  if (benchmark) {
+    gdouble wall_time = g_timer_elapsed (timer, NULL);
+    FILE *out = benchmark_output ? g_fopen (benchmark_output, "w") : stdout;
+
+    if (out) {
+      benchmark_report (out, wall_time, get_cpu_time () - cpu_time);
+      if (out != stdout)
+        fclose (out);
+    } else
+      g_printerr ("Couldn't open %s\n", benchmark_output);
+    g_timer_destroy (timer);
+  }
+
   gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
 
+  if (trace_path) {
+    if (!ges_trace_save (trace_path))
+      g_printerr ("Couldn't write the trace to %s\n", trace_path);
+    g_free (trace_path);
+  }
+
+  if (benchmark_path) {
+    g_unlink (benchmark_path);
+    g_free (benchmark_path);
+  }
+
   gst_object_unref (pipeline);
 
   return (int) seenerrors;